@@ -28,6 +28,7 @@
 
 #include <panic.h>
 #include <task_list.h>
+#include <message_broker.h>
 #include <logging.h>
 
 /* Make the type used for message IDs available in debug tools */
@@ -622,7 +623,8 @@ static void ancstateManager_MsgRegisteredClientsOnFFGainUpdate(void)
         MESSAGE_MAKE(ind, AANC_FF_GAIN_UPDATE_IND_T);
         ind->aanc_ff_gain = ancStateManager_GetAancFFGain();
 
-        TaskList_MessageSend(anc_sm->client_tasks, AANC_FF_GAIN_UPDATE_IND, ind);
+        /* Gain updates arrive in bursts, only the latest one is worth delivering */
+        MessageBroker_SendState(ANC_MESSAGE_GROUP, anc_sm->client_tasks, AANC_FF_GAIN_UPDATE_IND, ind);
     }
 }
 
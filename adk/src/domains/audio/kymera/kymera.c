@@ -257,6 +257,20 @@ void appKymeraA2dpStart(uint16 *client_lock, uint16 client_lock_mask,
                              &theKymera->lock);
 }
 
+#ifdef INCLUDE_MIRRORING
+void appKymeraA2dpPrewarm(const a2dp_codec_settings *codec_settings, uint32 max_bitrate)
+{
+    kymeraTaskData *theKymera = KymeraGetTaskData();
+    DEBUG_LOG("appKymeraA2dpPrewarm, seid %u", codec_settings->seid);
+
+    MAKE_KYMERA_MESSAGE(KYMERA_INTERNAL_A2DP_PREWARM);
+    message->codec_settings = *codec_settings;
+    message->max_bitrate = max_bitrate;
+    MessageSendConditionally(&theKymera->task, KYMERA_INTERNAL_A2DP_PREWARM,
+                             message, &theKymera->lock);
+}
+#endif /* INCLUDE_MIRRORING */
+
 void appKymeraA2dpStop(uint8 seid, Source source)
 {
     kymeraTaskData *theKymera = KymeraGetTaskData();
@@ -611,6 +625,10 @@ void appKymeraProspectiveDspPowerOn(void)
 static void appKymeraHandleProspectivePowerOff(void)
 {
     DEBUG_LOG("appKymeraHandleProspectivePowerOff");
+#ifdef INCLUDE_MIRRORING
+    /* Any pre-built chain must be destroyed while the DSP is still powered */
+    appKymeraA2dpDiscardPrewarm();
+#endif
     OperatorsFrameworkDisable();
 }
 
@@ -932,6 +950,14 @@ static void kymera_msg_handler(Task task, MessageId id, Message msg)
             appKymeraA2dpHandleMessageMoreData((const MessageMoreData *)msg);
         break;
 
+        case KYMERA_INTERNAL_A2DP_PREWARM:
+            appKymeraA2dpHandlePrewarm((const KYMERA_INTERNAL_A2DP_PREWARM_T *)msg);
+        break;
+
+        case KYMERA_INTERNAL_A2DP_PREWARM_TIMEOUT:
+            appKymeraA2dpDiscardPrewarm();
+        break;
+
         case KYMERA_INTERNAL_LATENCY_CHECK_TIMEOUT:
             Kymera_DynamicLatencyHandleLatencyTimeout();
         break;
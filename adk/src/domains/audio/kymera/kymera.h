@@ -333,6 +333,22 @@ typedef struct
     appKymeraAudioSyncState state;
     Source source;
 } appKymeraAudioSyncInfo;
+
+/*! \brief Kymera A2DP pre-warmed input chain information structure */
+typedef struct
+{
+    /*! Input chain built and connected ahead of the A2DP start, NULL if none */
+    kymera_chain_handle_t input_handle;
+    /*! The parameters the input chain was configured with */
+    uint32 rate;
+    uint32 max_bitrate;
+    /*! The TTP latency set on the RTP decoder, in microseconds */
+    uint32 ttp_latency;
+    uint8 seid;
+    unsigned cp_header_enabled : 1;
+    unsigned is_left : 1;
+    unsigned enable_left_right_mix : 1;
+} appKymeraA2dpPrewarmInfo;
 #endif /* INCLUDE_MIRRORING */
 
 /*! \brief Kymera instance structure.
@@ -406,6 +422,9 @@ typedef struct
     /* A2DP media source */
     Source media_source;
 
+    /* A2DP input chain pre-warm information */
+    appKymeraA2dpPrewarmInfo prewarm;
+
 #else
     /*! The TWS master packetiser transform packs compressed audio frames
         (SBC, AAC, aptX) from the audio subsystem into TWS packets for transmission
@@ -838,6 +857,19 @@ void appKymeraA2dpSetSyncStartTime(uint32 clock);
  *        operations.  See handover_if library documentation for more information.
  */
 extern const handover_interface kymera_a2dp_mirror_handover_if;
+
+/*! \brief Pre-build the A2DP input chain for the configured codec.
+    \param codec_settings The A2DP codec settings.
+    \param max_bitrate The max bitrate for the input stream (in bps). Ignored if zero.
+
+    Called on the primary when the A2DP media channel has been configured, and on
+    the secondary when the primary's stream context arrives, so that the next
+    A2DP start only has to connect and start the chains. The chain is destroyed
+    if not used within appConfigA2dpPrewarmTimeout().
+*/
+void appKymeraA2dpPrewarm(const a2dp_codec_settings *codec_settings, uint32 max_bitrate);
+#else
+#define appKymeraA2dpPrewarm(codec_settings, max_bitrate) ((void)(0))
 #endif /* INCLUDE_MIRRORING */
 
 /*! \brief Connects passthrough operator to dac in order to mitigate tonal noise
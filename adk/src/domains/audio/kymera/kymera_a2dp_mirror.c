@@ -186,11 +186,37 @@ static void appKymeraConfigureInputChain(kymeraTaskData *theKymera,
     ChainConnect(chain_handle);
 }
 
+unsigned appKymeraA2dpGetOutputKickPeriod(uint8 seid, bool gaming_mode)
+{
+    if (Kymera_FastKickPeriodInGamingMode() && gaming_mode)
+    {
+        return KICK_PERIOD_FAST;
+    }
+
+    switch (seid)
+    {
+        case AV_SEID_SBC_SNK:
+            return KICK_PERIOD_MASTER_SBC;
+
+        case AV_SEID_AAC_SNK:
+            return KICK_PERIOD_MASTER_AAC;
+
+        case AV_SEID_APTX_SNK:
+            return KICK_PERIOD_MASTER_APTX;
+
+        case AV_SEID_APTX_ADAPTIVE_SNK:
+            return KICK_PERIOD_MASTER_APTX_ADAPTIVE;
+
+        default:
+            return KICK_PERIOD_FAST;
+    }
+}
+
 static void appKymeraCreateAndConfigureOutputChain(uint8 seid, uint32 rate,
                                                    int16 volume_in_db)
 {
     kymeraTaskData *theKymera = KymeraGetTaskData();
-    unsigned kick_period = KICK_PERIOD_FAST;
+    unsigned kick_period;
     unsigned block_size = 256;
     // the sosy and vc operators are created with prio 2, and there is no CVC operator,
     // so the two operators have low scheduling latency. MAX_PERIOD can be set close to 1.
@@ -204,29 +230,19 @@ static void appKymeraCreateAndConfigureOutputChain(uint8 seid, uint32 rate,
     switch (seid)
     {
         case AV_SEID_SBC_SNK:
-            kick_period = KICK_PERIOD_MASTER_SBC;
             block_size = 384;
             break;
 
         case AV_SEID_AAC_SNK:
-            kick_period = KICK_PERIOD_MASTER_AAC;
             block_size = 1024;
             break;
 
         case AV_SEID_APTX_SNK:
-            kick_period = KICK_PERIOD_MASTER_APTX;
-            block_size = 512;
-            break;
-
         case AV_SEID_APTX_ADAPTIVE_SNK:
-            kick_period = KICK_PERIOD_MASTER_APTX_ADAPTIVE;
             block_size = 512;
             break;
     }
-    if (Kymera_FastKickPeriodInGamingMode() && Kymera_LatencyManagerIsGamingModeEnabled())
-    {
-        kick_period = KICK_PERIOD_FAST;
-    }
+    kick_period = appKymeraA2dpGetOutputKickPeriod(seid, Kymera_LatencyManagerIsGamingModeEnabled());
     theKymera->output_rate = rate;
     config.rate = rate;
     config.kick_period = kick_period;
@@ -626,6 +642,121 @@ static void appKymeraStartChains(kymeraTaskData *theKymera)
     }
 }
 
+void appKymeraA2dpDiscardPrewarm(void)
+{
+    kymeraTaskData *theKymera = KymeraGetTaskData();
+
+    MessageCancelAll(KymeraGetTask(), KYMERA_INTERNAL_A2DP_PREWARM_TIMEOUT);
+
+    if (theKymera->prewarm.input_handle)
+    {
+        DEBUG_LOG("appKymeraA2dpDiscardPrewarm, seid %u", theKymera->prewarm.seid);
+        ChainDestroy(theKymera->prewarm.input_handle);
+        theKymera->prewarm.input_handle = NULL;
+    }
+}
+
+/*! \brief Check if the pre-built input chain was configured with the given parameters.
+    The target latency is compared too, as gaming mode may have been toggled
+    since the chain was built. */
+static bool appKymeraA2dpIsPrewarmedFor(kymeraTaskData *theKymera,
+                                        uint8 seid, uint32 rate, uint32 max_bitrate,
+                                        bool cp_header_enabled, bool is_left)
+{
+    appKymeraA2dpPrewarmInfo *prewarm = &theKymera->prewarm;
+
+    return (prewarm->input_handle &&
+            prewarm->seid == seid && prewarm->rate == rate &&
+            prewarm->max_bitrate == max_bitrate &&
+            prewarm->ttp_latency == Kymera_LatencyManagerGetLatencyForSeidInUs(seid) &&
+            prewarm->cp_header_enabled == cp_header_enabled &&
+            prewarm->is_left == is_left &&
+            prewarm->enable_left_right_mix == theKymera->enable_left_right_mix);
+}
+
+void appKymeraA2dpHandlePrewarm(const KYMERA_INTERNAL_A2DP_PREWARM_T *msg)
+{
+    kymeraTaskData *theKymera = KymeraGetTaskData();
+    appKymeraA2dpPrewarmInfo *prewarm = &theKymera->prewarm;
+    aptx_adaptive_ttp_latencies_t nq2q_ttp = {0};
+    bool cp_header_enabled;
+    uint32 rate;
+    uint8 seid;
+    Source source;
+    uint16 mtu;
+    bool is_left = Multidevice_IsLeft();
+
+    appKymeraGetA2dpCodecSettingsCore(&msg->codec_settings, &seid, &source, &rate, &cp_header_enabled, &mtu);
+
+    /* Only pre-build when nothing else is using the DSP. The aptX adaptive
+       chain depends on the Q2Q mode, which is only known at start. */
+    if (appKymeraGetState() != KYMERA_STATE_IDLE || !appA2dpIsSeidNonTwsSink(seid) ||
+        seid == AV_SEID_APTX_ADAPTIVE_SNK)
+    {
+        DEBUG_LOG("appKymeraA2dpHandlePrewarm, ignored, state %u, seid %u", appKymeraGetState(), seid);
+        return;
+    }
+
+    /* The same codec may be reported more than once before the start */
+    if (appKymeraA2dpIsPrewarmedFor(theKymera, seid, rate, msg->max_bitrate, cp_header_enabled, is_left))
+    {
+        DEBUG_LOG("appKymeraA2dpHandlePrewarm, already built, seid %u", seid);
+        MessageCancelAll(KymeraGetTask(), KYMERA_INTERNAL_A2DP_PREWARM_TIMEOUT);
+        MessageSendLater(KymeraGetTask(), KYMERA_INTERNAL_A2DP_PREWARM_TIMEOUT, NULL,
+                         appConfigA2dpPrewarmTimeout());
+        return;
+    }
+
+    appKymeraA2dpDiscardPrewarm();
+    appKymeraProspectiveDspPowerOn();
+
+    DEBUG_LOG("appKymeraA2dpHandlePrewarm, seid %u, rate %u", seid, rate);
+
+    /* Build into the active handle so the start code path is shared, then
+       set the chain aside until the A2DP start */
+    theKymera->q2q_mode = 0;
+    appKymeraCreateInputChain(theKymera, seid, is_left);
+    appKymeraConfigureInputChain(theKymera, seid,
+                                 rate, msg->max_bitrate, cp_header_enabled,
+                                 is_left, nq2q_ttp);
+    prewarm->input_handle = theKymera->chain_input_handle;
+    theKymera->chain_input_handle = NULL;
+
+    prewarm->seid = seid;
+    prewarm->rate = rate;
+    prewarm->max_bitrate = msg->max_bitrate;
+    prewarm->ttp_latency = Kymera_LatencyManagerGetLatencyForSeidInUs(seid);
+    prewarm->cp_header_enabled = cp_header_enabled;
+    prewarm->is_left = is_left;
+    prewarm->enable_left_right_mix = theKymera->enable_left_right_mix;
+
+    MessageSendLater(KymeraGetTask(), KYMERA_INTERNAL_A2DP_PREWARM_TIMEOUT, NULL,
+                     appConfigA2dpPrewarmTimeout());
+    TimestampEvent(TIMESTAMP_EVENT_KYMERA_A2DP_PREWARMED);
+}
+
+/*! \brief Use the pre-built input chain if it was configured with the same parameters.
+    \return TRUE if the pre-built chain is now the active input chain. */
+static bool appKymeraA2dpAdoptPrewarm(kymeraTaskData *theKymera,
+                                      uint8 seid, uint32 rate, uint32 max_bitrate,
+                                      bool cp_header_enabled, bool is_left)
+{
+    appKymeraA2dpPrewarmInfo *prewarm = &theKymera->prewarm;
+
+    if (!theKymera->q2q_mode &&
+        appKymeraA2dpIsPrewarmedFor(theKymera, seid, rate, max_bitrate, cp_header_enabled, is_left))
+    {
+        DEBUG_LOG("appKymeraA2dpAdoptPrewarm, seid %u", seid);
+        MessageCancelAll(KymeraGetTask(), KYMERA_INTERNAL_A2DP_PREWARM_TIMEOUT);
+        theKymera->chain_input_handle = prewarm->input_handle;
+        prewarm->input_handle = NULL;
+        return TRUE;
+    }
+
+    appKymeraA2dpDiscardPrewarm();
+    return FALSE;
+}
+
 bool appKymeraA2dpStartMaster(const a2dp_codec_settings *codec_settings, uint32 max_bitrate, int16 volume_in_db,
                               aptx_adaptive_ttp_latencies_t nq2q_ttp)
 {
@@ -651,11 +782,17 @@ bool appKymeraA2dpStartMaster(const a2dp_codec_settings *codec_settings, uint32
     theKymera->cp_header_enabled = cp_header_enabled;
 
     KymeraPioSet();
+    TimestampEvent(TIMESTAMP_EVENT_KYMERA_A2DP_START);
     appKymeraCreateAndConfigureOutputChain(seid, rate, volume_in_db);
-    appKymeraCreateInputChain(theKymera, seid, is_left);
-    appKymeraConfigureInputChain(theKymera, seid,
-                                    rate, max_bitrate, cp_header_enabled,
-                                    is_left, nq2q_ttp);
+    TimestampEvent(TIMESTAMP_EVENT_KYMERA_A2DP_OUTPUT_CHAIN_READY);
+    if (!appKymeraA2dpAdoptPrewarm(theKymera, seid, rate, max_bitrate, cp_header_enabled, is_left))
+    {
+        appKymeraCreateInputChain(theKymera, seid, is_left);
+        appKymeraConfigureInputChain(theKymera, seid,
+                                        rate, max_bitrate, cp_header_enabled,
+                                        is_left, nq2q_ttp);
+    }
+    TimestampEvent(TIMESTAMP_EVENT_KYMERA_A2DP_INPUT_CHAIN_READY);
     Kymera_CreateMusicProcessingChain();
     Kymera_ConfigureMusicProcessing(rate);
     appKymeraJoinChains(theKymera);
@@ -705,6 +842,7 @@ bool appKymeraA2dpStartMaster(const a2dp_codec_settings *codec_settings, uint32
 
     appKymeraConfigureDspPowerMode();
     appKymeraStartChains(theKymera);
+    TimestampEvent(TIMESTAMP_EVENT_KYMERA_A2DP_CHAINS_STARTED);
     KymeraPioClr();
 
     theKymera->media_source = source;
@@ -1027,6 +1165,7 @@ void appKymeraA2dpHandleMessageMoreData(const MessageMoreData *mmd)
             MessageCancelFirst(KymeraGetTask(), KYMERA_INTERNAL_A2DP_MESSAGE_MORE_DATA_TIMEOUT);
 
             appKymeraConfigureAndStartHashTransform(theKymera, theKymera->a2dp_seid, mmd->source);
+            TimestampEvent(TIMESTAMP_EVENT_KYMERA_A2DP_FIRST_PACKET);
 
             /* Not interested in any more messages */
             SourceConfigure(mmd->source, VM_SOURCE_MESSAGES, VM_MESSAGES_NONE);
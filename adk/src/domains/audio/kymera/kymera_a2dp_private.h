@@ -60,6 +60,15 @@
 bool appKymeraA2dpStartMaster(const a2dp_codec_settings *codec_settings, uint32 max_bitrate, int16 volume_in_db,
                               aptx_adaptive_ttp_latencies_t nq2q_ttp);
 
+/*! \brief Get the kick period of the A2DP output chain.
+
+    \param seid The stream endpoint id of the codec.
+    \param gaming_mode TRUE to get the kick period used in gaming mode.
+
+    \return The kick period in microseconds.
+ */
+unsigned appKymeraA2dpGetOutputKickPeriod(uint8 seid, bool gaming_mode);
+
 /*! \brief Start A2DP forwarding.
 
     \param codec_settings The A2DP codec settings to use.
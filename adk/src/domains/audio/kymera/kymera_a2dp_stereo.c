@@ -152,12 +152,12 @@ static void appKymeraConfigureInputChain(kymeraTaskData *theKymera,
     ChainConnect(chain_handle);
 }
 
-static void appKymeraCreateAndConfigureOutputChain(uint8 seid, uint32 rate,
-                                                   int16 volume_in_db)
+unsigned appKymeraA2dpGetOutputKickPeriod(uint8 seid, bool gaming_mode)
 {
-    kymeraTaskData *theKymera = KymeraGetTaskData();
     unsigned kick_period = KICK_PERIOD_FAST;
-    DEBUG_LOG("appKymeraCreateAndConfigureOutputChain, creating output chain, completing startup");
+
+    /* The stereo output chain does not change kick period in gaming mode */
+    UNUSED(gaming_mode);
 
     switch (seid)
     {
@@ -183,6 +183,15 @@ static void appKymeraCreateAndConfigureOutputChain(uint8 seid, uint32 rate,
             Panic();
             break;
     }
+    return kick_period;
+}
+
+static void appKymeraCreateAndConfigureOutputChain(uint8 seid, uint32 rate,
+                                                   int16 volume_in_db)
+{
+    kymeraTaskData *theKymera = KymeraGetTaskData();
+    unsigned kick_period = appKymeraA2dpGetOutputKickPeriod(seid, FALSE);
+    DEBUG_LOG("appKymeraCreateAndConfigureOutputChain, creating output chain, completing startup");
 
     theKymera->output_rate = rate;
     KymeraOutput_CreateChain(kick_period, outputLatencyBuffer(), volume_in_db);
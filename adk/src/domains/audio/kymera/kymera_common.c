@@ -78,6 +78,13 @@ void appKymeraSetState(appKymeraState state)
     DEBUG_LOG_STATE("appKymeraSetState, state %u -> %u", theKymera->state, state);
     theKymera->state = state;
     KymeraAnc_PreStateTransition(state);
+#ifdef INCLUDE_MIRRORING
+    /* A pre-built A2DP input chain is only kept until an A2DP start adopts it */
+    if ((state != KYMERA_STATE_IDLE) && (state != KYMERA_STATE_A2DP_STARTING_A))
+    {
+        appKymeraA2dpDiscardPrewarm();
+    }
+#endif
     /* Set busy lock if not in idle or tone state */
     theKymera->busy_lock = (state != KYMERA_STATE_IDLE) && (state != KYMERA_STATE_TONE_PLAYING) && (state != KYMERA_STATE_STANDALONE_LEAKTHROUGH) && (state != KYMERA_STATE_ADAPTIVE_ANC_STARTED);
 }
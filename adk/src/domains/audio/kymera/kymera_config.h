@@ -255,6 +255,12 @@
     which the audio subsystem will be powered-off again if still inactive */
 #define appConfigProspectiveAudioOffTimeout() D_SEC(5)
 
+/*! After pre-building the A2DP input chain when the media channel opens, the
+    length of time after which the chain will be destroyed if A2DP has not started.
+    This must be shorter than appConfigProspectiveAudioOffTimeout(), so the chain
+    is destroyed before the DSP it was built on is powered off. */
+#define appConfigA2dpPrewarmTimeout() D_SEC(4)
+
 /*! When the secondary joins an a primary with active A2DP, it starts with its
     audio muted. After synchronising, it unmutes. This configures the unmute
     time (in milliseconds) once synchronised.
@@ -17,6 +17,14 @@
 #include "kymera_latency_manager.h"
 #include "kymera_private.h"
 
+/*! Averages in the jitter model are held in fixed point with this many
+    fractional bits. */
+#define DYNAMIC_LATENCY_AVG_FRAC_BITS   (4)
+#define DYNAMIC_LATENCY_AVG_ONE         (1 << DYNAMIC_LATENCY_AVG_FRAC_BITS)
+
+/*! Each new sample has 1/DYNAMIC_LATENCY_AVG_WEIGHT of the weight in the averages. */
+#define DYNAMIC_LATENCY_AVG_WEIGHT      (4)
+
 
 /*! \brief Dynamic latency state */
 typedef struct
@@ -33,8 +41,23 @@ typedef struct
     /*! The base latency for the current use case in milli-seconds */
     uint16 base_latency;
 
-    /*! Relay Packet percentage which was recorded at last latency update.*/
-    uint8 current_percentage;
+    /*! Sum of the flush and buffer error counts at the last measurement */
+    uint32 error_count;
+
+    /*! Average relay percentage, fixed point */
+    int32 relay_avg;
+
+    /*! Average deviation of the relay percentage from relay_avg, fixed point */
+    int32 relay_dev;
+
+    /*! Average packets received per measurement, fixed point */
+    int32 rx_avg;
+
+    /*! Average deviation of the packets received from rx_avg, fixed point */
+    int32 rx_dev;
+
+    /*! Measurements left before the latency may be reduced */
+    uint8 reduction_delay;
 
     /*! Relay % threshold beyond which latency is increased */
     uint8 relay_percentage_threshold;
@@ -47,6 +70,11 @@ typedef struct
     /*! This flag is set when dynamic adjustment is currently active */
     unsigned dynamic_adjustment_active : 1;
 
+    /*! Set once relay_packet_count, rx_packet_count and error_count hold a
+        sample of this device's ACL statistics. The statistics are cumulative,
+        so only the changes from this sample are used. */
+    unsigned counters_valid : 1;
+
 } kymera_dynamic_latency_data_t;
 
 kymera_dynamic_latency_data_t kymera_dynamic_latency_data;
@@ -83,9 +111,10 @@ void Kymera_DynamicLatencyStartDynamicAdjustment(uint16 base_latency)
     {
         kymera_dynamic_latency_data_t *data = KymeraGetDynamicLatencyData();
         DEBUG_LOG("Kymera_DynamicLatencyStartDynamicAdjustment");
-        data->relay_packet_count = 0;
-        data->rx_packet_count = 0;
-        data->current_percentage = data->relay_percentage_threshold;
+        data->counters_valid = 0;
+        data->relay_avg = data->relay_dev = 0;
+        data->rx_avg = data->rx_dev = 0;
+        data->reduction_delay = KYMERA_LATENCY_REDUCTION_DELAY_COUNTER;
         data->base_latency = data->dynamic_latency = base_latency;
         data->dynamic_adjustment_active = 1;
         Kymera_DynamicLatencyHandleLatencyTimeout();
@@ -137,6 +166,9 @@ void Kymera_DynamicLatencyHandoverCommit(bool is_primary)
     {
         if (Kymera_DynamicLatencyIsEnabled())
         {
+            /* The counters were sampled from the other device's statistics */
+            KymeraGetDynamicLatencyData()->counters_valid = 0;
+
             if (KymeraGetDynamicLatencyData()->dynamic_adjustment_active)
             {
                 Kymera_DynamicLatencyScheduleNextMeasurement();
@@ -150,45 +182,113 @@ void Kymera_DynamicLatencyHandoverCommit(bool is_primary)
 }
 
 
-static uint16 convertRelayPercentageToLatency(uint8 new_percentage)
+/*! \brief Move a fixed point average and its average deviation towards a new sample. */
+static void kymera_DynamicLatencyUpdateAverage(int32 *avg, int32 *dev, uint32 sample)
+{
+    int32 value = (int32)(sample << DYNAMIC_LATENCY_AVG_FRAC_BITS);
+
+    if (*avg == 0 && *dev == 0)
+    {
+        /* First sample, start the average from it */
+        *avg = value;
+        return;
+    }
+    *dev += (abs(value - *avg) - *dev) / DYNAMIC_LATENCY_AVG_WEIGHT;
+    *avg += (value - *avg) / DYNAMIC_LATENCY_AVG_WEIGHT;
+}
+
+/*! \brief Predict the latency needed to ride out the relaying and jitter seen.
+
+    The relay percentage is taken with a margin of twice its deviation, so a
+    link that is starting to vary raises the latency before the average does.
+    Above the threshold, each KYMERA_LATENCY_MINIMUM_PERCENT_CHANGE percent
+    needs a further KYMERA_LATENCY_UPDATE_UP_STEP_MS.
+
+    Variation in the packets received per measurement shows packets arriving
+    in bursts. Variation above KYMERA_LATENCY_JITTER_FLOOR_PERCENT adds the
+    same share of the measurement period.
+
+    Flushes and buffer errors show that buffering has already run out, so
+    each adds KYMERA_LATENCY_ERROR_PENALTY_MS.
+
+    \param new_errors Flush and buffer errors since the last measurement.
+    \return The predicted latency, in whole down steps above the base latency.
+*/
+static uint16 kymera_DynamicLatencyPredict(uint32 new_errors)
+{
+    kymera_dynamic_latency_data_t * data = KymeraGetDynamicLatencyData();
+    int32 relay_margin;
+    uint32 latency = data->base_latency;
+
+    relay_margin = ((data->relay_avg + 2 * data->relay_dev) >> DYNAMIC_LATENCY_AVG_FRAC_BITS)
+                   - data->relay_percentage_threshold;
+    if (relay_margin > 0)
+    {
+        latency += (uint32)relay_margin * KYMERA_LATENCY_UPDATE_UP_STEP_MS / KYMERA_LATENCY_MINIMUM_PERCENT_CHANGE;
+    }
+
+    if (data->rx_avg > 0)
+    {
+        uint32 jitter_percent = (uint32)data->rx_dev * 100 / (uint32)data->rx_avg;
+        if (jitter_percent > KYMERA_LATENCY_JITTER_FLOOR_PERCENT)
+        {
+            latency += (jitter_percent - KYMERA_LATENCY_JITTER_FLOOR_PERCENT) * KYMERA_LATENCY_CHECK_DELAY / 100;
+        }
+    }
+
+    latency += MIN(new_errors, KYMERA_LATENCY_ERROR_PENALTY_MAX) * KYMERA_LATENCY_ERROR_PENALTY_MS;
+
+    /* Round up to a whole number of down steps, so reductions land on the base latency */
+    latency = data->base_latency + ((latency - data->base_latency + KYMERA_LATENCY_UPDATE_DOWN_STEP_MS - 1)
+                                    / KYMERA_LATENCY_UPDATE_DOWN_STEP_MS) * KYMERA_LATENCY_UPDATE_DOWN_STEP_MS;
+
+    return (uint16)MIN(latency, TWS_STANDARD_LATENCY_MAX_MS);
+}
+
+/*! \brief Apply hysteresis to the predicted latency.
+
+    Increases take effect immediately. Decreases only happen once the
+    prediction has been at least KYMERA_LATENCY_DECREASE_HYSTERESIS_MS below
+    the current latency for KYMERA_LATENCY_REDUCTION_DELAY_COUNTER
+    measurements, and then close half the gap (at least one down step) each
+    measurement.
+
+    \param required The predicted latency.
+    \return The new latency.
+*/
+static uint16 kymera_DynamicLatencyApplyHysteresis(uint16 required)
 {
     kymera_dynamic_latency_data_t * data = KymeraGetDynamicLatencyData();
-    uint8 percentage_change; /* Change in relay % from current_percentage */
-    uint8 units_of_change;   /* Number of steps to increase/decrease */
-    uint16 value_of_change;  /* Value of latency to increase/decrease */
     uint16 latency = data->dynamic_latency;
 
-    percentage_change = abs(data->current_percentage - new_percentage);
-    if(new_percentage > data->current_percentage)
+    if (required > latency)
+    {
+        latency = required;
+        data->reduction_delay = KYMERA_LATENCY_REDUCTION_DELAY_COUNTER;
+    }
+    else if (required + KYMERA_LATENCY_DECREASE_HYSTERESIS_MS <= latency)
     {
-        /* increase latency as relay % has further increased */
-        units_of_change = percentage_change/KYMERA_LATENCY_MINIMUM_PERCENT_CHANGE;
-        DEBUG_LOG_VERBOSE("Units of Latency Change (increasing): %d", units_of_change);
-        value_of_change = KYMERA_LATENCY_UPDATE_UP_STEP_MS * units_of_change;
-        latency = MIN(latency + value_of_change, TWS_STANDARD_LATENCY_MAX_MS);
-        data->current_percentage = new_percentage;
+        if (data->reduction_delay)
+        {
+            data->reduction_delay--;
+        }
+        else
+        {
+            uint16 decrease = MAX((latency - required) / 2, KYMERA_LATENCY_UPDATE_DOWN_STEP_MS);
+            latency = MAX(latency - decrease, required);
+        }
     }
-    else if (latency > data->base_latency)
+    else
     {
-        /* If relay % has reduced but above threshold, decrease it proportional to change.
-           If relay % is below threshold, decrease it atleast by a single step since latency
-           is higher then default and needs to be reduced.
-        */
-        units_of_change = MAX(percentage_change/KYMERA_LATENCY_MINIMUM_PERCENT_CHANGE, 1);
-        DEBUG_LOG_VERBOSE("Units of Latency Change (decreasing): %d", units_of_change);
-        value_of_change = KYMERA_LATENCY_UPDATE_DOWN_STEP_MS * units_of_change;
-        latency = MAX(latency - value_of_change, data->base_latency);
-        data->current_percentage = MAX(new_percentage, data->relay_percentage_threshold);
+        data->reduction_delay = KYMERA_LATENCY_REDUCTION_DELAY_COUNTER;
     }
-    return latency;
+    return MAX(latency, data->base_latency);
 }
 
 /*
-    If relay percentage is increased by a threshold, latency is incremented by
-    KYMERA_LATENCY_UPDATE_UP_STEP_MS, untill MAX is reached.
-
-    If relay percentage is reduced by a thredhold, latency is reduced by
-    KYMERA_LATENCY_UPDATE_DOWN_STEP_MS, untill MIN (i.e. DEFAULT) is reached
+    The relay percentage and the number of packets received in each
+    measurement feed a model of the link. The latency needed is predicted
+    from the model and any packets flushed, and applied with hysteresis.
 */
 static uint16 kymera_DynamicLatencyUpdate(void)
 {
@@ -196,14 +296,29 @@ static uint16 kymera_DynamicLatencyUpdate(void)
     acl_reliable_mirror_debug_statistics_t stats;
     uint32 relay_change; /*packets relayed since last time */
     uint32 rx_change; /*packets received since last time */
+    uint32 error_count; /* flushes and buffer errors so far */
     uint8 relay_percentage;
     tp_bdaddr tp_addr;
+    uint16 required_latency;
     uint16 calculated_latency = 0;
 
     /*Get relayed and received packet counts from ACL Stats*/
     BdaddrTpFromBredrBdaddr(&tp_addr, MirrorProfile_GetMirroredDeviceAddress());
     if(AclReliableMirrorDebugStatistics(&tp_addr, &stats))
     {
+        error_count = stats.flush_flag_count + stats.out_of_buffers_count + stats.overflow_count;
+
+        if(!data->counters_valid)
+        {
+            /* The statistics count from when mirroring started, so the first
+               sample only sets the point the changes are measured from */
+            data->relay_packet_count = stats.relay_packet_count;
+            data->rx_packet_count = stats.rx_packet_count;
+            data->error_count = error_count;
+            data->counters_valid = 1;
+            return 0;
+        }
+
         if(stats.rx_packet_count == data->rx_packet_count)
         {
             /* No packets received */
@@ -219,14 +334,20 @@ static uint16 kymera_DynamicLatencyUpdate(void)
 
         /* Calculate relay percentage */
         relay_percentage = (relay_change * 100)/rx_change;
+
+        kymera_DynamicLatencyUpdateAverage(&data->relay_avg, &data->relay_dev, relay_percentage);
+        kymera_DynamicLatencyUpdateAverage(&data->rx_avg, &data->rx_dev, rx_change);
+
+        required_latency = kymera_DynamicLatencyPredict(error_count - data->error_count);
+        data->error_count = error_count;
+
+        calculated_latency = kymera_DynamicLatencyApplyHysteresis(required_latency);
+
         DEBUG_LOG_VERBOSE("kymera_DynamicLatencyUpdate Relay Change: %u, Rx Change: %u, Percentage: %u, Current Latency: %d",
                              relay_change, rx_change, relay_percentage, data->dynamic_latency);
-        if(relay_percentage > data->relay_percentage_threshold ||
-           data->current_percentage > data->relay_percentage_threshold ||
-           data->dynamic_latency > data->base_latency)
-        {
-            calculated_latency = convertRelayPercentageToLatency(relay_percentage);
-        }
+        DEBUG_LOG_VERBOSE("kymera_DynamicLatencyUpdate relay avg %d dev %d, rx avg %d dev %d, required %u, new %u",
+                             data->relay_avg, data->relay_dev, data->rx_avg, data->rx_dev,
+                             required_latency, calculated_latency);
     }
     return calculated_latency;
 }
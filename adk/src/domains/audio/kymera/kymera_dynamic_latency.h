@@ -4,10 +4,12 @@
             Qualcomm Technologies International, Ltd. Confidential and Proprietary.
 \file
 \brief      Kymera module to adjust A2DP audio latency dynamically.
-            The amount of packets relayed from primary to secondary earbud is
-            monitored and the latency is increased relative to the percentage
-            of relayed packets. The latency is then adjustment seemlessly by
-            the kymera_latency_manager.
+            The amount of packets relayed from primary to secondary earbud,
+            the variation in the rate packets are received and any flushed
+            packets are monitored. From these the buffering required is
+            predicted and the latency is raised to it straight away, or
+            lowered towards it once it has stayed lower for a while. The
+            latency is then adjustment seemlessly by the kymera_latency_manager.
 
             Dynamic adjustment may be enabled using the function
             Kymera_DynamicLatencyEnableDynamicAdjustment().
@@ -34,7 +36,11 @@
    latency. This parameter along with KYMERA_LATENCY_UPDATE_DOWN_STEP_US decide
    the rate of reducing latency
 */
-#define KYMERA_LATENCY_REDUCTION_DELAY_COUNTER (0)
+#define KYMERA_LATENCY_REDUCTION_DELAY_COUNTER (2)
+
+/*! \brief The predicted latency must be this much (milliseconds) below the
+    current latency before the latency is reduced. */
+#define KYMERA_LATENCY_DECREASE_HYSTERESIS_MS (KYMERA_LATENCY_UPDATE_DOWN_STEP_MS)
 
 /*! \brief Periodic delay (in ms) after which Latency Manager checks whether TTP
    Latency should be updated */
@@ -53,6 +59,22 @@
 */
 #define KYMERA_LATENCY_MINIMUM_PERCENT_CHANGE (2)
 
+/******************************************************************************
+ *  Jitter model
+ *****************************************************************************/
+/*! \brief Variation in the number of packets received per check, as a
+    percentage of the average, that is treated as normal. Variation above
+    this adds the same percentage of KYMERA_LATENCY_CHECK_DELAY to the
+    latency. */
+#define KYMERA_LATENCY_JITTER_FLOOR_PERCENT (10)
+
+/*! \brief Latency (milliseconds) added for each flush or buffer error seen
+    in the last check. */
+#define KYMERA_LATENCY_ERROR_PENALTY_MS (KYMERA_LATENCY_UPDATE_UP_STEP_MS)
+
+/*! \brief Maximum number of errors per check counted towards the latency. */
+#define KYMERA_LATENCY_ERROR_PENALTY_MAX (4)
+
 void Kymera_DynamicLatencyInit(void);
 
 /*! \brief Enables the dynamic latency adjustment feature to operate when A2DP
@@ -39,6 +39,7 @@ static uint8 appKymeraCodecToSinkSeid(rtp_codec_type_t codec)
 #ifdef INCLUDE_LATENCY_MANAGER
 #include <message.h>
 #include <panic.h>
+#include <vm.h>
 #include <system_clock.h>
 #include <audio_clock.h>
 #include "power_manager.h"
@@ -67,7 +68,10 @@ static uint32 latencyManager_GetBaseLatency(void)
 
 static void kymera_LatencyManagerReconfigureComplete(void)
 {
-    DEBUG_LOG("kymera_LatencyManagerReconfigureComplete");
+    kymera_latency_manager_data_t *data = KymeraGetLatencyData();
+    DEBUG_LOG("kymera_LatencyManagerReconfigureComplete live %d, took %ums",
+              data->live_retarget, VmGetClock() - data->reconfig_start_ms);
+    data->live_retarget = FALSE;
     Kymera_LatencyManagerClearAdjustingLatency();
 }
 
@@ -95,7 +99,7 @@ void Kymera_LatencyManagerHandleToneEnd(void)
     KYMERA_INTERNAL_A2DP_START_T *params = KymeraGetLatencyData()->a2dp_start_params;
     uint16 seid = Kymera_GetCurrentSeid();
 
-    if (!Kymera_LatencyManagerIsReconfigInProgress())
+    if (!Kymera_LatencyManagerIsReconfigInProgress() || data->live_retarget)
     {
         return;
     }
@@ -129,6 +133,7 @@ void Kymera_LatencyManagerHandleToneEnd(void)
         PanicFalse(appKymeraA2dpStartMaster(&params->codec_settings, params->max_bitrate, VOLUME_MUTE_IN_DB, params->nq2q_ttp));
         kymera_LatencyManagerConfigureRtpStartup(params->codec_settings.seid);
         data->current_latency = Kymera_LatencyManagerGetLatencyForSeid(params->codec_settings.seid);
+        data->applied_latency = data->current_latency;
 
         if (forwarding)
         {
@@ -185,6 +190,7 @@ static void kymera_LatencyManagerApplyLatency(void)
         uint32 latency = kymera_LatencyManagerOverrideLatency(data->current_latency);
         DEBUG_LOG("kymera_LatencyManagerApplyLatency %ums", latency);
         OperatorsStandardSetTimeToPlayLatency(op, US_PER_MS * latency);
+        data->applied_latency = (uint16)latency;
     }
 }
 
@@ -288,16 +294,55 @@ static void kymera_PlayLatencyChangeTone(const ringtone_note *tone, rtime_t tone
     appKymeraHandleInternalTonePromptPlay(&tone_params);
 }
 
+/*! \brief Check if the new latency can be walked in without restarting the chain.
+    The running chain keeps its kick period, so the gaming mode kick period
+    takes effect from the next A2DP start. The aptX adaptive packetiser applies
+    a gaming mode specific TTP delay, so it still needs the chain restarted.
+*/
+static bool kymera_LatencyManagerCanRetargetLive(const KYMERA_INTERNAL_A2DP_START_T *params)
+{
+    return Kymera_LiveLatencyRetargetInGamingMode() &&
+           !KymeraGetTaskData()->q2q_mode &&
+           (params->codec_settings.seid != AV_SEID_APTX_ADAPTIVE_SNK);
+}
+
+/*! \brief Walk the latency to the value for the current mode while audio keeps
+    playing. The RTP decoder limits the rate of the walk, so completion is
+    reported once the time to walk the size of the change has elapsed.
+*/
+static void kymera_LatencyManagerRetargetLive(void)
+{
+    kymera_latency_manager_data_t *data = KymeraGetLatencyData();
+    uint16 previous = data->applied_latency;
+    uint32 walk_ms;
+
+    data->current_latency = Kymera_LatencyManagerGetLatencyForSeid(data->a2dp_start_params->codec_settings.seid);
+    kymera_LatencyManagerApplyLatency();
+
+    walk_ms = (data->applied_latency > previous) ? (data->applied_latency - previous) :
+                                                   (previous - data->applied_latency);
+    walk_ms *= Kymera_LatencyManagerConfigLiveRetargetMsPerMs();
+
+    DEBUG_LOG("kymera_LatencyManagerRetargetLive %ums -> %ums in %ums", previous, data->applied_latency, walk_ms);
+
+    MessageSendLater(KymeraGetTask(),
+                     KYMERA_INTERNAL_LATENCY_MANAGER_MUTE_COMPLETE,
+                     NULL,
+                     walk_ms + Kymera_LatencyManagerConfigLiveRetargetMarginMs());
+}
+
 void Kymera_LatencyManagerReconfigureLatency(Task task, rtime_t mute_instant, const ringtone_note *tone)
 {
     kymera_latency_manager_data_t *data = KymeraGetLatencyData();
     KYMERA_INTERNAL_A2DP_START_T *params = data->a2dp_start_params;
     rtime_t tone_instant;
 
-    DEBUG_LOG("Kymera_LatencyManagerReconfigureLatency");
-
     PanicNull(params);
 
+    data->live_retarget = kymera_LatencyManagerCanRetargetLive(params);
+
+    DEBUG_LOG("Kymera_LatencyManagerReconfigureLatency live %d", data->live_retarget);
+
     Kymera_LatencyManagerSetAdjustingLatency();
 
     MessageSendConditionally(task,
@@ -315,9 +360,27 @@ void Kymera_LatencyManagerReconfigureLatency(Task task, rtime_t mute_instant, co
 void Kymera_LatencyManagerHandleMute(void)
 {
     kymera_latency_manager_data_t * data = KymeraGetLatencyData();
+    int16 actual_volume;
+
+    data->reconfig_start_ms = VmGetClock();
+
+    if (data->live_retarget)
+    {
+        if (data->a2dp_start_params)
+        {
+            kymera_LatencyManagerRetargetLive();
+        }
+        else
+        {
+            /* Streaming stopped before the latency change was due. */
+            kymera_LatencyManagerReconfigureComplete();
+        }
+        return;
+    }
+
     /* Calling this function will overwrite our stored volume, so backup and
        restore the actual volume */
-    int16 actual_volume =  data->a2dp_start_params->volume_in_db;
+    actual_volume =  data->a2dp_start_params->volume_in_db;
     appKymeraHandleInternalA2dpSetVolume(VOLUME_MUTE_IN_DB);
     data->a2dp_start_params->volume_in_db = actual_volume;
 }
@@ -352,6 +415,7 @@ void Kymera_LatencyManagerA2dpStart(const KYMERA_INTERNAL_A2DP_START_T* a2dp_sta
     /* Initialise current_latency before setting the start params - this returns
        the initial static per-codec latency */
     data->current_latency = Kymera_LatencyManagerGetLatencyForSeid(a2dp_start_params->codec_settings.seid);
+    data->applied_latency = data->current_latency;
     data->a2dp_start_params = PanicUnlessMalloc(sizeof(*a2dp_start_params));
     *(data->a2dp_start_params) = *a2dp_start_params;
     kymera_LatencyManagerStartDynamicAdjustment();
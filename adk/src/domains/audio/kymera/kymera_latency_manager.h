@@ -11,6 +11,8 @@
                May be enabled using Kymera_LatencyManagerConfigEnableDynamicAdjustment().
             2. Fast adjustments to latency masked by muting the output and playing
                a tone. This is used for gross latency mode changes.
+               Where the chain does not need to be restarted, the mode change
+               is instead walked in by the RTP decoder while audio keeps playing.
 */
 
 #ifndef KYMERA_LATENCY_MANAGER_H_
@@ -31,6 +33,12 @@
 /*! \brief Configure the duration the output is muted after reconfiguration to
            mask audio glitches. */
 #define Kymera_LatencyManagerConfigMuteDurationMs() (500)
+/*! \brief The time taken to walk the latency by one millisecond without muting.
+           This matches the 1% rate limit the RTP decoder applies when walking
+           to a new target latency. */
+#define Kymera_LatencyManagerConfigLiveRetargetMsPerMs() (100)
+/*! \brief Margin added to the expected duration of a live latency retarget. */
+#define Kymera_LatencyManagerConfigLiveRetargetMarginMs() (100)
 
 /*! \brief Latency Manager State variables */
 typedef struct
@@ -46,9 +54,19 @@ typedef struct
         a conditional message lock. */
     uint16 adjusting_latency;
 
+    /*! The latency last sent to the RTP decoder in milliseconds */
+    uint16 applied_latency;
+
     /*! Gaming mode enabled */
     unsigned gaming_mode_enabled : 1;
 
+    /*! Set when the current reconfiguration is walking the latency without
+        muting or restarting the chain */
+    unsigned live_retarget : 1;
+
+    /*! The time the current reconfiguration started changing the latency */
+    uint32 reconfig_start_ms;
+
     /*! The a2dp start data needs to be stored as latency manager needs to
         restart the A2DP audio chain when entering/exiting gaming mode */
     KYMERA_INTERNAL_A2DP_START_T *a2dp_start_params;
@@ -88,8 +106,9 @@ void Kymera_LatencyManagerA2dpStop(void);
                 message is sent  to inform the task.
     \param mute_instant The time at which to start the latency adjustment.
     \param tone The tone to play whilst muted to indicate the latency change.
-    \note Audio is muted during the reconfiguration to avoid audible glitches.
-    .
+    \note Audio is muted during the reconfiguration to avoid audible glitches,
+          unless the chain can be kept running, in which case the latency is
+          walked to the new value from mute_instant while audio keeps playing.
  */
 void Kymera_LatencyManagerReconfigureLatency(Task task, rtime_t mute_instant, const ringtone_note *tone);
 
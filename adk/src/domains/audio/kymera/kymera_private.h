@@ -259,6 +259,10 @@ enum app_kymera_internal_message_ids
     KYMERA_INTERNAL_USB_VOICE_MIC_MUTE,
     /*! Internal message indicating timeout waiting for prompt play */
     KYMERA_INTERNAL_PREPARE_FOR_PROMPT_TIMEOUT,
+    /*! Internal message to pre-build the A2DP input chain */
+    KYMERA_INTERNAL_A2DP_PREWARM,
+    /*! Internal message to destroy an unused pre-built A2DP input chain */
+    KYMERA_INTERNAL_A2DP_PREWARM_TIMEOUT,
 };
 
 /*! \brief The KYMERA_INTERNAL_A2DP_START and KYMERA_INTERNAL_A2DP_STARTING message content. */
@@ -283,6 +287,15 @@ typedef struct
     aptx_adaptive_ttp_latencies_t nq2q_ttp;
 } KYMERA_INTERNAL_A2DP_START_T;
 
+/*! \brief The KYMERA_INTERNAL_A2DP_PREWARM message content. */
+typedef struct
+{
+    /*! The A2DP codec settings */
+    a2dp_codec_settings codec_settings;
+    /*! The max bitrate for the input stream (in bps). Ignored if zero. */
+    uint32 max_bitrate;
+} KYMERA_INTERNAL_A2DP_PREWARM_T;
+
 
 /*! \brief The KYMERA_INTERNAL_A2DP_SET_VOL message content. */
 typedef struct
@@ -815,6 +828,10 @@ void appKymeraA2dpHandleMessageMoreDataTimeout(void);
 void appKymeraA2dpHandleAudioSyncStreamInd(MessageId id, Message msg);
 void appKymeraA2dpHandleAudioSynchronisedInd(void);
 void appKymeraA2dpHandleMessageMoreData(const MessageMoreData *mmd);
+void appKymeraA2dpHandlePrewarm(const KYMERA_INTERNAL_A2DP_PREWARM_T *msg);
+
+/*! \brief Destroy the pre-built A2DP input chain, if there is one. */
+void appKymeraA2dpDiscardPrewarm(void);
 #endif /* INCLUDE_MIRRORING */
 
 /*! \brief returns the AEC REF UCID */
@@ -61,6 +61,14 @@ slave.
 */
 #define Kymera_BoostClockInGamingMode() (TRUE)
 
+/*! \brief Define whether gaming mode latency changes should be walked in
+           while audio keeps playing, instead of muting the output and
+           restarting the A2DP chain.
+    \note  The chain is not restarted, so the gaming mode kick period and DSP
+           clock boost only take effect from the next A2DP start.
+*/
+#define Kymera_LiveLatencyRetargetInGamingMode() (TRUE)
+
 /*! \brief Define whether the DSP kick period should always be set to
            KICK_PERIOD_FAST in gaming mode.
     \note  Setting a fast kick period will reduce audio subsystem latency at a cost
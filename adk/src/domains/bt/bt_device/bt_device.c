@@ -54,6 +54,9 @@ enum
 /*! \brief Delay before storing the device data in ps */
 #define BT_DEVICE_STORE_PS_DATA_DELAY D_SEC(1)
 
+/*! \brief Number of entries in the remote PSM cache, one for each DEVICE_PROFILE_ bit */
+#define BT_DEVICE_PSM_CACHE_SIZE (16)
+
 /*!< App device management task */
 deviceTaskData  app_device;
 
@@ -742,6 +745,67 @@ device_t BtDevice_SetSupportedProfile(const bdaddr *bd_addr, uint32 profile_to_s
     return device;
 }
 
+/*! \brief Get the index of a profile in the remote PSM cache */
+static unsigned btDevice_GetPsmCacheIndex(uint32 profile)
+{
+    unsigned index = 0;
+
+    /* Exactly one profile bit must be set */
+    PanicFalse(profile && !(profile & (profile - 1)));
+
+    while (!(profile & 1))
+    {
+        profile >>= 1;
+        index++;
+    }
+
+    PanicFalse(index < BT_DEVICE_PSM_CACHE_SIZE);
+    return index;
+}
+
+bool BtDevice_GetCachedRemotePsm(const bdaddr *bd_addr, uint32 profile, uint16 *psm)
+{
+    unsigned index = btDevice_GetPsmCacheIndex(profile);
+    device_t device = BtDevice_GetDeviceForBdAddr(bd_addr);
+    uint16 *cache = NULL;
+    size_t size = 0;
+
+    if (device && Device_GetProperty(device, device_property_remote_psm_cache, (void **)&cache, &size))
+    {
+        PanicFalse(size == BT_DEVICE_PSM_CACHE_SIZE * sizeof(uint16));
+        if (cache[index])
+        {
+            *psm = cache[index];
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+void BtDevice_SetCachedRemotePsm(const bdaddr *bd_addr, uint32 profile, uint16 psm)
+{
+    unsigned index = btDevice_GetPsmCacheIndex(profile);
+    device_t device = BtDevice_GetDeviceForBdAddr(bd_addr);
+
+    if (device)
+    {
+        uint16 cache[BT_DEVICE_PSM_CACHE_SIZE] = {0};
+        uint16 *stored = NULL;
+        size_t size = 0;
+
+        if (Device_GetProperty(device, device_property_remote_psm_cache, (void **)&stored, &size))
+        {
+            PanicFalse(size == sizeof(cache));
+            memcpy(cache, stored, sizeof(cache));
+        }
+
+        DEBUG_LOG("BtDevice_SetCachedRemotePsm lap 0x%x profile 0x%x psm 0x%x", bd_addr->lap, profile, psm);
+
+        cache[index] = psm;
+        Device_SetProperty(device, device_property_remote_psm_cache, cache, sizeof(cache));
+    }
+}
+
 void appDeviceSetLinkMode(const bdaddr *bd_addr, deviceLinkMode link_mode)
 {
     device_t device = BtDevice_GetDeviceForBdAddr(bd_addr);
@@ -1159,8 +1223,9 @@ void BtDevice_SetLastConnectedProfilesForDevice(device_t device, uint32 profile_
 
         /* Update the PDL with this profile connection state in the persistent device data. This is in order to ensure
            we don't lose state information in the case of unexpected power loss. N.b. Normally serialisation occurs
-           during a controlled shutdown of the App. */
-        DeviceDbSerialiser_Serialise();
+           during a controlled shutdown of the App. The write is deferred so that profiles connecting together
+           result in a single write. */
+        DeviceDbSerialiser_SerialiseDeviceLater(device);
     }
     Device_SetPropertyU32(device, device_property_last_connected_profiles, connected_profiles);
     DEBUG_LOG("BtDevice_SetLastConnectedProfilesForDevice, device 0x%x connected_profiles %08x", device, connected_profiles);
@@ -1316,7 +1381,7 @@ uint32 BtDevice_SetProfileConnectedAndSupportedFlagsFromPeer(const bdaddr *bd_ad
         /* Update the PDL with this state provided by the peer in our persistent device data. This is in order to ensure
            we don't lose state information in the case of unexpected power loss. N.b. Normally serialisation occurs
            during a controlled shutdown of the App. */
-        DeviceDbSerialiser_Serialise();
+        DeviceDbSerialiser_SerialiseDeviceLater(device);
     }
 
     return was_supported;
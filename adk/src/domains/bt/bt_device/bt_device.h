@@ -305,6 +305,27 @@ bool BtDevice_LeDeviceIsPeer(const tp_bdaddr *tpaddr);
 */
 bool BtDevice_IsProfileSupported(const bdaddr *bd_addr, uint32 profile_to_check);
 
+/*! \brief Get the remote L2CAP PSM of a profile found by an earlier SDP search
+
+    The cache lets a profile reconnect to a device without repeating the SDP
+    search. It is held in RAM and lasts until the device is deleted or the
+    earbud reboots.
+
+    \param bd_addr Pointer to read-only device BT address.
+    \param profile The DEVICE_PROFILE_ bit of the profile.
+    \param[out] psm The cached remote PSM.
+    \return TRUE if a PSM is cached for the profile, otherwise FALSE.
+*/
+bool BtDevice_GetCachedRemotePsm(const bdaddr *bd_addr, uint32 profile, uint16 *psm);
+
+/*! \brief Cache the remote L2CAP PSM of a profile
+
+    \param bd_addr Pointer to read-only device BT address.
+    \param profile The DEVICE_PROFILE_ bit of the profile.
+    \param psm The remote PSM, or 0 to forget a PSM that is no longer valid.
+*/
+void BtDevice_SetCachedRemotePsm(const bdaddr *bd_addr, uint32 profile, uint16 psm);
+
 /*! \brief Set flag to indicate a particular profile is supported
 
     \param bd_addr Pointer to read-only device BT address.
@@ -81,6 +81,21 @@ typedef enum
     cm_qos_max
 } cm_qos_t;
 
+/*! \brief Demand placed on a LE link by a client
+
+    Demands from all clients of a link are combined, and the connection
+    parameters requested for the link are tightened until they satisfy them.
+*/
+typedef struct
+{
+    /*! Throughput needed, in octets per second. Zero if there is no throughput demand */
+    uint32 throughput;
+    /*! Longest acceptable delay before data can be exchanged, in milliseconds. Zero if there is no latency demand */
+    uint16 latency_ms;
+    /*! Time without a refresh of the demand after which it lapses, in milliseconds. Zero to hold the demand until released */
+    uint16 idle_timeout_ms;
+} cm_link_demand_t;
+
 /*! \brief Callback to authorise incoming connections. */
 typedef struct
 {
@@ -512,6 +527,37 @@ void ConManagerRequestDeviceQos(const tp_bdaddr *tpaddr, cm_qos_t qos);
  */
 void ConManagerReleaseDeviceQos(const tp_bdaddr *tpaddr, cm_qos_t qos);
 
+/*! \brief Request, refresh or change the demand a client places on a link
+
+           Demands of all clients of the link are combined: throughputs add up
+           and the shortest latency applies. The connection interval, slave
+           latency and PHY requested for the link are chosen to satisfy the
+           combined demand, but are never relaxed below the QoS setting of
+           the link, nor tightened beyond the maximum QoS.
+
+           Calling this function again with the same demand only refreshes it,
+           so clients moving data can call it for each transfer. A demand with
+           an idle timeout lapses if it is not refreshed in time, and the link
+           relaxes without the client having to release it.
+
+    \param tpaddr The address of the remote device
+
+    \param client Task identifying the client placing the demand
+
+    \param demand The demand of the client
+
+    \note Only addresses with TRANSPORT_BLE_ACL are currently supported
+ */
+void ConManagerRequestDeviceDemand(const tp_bdaddr *tpaddr, Task client, const cm_link_demand_t *demand);
+
+/*! \brief Release the demand a client places on a link
+
+    \param tpaddr The address of the remote device
+
+    \param client Task identifying the client which placed the demand
+ */
+void ConManagerReleaseDeviceDemand(const tp_bdaddr *tpaddr, Task client);
+
 /*! \brief Set the maximum permitted QoS
     
            Any subsequent requests for a QoS above the maximum will result
@@ -22,4 +22,14 @@
 
 /*! Maximum number of Handsets can be connected to earbud at the same time */
 #define appConfigMaxNumOfHandsetsCanConnect()  (1)
+
+/*! Maximum number of link demands that can be held across all LE links. */
+#define appConfigMaxNumOfLinkDemands()  (8)
+
+/*! Octets of application data assumed to be exchanged in one LE connection event,
+    used to convert a throughput demand into a connection interval. */
+#define appConfigLinkDemandOctetsPerConnectionEvent()  (100)
+
+/*! Throughput demand on a LE link, in octets per second, above which the 2M PHY is preferred. */
+#define appConfigLinkDemandHighRatePhyThroughput()  (8000)
 #endif /* CONNECTION_MANAGER_CONFIG_H_ */
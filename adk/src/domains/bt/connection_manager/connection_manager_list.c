@@ -275,6 +275,19 @@ void ConManagerSetConnectionLocal(cm_connection_t *connection, bool local)
         connection->bitfields.local = local;
 }
 
+/******************************************************************************/
+void conManagerSetConnectionHighRatePhy(cm_connection_t *connection, bool high_rate)
+{
+    if (connection)
+        connection->bitfields.high_rate_phy = high_rate;
+}
+
+/******************************************************************************/
+bool conManagerConnectionIsUsingHighRatePhy(const cm_connection_t *connection)
+{
+    return connection ? connection->bitfields.high_rate_phy : FALSE;
+}
+
 /******************************************************************************/
 void conManagerAddConnectionUser(cm_connection_t *connection)
 {
@@ -351,6 +364,7 @@ static void conManagerResetConnection(cm_connection_t* connection)
     if (connection)
     {
         MessageFlushTask(&connection->task_data);
+        conManagerQosResetConnection(connection);
         /* The default values for mode and interval are acceptable */
         memset(connection, 0, sizeof(cm_connection_t));
         ConManagerSetConnectionState(connection, ACL_DISCONNECTED);
@@ -72,6 +72,18 @@ bool conManagerAnyLinkInState(cm_transport_t transport_mask, cm_connection_state
 */
 void ConManagerSetConnectionLocal(cm_connection_t *connection, bool local);
 
+/*! \brief Record whether the 2M PHY has been requested for a connection.
+    \param connection Pointer to connection
+    \param high_rate TRUE if the 2M PHY has been requested, otherwise FALSE
+*/
+void conManagerSetConnectionHighRatePhy(cm_connection_t *connection, bool high_rate);
+
+/*! \brief Check if the 2M PHY has been requested for a connection.
+    \param connection Pointer to connection
+    \return TRUE if the 2M PHY has been requested, otherwise FALSE
+*/
+bool conManagerConnectionIsUsingHighRatePhy(const cm_connection_t *connection);
+
 /*! \brief Increment number of users for a connection.
     \param connection Pointer to connection 
 */
@@ -109,10 +109,10 @@ void ConManagerSendCloseAclRequest(const bdaddr *addr, bool force)
 }
 
 /******************************************************************************/
-void conManagerSendInternalMsgUpdateQos(cm_connection_t* connection)
+void conManagerSendInternalMsgUpdateQosLater(cm_connection_t* connection, uint32 delay)
 {
     Task task = ConManagerGetTask(connection);
-    DEBUG_LOG("conManagerSendInternalMsgUpdateQos");
+    DEBUG_LOG("conManagerSendInternalMsgUpdateQosLater delay:%d", delay);
     
     if(task)
     {
@@ -123,10 +123,18 @@ void conManagerSendInternalMsgUpdateQos(cm_connection_t* connection)
         message->tpaddr = *tpaddr;
         
         MessageCancelFirst(task, CON_MANAGER_INTERNAL_MSG_UPDATE_QOS);
-        MessageSend(task, CON_MANAGER_INTERNAL_MSG_UPDATE_QOS, message);
+        MessageSendLater(task, CON_MANAGER_INTERNAL_MSG_UPDATE_QOS, message, delay);
     }
 }
 
+/******************************************************************************/
+void conManagerSendInternalMsgUpdateQos(cm_connection_t* connection)
+{
+    DEBUG_LOG("conManagerSendInternalMsgUpdateQos");
+    
+    conManagerSendInternalMsgUpdateQosLater(connection, 0);
+}
+
 /******************************************************************************/
 static void conManagerHandleUpdateQos(CON_MANAGER_INTERNAL_MSG_UPDATE_QOS_T* message)
 {
@@ -71,6 +71,12 @@ void conManagerSendCloseTpAclRequest(const tp_bdaddr* tpaddr, bool force);
  */
 void conManagerSendInternalMsgUpdateQos(cm_connection_t* connection);
 
+/*! \brief Send internal message to update QoS after a delay
+    \param connection The connection to send the message to
+    \param delay Time to wait before the update, in milliseconds
+ */
+void conManagerSendInternalMsgUpdateQosLater(cm_connection_t* connection, uint32 delay);
+
 /*! \brief Handle a message sent to a connection task
     \param task The task the message was sent to
     \param id The message ID
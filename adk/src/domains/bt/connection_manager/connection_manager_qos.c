@@ -8,13 +8,185 @@
 #include "connection_manager_params.h"
 #include "connection_manager_list.h"
 #include "connection_manager_msg.h"
+#include "connection_manager_config.h"
 
 #include <logging.h>
 #include <panic.h>
 #include <local_addr.h>
+#include <vm.h>
+
+/*! A demand placed on a link by a client */
+typedef struct
+{
+    tp_bdaddr           tpaddr;         /*!< Address of the link */
+    Task                client;         /*!< Client placing the demand, NULL if the entry is free */
+    cm_link_demand_t    demand;         /*!< The demand */
+    uint32              last_refresh;   /*!< Time the demand was last requested, in milliseconds */
+} cm_qos_demand_t;
 
 static cm_qos_t cm_default_qos;
 static cm_qos_t cm_max_qos;
+static cm_qos_demand_t cm_qos_demands[appConfigMaxNumOfLinkDemands()];
+
+/******************************************************************************/
+static bool conManagerDemandIsForConnection(const cm_qos_demand_t* entry, cm_connection_t* connection)
+{
+    return entry->client && (ConManagerFindConnectionFromBdAddr(&entry->tpaddr) == connection);
+}
+
+/******************************************************************************/
+static cm_qos_demand_t* conManagerFindDemand(cm_connection_t* connection, Task client)
+{
+    cm_qos_demand_t* entry;
+    
+    for(entry = cm_qos_demands; entry < &cm_qos_demands[appConfigMaxNumOfLinkDemands()]; entry++)
+    {
+        if(entry->client == client && conManagerDemandIsForConnection(entry, connection))
+        {
+            return entry;
+        }
+    }
+    
+    return NULL;
+}
+
+/******************************************************************************/
+static cm_qos_demand_t* conManagerAllocateDemand(void)
+{
+    cm_qos_demand_t* entry;
+    
+    for(entry = cm_qos_demands; entry < &cm_qos_demands[appConfigMaxNumOfLinkDemands()]; entry++)
+    {
+        /* Reclaim demands left behind by links that no longer exist */
+        if(entry->client && !ConManagerFindConnectionFromBdAddr(&entry->tpaddr))
+        {
+            entry->client = NULL;
+        }
+        
+        if(!entry->client)
+        {
+            return entry;
+        }
+    }
+    
+    return NULL;
+}
+
+/******************************************************************************/
+static bool conManagerGetCombinedDemand(cm_connection_t* connection, cm_link_demand_t* combined, uint32* next_lapse)
+{
+    uint32 now = VmGetClock();
+    bool has_demand = FALSE;
+    cm_qos_demand_t* entry;
+    
+    memset(combined, 0, sizeof(*combined));
+    *next_lapse = 0;
+    
+    for(entry = cm_qos_demands; entry < &cm_qos_demands[appConfigMaxNumOfLinkDemands()]; entry++)
+    {
+        if(conManagerDemandIsForConnection(entry, connection))
+        {
+            if(entry->demand.idle_timeout_ms)
+            {
+                uint32 idle = now - entry->last_refresh;
+                
+                if(idle >= entry->demand.idle_timeout_ms)
+                {
+                    DEBUG_LOG("conManagerGetCombinedDemand client:%p lapsed", entry->client);
+                    entry->client = NULL;
+                    continue;
+                }
+                
+                if(*next_lapse == 0 || (entry->demand.idle_timeout_ms - idle) < *next_lapse)
+                {
+                    *next_lapse = entry->demand.idle_timeout_ms - idle;
+                }
+            }
+            
+            combined->throughput += entry->demand.throughput;
+            
+            if(entry->demand.latency_ms && (combined->latency_ms == 0 || entry->demand.latency_ms < combined->latency_ms))
+            {
+                combined->latency_ms = entry->demand.latency_ms;
+            }
+            
+            has_demand = TRUE;
+        }
+    }
+    
+    return has_demand;
+}
+
+/******************************************************************************/
+static void conManagerApplyDemand(const cm_link_demand_t* demand, ble_connection_params* params)
+{
+    /* Connection intervals and latency limits in 1.25ms units */
+    uint32 interval = params->conn_interval_max;
+    uint32 latency = params->conn_latency;
+    uint32 latency_limit = (demand->latency_ms * 4UL) / 5UL;
+    uint32 floor = cm_qos_params[cm_qos_short_data_exchange]->conn_interval_min;
+    
+    /* Never tighten beyond what the maximum QoS allows */
+    if(cm_max_qos < cm_qos_max && cm_qos_params[cm_max_qos])
+    {
+        floor = MAX(floor, cm_qos_params[cm_max_qos]->conn_interval_min);
+    }
+    
+    if(demand->throughput)
+    {
+        uint32 throughput_limit = (appConfigLinkDemandOctetsPerConnectionEvent() * 1000UL * 4UL) / (demand->throughput * 5UL);
+        
+        interval = MIN(interval, throughput_limit);
+        /* Data is flowing, so skipping connection events would only add delay */
+        latency = 0;
+    }
+    
+    if(latency_limit)
+    {
+        interval = MIN(interval, latency_limit);
+    }
+    
+    interval = MAX(interval, floor);
+    
+    /* Don't use a multiple of 6 as this may cause LE transmissions to clash with eSCO */
+    if((interval % 6) == 0 && interval > floor)
+    {
+        interval--;
+    }
+    
+    if(latency_limit)
+    {
+        uint32 events = latency_limit / interval;
+        
+        latency = MIN(latency, events ? events - 1 : 0);
+    }
+    
+    params->conn_interval_max = MIN(params->conn_interval_max, interval);
+    params->conn_interval_min = MIN(params->conn_interval_min, params->conn_interval_max);
+    params->conn_latency = latency;
+}
+
+/******************************************************************************/
+static void conManagerSetHighRatePhy(cm_connection_t* connection, const tp_bdaddr* tpaddr, bool high_rate)
+{
+    if(high_rate == conManagerConnectionIsUsingHighRatePhy(connection))
+    {
+        return;
+    }
+    
+    DEBUG_LOG("conManagerSetHighRatePhy high_rate:%d", high_rate);
+    
+    conManagerSetConnectionHighRatePhy(connection, high_rate);
+    
+    if(high_rate)
+    {
+        ConnectionDmUlpSetPhy(tpaddr, phy_rate_2M, phy_rate_MAX, phy_rate_2M, phy_rate_MAX, 0);
+    }
+    else
+    {
+        ConnectionDmUlpSetPhy(tpaddr, phy_rate_min, phy_rate_MAX, phy_rate_min, phy_rate_MAX, 0);
+    }
+}
 
 /******************************************************************************/
 static bool conManagerGetParamsToUse(cm_qos_t qos, ble_connection_params* params)
@@ -29,7 +201,7 @@ static bool conManagerGetParamsToUse(cm_qos_t qos, ble_connection_params* params
 }
 
 /******************************************************************************/
-static void conManagerSendParameterUpdate(const tp_bdaddr* tpaddr, cm_qos_t qos)
+static void conManagerSendParameterUpdate(const tp_bdaddr* tpaddr, cm_qos_t qos, const cm_link_demand_t* demand)
 {
     if(tpaddr && tpaddr->transport == TRANSPORT_BLE_ACL)
     {
@@ -42,6 +214,13 @@ static void conManagerSendParameterUpdate(const tp_bdaddr* tpaddr, cm_qos_t qos)
             
             if(conManagerGetParamsToUse(qos, &params))
             {
+                if(demand)
+                {
+                    conManagerApplyDemand(demand, &params);
+                    DEBUG_LOG("conManagerSendParameterUpdate throughput:%d latency:%d interval:%d-%d slave_latency:%d",
+                              demand->throughput, demand->latency_ms, params.conn_interval_min, params.conn_interval_max, params.conn_latency);
+                }
+                
                 /* NULL AppTask as we can't do much if this fails anyway */
                 ConnectionDmBleConnectionParametersUpdateReq(
                     NULL, 
@@ -58,12 +237,12 @@ static void conManagerSendParameterUpdate(const tp_bdaddr* tpaddr, cm_qos_t qos)
 }
 
 /******************************************************************************/
-static void conManagerUpdateConnectionParameters(cm_connection_t* connection, cm_qos_t qos)
+static void conManagerUpdateConnectionParameters(cm_connection_t* connection, cm_qos_t qos, const cm_link_demand_t* demand)
 {
     if(conManagerGetConnectionState(connection) == ACL_CONNECTED)
     {
         const tp_bdaddr* tpaddr = ConManagerGetConnectionTpAddr(connection);
-        conManagerSendParameterUpdate(tpaddr, qos);
+        conManagerSendParameterUpdate(tpaddr, qos, demand);
     }
 }
 
@@ -150,6 +329,9 @@ static void conManagerValidateQos(cm_transport_t transport_mask, cm_qos_t qos)
 void ConManagerApplyQosOnConnect(const tp_bdaddr *tpaddr)
 {
     cm_qos_t qos_to_use;
+    cm_link_demand_t demand;
+    uint32 next_lapse;
+    bool has_demand;
     cm_connection_t* connection = ConManagerFindConnectionFromBdAddr(tpaddr);
     
     if(!connection)
@@ -158,8 +340,22 @@ void ConManagerApplyQosOnConnect(const tp_bdaddr *tpaddr)
         return;
     }
     
+    has_demand = conManagerGetCombinedDemand(connection, &demand, &next_lapse);
+    
+    /* Come back to relax the link when the next demand lapses */
+    if(next_lapse)
+    {
+        conManagerSendInternalMsgUpdateQosLater(connection, next_lapse);
+    }
+    
+    if(conManagerGetConnectionState(connection) == ACL_CONNECTED)
+    {
+        conManagerSetHighRatePhy(connection, ConManagerGetConnectionTpAddr(connection),
+                                 has_demand && demand.throughput >= appConfigLinkDemandHighRatePhyThroughput());
+    }
+    
     /* Locally initiated connection will already be using default parameters*/
-    if(conManagerConnectionIsLocallyInitiated(connection))
+    if(conManagerConnectionIsLocallyInitiated(connection) && !has_demand)
     {
         if(conManagerConnectionQosIsDefault(connection))
         {
@@ -168,7 +364,21 @@ void ConManagerApplyQosOnConnect(const tp_bdaddr *tpaddr)
     }
     
     qos_to_use = conManagerGetQosToUse(connection);
-    conManagerUpdateConnectionParameters(connection, qos_to_use);
+    conManagerUpdateConnectionParameters(connection, qos_to_use, has_demand ? &demand : NULL);
+}
+
+/******************************************************************************/
+void conManagerQosResetConnection(cm_connection_t* connection)
+{
+    cm_qos_demand_t* entry;
+    
+    for(entry = cm_qos_demands; entry < &cm_qos_demands[appConfigMaxNumOfLinkDemands()]; entry++)
+    {
+        if(conManagerDemandIsForConnection(entry, connection))
+        {
+            entry->client = NULL;
+        }
+    }
 }
 
 /******************************************************************************/
@@ -280,3 +490,68 @@ void ConManagerSetMaxQos(cm_qos_t qos)
         connection = ConManagerListNextConnection(&iterator);
     }
 }
+
+/******************************************************************************/
+void ConManagerRequestDeviceDemand(const tp_bdaddr *tpaddr, Task client, const cm_link_demand_t *demand)
+{
+    cm_connection_t* connection = ConManagerFindConnectionFromBdAddr(tpaddr);
+    
+    PanicFalse(tpaddr->transport == TRANSPORT_BLE_ACL);
+    PanicNull(client);
+    PanicNull((void *)demand);
+    
+    if(connection)
+    {
+        cm_qos_demand_t* entry = conManagerFindDemand(connection, client);
+        
+        if(entry && entry->demand.throughput == demand->throughput
+                 && entry->demand.latency_ms == demand->latency_ms
+                 && entry->demand.idle_timeout_ms == demand->idle_timeout_ms)
+        {
+            /* Only a refresh, the link already satisfies the demand */
+            entry->last_refresh = VmGetClock();
+            return;
+        }
+        
+        if(!entry)
+        {
+            entry = conManagerAllocateDemand();
+        }
+        
+        if(!entry)
+        {
+            DEBUG_LOG("ConManagerRequestDeviceDemand no space for client:%p", client);
+            return;
+        }
+        
+        DEBUG_LOG("ConManagerRequestDeviceDemand client:%p throughput:%d latency:%d", client, demand->throughput, demand->latency_ms);
+        
+        entry->tpaddr = *tpaddr;
+        entry->client = client;
+        entry->demand = *demand;
+        entry->last_refresh = VmGetClock();
+        
+        conManagerSendInternalMsgUpdateQos(connection);
+    }
+}
+
+/******************************************************************************/
+void ConManagerReleaseDeviceDemand(const tp_bdaddr *tpaddr, Task client)
+{
+    cm_connection_t* connection = ConManagerFindConnectionFromBdAddr(tpaddr);
+    
+    PanicFalse(tpaddr->transport == TRANSPORT_BLE_ACL);
+    
+    if(connection)
+    {
+        cm_qos_demand_t* entry = conManagerFindDemand(connection, client);
+        
+        if(entry)
+        {
+            DEBUG_LOG("ConManagerReleaseDeviceDemand client:%p", client);
+            
+            entry->client = NULL;
+            conManagerSendInternalMsgUpdateQos(connection);
+        }
+    }
+}
@@ -17,6 +17,9 @@ void ConManagerApplyQosOnConnect(const tp_bdaddr *tpaddr);
 /*! \brief Apply parameters before connection */
 void ConManagerApplyQosPreConnect(const tp_bdaddr *tpaddr);
 
+/*! \brief Drop the link demands of a connection that is being reset */
+void conManagerQosResetConnection(cm_connection_t* connection);
+
 /*! \brief Initialise connection parameters */
 void ConnectionManagerQosInit(void);
 
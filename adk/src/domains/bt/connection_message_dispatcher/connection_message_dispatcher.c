@@ -11,8 +11,10 @@
 #include <logging.h>
 #include <panic.h>
 #include <vmtypes.h>
+#include <vm.h>
 
 #include <stdlib.h>
+#include <string.h>
 #include <connection.h>
 
 
@@ -43,6 +45,27 @@ typedef enum
 
 #define MAX_NUMBER_OF_GROUPS unknown_group
 
+/*! Maximum number of bulk messages held for a batch before it is delivered. */
+#define MAX_NUMBER_OF_BULK_MESSAGES (8)
+
+/*! \brief Internal messages */
+enum
+{
+    /*! Deliver the pending batch of bulk messages */
+    CONNECTION_MESSAGE_DISPATCHER_INTERNAL_FLUSH_BULK
+};
+
+/*! \brief A bulk message waiting to be delivered */
+typedef struct
+{
+    /*! The message id */
+    MessageId id;
+    /*! Copy of the message content */
+    void *message;
+    /*! Time the dispatcher received the message in microseconds */
+    uint32 received_us;
+} bulk_message_t;
+
 /* ------------------------------ Global Variables ------------------------------ */
 
 /** Encapsulation of connection_message_dispatcher state */
@@ -52,6 +75,12 @@ static struct connection_message_dispatcher
     TaskData task;
     /* Array of registered clients */
     Task registered_clients[MAX_NUMBER_OF_GROUPS];
+    /* Bulk messages waiting to be delivered, oldest first */
+    bulk_message_t bulk[MAX_NUMBER_OF_BULK_MESSAGES];
+    /* Number of entries in bulk */
+    unsigned bulk_count;
+    /* Dispatch statistics */
+    connection_message_dispatcher_stats_t stats;
 
 } connection_message_dispatcher;
 
@@ -62,6 +91,7 @@ static void connectionMessageDispatcher_HandleMessage(Task task, MessageId id, M
 static Task connectionMessageDispatcher_RegisterClient(Task task, group_type_t group_id);
 static void connectionMessageDispatcher_ResetRegisteredClients(void);
 static group_type_t connectionMessageDispatcher_GetGroupType(MessageId id);
+static connection_message_class_t connectionMessageDispatcher_GetClass(MessageId id, group_type_t group_id);
 
 /* ------------------------------ API functions start here ------------------------------ */
 
@@ -70,6 +100,8 @@ void ConnectionMessageDispatcher_Init(void)
     DEBUG_LOG("ConnectionMessageDispatcher_Init called.");
 
     connectionMessageDispatcher_ResetRegisteredClients();
+    connection_message_dispatcher.bulk_count = 0;
+    ConnectionMessageDispatcher_ResetStats();
 
     connection_message_dispatcher.task.handler = connectionMessageDispatcher_HandleMessage;
 }
@@ -159,14 +191,28 @@ Task ConnectionMessageDispatcher_RegisterSdpClient(Task client)
     return connectionMessageDispatcher_RegisterClient(client, sdp_group);
 }
 
+void ConnectionMessageDispatcher_GetStats(connection_message_dispatcher_stats_t *stats)
+{
+    PanicNull(stats);
+    *stats = connection_message_dispatcher.stats;
+}
+
+void ConnectionMessageDispatcher_ResetStats(void)
+{
+    memset(&connection_message_dispatcher.stats, 0, sizeof(connection_message_dispatcher.stats));
+}
+
 /* ------------------------------ Static functions start here ------------------------------ */
 
-/*! \brief Distributes messages to all registered clients.
-    \param  Pointer to task.
-    \param  Message ID.
-    \param  Message.
+/*! \brief Calls the client registered for a message's group and records the time taken.
+    \param task The dispatcher task.
+    \param id Message ID.
+    \param message Message.
+    \param msg_class Dispatch class of the message.
+    \param received_us Time the dispatcher received the message.
 */
-static void connectionMessageDispatcher_HandleMessage(Task task, MessageId id, Message message)
+static void connectionMessageDispatcher_Deliver(Task task, MessageId id, Message message,
+                                                connection_message_class_t msg_class, uint32 received_us)
 {
     group_type_t group_id = connectionMessageDispatcher_GetGroupType(id);
 
@@ -175,12 +221,142 @@ static void connectionMessageDispatcher_HandleMessage(Task task, MessageId id, M
         Task handling_task = connection_message_dispatcher.registered_clients[group_id];
         if (handling_task)
         {
+            connection_message_class_stats_t *stats = &connection_message_dispatcher.stats.classes[msg_class];
+            uint32 start_us = VmGetTimerTime();
+            uint32 handler_us;
+
             PanicFalse(handling_task->handler != NULL);
             handling_task->handler(task, id, message);
+
+            handler_us = VmGetTimerTime() - start_us;
+            stats->messages++;
+            stats->handler_us_total += handler_us;
+            stats->handler_us_max = MAX(stats->handler_us_max, handler_us);
+            stats->deferred_us_max = MAX(stats->deferred_us_max, start_us - received_us);
         }
     }
 }
 
+/*! \brief Delivers all the pending bulk messages in the order they were received.
+    \param task The dispatcher task.
+*/
+static void connectionMessageDispatcher_FlushBulk(Task task)
+{
+    unsigned count = connection_message_dispatcher.bulk_count;
+    unsigned index;
+
+    if (count == 0)
+    {
+        return;
+    }
+
+    MessageCancelFirst(task, CONNECTION_MESSAGE_DISPATCHER_INTERNAL_FLUSH_BULK);
+
+    connection_message_dispatcher.bulk_count = 0;
+    connection_message_dispatcher.stats.batches++;
+    connection_message_dispatcher.stats.batch_size_max = MAX(connection_message_dispatcher.stats.batch_size_max, count);
+
+    for (index = 0; index < count; index++)
+    {
+        bulk_message_t *bulk = &connection_message_dispatcher.bulk[index];
+
+        connectionMessageDispatcher_Deliver(task, bulk->id, bulk->message,
+                                            connection_message_class_bulk, bulk->received_us);
+        free(bulk->message);
+        bulk->message = NULL;
+    }
+}
+
+/*! \brief Get the size of a bulk message including its variable length data.
+    \param id Message ID.
+    \param message Message.
+    \return Size of the message in bytes.
+*/
+static size_t connectionMessageDispatcher_GetBulkMessageSize(MessageId id, Message message)
+{
+    if (id == CL_DM_INQUIRE_RESULT)
+    {
+        const CL_DM_INQUIRE_RESULT_T *result = (const CL_DM_INQUIRE_RESULT_T *)message;
+        return sizeof(*result) + result->size_eir_data;
+    }
+    else
+    {
+        const CL_DM_BLE_ADVERTISING_REPORT_IND_T *report = (const CL_DM_BLE_ADVERTISING_REPORT_IND_T *)message;
+        PanicFalse(id == CL_DM_BLE_ADVERTISING_REPORT_IND);
+        return sizeof(*report) + (report->size_advertising_data ? report->size_advertising_data - 1 : 0);
+    }
+}
+
+/*! \brief Copies a bulk message for delivery in the next batch.
+
+    The batch is delivered when the flush message, sent behind the messages
+    already queued for the dispatcher, is handled or when the batch is full.
+
+    \param task The dispatcher task.
+    \param id Message ID.
+    \param message Message.
+*/
+static void connectionMessageDispatcher_QueueBulk(Task task, MessageId id, Message message)
+{
+    size_t size = connectionMessageDispatcher_GetBulkMessageSize(id, message);
+    bulk_message_t *bulk;
+
+    if (connection_message_dispatcher.bulk_count == MAX_NUMBER_OF_BULK_MESSAGES)
+    {
+        connectionMessageDispatcher_FlushBulk(task);
+    }
+
+    bulk = &connection_message_dispatcher.bulk[connection_message_dispatcher.bulk_count];
+    bulk->id = id;
+    bulk->message = PanicUnlessMalloc(size);
+    memcpy(bulk->message, message, size);
+    bulk->received_us = VmGetTimerTime();
+
+    if (connection_message_dispatcher.bulk_count++ == 0)
+    {
+        MessageSend(task, CONNECTION_MESSAGE_DISPATCHER_INTERNAL_FLUSH_BULK, NULL);
+    }
+}
+
+/*! \brief Distributes messages to all registered clients.
+    \param  Pointer to task.
+    \param  Message ID.
+    \param  Message.
+*/
+static void connectionMessageDispatcher_HandleMessage(Task task, MessageId id, Message message)
+{
+    group_type_t group_id;
+
+    if (id == CONNECTION_MESSAGE_DISPATCHER_INTERNAL_FLUSH_BULK)
+    {
+        connectionMessageDispatcher_FlushBulk(task);
+        return;
+    }
+
+    group_id = connectionMessageDispatcher_GetGroupType(id);
+
+    if (group_id == unknown_group || !connection_message_dispatcher.registered_clients[group_id])
+    {
+        return;
+    }
+
+    switch (connectionMessageDispatcher_GetClass(id, group_id))
+    {
+        case connection_message_class_critical:
+            connectionMessageDispatcher_Deliver(task, id, message, connection_message_class_critical, VmGetTimerTime());
+            break;
+
+        case connection_message_class_bulk:
+            connectionMessageDispatcher_QueueBulk(task, id, message);
+            break;
+
+        default:
+            connectionMessageDispatcher_FlushBulk(task);
+            connectionMessageDispatcher_Deliver(task, id, message, connection_message_class_normal, VmGetTimerTime());
+            break;
+    }
+}
+
 /*! \brief Register a client task to the handler array (set to NULL to unregister).
     \param client Client task.
     \param group_id Group ID.
@@ -212,6 +388,39 @@ static void connectionMessageDispatcher_ResetRegisteredClients(void)
     }
 }
 
+/*! \brief Matches a message to its dispatch class.
+    \param  id Message ID.
+    \param  group_id Group of the message.
+    \return Dispatch class.
+*/
+static connection_message_class_t connectionMessageDispatcher_GetClass(MessageId id, group_type_t group_id)
+{
+    if (group_id == sco_group)
+    {
+        return connection_message_class_critical;
+    }
+
+    switch (id)
+    {
+        case CL_SM_ENCRYPT_CFM:
+        case CL_SM_ENCRYPTION_CHANGE_IND:
+        case CL_SM_ENCRYPTION_KEY_REFRESH_IND:
+        case CL_DM_ACL_OPENED_IND:
+        case CL_DM_ACL_CLOSED_IND:
+        case CL_DM_LINK_SUPERVISION_TIMEOUT_IND:
+        case CL_DM_ROLE_IND:
+        case CL_DM_ROLE_CFM:
+            return connection_message_class_critical;
+
+        case CL_DM_INQUIRE_RESULT:
+        case CL_DM_BLE_ADVERTISING_REPORT_IND:
+            return connection_message_class_bulk;
+
+        default:
+            return connection_message_class_normal;
+    }
+}
+
 /*! \brief Matches a message id from the connection library to its group.
     \param  Message ID.
     \return Group ID.
@@ -17,6 +17,14 @@ not an individual message.
 
 The mapping of the messages to groups in hard-coded in this component.
 
+Messages are also given a dispatch class. Critical messages (SCO, encryption
+and ACL link events) are always passed on as soon as they are received. Bulk
+messages (inquiry results and advertising reports) are copied and delivered in
+a batch once the messages already queued for the dispatcher have been handled,
+so a burst of reports does not hold up the critical messages behind it. Normal
+messages flush any pending batch first, so their order relative to the bulk
+messages is unchanged.
+
 */
 
 #ifndef CONNECTION_MESSAGE_DISPATCHER_H_
@@ -26,6 +34,44 @@ The mapping of the messages to groups in hard-coded in this component.
 
 /*\{*/
 
+/*! \brief Dispatch classes of connection library messages. */
+typedef enum
+{
+    /*! Time critical messages, never deferred. */
+    connection_message_class_critical = 0,
+    /*! Messages delivered in order with the bulk messages. */
+    connection_message_class_normal,
+    /*! High rate reports that are batched. */
+    connection_message_class_bulk,
+    /*! Number of dispatch classes. */
+    connection_message_class_max
+} connection_message_class_t;
+
+/*! Dispatch statistics for one message class. */
+typedef struct
+{
+    /*! Number of messages delivered to a client. */
+    uint32 messages;
+    /*! Total time spent in client handlers in microseconds. */
+    uint32 handler_us_total;
+    /*! Longest time spent in a client handler in microseconds. */
+    uint32 handler_us_max;
+    /*! Longest time from the dispatcher receiving a message to delivering it,
+        in microseconds. Only non-zero for the bulk class. */
+    uint32 deferred_us_max;
+} connection_message_class_stats_t;
+
+/*! Dispatch statistics since boot or the last reset. */
+typedef struct
+{
+    /*! Statistics for each message class. */
+    connection_message_class_stats_t classes[connection_message_class_max];
+    /*! Number of batches of bulk messages delivered. */
+    uint16 batches;
+    /*! Largest number of bulk messages delivered in one batch. */
+    uint16 batch_size_max;
+} connection_message_dispatcher_stats_t;
+
 /*! \brief Initialise message dispatcher.
 */
 void ConnectionMessageDispatcher_Init(void);
@@ -131,6 +177,14 @@ Task ConnectionMessageDispatcher_RegisterScoClient(Task task);
 */
 Task ConnectionMessageDispatcher_RegisterSdpClient(Task task);
 
+/*! \brief Get the dispatch statistics.
+    \param[out] stats Filled with the statistics.
+*/
+void ConnectionMessageDispatcher_GetStats(connection_message_dispatcher_stats_t *stats);
+
+/*! \brief Reset the dispatch statistics. */
+void ConnectionMessageDispatcher_ResetStats(void);
+
 
 /*\}*/
 
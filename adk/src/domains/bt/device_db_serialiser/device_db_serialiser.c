@@ -13,11 +13,14 @@
 #endif
 
 #include "connection_manager_config.h"
+#include <bdaddr.h>
 #include <connection_no_ble.h>
 #include <device_list.h>
 #include <logging.h>
+#include <message.h>
 #include <panic.h>
 #include <stdlib.h>
+#include <string.h>
 
 #define SIZE_OF_TYPE            0x1
 #define SIZE_OF_LEN             0x1
@@ -33,6 +36,19 @@
 
 #define SIZE_OF_METADATA 3
 
+/*! Time to wait after a deferred serialisation request before writing, so that
+    a burst of property changes (e.g. several profiles connecting) results in a
+    single write of each changed device. */
+#ifndef DEVICE_DB_SERIALISER_COALESCE_MS
+#define DEVICE_DB_SERIALISER_COALESCE_MS    500
+#endif
+
+/*! Internal messages */
+enum
+{
+    DEVICE_DB_SERIALISER_INTERNAL_SERIALISE,
+};
+
 /*! \brief Stores the function pointers for a registered PDDU */
 typedef struct
 {
@@ -49,10 +65,70 @@ uint8 num_registered_pddus = 0;
 
 static bool deserialised = FALSE;
 
+/*! \brief The last PDD frame successfully stored for a device.
+
+    Comparing against a record of the last frame stored, rather than reading
+    the PS store back, keeps an unchanged device from costing a PS read on
+    every serialisation.
+*/
+typedef struct
+{
+    bdaddr addr;
+
+    /*! Length of the frame stored, 0 if this entry is unused. */
+    uint16 frame_len;
+
+    /*! Hash of the frame stored. */
+    uint32 frame_hash;
+} device_db_serialiser_shadow_t;
+
+/*! \brief Deferred serialisation state */
+typedef struct
+{
+    /*! Task used to receive the coalescing timer. */
+    TaskData task;
+
+    /*! Devices that have changed since the last write. */
+    device_t *dirty_devices;
+
+    /*! The number of entries in dirty_devices. */
+    uint8 num_dirty_devices;
+
+    /*! Set when every device must be checked on the next write. */
+    bool all_dirty;
+
+    /*! Bytes written to the PS store by the serialisation in progress. */
+    uint32 event_bytes_written;
+
+    /*! Record of the frames stored, MAX_NUM_DEVICES_IN_PDL entries. */
+    device_db_serialiser_shadow_t *shadow;
+
+    device_db_serialiser_stats_t stats;
+} device_db_serialiser_deferred_t;
+
+static device_db_serialiser_deferred_t deferred;
+
+static void deviceDbSerialiser_HandleMessage(Task task, MessageId id, Message message);
+static void deviceDbSerialiser_SerialiseDirty(void);
+
+static void deviceDbSerialiser_ClearDirty(void)
+{
+    MessageCancelAll(&deferred.task, DEVICE_DB_SERIALISER_INTERNAL_SERIALISE);
+    free(deferred.dirty_devices);
+    deferred.dirty_devices = NULL;
+    deferred.num_dirty_devices = 0;
+    deferred.all_dirty = FALSE;
+}
+
 void DeviceDbSerialiser_Init(void)
 {
     num_registered_pddus = 0;
     deserialised = FALSE;
+
+    deviceDbSerialiser_ClearDirty();
+    free(deferred.shadow);
+    memset(&deferred, 0, sizeof(deferred));
+    deferred.task.handler = deviceDbSerialiser_HandleMessage;
 }
 
 void DeviceDbSerialiser_RegisterPersistentDeviceDataUser(
@@ -141,14 +217,107 @@ static inline uint16 deviceDbSerialiser_sumAllPdduPayloads(uint8 *pddus_payload_
     return sum_of_individual_pddu_frames;
 }
 
+static uint32 deviceDbSerialiser_HashFrame(const uint8 *pdd_frame, uint16 frame_len)
+{
+    /* FNV-1a */
+    uint32 hash = 0x811C9DC5UL;
+
+    for (uint16 i = 0; i < frame_len; i++)
+    {
+        hash = (hash ^ pdd_frame[i]) * 0x01000193UL;
+    }
+    return hash;
+}
+
+static device_db_serialiser_shadow_t *deviceDbSerialiser_FindShadow(const bdaddr *device_bdaddr)
+{
+    if (deferred.shadow)
+    {
+        for (uint8 i = 0; i < MAX_NUM_DEVICES_IN_PDL; i++)
+        {
+            if (deferred.shadow[i].frame_len && BdaddrIsSame(&deferred.shadow[i].addr, device_bdaddr))
+            {
+                return &deferred.shadow[i];
+            }
+        }
+    }
+    return NULL;
+}
+
+/*! \brief Record the PDD frame most recently stored for a device. */
+static void deviceDbSerialiser_UpdateShadow(const bdaddr *device_bdaddr, const uint8 *pdd_frame)
+{
+    device_db_serialiser_shadow_t *entry = deviceDbSerialiser_FindShadow(device_bdaddr);
+
+    if (!entry)
+    {
+        if (!deferred.shadow)
+        {
+            deferred.shadow = (device_db_serialiser_shadow_t *)PanicUnlessMalloc(MAX_NUM_DEVICES_IN_PDL * sizeof(device_db_serialiser_shadow_t));
+            memset(deferred.shadow, 0, MAX_NUM_DEVICES_IN_PDL * sizeof(device_db_serialiser_shadow_t));
+        }
+
+        for (uint8 i = 0; i < MAX_NUM_DEVICES_IN_PDL; i++)
+        {
+            if (!deferred.shadow[i].frame_len)
+            {
+                entry = &deferred.shadow[i];
+                entry->addr = *device_bdaddr;
+                break;
+            }
+        }
+    }
+
+    /* With no free entry the device is simply written every time */
+    if (entry)
+    {
+        entry->frame_len = pdd_frame[LEN_OFFSET_IN_FRAME];
+        entry->frame_hash = deviceDbSerialiser_HashFrame(pdd_frame, entry->frame_len);
+    }
+}
+
+/*! \brief Forget the frames recorded for devices that are no longer in the device list.
+
+    The PS store attributes of a deleted device go with its TDL entry, so if the
+    same address is paired again its record must not be considered stored.
+*/
+static void deviceDbSerialiser_PruneShadow(void)
+{
+    if (deferred.shadow)
+    {
+        for (uint8 i = 0; i < MAX_NUM_DEVICES_IN_PDL; i++)
+        {
+            if (deferred.shadow[i].frame_len &&
+                !DeviceList_GetFirstDeviceWithPropertyValue(device_property_bdaddr, &deferred.shadow[i].addr, sizeof(bdaddr)))
+            {
+                deferred.shadow[i].frame_len = 0;
+            }
+        }
+    }
+}
+
+/*! \brief Check if an identical PDD frame was the last one stored for a device. */
+static bool deviceDbSerialiser_IsPddFrameStored(const bdaddr *device_bdaddr, const uint8 *pdd_frame)
+{
+    device_db_serialiser_shadow_t *entry = deviceDbSerialiser_FindShadow(device_bdaddr);
+    uint16 frame_len = pdd_frame[LEN_OFFSET_IN_FRAME];
+
+    return entry && (entry->frame_len == frame_len)
+                 && (entry->frame_hash == deviceDbSerialiser_HashFrame(pdd_frame, frame_len));
+}
+
+/*! \brief Serialise one device.
+
+    \param data Pointer to a bool, TRUE to write the device even if its frame
+                is unchanged.
+*/
 static void deviceDbSerialiser_SerialiseDevice(device_t device, void *data)
 {
     uint8 pdd_frame_payload_len = 0;
     uint8 *pddus_payload_lengths = NULL;
     bdaddr *device_bdaddr = NULL;
     size_t bdaddr_size;
-
-    UNUSED(data);
+    bool force = *(bool *)data;
 
     if (!registered_pddu_list)
         return;
@@ -169,7 +338,25 @@ static void deviceDbSerialiser_SerialiseDevice(device_t device, void *data)
 
         deviceDbSerialiser_populatePddFrame(device, pdd_frame, pddus_payload_lengths);
 
-        ConnectionSmPutAttributeReq(0, TYPED_BDADDR_PUBLIC, device_bdaddr, pdd_frame[LEN_OFFSET_IN_FRAME], pdd_frame);
+        if (!force && deviceDbSerialiser_IsPddFrameStored(device_bdaddr, pdd_frame))
+        {
+            deferred.stats.records_skipped++;
+        }
+        else
+        {
+            if (ConnectionSmPutAttributeReq(0, TYPED_BDADDR_PUBLIC, device_bdaddr, pdd_frame[LEN_OFFSET_IN_FRAME], pdd_frame))
+            {
+                deviceDbSerialiser_UpdateShadow(device_bdaddr, pdd_frame);
+
+                deferred.stats.records_written++;
+                deferred.event_bytes_written += pdd_frame[LEN_OFFSET_IN_FRAME];
+            }
+            else
+            {
+                /* Leave the old record, so the frame is written again next time */
+                DEBUG_LOG_WARN("DeviceDbSerialiser: failed to store device 0x%x", device);
+            }
+        }
 
         free(pdd_frame);
     }
@@ -177,15 +364,145 @@ static void deviceDbSerialiser_SerialiseDevice(device_t device, void *data)
     free(pddus_payload_lengths);
 }
 
+static void deviceDbSerialiser_StartEvent(void)
+{
+    deviceDbSerialiser_PruneShadow();
+
+    deferred.event_bytes_written = 0;
+    deferred.stats.events++;
+}
+
+static void deviceDbSerialiser_EndEvent(void)
+{
+    deferred.stats.bytes_written += deferred.event_bytes_written;
+    deferred.stats.last_event_bytes_written = deferred.event_bytes_written;
+
+    /* Completion of the serialisation less important */
+    DEBUG_LOG_DEBUG("DeviceDbSerialiser: serialisation completed, %u bytes written", deferred.event_bytes_written);
+}
+
 void DeviceDbSerialiser_Serialise(void)
 {
+    bool force = FALSE;
+
     /* Useful to record serialisation as updates persistent storage */
     DEBUG_LOG_INFO("DeviceDbSerialiser_Serialise");
 
-    DeviceList_Iterate(deviceDbSerialiser_SerialiseDevice, NULL);
+    /* Every device is about to be written, so nothing is left to defer */
+    deviceDbSerialiser_ClearDirty();
 
-    /* Completion of the serialisation less important */
-    DEBUG_LOG_DEBUG("DeviceDbSerialiser_Serialise Completed");
+    deviceDbSerialiser_StartEvent();
+    DeviceList_Iterate(deviceDbSerialiser_SerialiseDevice, &force);
+    deviceDbSerialiser_EndEvent();
+}
+
+void DeviceDbSerialiser_SerialiseDevice(device_t device)
+{
+    bool force = TRUE;
+
+    DEBUG_LOG_INFO("DeviceDbSerialiser_SerialiseDevice, device 0x%x", device);
+
+    deviceDbSerialiser_StartEvent();
+    deviceDbSerialiser_SerialiseDevice(PanicNull(device), &force);
+    deviceDbSerialiser_EndEvent();
+}
+
+static bool deviceDbSerialiser_IsDeviceDirty(device_t device)
+{
+    for (uint8 i = 0; i < deferred.num_dirty_devices; i++)
+    {
+        if (deferred.dirty_devices[i] == device)
+        {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+static void deviceDbSerialiser_SerialiseDeviceIfDirty(device_t device, void *data)
+{
+    UNUSED(data);
+
+    if (deferred.all_dirty || deviceDbSerialiser_IsDeviceDirty(device))
+    {
+        bool force = FALSE;
+        deviceDbSerialiser_SerialiseDevice(device, &force);
+    }
+}
+
+/*! \brief Write the devices that have changed since the last write.
+
+    The device list is walked rather than the dirty list itself, so that a
+    device destroyed after being marked dirty is never accessed.
+*/
+static void deviceDbSerialiser_SerialiseDirty(void)
+{
+    DEBUG_LOG_INFO("DeviceDbSerialiser_SerialiseDirty, all %d, devices %d",
+                   deferred.all_dirty, deferred.num_dirty_devices);
+
+    deviceDbSerialiser_StartEvent();
+    DeviceList_Iterate(deviceDbSerialiser_SerialiseDeviceIfDirty, NULL);
+    deviceDbSerialiser_EndEvent();
+
+    deviceDbSerialiser_ClearDirty();
+}
+
+static void deviceDbSerialiser_HandleMessage(Task task, MessageId id, Message message)
+{
+    UNUSED(task);
+    UNUSED(message);
+
+    switch (id)
+    {
+        case DEVICE_DB_SERIALISER_INTERNAL_SERIALISE:
+            deviceDbSerialiser_SerialiseDirty();
+            break;
+
+        default:
+            break;
+    }
+}
+
+static void deviceDbSerialiser_StartCoalescing(void)
+{
+    if (!MessagePendingFirst(&deferred.task, DEVICE_DB_SERIALISER_INTERNAL_SERIALISE, NULL))
+    {
+        MessageSendLater(&deferred.task, DEVICE_DB_SERIALISER_INTERNAL_SERIALISE, NULL,
+                         DEVICE_DB_SERIALISER_COALESCE_MS);
+    }
+    else
+    {
+        deferred.stats.requests_coalesced++;
+    }
+}
+
+void DeviceDbSerialiser_SerialiseDeviceLater(device_t device)
+{
+    PanicNull(device);
+
+    if (!deferred.all_dirty && !deviceDbSerialiser_IsDeviceDirty(device))
+    {
+        if (deferred.num_dirty_devices < MAX_NUM_DEVICES_IN_PDL)
+        {
+            if (!deferred.dirty_devices)
+            {
+                deferred.dirty_devices = (device_t *)PanicUnlessMalloc(MAX_NUM_DEVICES_IN_PDL * sizeof(device_t));
+            }
+            deferred.dirty_devices[deferred.num_dirty_devices++] = device;
+        }
+        else
+        {
+            /* More devices changed than fit in the PDL, just check them all */
+            deferred.all_dirty = TRUE;
+        }
+    }
+    deviceDbSerialiser_StartCoalescing();
+}
+
+void DeviceDbSerialiser_GetStats(device_db_serialiser_stats_t *stats)
+{
+    PanicNull(stats);
+    *stats = deferred.stats;
 }
 
 static device_db_serialiser_registered_pddu_t * deviceDbSerialiser_getRegisteredPddu(uint8 id)
@@ -257,6 +574,9 @@ static void deviceDbSerialiser_GetDeviceAttributesFromPdlAndDeserialise(uint8 pd
         DeviceList_AddDevice(device);
 
         deviceDbSerialiser_deserialisePddFrame(device, *pdd_frame);
+
+        /* The frame just read is what the PS store holds */
+        deviceDbSerialiser_UpdateShadow(&taddr.addr, *pdd_frame);
     }
 }
 
@@ -22,6 +22,28 @@ typedef void (*serialise_persistent_device_data)(device_t device, void *buf, uin
 
 typedef void (*deserialise_persistent_device_data)(device_t device, void *buf, uint8 data_length, uint8 offset);
 
+/*! \brief Device Database Serialiser statistics. */
+typedef struct
+{
+    /*! The number of serialisations performed, immediate or deferred. */
+    uint32 events;
+
+    /*! The number of deferred requests absorbed by a pending serialisation. */
+    uint32 requests_coalesced;
+
+    /*! The number of device records written to the PS store. */
+    uint32 records_written;
+
+    /*! The number of device records not written as the PS store was up to date. */
+    uint32 records_skipped;
+
+    /*! The total number of bytes written to the PS store. */
+    uint32 bytes_written;
+
+    /*! The number of bytes written to the PS store by the last serialisation. */
+    uint32 last_event_bytes_written;
+} device_db_serialiser_stats_t;
+
 /*! \brief Initialise the Device Database Serialiser.
 */
 void DeviceDbSerialiser_Init(void);
@@ -49,9 +71,39 @@ void DeviceDbSerialiser_RegisterPersistentDeviceDataUser(
         deserialise_persistent_device_data deser);
 
 /*! \brief Serialise the set of Persistent Device Data.
+
+    Devices whose Persistent Device Data matches the last data requested to be
+    stored are not written. Any deferred serialisation is cancelled as it is no
+    longer needed.
 */
 void DeviceDbSerialiser_Serialise(void);
 
+/*! \brief Serialise the Persistent Device Data of one device now.
+
+    The device is always written, whether or not its data has changed. This is
+    for changes to the paired device itself, such as pairing or a new link key,
+    after which the PS store may no longer hold the device's data.
+
+    \param device The device to serialise.
+*/
+void DeviceDbSerialiser_SerialiseDevice(device_t device);
+
+/*! \brief Serialise the Persistent Device Data of one device after a short delay.
+
+    Requests made while a deferred serialisation is pending are merged into it,
+    so a burst of changes results in one write per changed device. Only the
+    devices marked this way are checked when the deferred serialisation runs.
+
+    \param device The device whose Persistent Device Data has changed.
+*/
+void DeviceDbSerialiser_SerialiseDeviceLater(device_t device);
+
+/*! \brief Get the serialisation statistics.
+
+    \param[out] stats Filled in with the statistics so far.
+*/
+void DeviceDbSerialiser_GetStats(device_db_serialiser_stats_t *stats);
+
 /*! \brief Deserialise the set of Persistent Device Data.
 */
 void DeviceDbSerialiser_Deserialise(void);
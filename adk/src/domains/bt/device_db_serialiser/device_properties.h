@@ -61,6 +61,7 @@ typedef enum
     device_property_av_instance,
     device_property_audio_source,
     device_property_blacklist,
+    device_property_remote_psm_cache,
 
     device_property_max_num
 
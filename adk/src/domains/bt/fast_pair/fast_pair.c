@@ -273,6 +273,10 @@ void FastPair_HandleMessage(Task task, MessageId id, Message message)
             fastPair_TimerExpired();
         break;
 
+        case fast_pair_state_event_adv_schedule_update:
+            fastPair_AdvUpdateSchedule();
+        break;
+
         case LOCAL_ADDR_CONFIGURE_BLE_GENERATION_CFM:
         {
             LOCAL_ADDR_CONFIGURE_BLE_GENERATION_CFM_T *cfm = (LOCAL_ADDR_CONFIGURE_BLE_GENERATION_CFM_T *)message;
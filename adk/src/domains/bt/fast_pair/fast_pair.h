@@ -82,6 +82,7 @@ typedef enum
      fast_pair_state_event_timer_expire,               /*! FP Procedure Timer expired */
      fast_pair_state_event_power_off,                  /*! Power Off event by user */
      fast_pair_state_event_auth,                       /*! CL_SM_AUTHENTICATE_CFM received from application */
+     fast_pair_state_event_adv_schedule_update,        /*! Identifiable mode changed, update the advertising schedule */
 } fast_pair_state_event_id;
 
 
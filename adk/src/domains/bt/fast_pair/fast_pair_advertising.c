@@ -121,6 +121,20 @@ static const le_adv_data_callback_t fastPair_advertising_callback = {
     .ReleaseItems = &fastPair_ReleaseItems
 };
 
+/*! Fastpair takes turns on air with the other scheduled advertisers, with twice
+    their share of the airtime and the advertising interval for its mode */
+static const le_adv_client_schedule_t fastPair_advertising_schedule_identifiable = {
+    .priority = 2,
+    .le_adv_interval_min = FP_ADV_INTERVAL_IDENTIFIABLE_MIN,
+    .le_adv_interval_max = FP_ADV_INTERVAL_IDENTIFIABLE_MAX
+};
+
+static const le_adv_client_schedule_t fastPair_advertising_schedule_unidentifiable = {
+    .priority = 2,
+    .le_adv_interval_min = FP_ADV_INTERVAL_UNIDENTIFIABLE_MIN,
+    .le_adv_interval_max = FP_ADV_INTERVAL_UNIDENTIFIABLE_MAX
+};
+
 
 /*! \brief Function to initialise the fastpair advertising globals
 */
@@ -133,8 +147,30 @@ static void fastPair_InitialiseAdvGlobal(void)
 */
 void fastPair_SetIdentifiable(const le_adv_data_set_t data_set)
 {
-    fastpair_advert.identifiable = (data_set == le_adv_data_set_handset_identifiable)?(TRUE):(FALSE);
-    DEBUG_LOG("fastPair_SetIdentifiable %d", fastpair_advert.identifiable);
+    bool identifiable = (data_set == le_adv_data_set_handset_identifiable)?(TRUE):(FALSE);
+    DEBUG_LOG("fastPair_SetIdentifiable %d", identifiable);
+
+    if (identifiable != fastpair_advert.identifiable)
+    {
+        /* This is called while the advertising data is being built, so the
+           advertising interval for the new mode is applied from the message loop */
+        Task task = &fastPair_GetTaskData()->task;
+        MessageCancelAll(task, fast_pair_state_event_adv_schedule_update);
+        MessageSend(task, fast_pair_state_event_adv_schedule_update, NULL);
+    }
+    fastpair_advert.identifiable = identifiable;
+}
+
+/*! @brief Private API to apply the advertising schedule for the current mode
+*/
+void fastPair_AdvUpdateSchedule(void)
+{
+    DEBUG_LOG("fastPair_AdvUpdateSchedule identifiable %d", fastpair_advert.identifiable);
+
+    LeAdvertisingManager_ScheduleClient(fastpair_advert.adv_register_handle,
+                                        fastpair_advert.identifiable ?
+                                            &fastPair_advertising_schedule_identifiable :
+                                            &fastPair_advertising_schedule_unidentifiable);
 }
 
 /*! \brief Query the advertisement interval and check if it in expected range*/
@@ -408,6 +444,7 @@ void fastPair_SetUpAdvertising(void)
 
     /*Register callback with Advertising Manager*/    
     fastpair_advert.adv_register_handle = LeAdvertisingManager_Register(&fast_pair_task_data->task, &fastPair_advertising_callback);
+    fastPair_AdvUpdateSchedule();
 }
 
 
@@ -64,5 +64,12 @@ bool fastPair_AdvIsBrEdrDiscoverable(void);
  */
 void fastPair_SetIdentifiable(const le_adv_data_set_t data_set);
 
+/*! @brief Private API to apply the advertising schedule for the current identifiable mode
+
+     Called from Fast Pair state manager after the identifiable mode has changed
+
+ */
+void fastPair_AdvUpdateSchedule(void);
+
 
 #endif /* FAST_PAIR_ADVERTISING_H_ */
@@ -30,6 +30,20 @@ DESCRIPTION
 
 #define AMA_TX_MTU_SIZE    (178)
 
+/* Link demand while voice data is being sent, enough for the encoded
+   speech with protocol overhead, delivered promptly enough for the
+   assistant to keep up with the user */
+#define AMA_VOICE_THROUGHPUT            (4000)
+#define AMA_VOICE_LATENCY_MS            (30)
+#define AMA_VOICE_IDLE_TIMEOUT_MS       (1000)
+
+static const cm_link_demand_t ama_voice_demand =
+{
+    .throughput = AMA_VOICE_THROUGHPUT,
+    .latency_ms = AMA_VOICE_LATENCY_MS,
+    .idle_timeout_ms = AMA_VOICE_IDLE_TIMEOUT_MS
+};
+
 static void gattServerAma_Handler(Task task, MessageId id, Message message);
 static void gattServerAma_OnConnection(uint16 cid);
 static void gattServerAma_OnDisconnection(uint16 cid);
@@ -117,9 +131,22 @@ static void gattServerAma_OnDisconnection(uint16 cid)
         {
             /* Release Quality of Service suitable for audio transmission */
             ConManagerReleaseDeviceQos(&tpaddr, cm_qos_audio);
+            ConManagerReleaseDeviceDemand(&tpaddr, &amaTask);
         }
     }
     DEBUG_LOG("gattServerAma_OnDisconnection cid  %04x\n",cid);
 }
 
+/******************************************************************************/
+void GattServerAma_RefreshVoiceDemand(void)
+{
+    tp_bdaddr tpaddr;
+
+    if (gatt_ama_server_data.cid && VmGetBdAddrtFromCid(gatt_ama_server_data.cid, &tpaddr) &&
+        tpaddr.transport == TRANSPORT_BLE_ACL)
+    {
+        ConManagerRequestDeviceDemand(&tpaddr, &amaTask, &ama_voice_demand);
+    }
+}
+
 #endif /* INCLUDE_AMA_LE */
@@ -34,4 +34,21 @@ RETURNS
 
 bool GattServerAma_Init(Task init_task);
 
+/*******************************************************************************
+NAME
+    GattServerAma_RefreshVoiceDemand
+
+DESCRIPTION
+    Request, or refresh, the link demand for sending voice data to the
+    connected AMA client. The demand lapses shortly after the last refresh.
+
+PARAMETERS
+    None
+
+RETURNS
+    None
+*/
+
+void GattServerAma_RefreshVoiceDemand(void);
+
 #endif /* _GATT_SERVER_AMA_H_ */
@@ -64,7 +64,8 @@ static const le_adv_data_callback_t gatt_battery_le_advert_callback =
 {
     .GetNumberOfItems = gattServerBattery_NumberOfAdvItems,
     .GetItem = gattServerBattery_GetAdvDataItems,
-    .ReleaseItems = gattServerBattery_ReleaseAdvDataItems
+    .ReleaseItems = gattServerBattery_ReleaseAdvDataItems,
+    .items_cacheable = TRUE
 };
 
 static const uint8 gatt_battery_advert_data[SIZE_BATTERY_ADVERT] = { \
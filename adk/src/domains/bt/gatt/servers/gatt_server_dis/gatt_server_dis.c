@@ -47,7 +47,8 @@ static const le_adv_data_callback_t gatt_device_info_le_advert_callback =
 {
     .GetNumberOfItems = gattServerDeviceInfo_NumberOfAdvItems,
     .GetItem = gattServerDeviceInfo_GetAdvDataItems,
-    .ReleaseItems = gattServerDeviceInfo_ReleaseAdvDataItems
+    .ReleaseItems = gattServerDeviceInfo_ReleaseAdvDataItems,
+    .items_cacheable = TRUE
 };
 
 static const uint8 gatt_device_info_advert_data[SIZE_DEVICE_INFO_ADVERT] = { \
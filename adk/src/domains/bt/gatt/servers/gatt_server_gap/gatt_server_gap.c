@@ -190,7 +190,8 @@ static const le_adv_data_callback_t gatt_gap_le_advert_callback =
 {
     .GetNumberOfItems = gattServerGap_NumberOfAdvItems,
     .GetItem = gattServerGap_GetAdvDataItems,
-    .ReleaseItems = gattServerGap_ReleaseAdvDataItems
+    .ReleaseItems = gattServerGap_ReleaseAdvDataItems,
+    .items_cacheable = TRUE
 };
 
 
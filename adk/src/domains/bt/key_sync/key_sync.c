@@ -168,6 +168,9 @@ static void keySync_HandleClSmAddAuthDeviceConfirm(CL_SM_ADD_AUTH_DEVICE_CFM_T*
     {
         keySync_SendKeySyncCfm(&cfm->bd_addr, cfm->status == success);
         keySync_AddDeviceAttributes(&cfm->bd_addr);
+
+        /* The TDL entry was replaced, store the device's data now */
+        DeviceDbSerialiser_SerialiseDevice(PanicNull(BtDevice_GetDeviceForBdAddr(&cfm->bd_addr)));
         BtDevice_PrintAllDevices();
     }
     else
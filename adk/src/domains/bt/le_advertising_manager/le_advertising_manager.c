@@ -9,6 +9,7 @@
 #include <adc.h>
 #include <panic.h>
 #include <stdlib.h>
+#include <vm.h>
 
 #include <connection.h>
 #include <connection_no_ble.h>
@@ -41,11 +42,16 @@ static Task task_enable_connectable;
 
 static bool leAdvertisingManager_UpdateParameters(uint8);
 static void leAdvertisingManager_HandleInternalIntervalSwitchover(void);
+static void leAdvertisingManager_HandleInternalRotateDataSet(void);
+static bool leAdvertisingManager_UpdateDataInPlace(const ble_adv_params_t * old_params);
+static void leAdvertisingManager_SendMessageRotateDataSet(void);
+static void leAdvertisingManager_ReportClientsAdvertised(void);
 static void leAdvertisingManager_HandleEnableAdvertising(const LE_ADV_INTERNAL_MSG_ENABLE_ADVERTISING_T * message);
 static void leAdvertisingManager_HandleNotifyRpaAddressChange(void);
 static void leAdvertisingManager_HandleInternalStartRequest(const LE_ADV_MGR_INTERNAL_START_T * message);
 static bool leAdvertisingManager_Start(const le_advert_start_params_t * params);
 static void leAdvertisingManager_ScheduleAdvertisingStart(const le_adv_data_set_t set);
+static void leAdvertisingManager_EnableAdvertising(bool enable);
 
 static void handleMessage(Task task, MessageId id, Message message)
 {
@@ -78,6 +84,11 @@ static void handleMessage(Task task, MessageId id, Message message)
             leAdvertisingManager_HandleInternalIntervalSwitchover();
             break;
 
+        case LE_ADV_MGR_INTERNAL_MSG_ROTATE_DATA_SET:
+            DEBUG_LOG_LEVEL_1("LE_ADV_MGR_INTERNAL_MSG_ROTATE_DATA_SET");
+            leAdvertisingManager_HandleInternalRotateDataSet();
+            break;
+
         default:
             break;
     }
@@ -92,9 +103,18 @@ static void leAdvertisingManager_GetDefaultAdvertisingIntervalParams(le_adv_comm
     
 }
 
+/* Local function to get the schedule of the client which has the airtime, NULL if all clients are merged */
+static const le_adv_client_schedule_t * leAdvertisingManager_GetActiveSchedule(void)
+{
+    le_adv_mgr_register_handle client_handle = leAdvertisingManager_GetOnAirClient();
+
+    return client_handle ? &client_handle->schedule : NULL;
+}
+
 /* Local Function to Set Advertising Interval */
 static ble_adv_params_t leAdvertisingManager_GetAdvertisingIntervalParams(void)
 {
+    const le_adv_client_schedule_t * schedule = leAdvertisingManager_GetActiveSchedule();
     ble_adv_params_t params;
     adv_mgr_task_data_t * adv_task_data = AdvManagerGetTaskData();
     le_adv_params_set_handle handle = adv_task_data->params_handle;
@@ -113,6 +133,12 @@ static ble_adv_params_t leAdvertisingManager_GetAdvertisingIntervalParams(void)
         params.undirect_adv.adv_interval_min = handle->params_set->set_type[handle->active_params_set].le_adv_interval_min;
         params.undirect_adv.adv_interval_max = handle->params_set->set_type[handle->active_params_set].le_adv_interval_max;
     }
+
+    if(schedule && schedule->le_adv_interval_min && schedule->le_adv_interval_max)
+    {
+        params.undirect_adv.adv_interval_min = schedule->le_adv_interval_min;
+        params.undirect_adv.adv_interval_max = schedule->le_adv_interval_max;
+    }
     
     params.undirect_adv.filter_policy = ble_filter_none;
     
@@ -466,6 +492,34 @@ static void leAdvertisingManager_HandleInternalIntervalSwitchover(void)
 
 }
 
+/* Local Function to Handle Internal Rotate Data Set Message */
+static void leAdvertisingManager_HandleInternalRotateDataSet(void)
+{
+    adv_mgr_task_data_t *adv_task_data = AdvManagerGetTaskData();
+    ble_adv_params_t old_params = leAdvertisingManager_GetAdvertisingIntervalParams();
+
+    if(!leAdvertisingManager_RotateOnAirClient())
+    {
+        DEBUG_LOG_LEVEL_2("leAdvertisingManager_HandleInternalRotateDataSet Info, No clients to rotate");
+        return;
+    }
+
+    DEBUG_LOG_LEVEL_2("leAdvertisingManager_HandleInternalRotateDataSet Info, Client %p has the airtime", leAdvertisingManager_GetOnAirClient());
+
+    if(leAdvertisingManager_UpdateDataInPlace(&old_params))
+    {
+        return;
+    }
+
+    if(LeAdvertisingManagerSm_IsAdvertisingStarting() || LeAdvertisingManagerSm_IsAdvertisingStarted())
+    {
+        adv_task_data->is_data_update_required = TRUE;
+
+        leAdvertisingManager_EnableAdvertising(FALSE);
+        leAdvertisingManager_ScheduleAdvertisingStart(start_params.set);
+    }
+}
+
 /* Local Function to Cancel Scheduled Enable/Disable Connectable Confirmation Messages */
 static bool leAdvertisingManager_CancelPendingEnableDisableConnectableMessages(void)
 {
@@ -587,7 +641,7 @@ static void leAdvertisingManager_EnableAdvertising(bool enable)
     }
     else
     {
-        if(LeAdvertisingManagerSm_IsAdvertisingStarting())
+        if(LeAdvertisingManagerSm_IsAdvertisingStarting() || adv_task_data->is_data_update_in_place)
         {
             leAdvertisingManager_RestartEnableAdvertising(enable);
         }
@@ -698,7 +752,20 @@ static void leAdvertisingManager_HandleSetScanResponseDataCfm(const CL_DM_BLE_SE
         {            
             DEBUG_LOG_LEVEL_2("leAdvertisingManager_HandleSetScanResponseDataCfm Info, CL_DM_BLE_SET_SCAN_RESPONSE_DATA_CFM received with success");    
             
-            leAdvertisingManager_SetupAdvertParams(&start_params);
+            if(adv_task_data->is_data_update_in_place)
+            {
+                DEBUG_LOG_LEVEL_2("leAdvertisingManager_HandleSetScanResponseDataCfm Info, Data updated while advertising");
+
+                adv_task_data->is_data_update_in_place = FALSE;
+                adv_task_data->blockingCondition = ADV_SETUP_BLOCK_NONE;
+
+                leAdvertisingManager_SendMessageRotateDataSet();
+                leAdvertisingManager_ReportClientsAdvertised();
+            }
+            else
+            {
+                leAdvertisingManager_SetupAdvertParams(&start_params);
+            }
         }
         else
         {
@@ -789,6 +856,114 @@ static void leAdvertisingManager_CancelMessageParameterSwitchover(void)
 
 }
 
+/* Local function to send LE_ADV_MGR_INTERNAL_MSG_ROTATE_DATA_SET message once the scheduled client has used its airtime */
+static void leAdvertisingManager_SendMessageRotateDataSet(void)
+{
+    const le_adv_client_schedule_t * schedule = leAdvertisingManager_GetActiveSchedule();
+
+    MessageCancelAll(AdvManagerGetTask(), LE_ADV_MGR_INTERNAL_MSG_ROTATE_DATA_SET);
+
+    if(schedule)
+    {
+        MessageSendLater(AdvManagerGetTask(), LE_ADV_MGR_INTERNAL_MSG_ROTATE_DATA_SET, NULL, schedule->priority * LE_ADV_SCHEDULE_SLOT_MS);
+    }
+}
+
+/* Local function to cancel LE_ADV_MGR_INTERNAL_MSG_ROTATE_DATA_SET message */
+static void leAdvertisingManager_CancelMessageRotateDataSet(void)
+{
+    MessageCancelAll(AdvManagerGetTask(), LE_ADV_MGR_INTERNAL_MSG_ROTATE_DATA_SET);
+}
+
+/* Local function to log how long the clients now on air waited since their data was selected or changed */
+static void leAdvertisingManager_ReportClientsAdvertised(void)
+{
+    le_adv_mgr_client_iterator_t iterator;
+    le_adv_mgr_register_handle client_handle = leAdvertisingManager_HeadClient(&iterator);
+    uint32 now = VmGetClock();
+
+    while(client_handle)
+    {
+        if(client_handle->awaiting_advert && client_handle->items_size && leAdvertisingManager_ClientIsOnAir(client_handle))
+        {
+            DEBUG_LOG("leAdvertisingManager_ReportClientsAdvertised, Client %p advertising %d ms after select or change",
+                      client_handle, now - client_handle->awaiting_since);
+
+            client_handle->awaiting_advert = FALSE;
+        }
+
+        client_handle = leAdvertisingManager_NextClient(&iterator);
+    }
+}
+
+/* Local function to mark a client as waiting for its data to be advertised */
+static void leAdvertisingManager_SetClientAwaitingAdvert(le_adv_mgr_register_handle client_handle)
+{
+    if(client_handle->callback && !client_handle->awaiting_advert)
+    {
+        client_handle->awaiting_advert = TRUE;
+        client_handle->awaiting_since = VmGetClock();
+    }
+}
+
+/* Local function to mark every client as waiting, or no client, when data sets are selected or all released */
+static void leAdvertisingManager_SetAllClientsAwaitingAdvert(bool awaiting)
+{
+    le_adv_mgr_client_iterator_t iterator;
+    le_adv_mgr_register_handle client_handle = leAdvertisingManager_HeadClient(&iterator);
+
+    while(client_handle)
+    {
+        if(awaiting)
+        {
+            leAdvertisingManager_SetClientAwaitingAdvert(client_handle);
+        }
+        else
+        {
+            client_handle->awaiting_advert = FALSE;
+        }
+
+        client_handle = leAdvertisingManager_NextClient(&iterator);
+    }
+}
+
+/* Local function to write the data of the client now on air to the controller without suspending advertising.
+   The HCI allows the data, but not the parameters, to change while advertising is enabled, so this is only
+   done when the advertising interval stays the same. */
+static bool leAdvertisingManager_UpdateDataInPlace(const ble_adv_params_t * old_params)
+{
+    adv_mgr_task_data_t *adv_task_data = AdvManagerGetTaskData();
+    ble_adv_params_t new_params = leAdvertisingManager_GetAdvertisingIntervalParams();
+
+    if(!LeAdvertisingManagerSm_IsAdvertisingStarted() || (adv_task_data->blockingCondition != ADV_SETUP_BLOCK_NONE))
+    {
+        return FALSE;
+    }
+
+    if((new_params.undirect_adv.adv_interval_min != old_params->undirect_adv.adv_interval_min) ||
+       (new_params.undirect_adv.adv_interval_max != old_params->undirect_adv.adv_interval_max))
+    {
+        DEBUG_LOG_LEVEL_2("leAdvertisingManager_UpdateDataInPlace Info, Advertising interval changes, restart advertising");
+        return FALSE;
+    }
+
+    adv_task_data->advertised_set = start_params.set;
+
+    if(!leAdvertisingManager_BuildData(adv_task_data->advertised_set))
+    {
+        leAdvertisingManager_ClearData(start_params.set);
+        return FALSE;
+    }
+
+    DEBUG_LOG_LEVEL_2("leAdvertisingManager_UpdateDataInPlace Info, Update data while advertising");
+
+    adv_task_data->is_data_update_in_place = TRUE;
+    leAdvertisingManager_SetupAdvertData();
+    adv_task_data->blockingCondition = ADV_SETUP_BLOCK_ADV_DATA_CFM;
+
+    return TRUE;
+}
+
 /* Local function to handle CL_DM_BLE_SET_ADVERTISE_ENABLE_CFM message */
 static void leAdvertisingManager_HandleSetAdvertisingEnableCfm(const CL_DM_BLE_SET_ADVERTISE_ENABLE_CFM_T *cfm)
 {
@@ -805,6 +980,7 @@ static void leAdvertisingManager_HandleSetAdvertisingEnableCfm(const CL_DM_BLE_S
                 
                 leAdvertisingManager_SetSuspendedStateAndCancelRpaNotifyMessages();
                 leAdvertisingManager_CancelMessageParameterSwitchover();
+                leAdvertisingManager_CancelMessageRotateDataSet();
 
             }
             else if(LeAdvertisingManagerSm_IsAdvertisingStarting())
@@ -814,6 +990,8 @@ static void leAdvertisingManager_HandleSetAdvertisingEnableCfm(const CL_DM_BLE_S
                 LeAdvertisingManagerSm_SetState(le_adv_mgr_state_started);
                 MessageSendLater(AdvManagerGetTask(), LE_ADV_INTERNAL_MSG_NOTIFY_RPA_CHANGE, NULL, D_SEC(BLE_RPA_TIMEOUT_DEFAULT));
                 leAdvertisingManager_SendMessageParameterSwitchover();
+                leAdvertisingManager_SendMessageRotateDataSet();
+                leAdvertisingManager_ReportClientsAdvertised();
             }
         }
         else if( (hci_error_command_disallowed == cfm->status) && LeAdvertisingManagerSm_IsSuspending() )
@@ -822,6 +1000,7 @@ static void leAdvertisingManager_HandleSetAdvertisingEnableCfm(const CL_DM_BLE_S
 
             leAdvertisingManager_SetSuspendedStateAndCancelRpaNotifyMessages();
             leAdvertisingManager_CancelMessageParameterSwitchover();
+            leAdvertisingManager_CancelMessageRotateDataSet();
         }
         else
         {
@@ -898,7 +1077,9 @@ static bool leAdvertisingManager_Start(const le_advert_start_params_t * params)
         
         adv_task_data->is_data_update_required = FALSE;
         
-        if(leAdvertisingManager_BuildData(start_params.set))
+        adv_task_data->advertised_set = start_params.set;
+        
+        if(leAdvertisingManager_BuildData(adv_task_data->advertised_set))
         {
             leAdvertisingManager_SetupAdvertData();
             adv_task_data->blockingCondition = ADV_SETUP_BLOCK_ADV_DATA_CFM;
@@ -1113,6 +1294,8 @@ bool LeAdvertisingManager_DeInit(void)
         adv_task_data->dataset_peer_handle = NULL;
     }
     
+    MessageCancelAll(AdvManagerGetTask(), LE_ADV_MGR_INTERNAL_MSG_ROTATE_DATA_SET);
+    
     memset(adv_task_data, 0, sizeof(adv_mgr_task_data_t));
 
     if(NULL != sm)
@@ -1248,6 +1431,8 @@ le_adv_data_set_handle LeAdvertisingManager_SelectAdvertisingDataSet(Task task,
         
         leAdvertisingManager_SetDataSetSelectMessageStatusBitmask(params->set, TRUE);
         
+        leAdvertisingManager_SetAllClientsAwaitingAdvert(TRUE);
+        
         MessageCancelAll(AdvManagerGetTask(), LE_ADV_MGR_INTERNAL_START);
             
         leAdvertisingManager_ScheduleAdvertisingStart(params->set);  
@@ -1296,6 +1481,10 @@ bool LeAdvertisingManager_ReleaseAdvertisingDataSet(le_adv_data_set_handle handl
         
         leAdvertisingManager_ScheduleAdvertisingStart(start_params.set);
     }
+    else
+    {
+        leAdvertisingManager_SetAllClientsAwaitingAdvert(FALSE);
+    }
         
     return TRUE;
 }
@@ -1314,6 +1503,12 @@ bool LeAdvertisingManager_NotifyDataChange(Task task, const le_adv_mgr_register_
     }
     
     adv_task_data->is_data_update_required = TRUE;
+    handle->items_changed = TRUE;
+
+    if(start_params.set)
+    {
+        leAdvertisingManager_SetClientAwaitingAdvert(handle);
+    }
     
     if(LeAdvertisingManagerSm_IsAdvertisingStarting() || LeAdvertisingManagerSm_IsAdvertisingStarted())
     {
@@ -1432,6 +1627,40 @@ bool LeAdvertisingManager_GetAdvertisingInterval(le_adv_common_parameters_t * in
 }
 
 
+/* API function to set how a client shares the advertising airtime */
+bool LeAdvertisingManager_ScheduleClient(le_adv_mgr_register_handle handle, const le_adv_client_schedule_t * schedule)
+{
+    DEBUG_LOG("LeAdvertisingManager_ScheduleClient, Client %p", handle);
+
+    if(FALSE == LeAdvertisingManagerSm_IsInitialised())
+    {
+        return FALSE;
+    }
+
+    if((NULL == schedule) || !leAdvertisingManager_ClientHandleIsValid(handle))
+    {
+        DEBUG_LOG("LeAdvertisingManager_ScheduleClient, Invalid Input Arguments");
+        return FALSE;
+    }
+
+    adv_mgr_task_data_t *adv_task_data = AdvManagerGetTaskData();
+
+    handle->schedule = *schedule;
+
+    DEBUG_LOG_LEVEL_2("LeAdvertisingManager_ScheduleClient Info, Priority is %d, Interval is %d to %d slots",
+                      schedule->priority, schedule->le_adv_interval_min, schedule->le_adv_interval_max);
+
+    adv_task_data->is_data_update_required = TRUE;
+
+    if(LeAdvertisingManagerSm_IsAdvertisingStarting() || LeAdvertisingManagerSm_IsAdvertisingStarted())
+    {
+        leAdvertisingManager_EnableAdvertising(FALSE);
+        leAdvertisingManager_ScheduleAdvertisingStart(start_params.set);
+    }
+
+    return TRUE;
+}
+
 /* API function to retrieve LE advertising own address configuration */
 bool LeAdvertisingManager_GetOwnAddressConfig(le_adv_own_addr_config_t * own_address_config)
 {
@@ -178,6 +178,10 @@ typedef struct
  unsigned int (*GetNumberOfItems)(const le_adv_data_params_t * params);
  le_adv_data_item_t (*GetItem)(const le_adv_data_params_t * params, unsigned int);
  void (*ReleaseItems)(const le_adv_data_params_t * params);
+ /*! Set to TRUE if the items only change when the client calls LeAdvertisingManager_NotifyDataChange().
+     The advertising manager then keeps a copy of the items, and only calls the client again
+     after a notification or when a different data set is advertised. */
+ bool items_cacheable;
 }le_adv_data_callback_t;
 
 /*! \brief Opaque type for LE Advertising Manager registry object */
@@ -257,6 +261,23 @@ typedef struct
     le_adv_data_set_t set;
 }le_adv_select_params_t;
 
+/*! \brief Data structure to specify how a client shares advertising airtime with the other clients
+
+    The data of clients with a non-zero priority is not merged into a single advert when more than
+    one of them has data for the selected data sets. Instead their data is advertised in turn, each
+    for a time proportional to its priority, while the data of clients with a zero priority is
+    included in every advert.
+*/
+typedef struct
+{
+    /*! Relative share of the advertising airtime, zero to merge the client's data with all others (default) */
+    uint8 priority;
+    /*! Minimum advertising interval while the client has the airtime, zero to use the selected parameter set. In units of 0.625 ms */
+    uint16 le_adv_interval_min;
+    /*! Maximum advertising interval while the client has the airtime, zero to use the selected parameter set. In units of 0.625 ms */
+    uint16 le_adv_interval_max;
+}le_adv_client_schedule_t;
+
 /*! \brief Data type for own address types */
 typedef enum
 {
@@ -366,6 +387,7 @@ bool LeAdvertisingManager_ReleaseAdvertisingDataSet(le_adv_data_set_handle handl
 \param[in] handle Handle returned from the call to the API LeAdvertisingManager_Register().
 \return TRUE for a succesful call to API for notification, FALSE otherwise.
 \return Sends LE_ADV_MGR_NOTIFY_DATA_CHANGE_CFM when LE advertising gets started with the modified data items.
+\note A client that sets items_cacheable must call this whenever its data items change.
 */
 bool LeAdvertisingManager_NotifyDataChange(Task task, const le_adv_mgr_register_handle handle);
 
@@ -393,4 +415,11 @@ bool LeAdvertisingManager_GetAdvertisingInterval(le_adv_common_parameters_t * in
 */
 bool LeAdvertisingManager_GetOwnAddressConfig(le_adv_own_addr_config_t * own_address_config);
 
+/*! \brief Public API to set how a client shares advertising airtime with other clients
+    \param[in] handle Handle returned by LeAdvertisingManager_Register
+    \param[in] schedule Pointer to the schedule to apply, takes effect from the next advert
+    \return TRUE if the schedule was applied, FALSE otherwise.
+*/
+bool LeAdvertisingManager_ScheduleClient(le_adv_mgr_register_handle handle, const le_adv_client_schedule_t * schedule);
+
 #endif /* LE_ADVERTSING_MANAGER_H_ */
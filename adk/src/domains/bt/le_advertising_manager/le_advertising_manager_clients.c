@@ -9,10 +9,55 @@
 #include "le_advertising_manager_clients.h"
 
 #include <panic.h>
+#include <stdlib.h>
+#include <string.h>
 
 /* Local database to store the callback information clients register */
 static struct _le_adv_mgr_register database[MAX_NUMBER_OF_CLIENTS];
 
+/* Scheduled client that has the advertising airtime */
+static le_adv_mgr_register_handle on_air_client;
+
+/* Local function to check if a client takes turns with other scheduled clients */
+static bool leAdvertisingManager_ClientIsScheduled(le_adv_mgr_register_handle client_handle)
+{
+    return (client_handle->callback && client_handle->schedule.priority && client_handle->items_size);
+}
+
+/* Local function to count the clients taking turns */
+static unsigned leAdvertisingManager_NumScheduledClients(void)
+{
+    unsigned count = 0;
+
+    for(int i = 0; i < MAX_NUMBER_OF_CLIENTS; i++)
+    {
+        if(leAdvertisingManager_ClientIsScheduled(&database[i]))
+        {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/* Local function to get the scheduled client following a client in turn order */
+static le_adv_mgr_register_handle leAdvertisingManager_NextScheduledClient(le_adv_mgr_register_handle client_handle)
+{
+    int start = client_handle ? (int)(client_handle - database) : (MAX_NUMBER_OF_CLIENTS - 1);
+
+    for(int step = 1; step <= MAX_NUMBER_OF_CLIENTS; step++)
+    {
+        le_adv_mgr_register_handle candidate = &database[(start + step) % MAX_NUMBER_OF_CLIENTS];
+
+        if(leAdvertisingManager_ClientIsScheduled(candidate))
+        {
+            return candidate;
+        }
+    }
+
+    return NULL;
+}
+
 /******************************************************************************/
 bool leAdvertisingManager_ClientHandleIsValid(const struct _le_adv_mgr_register * handle)
 {
@@ -34,7 +79,17 @@ void leAdvertisingManager_ClientsInit(void)
     {
         database[i].task = NULL;
         database[i].callback = NULL;
+        /* The database starts zeroed, so this only frees copies kept before a re-initialisation */
+        free(database[i].items);
+        database[i].items = NULL;
+        database[i].items_size = 0;
+        database[i].items_changed = TRUE;
+        memset(&database[i].schedule, 0, sizeof(database[i].schedule));
+        database[i].awaiting_advert = FALSE;
+        database[i].awaiting_since = 0;
     }
+
+    on_air_client = NULL;
 }
 
 /******************************************************************************/
@@ -57,6 +112,7 @@ le_adv_mgr_register_handle LeAdvertisingManager_NewClient(Task task, const le_ad
         }
         database[i].callback = callback;
         database[i].task = task;
+        database[i].items_changed = TRUE;
         break;
     }
 
@@ -117,3 +173,44 @@ size_t leAdvertisingManager_ClientNumItems(le_adv_mgr_register_handle client_han
     
     return client_handle->callback->GetNumberOfItems(params);
 }
+
+/******************************************************************************/
+le_adv_mgr_register_handle leAdvertisingManager_GetOnAirClient(void)
+{
+    if(leAdvertisingManager_NumScheduledClients() < 2)
+    {
+        return NULL;
+    }
+
+    if(!on_air_client || !leAdvertisingManager_ClientIsScheduled(on_air_client))
+    {
+        on_air_client = leAdvertisingManager_NextScheduledClient(on_air_client);
+    }
+
+    return on_air_client;
+}
+
+/******************************************************************************/
+bool leAdvertisingManager_ClientIsOnAir(le_adv_mgr_register_handle client_handle)
+{
+    if(!leAdvertisingManager_ClientIsScheduled(client_handle))
+    {
+        return TRUE;
+    }
+
+    le_adv_mgr_register_handle on_air = leAdvertisingManager_GetOnAirClient();
+
+    return (!on_air || (on_air == client_handle));
+}
+
+/******************************************************************************/
+bool leAdvertisingManager_RotateOnAirClient(void)
+{
+    if(leAdvertisingManager_NumScheduledClients() < 2)
+    {
+        return FALSE;
+    }
+
+    on_air_client = leAdvertisingManager_NextScheduledClient(on_air_client);
+    return TRUE;
+}
@@ -16,6 +16,18 @@ struct _le_adv_mgr_register
 {
     Task task;
     const le_adv_data_callback_t *callback;
+    /*! Copy of the client's data items, kept by le_advertising_manager_data */
+    uint8 *items;
+    /*! Size of the copy of the client's data items */
+    uint16 items_size;
+    /*! Set when the copy of the data items must be refreshed from the client */
+    bool items_changed;
+    /*! How the client shares the advertising airtime with other clients */
+    le_adv_client_schedule_t schedule;
+    /*! Set while the client's data has not been advertised since it was selected or changed */
+    bool awaiting_advert;
+    /*! Time at which the client started waiting for its data to be advertised */
+    uint32 awaiting_since;
 };
 
 typedef struct
@@ -63,4 +75,25 @@ bool leAdvertisingManager_ClientListIsEmpty(void);
 */
 size_t leAdvertisingManager_ClientNumItems(le_adv_mgr_register_handle client_handle, const le_adv_data_params_t* params);
 
+/*! \brief Check if a client's data is in the advert being advertised
+
+    When more than one client with a non-zero priority has data, only one of
+    them is advertised at a time. The data of every other client is always
+    advertised.
+
+    \param client_handle The client handle
+    \return TRUE if the client's data is advertised, otherwise FALSE
+*/
+bool leAdvertisingManager_ClientIsOnAir(le_adv_mgr_register_handle client_handle);
+
+/*! \brief Get the scheduled client that has the advertising airtime
+    \return The client handle, or NULL if clients are not taking turns
+*/
+le_adv_mgr_register_handle leAdvertisingManager_GetOnAirClient(void);
+
+/*! \brief Give the advertising airtime to the next scheduled client
+    \return TRUE if the airtime moved to another client, FALSE if clients are not taking turns
+*/
+bool leAdvertisingManager_RotateOnAirClient(void);
+
 #endif /* LE_ADVERTSING_MANAGER_CLIENTS_H_ */
@@ -12,6 +12,7 @@
 #include "le_advertising_manager_local_name.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include <panic.h>
 
 #define for_all_data_sets(params) for((params)->data_set = le_adv_data_set_handset_identifiable; (params)->data_set <= le_adv_data_set_peer; ((params)->data_set) <<= 1)
@@ -29,6 +30,28 @@ typedef struct
     uint8  space;
 } le_adv_data_packet_t;
 
+/* Header of a data item in a client's copy of its items, followed by the item data */
+typedef struct
+{
+    uint8  data_set;
+    uint8  completeness;
+    uint8  placement;
+    uint16 size;
+} le_adv_cached_item_header_t;
+
+/* Copy of the items collected from a client while it is polled */
+static uint8* poll_buffer;
+static uint16 poll_buffer_size;
+
+/* The data set the packets were last built for, and the clients whose data they hold */
+static le_adv_data_set_t built_set;
+static uint16 built_on_air_clients;
+static bool built;
+
+/* Number of times the packets were assembled, and reused unchanged */
+static uint16 build_count;
+static uint16 reuse_count;
+
 static void leAdvertisingManager_DebugDataItems(const uint8 size, const uint8 * data)
 {
     if(size && data)
@@ -38,12 +61,10 @@ static void leAdvertisingManager_DebugDataItems(const uint8 size, const uint8 *
     }
 }
 
-static le_adv_data_packet_t* leAdvertisingManager_CreatePacket(void)
+static void leAdvertisingManager_ResetPacket(le_adv_data_packet_t* packet)
 {
-    le_adv_data_packet_t* packet = PanicUnlessMalloc(sizeof(le_adv_data_packet_t));
     packet->head = packet->data;
     packet->space = MAX_AD_DATA_SIZE_IN_OCTETS;
-    return packet;
 }
 
 static bool leAdvertisingManager_AddDataItemToPacket(le_adv_data_packet_t* packet, const le_adv_data_item_t* item)
@@ -66,18 +87,16 @@ static bool leAdvertisingManager_AddDataItemToPacket(le_adv_data_packet_t* packe
     return TRUE;
 }
 
-static void leAdvertisingManager_DestroyPacket(le_adv_data_packet_t* packet)
-{
-    free(packet);
-}
-
 static unsigned leAdvertisingManager_GetPacketSize(le_adv_data_packet_t* packet)
 {
     return (packet->head - packet->data);
 }
 
-static le_adv_data_packet_t* advert;
-static le_adv_data_packet_t* scan_rsp;
+static le_adv_data_packet_t advert_packet;
+static le_adv_data_packet_t scan_rsp_packet;
+
+static le_adv_data_packet_t* const advert = &advert_packet;
+static le_adv_data_packet_t* const scan_rsp = &scan_rsp_packet;
 
 static bool leAdvertisingManager_AddDataItemToAdvert(const le_adv_data_item_t* item)
 {
@@ -209,80 +228,173 @@ static void leAdvertisingManager_BuildDataItem(const le_adv_data_item_t* item, c
     }
 }
 
-static void leAdvertisingManager_ProcessClientData(le_adv_mgr_register_handle client_handle, const le_adv_data_params_t* params)
+static uint16 leAdvertisingManager_PollItem(uint16 offset, const le_adv_data_item_t* item, const le_adv_data_params_t* params)
 {
-    size_t num_items = leAdvertisingManager_ClientNumItems(client_handle, params);
-    
-    if(num_items)
+    le_adv_cached_item_header_t header;
+    uint16 size = sizeof(header) + item->size;
+
+    if(offset + size > poll_buffer_size)
     {
-        DEBUG_LOG_V_VERBOSE("leAdvertisingManager_ProcessClientData num_items %d", num_items);
-        
-        for(unsigned i = 0; i < num_items; i++)
-        {
-            le_adv_data_item_t item = client_handle->callback->GetItem(params, i);
-            leAdvertisingManager_ProcessDataItem(&item, params);
-        }
+        /* Only grows, so polling does not allocate once the largest client has been seen */
+        poll_buffer = PanicNull(realloc(poll_buffer, offset + size));
+        poll_buffer_size = offset + size;
     }
+
+    header.data_set = params->data_set;
+    header.completeness = params->completeness;
+    header.placement = params->placement;
+    header.size = item->size;
+
+    memcpy(&poll_buffer[offset], &header, sizeof(header));
+    memcpy(&poll_buffer[offset + sizeof(header)], item->data, item->size);
+
+    return offset + size;
 }
 
-static void leAdvertisingManager_BuildClientData(le_adv_mgr_register_handle client_handle, const le_adv_data_params_t* params)
+/*! Collect a client's items for all parameters in the set and release them again.
+    \return TRUE if the items differ from the copy kept for the client */
+static bool leAdvertisingManager_PollClient(le_adv_mgr_register_handle client_handle, le_adv_data_set_t set)
 {
-    size_t num_items = leAdvertisingManager_ClientNumItems(client_handle, params);
-    
-    if(num_items)
+    le_adv_data_params_t params;
+    uint16 size = 0;
+
+    for_all_params_in_set(&params, set)
     {
-        DEBUG_LOG_V_VERBOSE("leAdvertisingManager_ProcessClientData num_items %d", num_items);
-        
-        for(unsigned i = 0; i < num_items; i++)
+        size_t num_items = leAdvertisingManager_ClientNumItems(client_handle, &params);
+
+        if(num_items)
         {
-            le_adv_data_item_t item = client_handle->callback->GetItem(params, i);
-            leAdvertisingManager_BuildDataItem(&item, params);
+            DEBUG_LOG_V_VERBOSE("leAdvertisingManager_PollClient num_items %d", num_items);
+
+            for(unsigned i = 0; i < num_items; i++)
+            {
+                le_adv_data_item_t item = client_handle->callback->GetItem(&params, i);
+                if(item.data && item.size)
+                {
+                    size = leAdvertisingManager_PollItem(size, &item, &params);
+                }
+            }
+            client_handle->callback->ReleaseItems(&params);
         }
     }
+
+    client_handle->items_changed = FALSE;
+
+    if(size == client_handle->items_size && (size == 0 || memcmp(client_handle->items, poll_buffer, size) == 0))
+    {
+        return FALSE;
+    }
+
+    if(size != client_handle->items_size)
+    {
+        free(client_handle->items);
+        client_handle->items = size ? PanicUnlessMalloc(size) : NULL;
+        client_handle->items_size = size;
+    }
+    if(size)
+    {
+        memcpy(client_handle->items, poll_buffer, size);
+    }
+    return TRUE;
 }
 
-static void leAdvertisingManager_ClearClientData(le_adv_mgr_register_handle client_handle, const le_adv_data_params_t* params)
+/*! Bring the copy of each client's items up to date. Clients with cacheable items
+    are only polled after a change notification or when the data set changes.
+    \return TRUE if any client's items changed */
+static bool leAdvertisingManager_PollAllClients(le_adv_data_set_t set)
 {
-    size_t num_items = leAdvertisingManager_ClientNumItems(client_handle, params);
-    
-    if(num_items)
+    le_adv_mgr_client_iterator_t iterator;
+    le_adv_mgr_register_handle client_handle = leAdvertisingManager_HeadClient(&iterator);
+    bool set_changed = !built || (set != built_set);
+    bool changed = FALSE;
+
+    while(client_handle)
     {
-        client_handle->callback->ReleaseItems(params);
+        if(client_handle->callback)
+        {
+            if(set_changed || client_handle->items_changed || !client_handle->callback->items_cacheable)
+            {
+                changed |= leAdvertisingManager_PollClient(client_handle, set);
+            }
+        }
+        client_handle = leAdvertisingManager_NextClient(&iterator);
     }
+
+    return changed || set_changed;
 }
 
-static void leAdvertisingManager_ProcessAllClientsData(const le_adv_data_params_t* params)
+/*! Get the clients whose data goes in the advert, one bit per client in list order */
+static uint16 leAdvertisingManager_GetOnAirClients(void)
 {
     le_adv_mgr_client_iterator_t iterator;
     le_adv_mgr_register_handle client_handle = leAdvertisingManager_HeadClient(&iterator);
-    
+    uint16 on_air = 0;
+    unsigned index = 0;
+
     while(client_handle)
     {
-        leAdvertisingManager_ProcessClientData(client_handle, params);
+        if(client_handle->callback && leAdvertisingManager_ClientIsOnAir(client_handle))
+        {
+            on_air |= (1U << index);
+        }
+        index++;
         client_handle = leAdvertisingManager_NextClient(&iterator);
     }
+
+    return on_air;
 }
 
-static void leAdvertisingManager_BuildAllClientsData(const le_adv_data_params_t* params)
+static void leAdvertisingManager_ForEachClientItem(le_adv_mgr_register_handle client_handle, const le_adv_data_params_t* params,
+                                                   void (*handler)(const le_adv_data_item_t* item, const le_adv_data_params_t* params))
+{
+    const uint8* record = client_handle->items;
+    const uint8* end = client_handle->items + client_handle->items_size;
+
+    while(record < end)
+    {
+        le_adv_cached_item_header_t header;
+        le_adv_data_item_t item;
+
+        memcpy(&header, record, sizeof(header));
+        item.size = header.size;
+        item.data = record + sizeof(header);
+
+        if((header.data_set == params->data_set) &&
+           (header.completeness == params->completeness) &&
+           (header.placement == params->placement))
+        {
+            handler(&item, params);
+        }
+        record += sizeof(header) + header.size;
+    }
+}
+
+static void leAdvertisingManager_ProcessAllClientsData(const le_adv_data_params_t* params)
 {
     le_adv_mgr_client_iterator_t iterator;
     le_adv_mgr_register_handle client_handle = leAdvertisingManager_HeadClient(&iterator);
     
     while(client_handle)
     {
-        leAdvertisingManager_BuildClientData(client_handle, params);
+        if(leAdvertisingManager_ClientIsOnAir(client_handle))
+        {
+            leAdvertisingManager_ForEachClientItem(client_handle, params, leAdvertisingManager_ProcessDataItem);
+        }
         client_handle = leAdvertisingManager_NextClient(&iterator);
     }
 }
 
-static void leAdvertisingManager_ClearAllClientsData(const le_adv_data_params_t* params)
+static void leAdvertisingManager_BuildAllClientsData(const le_adv_data_params_t* params)
 {
     le_adv_mgr_client_iterator_t iterator;
     le_adv_mgr_register_handle client_handle = leAdvertisingManager_HeadClient(&iterator);
     
     while(client_handle)
     {
-        leAdvertisingManager_ClearClientData(client_handle, params);
+        if(leAdvertisingManager_ClientIsOnAir(client_handle))
+        {
+            leAdvertisingManager_ForEachClientItem(client_handle, params, leAdvertisingManager_BuildDataItem);
+        }
         client_handle = leAdvertisingManager_NextClient(&iterator);
     }
 }
@@ -319,24 +431,41 @@ bool leAdvertisingManager_BuildData(le_adv_data_set_t set)
 {
     le_adv_data_params_t params;
     
-    advert = leAdvertisingManager_CreatePacket();
-    scan_rsp = leAdvertisingManager_CreatePacket();
+    bool changed = leAdvertisingManager_PollAllClients(set);
+    uint16 on_air_clients = leAdvertisingManager_GetOnAirClients();
     
-    LeAdvertisingManager_UuidReset();
-    LeAdvertisingManager_LocalNameReset();
-    
-    for_all_params_in_set(&params, set)
+    if(changed || (on_air_clients != built_on_air_clients))
     {
-        leAdvertisingManager_ProcessAllClientsData(&params);
+        leAdvertisingManager_ResetPacket(advert);
+        leAdvertisingManager_ResetPacket(scan_rsp);
+        
+        LeAdvertisingManager_UuidReset();
+        LeAdvertisingManager_LocalNameReset();
+        
+        for_all_params_in_set(&params, set)
+        {
+            leAdvertisingManager_ProcessAllClientsData(&params);
+        }
+        
+        for_all_params_in_set(&params, set)
+        {
+            leAdvertisingManager_BuildAllClientsData(&params);
+            leAdvertisingManager_BuildLocalNameData(&params);
+            leAdvertisingManager_BuildUuidData(&params);
+        }
+        
+        built_set = set;
+        built_on_air_clients = on_air_clients;
+        built = TRUE;
+        build_count++;
     }
-    
-    for_all_params_in_set(&params, set)
+    else
     {
-        leAdvertisingManager_BuildAllClientsData(&params);
-        leAdvertisingManager_BuildLocalNameData(&params);
-        leAdvertisingManager_BuildUuidData(&params);
+        reuse_count++;
     }
     
+    DEBUG_LOG("leAdvertisingManager_BuildData, set 0x%x, built %u, reused %u", set, build_count, reuse_count);
+    
     if(leAdvertisingManager_GetPacketSize(advert) || leAdvertisingManager_GetPacketSize(scan_rsp))
     {
         return TRUE;
@@ -370,18 +499,10 @@ void leAdvertisingManager_SetupAdvertData(void)
 
 void leAdvertisingManager_ClearData(le_adv_data_set_t set)
 {
-    le_adv_data_params_t params;
-    
-    leAdvertisingManager_DestroyPacket(scan_rsp);
-    scan_rsp = NULL;
-    
-    leAdvertisingManager_DestroyPacket(advert);
-    advert = NULL;
+    UNUSED(set);
     
+    /* The packets and the copies of the client items are kept for the next build,
+       only the lists built from them are released */
     LeAdvertisingManager_UuidReset();
-    
-    for_all_params_in_set(&params, set)
-    {
-        leAdvertisingManager_ClearAllClientsData(&params);
-    }
+    LeAdvertisingManager_LocalNameReset();
 }
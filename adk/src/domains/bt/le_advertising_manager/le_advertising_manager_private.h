@@ -35,6 +35,9 @@
 #define DEFAULT_ADVERTISING_INTERVAL_MIN_IN_SLOTS 148 /* This value is in units of 0.625 ms */
 #define DEFAULT_ADVERTISING_INTERVAL_MAX_IN_SLOTS 160 /* This value is in units of 0.625 ms */
 
+/*! Advertising airtime given to a scheduled client per unit of its priority */
+#define LE_ADV_SCHEDULE_SLOT_MS 500
+
 /* Number of clients supported that can register callbacks for advertising data */
 #define MAX_NUMBER_OF_CLIENTS 10
 
@@ -83,7 +86,9 @@ enum adv_mgr_internal_messages_t
     LE_ADV_INTERNAL_MSG_ENABLE_ADVERTISING,
     LE_ADV_INTERNAL_MSG_NOTIFY_RPA_CHANGE,
     LE_ADV_MGR_INTERNAL_START,
-    LE_ADV_MGR_INTERNAL_MSG_NOTIFY_INTERVAL_SWITCHOVER
+    LE_ADV_MGR_INTERNAL_MSG_NOTIFY_INTERVAL_SWITCHOVER,
+        /*! Give the advertising airtime to the next scheduled client */
+    LE_ADV_MGR_INTERNAL_MSG_ROTATE_DATA_SET
 };
 
 /*! Advertising manager task structure */
@@ -107,6 +112,10 @@ typedef struct
     le_adv_params_set_handle    params_handle;
     /*! The condition (internal) that the blocked operation is waiting for */
     uint16                      blockingCondition;
+    /*! Data sets in the advert last built */
+    le_adv_data_set_t           advertised_set;
+    /*! Set while new data is written to the controller without suspending advertising */
+    bool                        is_data_update_in_place;
 } adv_mgr_task_data_t;
 
 /*!< Task information for the advertising manager */
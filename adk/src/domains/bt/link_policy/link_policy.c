@@ -18,6 +18,8 @@
 #include <panic.h>
 #include <connection.h>
 #include <sink.h>
+#include <vm.h>
+#include <string.h>
 
 #include "link_policy_config.h"
 #include "av_typedef.h"
@@ -129,6 +131,27 @@ struct powertable_data
     uint16 rows;
 };
 
+/*! Maximum number of rows in any of the power tables */
+#define LP_MAX_POWER_TABLE_ROWS (3)
+
+/*! Traffic statistics and adapted power table of a link */
+typedef struct
+{
+    bdaddr bd_addr;                 /*!< Address of the link */
+    bool in_use:1;                  /*!< The entry is in use */
+    bool in_sniff:1;                /*!< The link is in sniff mode */
+    bool policy_pending:1;          /*!< The next wake from sniff follows a power table update, not traffic */
+    uint16 sniff_interval;          /*!< Present sniff interval, in slots */
+    uint16 sniff_min_interval;      /*!< Sniff min interval of the power table before adaptation */
+    uint16 sniff_max_interval;      /*!< Sniff max interval of the power table before adaptation */
+    uint32 last_wake;               /*!< Time of the last wake from sniff */
+    uint32 active_since;            /*!< Time the link entered active mode */
+    lpLinkActivity activity;        /*!< Statistics reported to clients */
+    lp_power_table table[LP_MAX_POWER_TABLE_ROWS]; /*!< Power table adapted to the traffic */
+} lpLinkActivityData;
+
+static lpLinkActivityData lp_link_activity[appConfigLinkPolicyMaxAdaptiveLinks()];
+
 /*! Array of structs used to store the power tables for standard phones */
 static const struct powertable_data powertables_standard[] = {
     [POWERTABLE_A2DP] =                    {ARRAY_AND_DIM(powertable_a2dp)},
@@ -153,6 +176,232 @@ static const struct powertable_data powertables_twsplus[] = {
     [POWERTABLE_PEER_MODE] =               {ARRAY_AND_DIM(powertable_twsplus_peer_streaming)},
 };
 
+static lpLinkActivityData *appLinkPolicyFindLinkActivity(const bdaddr *bd_addr)
+{
+    lpLinkActivityData *entry;
+
+    for (entry = lp_link_activity; entry < &lp_link_activity[ARRAY_DIM(lp_link_activity)]; entry++)
+    {
+        if (entry->in_use && BdaddrIsSame(&entry->bd_addr, bd_addr))
+        {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static lpLinkActivityData *appLinkPolicyAllocateLinkActivity(void)
+{
+    lpLinkActivityData *entry;
+
+    for (entry = lp_link_activity; entry < &lp_link_activity[ARRAY_DIM(lp_link_activity)]; entry++)
+    {
+        /* Reuse entries of links that have since disconnected */
+        if (!entry->in_use || !ConManagerIsConnected(&entry->bd_addr))
+        {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/*! \brief Get the sniff max interval to use for a link
+
+    The interval is capped so that the link has a number of sniff anchor
+    points within the typical gap between bursts of traffic. Busy links
+    get a short interval and so a short wake latency, idle links keep
+    the interval of the power table.
+*/
+static uint16 appLinkPolicyGetAdaptedSniffInterval(const lpLinkActivityData *entry)
+{
+    uint32 interval = entry->sniff_max_interval;
+
+    if (entry->activity.traffic_gap_ms)
+    {
+        /* Slots are 0.625ms */
+        interval = (entry->activity.traffic_gap_ms * 8UL) / (5UL * appConfigLinkPolicySniffAnchorsPerTrafficGap());
+        interval = MIN(interval, entry->sniff_max_interval);
+        /* Only even intervals are valid */
+        interval = MAX(interval & ~1UL, entry->sniff_min_interval);
+    }
+    return (uint16)interval;
+}
+
+static bool appLinkPolicyIsLinkIdle(const lpLinkActivityData *entry)
+{
+    return entry->activity.traffic_gap_ms >= appConfigLinkPolicyIdleTrafficGap();
+}
+
+/*! \brief Check if the power table applied to a link no longer fits its traffic */
+static bool appLinkPolicyIsAdaptationNeeded(const lpLinkActivityData *entry)
+{
+    uint16 applied = entry->activity.sniff_max_interval;
+    uint16 wanted = appLinkPolicyGetAdaptedSniffInterval(entry);
+
+    if (!entry->sniff_max_interval)
+    {
+        /* Power table has no sniff state */
+        return FALSE;
+    }
+
+    /* Only re-apply on a large change to avoid renegotiating sniff on every burst */
+    return (wanted * 2UL <= applied) || (wanted >= applied * 2UL) ||
+           (appLinkPolicyIsLinkIdle(entry) != entry->activity.subrating);
+}
+
+/*! \brief Adapt the sniff states of a power table to the traffic on a link
+
+    \param bd_addr The Bluetooth address of the link.
+    \param sink A sink of the link.
+    \param selected The power table selected for the link.
+
+    \return The power table to apply, which stays valid until the table is
+             next adapted.
+*/
+static const lp_power_table *appLinkPolicyAdaptPowerTable(const bdaddr *bd_addr, Sink sink, const struct powertable_data *selected)
+{
+    lpLinkActivityData *entry = appLinkPolicyFindLinkActivity(bd_addr);
+    bool subrating;
+    uint16 row;
+
+    if (!entry || selected->rows > LP_MAX_POWER_TABLE_ROWS)
+    {
+        return selected->table;
+    }
+
+    memcpy(entry->table, selected->table, selected->rows * sizeof(lp_power_table));
+    entry->sniff_max_interval = 0;
+
+    for (row = 0; row < selected->rows; row++)
+    {
+        lp_power_table *state = &entry->table[row];
+
+        if (state->state == lp_sniff)
+        {
+            entry->sniff_min_interval = state->min_interval;
+            entry->sniff_max_interval = state->max_interval;
+            state->max_interval = appLinkPolicyGetAdaptedSniffInterval(entry);
+            entry->activity.sniff_max_interval = state->max_interval;
+        }
+    }
+
+    subrating = entry->sniff_max_interval && appLinkPolicyIsLinkIdle(entry);
+    if (subrating != entry->activity.subrating)
+    {
+        if (subrating)
+        {
+            ConnectionSetSniffSubRatePolicy(sink, appConfigLinkPolicySubrateMaxLatency(),
+                                            appConfigLinkPolicySubrateMinTimeout(),
+                                            appConfigLinkPolicySubrateMinTimeout());
+        }
+        else
+        {
+            ConnectionSetSniffSubRatePolicy(sink, 0, 0, 0);
+        }
+        entry->activity.subrating = subrating;
+    }
+
+    /* Changing the policy of a link in sniff may bring it out of sniff */
+    entry->policy_pending = entry->in_sniff;
+
+    DEBUG_LOG("appLinkPolicyAdaptPowerTable traffic_gap=%u sniff_max_interval=%u subrating=%d",
+              entry->activity.traffic_gap_ms, entry->activity.sniff_max_interval, subrating);
+
+    return entry->table;
+}
+
+void appLinkPolicyResetLinkActivity(const bdaddr *bd_addr)
+{
+    lpLinkActivityData *entry = appLinkPolicyFindLinkActivity(bd_addr);
+
+    if (!entry)
+    {
+        entry = appLinkPolicyAllocateLinkActivity();
+    }
+
+    if (entry)
+    {
+        memset(entry, 0, sizeof(*entry));
+        entry->bd_addr = *bd_addr;
+        entry->in_use = TRUE;
+        /* An ACL starts in active mode */
+        entry->active_since = VmGetClock();
+    }
+    else
+    {
+        DEBUG_LOG("appLinkPolicyResetLinkActivity, no space for 0x%x", bd_addr->lap);
+    }
+}
+
+void appLinkPolicyHandleModeChange(const CL_DM_MODE_CHANGE_EVENT_T *event)
+{
+    lpLinkActivityData *entry = appLinkPolicyFindLinkActivity(&event->bd_addr);
+    uint32 now = VmGetClock();
+    bool policy_pending;
+
+    if (!entry)
+    {
+        return;
+    }
+
+    policy_pending = entry->policy_pending;
+    entry->policy_pending = FALSE;
+
+    if (event->mode == lp_sniff)
+    {
+        if (!entry->in_sniff)
+        {
+            entry->activity.time_in_active_ms += now - entry->active_since;
+            entry->in_sniff = TRUE;
+        }
+        entry->sniff_interval = event->interval;
+    }
+    else if (event->mode == lp_active && entry->in_sniff)
+    {
+        entry->in_sniff = FALSE;
+        entry->active_since = now;
+
+        if (!policy_pending)
+        {
+            /* On average traffic waits half a sniff interval for the link to wake */
+            entry->activity.wakes++;
+            entry->activity.wake_latency_ms += (entry->sniff_interval * 625UL) / 2000UL;
+
+            if (entry->last_wake)
+            {
+                uint32 gap = now - entry->last_wake;
+
+                entry->activity.traffic_gap_ms = entry->activity.traffic_gap_ms ?
+                                                    (entry->activity.traffic_gap_ms * 3 + gap) / 4 :
+                                                    gap;
+            }
+            entry->last_wake = now;
+
+            if (appLinkPolicyIsAdaptationNeeded(entry))
+            {
+                appLinkPolicyForceUpdatePowerTable(&entry->bd_addr);
+            }
+        }
+    }
+}
+
+bool appLinkPolicyGetLinkActivity(const bdaddr *bd_addr, lpLinkActivity *activity)
+{
+    const lpLinkActivityData *entry = appLinkPolicyFindLinkActivity(bd_addr);
+
+    if (!entry || !activity)
+    {
+        return FALSE;
+    }
+
+    *activity = entry->activity;
+    if (!entry->in_sniff)
+    {
+        activity->time_in_active_ms += VmGetClock() - entry->active_since;
+    }
+    return TRUE;
+}
+
 void appLinkPolicyUpdateLinkSupervisionTimeout(const bdaddr *bd_addr)
 {
     uint16 timeout;
@@ -281,7 +530,7 @@ static void appLinkPolicyUpdatePowerTableImpl(const bdaddr *bd_addr, bool force)
         const struct powertable_data *selected = isTwsPlusHandset ?
                                                     &powertables_twsplus[pt_index] :
                                                     &powertables_standard[pt_index];
-        ConnectionSetLinkPolicy(sink, selected->rows, selected->table);
+        ConnectionSetLinkPolicy(sink, selected->rows, appLinkPolicyAdaptPowerTable(bd_addr, sink, selected));
         if(is_peer)
         {
             DEBUG_LOG("appLinkPolicyUpdatePowerTable for peer, index=%d, prev=%d", pt_index, lp_state.pt_index);
@@ -53,6 +53,17 @@ typedef struct
     lpPowerTableIndex pt_index;     /*!< Current powertable in use */
 } lpPerConnectionState;
 
+/*! Traffic statistics of an ACL, used to adapt the sniff policy */
+typedef struct
+{
+    uint32 time_in_active_ms;       /*!< Time spent in active mode since the ACL connected */
+    uint32 wake_latency_ms;         /*!< Sum of the estimated latency of each wake from sniff */
+    uint32 traffic_gap_ms;          /*!< Smoothed time between wakes from sniff */
+    uint16 wakes;                   /*!< Number of wakes from sniff caused by traffic */
+    uint16 sniff_max_interval;      /*!< Sniff max interval applied to the power table, in slots */
+    bool subrating;                 /*!< TRUE if sniff subrating is enabled for the link */
+} lpLinkActivity;
+
 /*!< Link Policy Manager data structure */
 extern lpTaskData  app_lp;
 
@@ -129,6 +140,28 @@ void appLinkPolicyBredrSecureConnectionHostSupportOverrideRemove(const bdaddr *b
 */
 void appLinkPolicyHandleClDmAclOpendedIndication(const CL_DM_ACL_OPENED_IND_T *ind);
 
+/*! \brief Clear the traffic statistics of a link.
+    \param bd_addr The Bluetooth address of the remote device.
+*/
+void appLinkPolicyResetLinkActivity(const bdaddr *bd_addr);
+
+/*! \brief Update the traffic statistics of a link following a mode change.
+
+    A change from sniff to active mode is taken as a burst of traffic on the
+    link. If the typical gap between bursts has moved far enough from the one
+    the current power table was adapted to, the power table is re-applied.
+
+    \param event The mode change event.
+*/
+void appLinkPolicyHandleModeChange(const CL_DM_MODE_CHANGE_EVENT_T *event);
+
+/*! \brief Get the traffic statistics of a link.
+    \param bd_addr The Bluetooth address of the remote device.
+    \param[out] activity The statistics of the link.
+    \return TRUE if statistics are kept for the link.
+*/
+bool appLinkPolicyGetLinkActivity(const bdaddr *bd_addr, lpLinkActivity *activity);
+
 /*! \brief Make changes to link policy following an address swap.
 */
 void appLinkPolicyHandleAddressSwap(void);
@@ -16,4 +16,21 @@
 /*! Default link supervision timeout for other ACLs (in milliseconds) */
 #define appConfigDefaultLinkSupervisionTimeout()  (5000)
 
+/*! Number of links for which traffic statistics are kept to adapt the sniff policy */
+#define appConfigLinkPolicyMaxAdaptiveLinks()  (3)
+
+/*! Number of sniff anchor points wanted within the typical gap between
+    bursts of traffic, used to cap the sniff interval of the power table */
+#define appConfigLinkPolicySniffAnchorsPerTrafficGap()  (4)
+
+/*! Typical gap between bursts of traffic (in milliseconds) above which a link
+    is considered idle and sniff subrating is enabled */
+#define appConfigLinkPolicyIdleTrafficGap()  (10000)
+
+/*! Maximum remote latency used when sniff subrating an idle link (in slots) */
+#define appConfigLinkPolicySubrateMaxLatency()  (3200)
+
+/*! Time an idle link stays in sniff before subrating (in slots) */
+#define appConfigLinkPolicySubrateMinTimeout()  (3200)
+
 #endif /* LINK_POLICY_CONFIG_H_ */
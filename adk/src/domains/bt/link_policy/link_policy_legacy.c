@@ -414,6 +414,10 @@ bool appLinkPolicyHandleConnectionLibraryMessages(MessageId id,Message message,
         case CL_DM_ROLE_IND:
             appLinkPolicyHandleClDmRoleIndication((CL_DM_ROLE_IND_T *)message);
             return TRUE;
+
+        case CL_DM_MODE_CHANGE_EVENT:
+            appLinkPolicyHandleModeChange((const CL_DM_MODE_CHANGE_EVENT_T *)message);
+            return already_handled;
     }
     return already_handled;
 }
@@ -438,6 +442,11 @@ void appLinkPolicyHandleClDmAclOpendedIndication(const CL_DM_ACL_OPENED_IND_T *i
 {
     const bool is_local = !!(~ind->flags & DM_ACL_FLAG_INCOMING);
 
+    if (!(ind->flags & DM_ACL_FLAG_ULP))
+    {
+        appLinkPolicyResetLinkActivity(&ind->bd_addr.addr);
+    }
+
     /* Set default link supervision timeout if locally inititated (i.e. we're master) */
     if (is_local)
     {
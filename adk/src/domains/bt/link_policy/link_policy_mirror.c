@@ -130,6 +130,8 @@ void appLinkPolicyHandleClDmAclOpendedIndication(const CL_DM_ACL_OPENED_IND_T *i
 
     if (!is_ble)
     {
+        appLinkPolicyResetLinkActivity(bd_addr);
+
         if (appDeviceIsHandset(bd_addr))
         {
             discover_role(bd_addr);
@@ -228,6 +230,10 @@ bool appLinkPolicyHandleConnectionLibraryMessages(MessageId id, Message message,
         }
         return TRUE;
 
+        case CL_DM_MODE_CHANGE_EVENT:
+            appLinkPolicyHandleModeChange(message);
+            return already_handled;
+
         case DM_WRITE_SC_HOST_SUPPORT_OVERRIDE_CFM:
             appLinkPolicyHandleScHostSupportOverrideCfm(message);
             return TRUE;
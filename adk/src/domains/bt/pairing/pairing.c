@@ -531,6 +531,14 @@ static void pairing_HandleClSmAuthenticateConfirm(const CL_SM_AUTHENTICATE_CFM_T
                     /* Update the device link mode based on the key type */
                     pairing_UpdateLinkMode(&cfm->bd_addr, cfm->key_type);
 
+                    /* The device has a new link key, store its data now rather than
+                       relying on a later or deferred serialisation */
+                    device_t device = BtDevice_GetDeviceForBdAddr(&cfm->bd_addr);
+                    if (device)
+                    {
+                        DeviceDbSerialiser_SerialiseDevice(device);
+                    }
+
                     /* Wait for TWS version, store BT address of authenticated device */
                     thePairing->device_to_pair_with_bdaddr = cfm->bd_addr;
 
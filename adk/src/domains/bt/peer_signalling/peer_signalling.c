@@ -105,6 +105,7 @@ static void appPeerSigMsgDisconnectCfm(Task task, peerSigStatus status);
 static void appPeerSigSendConnectConfirmation(peerSigStatus status);
 static void appPeerSigSendDisconnectConfirmation(peerSigStatus status);
 static marshal_msg_channel_data_t* appPeerSigGetChannelData(peerSigMsgChannel channel);
+static void appPeerSigConnectL2cap(const bdaddr *bd_addr);
 
 /*!< Peer earbud signalling */
 peerSigTaskData app_peer_sig;
@@ -159,6 +160,9 @@ static void appPeerSigExitConnected(void)
     AancQuietMode_SetWallClock((Sink)0);
     appPeerSigCancelInactivityTimer();
 
+    /* The next peer may run different firmware */
+    peer_sig->peer_features = 0;
+
     /* If we have any clients inform them of peer signalling disconnection */
     if (peer_sig->link_loss_occurred)
     {
@@ -550,6 +554,57 @@ static void appPeerSigWriteUint32(uint8 *data, uint32 val)
     data[3] = (val >> 24) & 0xFF;
 }
 
+/*! \brief Number of octets needed to write val as a varint. */
+static uint16 appPeerSigVarintSize(uint32 val)
+{
+    uint16 size = 1;
+
+    while (val >= 0x80)
+    {
+        val >>= 7;
+        size++;
+    }
+    return size;
+}
+
+/*! \brief Write val as a varint, 7 bits per octet least significant first,
+           with the top bit set on all but the last octet.
+    \return The number of octets written. */
+static uint16 appPeerSigWriteVarint(uint8 *data, uint32 val)
+{
+    uint16 size = 0;
+
+    while (val >= 0x80)
+    {
+        data[size++] = (uint8)(val | 0x80);
+        val >>= 7;
+    }
+    data[size++] = (uint8)val;
+    return size;
+}
+
+/*! \brief Read a varint from at most size octets.
+    \return The number of octets read, or 0 if the varint is truncated. */
+static uint16 appPeerSigReadVarint(const uint8 *data, uint16 size, uint32 *val)
+{
+    uint16 read = 0;
+    uint32 result = 0;
+
+    while (read < size && read < 5)
+    {
+        uint8 octet = data[read];
+
+        result |= (uint32)(octet & 0x7F) << (7 * read);
+        read++;
+        if (!(octet & 0x80))
+        {
+            *val = result;
+            return read;
+        }
+    }
+    return 0;
+}
+
 
 static void appPeerSigHandleInternalStartupRequest(PEER_SIG_INTERNAL_STARTUP_REQ_T *req)
 {
@@ -567,8 +622,20 @@ static void appPeerSigHandleInternalStartupRequest(PEER_SIG_INTERNAL_STARTUP_REQ
                 /* Store address of peer */
                 peer_sig->peer_addr = req->peer_addr;
 
-                /* Begin the search for the peer signalling SDP record */
-                appPeerSigSetState(PEER_SIG_STATE_CONNECTING_SDP_SEARCH);
+                /* Skip the SDP search if the peer PSM is known from an earlier connection */
+                peer_sig->remote_psm_cached = BtDevice_GetCachedRemotePsm(&peer_sig->peer_addr, DEVICE_PROFILE_PEERSIG,
+                                                                          &peer_sig->remote_psm);
+                if (peer_sig->remote_psm_cached)
+                {
+                    DEBUG_LOG("appPeerSigHandleInternalStartupRequest, cached peer psm 0x%x", peer_sig->remote_psm);
+                    appPeerSigConnectL2cap(&peer_sig->peer_addr);
+                    appPeerSigSetState(PEER_SIG_STATE_CONNECTING_LOCAL);
+                }
+                else
+                {
+                    /* Begin the search for the peer signalling SDP record */
+                    appPeerSigSetState(PEER_SIG_STATE_CONNECTING_SDP_SEARCH);
+                }
             }
             else
             {
@@ -759,6 +826,7 @@ static void appPeerSigHandleClSdpServiceSearchAttributeCfm(const CL_SDP_SERVICE_
                                          &peer_sig->remote_psm, saProtocolDescriptorList))
                 {
                     DEBUG_LOG("appPeerSigHandleClSdpServiceSearchAttributeCfm, peer psm 0x%x", peer_sig->remote_psm);
+                    BtDevice_SetCachedRemotePsm(&peer_sig->peer_addr, DEVICE_PROFILE_PEERSIG, peer_sig->remote_psm);
 
                     /* Initate outgoing peer L2CAP connection */
                     appPeerSigConnectL2cap(&peer_sig->peer_addr);
@@ -929,7 +997,18 @@ static void appPeerSigHandleL2capConnectCfm(const CL_L2CAP_CONNECT_CFM_T *cfm)
             else
             {
                 /* Connection failed, if no more pending connections, return to disconnected state */
-                if (peer_sig->pending_connects == 0)
+                if (peer_sig->pending_connects == 0 && peer_sig->remote_psm_cached &&
+                    appPeerSigGetState() == PEER_SIG_STATE_CONNECTING_LOCAL &&
+                    ConManagerIsConnected(&peer_sig->peer_addr))
+                {
+                    /* The cached PSM may be stale, forget it and fall back to a SDP search */
+                    DEBUG_LOG("appPeerSigHandleL2capConnectCfm, failed with cached psm, search again");
+
+                    BtDevice_SetCachedRemotePsm(&peer_sig->peer_addr, DEVICE_PROFILE_PEERSIG, 0);
+                    peer_sig->remote_psm_cached = FALSE;
+                    appPeerSigSetState(PEER_SIG_STATE_CONNECTING_SDP_SEARCH);
+                }
+                else if (peer_sig->pending_connects == 0)
                 {
                     DEBUG_LOG("appPeerSigHandleL2capConnectCfm, failed, go to disconnected state");
 
@@ -1050,15 +1129,36 @@ octet
  *  Peer signaling makes no assumptions about the contents, including
  *  not requiring that there be a response message in return. */
 #define PEER_SIG_TYPE_MARSHAL   0x1
+/*! Compact peer signalling message type.
+ *  Carries a message of a basic marshal type as its raw bytes, so
+ *  neither side has to run the marshaller. */
+#define PEER_SIG_TYPE_COMPACT   0x2
 
 #define PEER_SIG_GET_HEADER_TYPE(hdr) ((hdr) & PEER_SIG_TYPE_MASK)
 #define PEER_SIG_SET_HEADER_TYPE(hdr, type) ((hdr) = (((hdr) & ~PEER_SIG_TYPE_MASK) | type))
 
+/*! Features of the sender, carried in the header of every message above
+ *  the type. Earlier firmware only looks at the type, so it ignores them. */
+#define PEER_SIG_FEATURE_MASK       0xFC
+/*! The sender accepts PEER_SIG_TYPE_COMPACT messages */
+#define PEER_SIG_FEATURE_COMPACT    0x04
+/*! Features advertised by this firmware */
+#define PEER_SIG_LOCAL_FEATURES     (PEER_SIG_FEATURE_COMPACT)
+
+#define PEER_SIG_GET_HEADER_FEATURES(hdr) ((hdr) & PEER_SIG_FEATURE_MASK)
+
+/* Header and tx sequence number, present in every message */
+#define PEER_SIG_MIN_PACKET_SIZE    2
+
 /* Marshal type */
 #define PEER_SIG_MARSHAL_CHANNELID_OFFSET   2
 #define PEER_SIG_MARSHAL_PAYLOAD_OFFSET     6
 #define PEER_SIG_MARSHAL_HEADER_SIZE        6
 
+/* Compact type, the channel and marshal type are varints followed by the
+   object's bytes */
+#define PEER_SIG_COMPACT_CHANNELID_OFFSET   2
+
 enum peer_sig_reponse
 {
     peer_sig_success = 0,
@@ -1113,38 +1213,159 @@ static marshal_msg_channel_data_t* appPeerSigGetChannelData(peerSigMsgChannel ch
     return &peer_sig->marshal_msg_channel_state[channel];
 }
 
+/*! \brief Test if a type is sent on a channel with a compact header. */
+static bool appPeerSigIsCompactType(const marshal_msg_channel_data_t *mmcd, marshal_type_t type)
+{
+    return mmcd->compact_types && type < mmcd->num_type_desc &&
+           (mmcd->compact_types[type / 8] & (1 << (type % 8)));
+}
+
+/*! \brief Build the table of a channel's types that can be sent as raw bytes.
+
+    Only basic types qualify: the marshaller copies them as a single object
+    with no members to follow, no custom copy and no dynamic length, so the
+    peer can rebuild them from the bytes alone.
+*/
+static void appPeerSigBuildCompactTypes(marshal_msg_channel_data_t *mmcd)
+{
+    size_t len = (mmcd->num_type_desc + 7) / 8;
+    marshal_type_t type;
+
+    free(mmcd->compact_types);
+    mmcd->compact_types = PanicUnlessMalloc(len);
+    memset(mmcd->compact_types, 0, len);
+
+    for (type = 0; type < mmcd->num_type_desc; type++)
+    {
+        const marshal_type_descriptor_t *desc = mmcd->type_desc[type];
+
+        if (desc && desc->members_len == 0 && desc->u.custom_copy_cbs == NULL &&
+            !desc->dynamic_length && !desc->is_union)
+        {
+            mmcd->compact_types[type / 8] |= (1 << (type % 8));
+        }
+    }
+}
+
+/*! \brief Release the marshalling state held for a channel. */
+static void appPeerSigFreeChannelMarshalling(marshal_msg_channel_data_t *mmcd)
+{
+    if (mmcd->marshaller)
+    {
+        MarshalDestroy(mmcd->marshaller, FALSE);
+        mmcd->marshaller = NULL;
+    }
+    if (mmcd->unmarshaller)
+    {
+        UnmarshalDestroy(mmcd->unmarshaller, FALSE);
+        mmcd->unmarshaller = NULL;
+    }
+    free(mmcd->compact_types);
+    mmcd->compact_types = NULL;
+}
+
+/*! \brief Pass a message received from the peer to the channel's client. */
+static void appPeerSigSendRxInd(marshal_msg_channel_data_t *mmcd, void *rx_msg, marshal_type_t type)
+{
+    MAKE_MESSAGE(PEER_SIG_MARSHALLED_MSG_CHANNEL_RX_IND);
+
+    message->channel = mmcd->msg_channel_id;
+    message->msg = rx_msg;
+    message->type = type;
+    MessageSend(mmcd->client_task, PEER_SIG_MARSHALLED_MSG_CHANNEL_RX_IND, message);
+}
+
+static void appPeerSigL2capProcessCompact(const uint8* data, uint16 size)
+{
+    uint16 offset = PEER_SIG_COMPACT_CHANNELID_OFFSET;
+    uint16 read;
+    uint32 channel;
+    uint32 type;
+    marshal_msg_channel_data_t* mmcd;
+
+#ifdef DUMP_MARSHALL_DATA
+    dump_buffer(data, size);
+#endif
+
+    read = appPeerSigReadVarint(&data[offset], size - offset, &channel);
+    offset += read;
+    if (read)
+    {
+        read = appPeerSigReadVarint(&data[offset], size - offset, &type);
+        offset += read;
+    }
+    if (!read || channel >= PEER_SIG_MSG_CHANNEL_MAX)
+    {
+        DEBUG_LOG("appPeerSigL2capProcessCompact dropping truncated message, size %u", size);
+        return;
+    }
+
+    mmcd = appPeerSigGetChannelData((peerSigMsgChannel)channel);
+
+    if (mmcd->client_task)
+    {
+        void *rx_msg;
+
+        /* Only types that both sides send compact, and that are complete, can be rebuilt */
+        if (!appPeerSigIsCompactType(mmcd, (marshal_type_t)type) ||
+            size - offset != mmcd->type_desc[type]->size)
+        {
+            DEBUG_LOG("appPeerSigL2capProcessCompact dropping malformed message, channel %u type %u size %u",
+                      channel, type, size - offset);
+            return;
+        }
+
+        rx_msg = PanicUnlessMalloc(size - offset);
+        memcpy(rx_msg, &data[offset], size - offset);
+        appPeerSigSendRxInd(mmcd, rx_msg, (marshal_type_t)type);
+    }
+}
+
 static void appPeerSigL2capProcessMarshal(const uint8* data, uint16 size)
 {
     marshal_msg_channel_data_t* mmcd = NULL;
-    uint16 marshal_size = size - PEER_SIG_MARSHAL_HEADER_SIZE; 
-    peerSigMsgChannel channel = appPeerSigReadUint32(&data[PEER_SIG_MARSHAL_CHANNELID_OFFSET]);
+    uint16 marshal_size;
+    peerSigMsgChannel channel;
     marshal_type_t type;
     void* rx_msg;
 
-//    DEBUG_LOG("appPeerSigL2capProcessMarshal channel %u data %p size %u", channel, data, size);
-
 #ifdef DUMP_MARSHALL_DATA
     dump_buffer(data, size);
 #endif
 
-    mmcd = appPeerSigGetChannelData(channel);
+    if (size < PEER_SIG_MARSHAL_HEADER_SIZE)
+    {
+        DEBUG_LOG("appPeerSigL2capProcessMarshal dropping truncated message, size %u", size);
+        return;
+    }
+    marshal_size = size - PEER_SIG_MARSHAL_HEADER_SIZE;
+    channel = appPeerSigReadUint32(&data[PEER_SIG_MARSHAL_CHANNELID_OFFSET]);
 
-    if (mmcd->client_task)
+//    DEBUG_LOG("appPeerSigL2capProcessMarshal channel %u data %p size %u", channel, data, size);
+
+    if (channel >= PEER_SIG_MSG_CHANNEL_MAX)
     {
-        unmarshaller_t unmarshaller = PanicNull(UnmarshalInit(mmcd->type_desc, mmcd->num_type_desc));
+        DEBUG_LOG("appPeerSigL2capProcessMarshal dropping message for unknown channel %u", channel);
+        return;
+    }
 
-        UnmarshalSetBuffer(unmarshaller, &data[PEER_SIG_MARSHAL_PAYLOAD_OFFSET], marshal_size); 
+    mmcd = appPeerSigGetChannelData(channel);
 
-        if (Unmarshal(unmarshaller, &rx_msg, &type))
+    if (mmcd->client_task)
+    {
+        if (!mmcd->unmarshaller)
         {
-            MAKE_MESSAGE(PEER_SIG_MARSHALLED_MSG_CHANNEL_RX_IND);
+            mmcd->unmarshaller = PanicNull(UnmarshalInit(mmcd->type_desc, mmcd->num_type_desc));
+        }
+        UnmarshalSetBuffer(mmcd->unmarshaller, &data[PEER_SIG_MARSHAL_PAYLOAD_OFFSET], marshal_size); 
 
-            message->channel = channel;
-            message->msg = rx_msg;
-            message->type = type;
-            MessageSend(mmcd->client_task, PEER_SIG_MARSHALLED_MSG_CHANNEL_RX_IND, message);
+        if (Unmarshal(mmcd->unmarshaller, &rx_msg, &type))
+        {
+            appPeerSigSendRxInd(mmcd, rx_msg, type);
         }
-        UnmarshalDestroy(unmarshaller, FALSE);
+
+        /* Forget the objects unmarshalled, they now belong to the client */
+        UnmarshalClearStore(mmcd->unmarshaller);
     }
 }
 
@@ -1158,10 +1379,25 @@ static void appPeerSigL2capProcessData(void)
     while((size = SourceBoundary(source)) != 0)
     {
         const uint8 *data = SourceMap(source);
+        uint8 type;
+
+        if (size < PEER_SIG_MIN_PACKET_SIZE)
+        {
+            DEBUG_LOG("appPeerSigL2capProcessData dropping truncated message, size %u", size);
+            SourceDrop(source, size);
+            continue;
+        }
 
-        uint8 type = PEER_SIG_GET_HEADER_TYPE(data[PEER_SIG_HEADER_OFFSET]);
+        type = PEER_SIG_GET_HEADER_TYPE(data[PEER_SIG_HEADER_OFFSET]);
         peer_sig->rx_seq = data[PEER_SIG_TX_SEQ_NUMBER_OFFSET];
 
+        /* Every message carries the peer's features, so they are known from its first message */
+        if (peer_sig->peer_features != PEER_SIG_GET_HEADER_FEATURES(data[PEER_SIG_HEADER_OFFSET]))
+        {
+            peer_sig->peer_features = PEER_SIG_GET_HEADER_FEATURES(data[PEER_SIG_HEADER_OFFSET]);
+            DEBUG_LOG("appPeerSigL2capProcessData peer features 0x%x", peer_sig->peer_features);
+        }
+
         /*DEBUG_LOG("appPeerSigL2capProcessData type 0x%x opid 0x%x", type, opid);*/
 
         switch (type)
@@ -1171,11 +1407,15 @@ static void appPeerSigL2capProcessData(void)
             appPeerSigL2capProcessMarshal(data, size);
             break;
 
+        case PEER_SIG_TYPE_COMPACT:
+            appPeerSigL2capProcessCompact(data, size);
+            break;
+
         default:
 #ifdef DUMP_MARSHALL_DATA
             dump_buffer(data, size);
 #endif
-            Panic();
+            DEBUG_LOG("appPeerSigL2capProcessData dropping message of unknown type 0x%x", type);
             break;
         }
 
@@ -1251,7 +1491,7 @@ static void appPeerSigHandleMMS(const MessageMoreSpace *mms)
 /*! \brief Write the marshalled message header into a buffer. */
 static void appPeerSigWriteMarshalMsgChannelHeader(uint8* bufptr, uint8 tx_seq, peerSigMsgChannel channel)
 {
-    uint8 hdr = 0;
+    uint8 hdr = PEER_SIG_LOCAL_FEATURES;
 
     bufptr[PEER_SIG_HEADER_OFFSET] = PEER_SIG_SET_HEADER_TYPE(hdr, PEER_SIG_TYPE_MARSHAL);
     bufptr[PEER_SIG_TX_SEQ_NUMBER_OFFSET] = tx_seq;
@@ -1259,6 +1499,86 @@ static void appPeerSigWriteMarshalMsgChannelHeader(uint8* bufptr, uint8 tx_seq,
     appPeerSigWriteUint32(&bufptr[PEER_SIG_MARSHAL_CHANNELID_OFFSET], channel);
 }
 
+/*! \brief Send a message of a basic type to the peer with a compact header.
+    \return The number of octets sent. */
+static uint16 appPeerSigSendCompact(marshal_msg_channel_data_t *mmcd,
+                                    marshal_type_t type,
+                                    const void *msg_ptr)
+{
+    peerSigTaskData *peer_sig = PeerSigGetTaskData();
+    uint8 size = mmcd->type_desc[type]->size;
+    uint16 total = PEER_SIG_COMPACT_CHANNELID_OFFSET +
+                   appPeerSigVarintSize(mmcd->msg_channel_id) +
+                   appPeerSigVarintSize(type) + size;
+    uint8 hdr = PEER_SIG_LOCAL_FEATURES;
+    uint8* bufptr = PanicNull(appPeerSigClaimSink(peer_sig->link_sink, total));
+    uint16 offset = PEER_SIG_COMPACT_CHANNELID_OFFSET;
+
+    /*Increment peer signalling tx sequence number*/
+    peer_sig->tx_seq++;
+
+    bufptr[PEER_SIG_HEADER_OFFSET] = PEER_SIG_SET_HEADER_TYPE(hdr, PEER_SIG_TYPE_COMPACT);
+    bufptr[PEER_SIG_TX_SEQ_NUMBER_OFFSET] = peer_sig->tx_seq;
+    offset += appPeerSigWriteVarint(&bufptr[offset], mmcd->msg_channel_id);
+    offset += appPeerSigWriteVarint(&bufptr[offset], type);
+    memcpy(&bufptr[offset], msg_ptr, size);
+
+#ifdef DUMP_MARSHALL_DATA
+    dump_buffer(bufptr, total);
+#endif
+    SinkFlush(peer_sig->link_sink, total);
+
+    return total;
+}
+
+/*! \brief Marshal a message to the peer using the channel's marshaller.
+    \return The number of octets sent. */
+static uint16 appPeerSigSendMarshalled(marshal_msg_channel_data_t *mmcd,
+                                       marshal_type_t type,
+                                       void *msg_ptr)
+{
+    peerSigTaskData *peer_sig = PeerSigGetTaskData();
+    size_t space_required = 0;
+    uint8* bufptr = NULL;
+
+    /* get the marshaller for this msg channel */
+    if (!mmcd->marshaller)
+    {
+        mmcd->marshaller = PanicNull(MarshalInit(mmcd->type_desc, mmcd->num_type_desc));
+    }
+
+    /* determine how much space the marshaller will need in order to claim
+     * it from the l2cap sink, then try and claim that amount. The sizing pass
+     * starts from an empty object store, and the real pass continues from it */
+    MarshalClearStore(mmcd->marshaller);
+    MarshalSetBuffer(mmcd->marshaller, NULL, 0);
+    Marshal(mmcd->marshaller, msg_ptr, type);
+    space_required = MarshalRemaining(mmcd->marshaller);
+    bufptr = appPeerSigClaimSink(peer_sig->link_sink, PEER_SIG_MARSHAL_HEADER_SIZE + space_required);
+    PanicNull(bufptr);
+
+    /*Increment peer signalling tx sequence number*/
+    peer_sig->tx_seq++;
+
+    /* write the marshal msg header */
+    appPeerSigWriteMarshalMsgChannelHeader(bufptr, peer_sig->tx_seq, mmcd->msg_channel_id);
+
+    /* tell the marshaller where in the buffer it can write */
+    MarshalSetBuffer(mmcd->marshaller, &bufptr[PEER_SIG_MARSHAL_PAYLOAD_OFFSET], space_required); 
+
+    /* actually marshal this time and flush the sink to transmit it */
+    PanicFalse(Marshal(mmcd->marshaller, msg_ptr, type));
+#ifdef DUMP_MARSHALL_DATA
+    dump_buffer(bufptr, PEER_SIG_MARSHAL_HEADER_SIZE + space_required);
+#endif
+    SinkFlush(peer_sig->link_sink, PEER_SIG_MARSHAL_HEADER_SIZE + space_required);
+
+    /* the marshaller is kept for the next message, so forget this one */
+    MarshalClearStore(mmcd->marshaller);
+
+    return PEER_SIG_MARSHAL_HEADER_SIZE + space_required;
+}
+
 /*! \brief Attempt to marshal a message to the peer. */
 static void appPeerSigMarshal(
                     marshal_msg_channel_data_t *mmcd,
@@ -1274,38 +1594,17 @@ static void appPeerSigMarshal(
     {
         case PEER_SIG_STATE_CONNECTED:
         {
-            marshaller_t marshaller;
-            size_t space_required = 0;
-            uint8* bufptr = NULL;
-
-            /* get the marshaller for this msg channel */
-            marshaller = PanicNull(MarshalInit(mmcd->type_desc, mmcd->num_type_desc));
-
-            /* determine how much space the marshaller will need in order to claim
-             * it from the l2cap sink, then try and claim that amount */
-            MarshalSetBuffer(marshaller, NULL, 0);
-            Marshal(marshaller, msg_ptr, type);
-            space_required = MarshalRemaining(marshaller);
-            bufptr = appPeerSigClaimSink(peer_sig->link_sink, PEER_SIG_MARSHAL_HEADER_SIZE + space_required);
-            PanicNull(bufptr);
-
-            /*Increment peer signalling tx sequence number*/
-            peer_sig->tx_seq++;
-
-            /* write the marshal msg header */
-            appPeerSigWriteMarshalMsgChannelHeader(bufptr, peer_sig->tx_seq, mmcd->msg_channel_id);
-
-            /* tell the marshaller where in the buffer it can write */
-            MarshalSetBuffer(marshaller, &bufptr[PEER_SIG_MARSHAL_PAYLOAD_OFFSET], space_required); 
-
-            /* actually marshal this time and flush the sink to transmit it */
-            PanicFalse(Marshal(marshaller, msg_ptr, type));
-#ifdef DUMP_MARSHALL_DATA
-            dump_buffer(bufptr, PEER_SIG_MARSHAL_HEADER_SIZE + space_required);
-#endif
-            SinkFlush(peer_sig->link_sink, PEER_SIG_MARSHAL_HEADER_SIZE + space_required);
-
-            MarshalDestroy(marshaller, FALSE);
+            /* Peers that have not advertised compact support get every message marshalled */
+            if ((peer_sig->peer_features & PEER_SIG_FEATURE_COMPACT) && appPeerSigIsCompactType(mmcd, type))
+            {
+                peer_sig->marshal_stats.compact_msgs++;
+                peer_sig->marshal_stats.compact_bytes += appPeerSigSendCompact(mmcd, type, msg_ptr);
+            }
+            else
+            {
+                peer_sig->marshal_stats.marshalled_msgs++;
+                peer_sig->marshal_stats.marshalled_bytes += appPeerSigSendMarshalled(mmcd, type, msg_ptr);
+            }
 
             /* tell the client the message was sent */
             appPeerSigMarshalledMsgChannelTxCfm(mmcd->client_task, type,
@@ -1480,6 +1779,10 @@ void appPeerSigMarshalledMsgChannelTaskRegister(Task task, peerSigMsgChannel cha
     mmcd->type_desc = PanicNull((void*)type_desc);
     mmcd->num_type_desc = PanicZero(num_type_desc);
 
+    /* The descriptors may differ from a previous registration */
+    appPeerSigFreeChannelMarshalling(mmcd);
+    appPeerSigBuildCompactTypes(mmcd);
+
     DEBUG_LOG("MarshalInit %p for task %p", mmcd->type_desc, task);
 }
 
@@ -1490,9 +1793,16 @@ void appPeerSigMarshalledMsgChannelTaskUnregister(Task task, peerSigMsgChannel c
 
     PanicFalse(mmcd->client_task == task);
 
+    appPeerSigFreeChannelMarshalling(mmcd);
     memset(mmcd, 0, sizeof(*mmcd));
 }
 
+void appPeerSigGetMarshalStats(peer_sig_marshal_stats_t *stats)
+{
+    PanicNull(stats);
+    *stats = PeerSigGetTaskData()->marshal_stats;
+}
+
 /*! \brief Transmit a marshalled message channel message to the peer. */
 void appPeerSigMarshalledMsgChannelTx(Task task,
                                       peerSigMsgChannel channel,
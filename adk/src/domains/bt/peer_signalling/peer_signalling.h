@@ -220,6 +220,19 @@ typedef struct
     marshal_type_t type;            /*!< Message type. */
 } PEER_SIG_MARSHALLED_MSG_CHANNEL_RX_IND_T;
 
+/*! \brief Counts of the marshalled messages sent to the peer.
+
+    Messages of basic marshal types are sent as raw bytes behind a compact
+    header, all others are sent using the marshaller.
+*/
+typedef struct
+{
+    uint32 compact_msgs;            /*!< Messages sent with a compact header. */
+    uint32 compact_bytes;           /*!< Bytes sent for those, including headers. */
+    uint32 marshalled_msgs;         /*!< Messages sent using the marshaller. */
+    uint32 marshalled_bytes;        /*!< Bytes sent for those, including headers. */
+} peer_sig_marshal_stats_t;
+
 /*! brief Confirmation of the result of a connection request. */
 typedef struct
 {
@@ -330,6 +343,11 @@ void appPeerSigMarshalledMsgChannelTxCancelAll(Task task,
                                                peerSigMsgChannel channel,
                                                marshal_type_t type);
 
+/*! \brief Get the counts of marshalled messages sent to the peer.
+    \param[out] stats   Filled with the counts since boot.
+*/
+void appPeerSigGetMarshalStats(peer_sig_marshal_stats_t *stats);
+
 /*! \brief Test if peer signalling is connected to a peer.
 
     \return TRUE if connected; FALSE otherwise.
@@ -47,6 +47,16 @@ typedef struct
 
     /*! The channel */
     peerSigMsgChannel msg_channel_id;
+
+    /*! Bitmap, indexed by marshal type, of the types that are sent as raw
+        bytes behind a compact header. Built from the type descriptors when
+        the channel is registered. */
+    uint8 *compact_types;
+
+    /*! The channel's marshaller and unmarshaller, created on first use and
+        kept until the channel is unregistered. */
+    marshaller_t marshaller;
+    unmarshaller_t unmarshaller;
 } marshal_msg_channel_data_t;
 
 /*! \brief Types of lock used to control receipt of messages by the peer sig task. */
@@ -79,6 +89,7 @@ typedef struct
     /* State related to L2CAP peer signalling channel */
     uint16 local_psm;               /*!< L2CAP PSM registered */
     uint16 remote_psm;              /*!< L2CAP PSM registered by peer device */
+    bool remote_psm_cached;         /*!< remote_psm was taken from the device cache rather than SDP */
     uint8 sdp_search_attempts;      /*!< Count of failed SDP searches */
     uint16 pending_connects;
     Sink link_sink;                 /*!< The sink of the L2CAP link */
@@ -88,9 +99,16 @@ typedef struct
     uint8 tx_seq;
     uint8 rx_seq;
 
+    /*! Features advertised in the headers of the peer's messages. Zero
+        until the first message of a connection is received. */
+    uint8 peer_features;
+
     /*! Per-channel state */
     marshal_msg_channel_data_t marshal_msg_channel_state[PEER_SIG_MSG_CHANNEL_MAX];
 
+    /*! Counts of the messages sent to the peer by each encoding */
+    peer_sig_marshal_stats_t marshal_stats;
+
     /* Record the Task which first requested a connect or disconnect */
     TASK_LIST_WITH_INITIAL_CAPACITY(PEER_SIG_CONNECT_TASKS_LIST_INIT_CAPACITY) connect_tasks;
     TASK_LIST_WITH_INITIAL_CAPACITY(PEER_SIG_DISCONNECT_TASKS_LIST_INIT_CAPACITY) disconnect_tasks;
@@ -646,6 +646,24 @@ static void appA2dpExitConnectingMediaRemoteSync(avInstanceTaskData *theInst)
     appA2dpInstSyncExit(theInst);
 }
 
+/*! \brief Ask kymera to pre-build the audio chain for the configured codec
+
+    This moves chain creation out of the A2DP start, shortening the time to
+    first sample when the handset starts streaming.
+*/
+static void appA2dpPrewarmAudio(avInstanceTaskData *theInst)
+{
+    if (appA2dpIsSinkNonTwsCodec(theInst))
+    {
+        a2dp_codec_settings *codec_settings = appA2dpGetCodecSettings(theInst);
+        if (codec_settings)
+        {
+            appKymeraA2dpPrewarm(codec_settings, A2dpProfile_GetMaxBitrate(codec_settings));
+            free(codec_settings);
+        }
+    }
+}
+
 /*! \brief Enter A2DP_STATE_CONNECTED_MEDIA
 
     The A2DP state machine has entered 'connected media' state, this means
@@ -656,6 +674,7 @@ static void appA2dpEnterConnectedMedia(avInstanceTaskData *theInst)
     DEBUG_LOG("appA2dpEnterConnectedMedia(%p)", (void *)theInst);
 
     appLinkPolicyUpdateRoleFromSink(A2dpMediaGetSink(theInst->a2dp.device_id, theInst->a2dp.stream_id));
+    appA2dpPrewarmAudio(theInst);
 }
 
 /*! \brief Exit A2DP_STATE_CONNECTED_MEDIA
@@ -717,7 +736,10 @@ static void appA2dpExitDisconnectingMedia(avInstanceTaskData *theInst)
 */
 static void appA2dpEnterConnectedMediaStreaming(avInstanceTaskData *theInst)
 {
-    DEBUG_LOG("appA2dpEnterConnectedMediaStreaming(%p)", (void *)theInst);
+    TimestampEvent(TIMESTAMP_EVENT_A2DP_STREAMING);
+
+    DEBUG_LOG("appA2dpEnterConnectedMediaStreaming(%p) out_of_case_to_streaming(%u)", (void *)theInst,
+              TimestampEvent_Delta(TIMESTAMP_EVENT_OUT_OF_CASE, TIMESTAMP_EVENT_A2DP_STREAMING));
 
     /* Prevent role switch when streaming TWS (standard or plus, source or sink) */
     if (appA2dpIsSeidTws(theInst->a2dp.current_seid))
@@ -862,6 +884,7 @@ static void appA2dpExitConnectedMediaReconfiguring(avInstanceTaskData *theInst)
 {
     DEBUG_LOG("appA2dpExitConnectedMediaReconfiguring(%p)", (void *)theInst);
     appA2dpClearTransitionLockBit(theInst);
+    appA2dpPrewarmAudio(theInst);
 }
 
 /*! \brief Enter A2DP_STATE_CONNECTED_MEDIA_STARTING_LOCAL_SYNC
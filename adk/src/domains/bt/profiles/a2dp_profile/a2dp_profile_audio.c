@@ -88,7 +88,7 @@ static a2dpTaskData * A2dpProfile_GetHandsetData(audio_source_t audio_source)
     return av_instance ? &av_instance->a2dp : NULL;
 }
 
-static uint32 a2dpProfile_GetMaxBitrate(const a2dp_codec_settings *codec_settings)
+uint32 A2dpProfile_GetMaxBitrate(const a2dp_codec_settings *codec_settings)
 {
     /* When bitrate is zero, the argument is ignored by the underlying code */
     uint32 max_bitrate = 0;
@@ -126,7 +126,7 @@ static bool a2dpProfile_GetConnectParameters(audio_source_t source, a2dpTaskData
         audio_connect_params->bitpool = codec_settings->codecData.bitpool;
         audio_connect_params->format = codec_settings->codecData.format;
         audio_connect_params->packet_size = codec_settings->codecData.packet_size;
-        audio_connect_params->max_bitrate = a2dpProfile_GetMaxBitrate(codec_settings);
+        audio_connect_params->max_bitrate = A2dpProfile_GetMaxBitrate(codec_settings);
         audio_connect_params->q2q_mode = codec_settings->codecData.aptx_ad_params.q2q_enabled;
         audio_connect_params->nq2q_ttp = codec_settings->codecData.aptx_ad_params.nq2q_ttp;
         free(codec_settings);
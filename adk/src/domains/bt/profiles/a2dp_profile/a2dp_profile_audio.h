@@ -14,6 +14,8 @@
 #include "audio_sources_audio_interface.h"
 #include "source_param_types.h"
 
+#include <a2dp.h>
+
 /*\{*/
 
 /*! \brief Gets the A2DP handset audio interface.
@@ -50,6 +52,13 @@ bool A2dpProfile_GetForwardingDisconnectParameters(source_defined_params_t * sou
  */
 void A2dpProfile_FreeForwardingDisconnectParameters(source_defined_params_t * source_params);
 
+/*! \brief Gets the max bitrate of the input stream passed to the audio subsystem.
+
+    \param codec_settings The A2DP codec settings.
+    \return The max bitrate (in bps), zero if there is no limit for the codec
+ */
+uint32 A2dpProfile_GetMaxBitrate(const a2dp_codec_settings *codec_settings);
+
 /*\}*/
 
 #endif /* A2DP_PROFILE_AUDIO_H_ */
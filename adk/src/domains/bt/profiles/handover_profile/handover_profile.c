@@ -404,25 +404,47 @@ handover_profile_status_t HandoverProfile_Handover(const tp_bdaddr *remote_addr)
             return ret;
         }
 
+        ho_inst->marshal_state = HANDOVER_PROFILE_MARSHAL_STATE_P1_MARSHALLING;
+
+        /* Marshal P1 data while the peer processes the start request, so only
+           sending it remains once the peer confirms. The application cannot
+           change the marshalled state as no messages are delivered until
+           handover completes. */
+        ret = HandoverProfile_MarshalP1Clients(&ho_inst->tp_handset_addr);
+        if(ret != HANDOVER_PROFILE_STATUS_SUCCESS)
+        {
+            if(HandoverProfile_SendHandoverCancelInd() != HANDOVER_PROFILE_STATUS_SUCCESS)
+            {
+                DEBUG_LOG_INFO("HandoverProfile_Handover Failed to send Handover Cancel Ind");
+            }
+            HandoverProfile_AbortP1Clients();
+            DEBUG_LOG_INFO("HandoverProfile_Handover HandoverProfile_MarshalP1Clients failed");
+            ho_inst->marshal_state = HANDOVER_PROFILE_MARSHAL_STATE_IDLE;
+            return ret;
+        }
+
         /* Block on peer stream to receive HANDOVER_START_CFM */
         if((ret = HandoverProfile_ProcessProtocolStartCfm())  != HANDOVER_PROFILE_STATUS_SUCCESS)
         {
             DEBUG_LOG_INFO("HandoverProfile_Handover HandoverProfile_ProcessProtocolStartCfm wasn't success. ret:%d", ret);
+            HandoverProfile_DiscardP1Data();
+            HandoverProfile_AbortP1Clients();
+            ho_inst->marshal_state = HANDOVER_PROFILE_MARSHAL_STATE_IDLE;
             return ret;
         }
-        ho_inst->marshal_state = HANDOVER_PROFILE_MARSHAL_STATE_P1_MARSHALLING;
 
-        /* Marshal P1 data */
-        ret = HandoverProfile_MarshalP1Clients(&ho_inst->tp_handset_addr);
+        /* Send P1 data */
+        ret = HandoverProfile_SendP1Data(&ho_inst->tp_handset_addr);
         if(ret != HANDOVER_PROFILE_STATUS_SUCCESS)
         {
+            HandoverProfile_DiscardP1Data();
             if(ret == HANDOVER_PROFILE_STATUS_HANDOVER_TIMEOUT && 
                 (HandoverProfile_SendHandoverCancelInd() != HANDOVER_PROFILE_STATUS_SUCCESS))
             {
                 DEBUG_LOG_INFO("HandoverProfile_Handover Failed to send Handover Cancel Ind");
             }
             HandoverProfile_AbortP1Clients();
-            DEBUG_LOG_INFO("HandoverProfile_Handover HandoverProfile_Marshal_P1_Clients timeout/failed");
+            DEBUG_LOG_INFO("HandoverProfile_Handover HandoverProfile_SendP1Data timeout/failed");
             ho_inst->marshal_state = HANDOVER_PROFILE_MARSHAL_STATE_IDLE;
             return ret;
         }
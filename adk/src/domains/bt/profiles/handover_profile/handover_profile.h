@@ -62,6 +62,34 @@ typedef struct
 /*! brief Confirmation of the result of a disconnect request. */
 typedef HANDOVER_PROFILE_CONNECT_CFM_T HANDOVER_PROFILE_DISCONNECT_CFM_T;
 
+/*! Number of P1 clients, in registration order, for which marshal statistics are kept. */
+#define HANDOVER_PROFILE_MAX_CLIENT_STATS 8
+
+/*! Time and space taken by a P1 client to marshal its data. */
+typedef struct
+{
+    /*! Time spent in the client's marshal function in microseconds. */
+    uint32 marshal_us;
+    /*! Number of bytes the client marshalled. */
+    uint16 marshal_bytes;
+} handover_profile_client_stats_t;
+
+/*! Statistics for marshalling P1 data in the last handover as primary. */
+typedef struct
+{
+    /*! Time taken to marshal all the P1 clients in microseconds. This overlaps
+        waiting for the peer to confirm the start of handover. */
+    uint32 marshal_us;
+    /*! Time taken to send the marshalled data once the peer confirmed in microseconds. */
+    uint32 send_us;
+    /*! Bytes sent to the peer, including packet headers. */
+    uint16 bytes_sent;
+    /*! Number of valid entries in clients. */
+    uint8 num_clients;
+    /*! Per-client statistics, indexed by P1 client. */
+    handover_profile_client_stats_t clients[HANDOVER_PROFILE_MAX_CLIENT_STATS];
+} handover_profile_marshal_stats_t;
+
 #ifdef INCLUDE_MIRRORING
 
 /*! \brief Initialise the handover profile.
@@ -158,6 +186,14 @@ void HandoverProfile_HandleMdmSetBredrSlaveAddressInd(const MDM_SET_BREDR_SLAVE_
 */
 void HandoverProfile_HandleSubsystemVersionInfo(const MessageSubsystemVersionInfo *info);
 
+/*! \brief Get the P1 marshal statistics for the last handover as primary.
+
+    \param[out] stats  Filled with the statistics.
+
+    \return TRUE if P1 data has been marshalled since boot, FALSE otherwise.
+*/
+bool HandoverProfile_GetMarshalStats(handover_profile_marshal_stats_t *stats);
+
 #else
 
 #define HandoverProfile_Init(init_task) (FALSE)
@@ -178,6 +214,8 @@ void HandoverProfile_HandleSubsystemVersionInfo(const MessageSubsystemVersionInf
 
 #define HandoverProfile_HandleSubsystemVersionInfo(info) /* Nothing to do */
 
+#define HandoverProfile_GetMarshalStats(stats) (FALSE)
+
 #endif /* INCLUDE_MIRRORING */
 
 #endif /*HANDOVER_PROFILE_H_*/
@@ -19,6 +19,8 @@
 #include <stream.h>
 #include <panic.h>
 #include <logging.h>
+#include <string.h>
+#include <vm.h>
 
 /* Various Marshal Data Packet formats possible are shown below
 
@@ -1316,48 +1318,132 @@ handover_profile_status_t HandoverProfile_MarshalP0Clients(const tp_bdaddr *bd_a
 
 
 /*! 
-    \brief Marshal all P1 clients data and send to to peer.
+    \brief Record the time and space a P1 client took to marshal its data.
+
+    \param[in] client_id    The client.
+    \param[in] start_us     Time the client's marshal function was called.
+    \param[in] len          Number of bytes the client marshalled.
+*/
+static void handoverProfile_UpdateClientStats(uint8 client_id, uint32 start_us, uint16 len)
+{
+    handover_profile_marshal_stats_t *stats = &Handover_GetTaskData()->marshal_stats;
+
+    if(client_id < HANDOVER_PROFILE_MAX_CLIENT_STATS)
+    {
+        stats->clients[client_id].marshal_us += VmGetTimerTime() - start_us;
+        stats->clients[client_id].marshal_bytes += len;
+    }
+}
+
+/*! 
+    \brief Claim space in the sink for a new P1 packet.
+
+    When the flush is deferred the packet follows the packets already written
+    but not flushed, and the claim does not block.
+
+    \param[in] size         Space required for the packet.
+    \param[in] defer_flush  TRUE if the packet is not to be flushed until the
+                            peer has confirmed the start of handover.
+
+    \return Pointer to the start of the packet. NULL if there is no space.
+*/
+static uint8 *handoverProfile_ClaimP1Packet(uint16 size, bool defer_flush)
+{
+    handover_profile_task_data_t *ho_inst = Handover_GetTaskData();
+    uint8 *dest_addr;
+
+    ho_inst->sink_written = 0;
+
+    if(!defer_flush)
+    {
+        return handoverProfile_ClaimSink(ho_inst->link_sink, size, HANDOVER_PROFILE_P1_MARSHAL_TIMEOUT_MSEC);
+    }
+
+    if(ho_inst->p1_pending_packets == HANDOVER_PROFILE_MAX_P1_PENDING_PACKETS)
+    {
+        return NULL;
+    }
+
+    dest_addr = handoverProfile_ClaimSink(ho_inst->link_sink, ho_inst->p1_pending_bytes + size, 0);
+    return dest_addr ? dest_addr + ho_inst->p1_pending_bytes : NULL;
+}
+
+/*! 
+    \brief Complete the current P1 packet, either sending it to the peer or
+           recording it to be sent once the peer has confirmed the start of
+           handover.
+
+    \param[in] defer_flush  TRUE if the packet is not to be flushed yet.
+
+    \return TRUE if successful, FALSE if SinkFlush() failed.
+*/
+static bool handoverProfile_CompleteP1Packet(bool defer_flush)
+{
+    handover_profile_task_data_t *ho_inst = Handover_GetTaskData();
+    uint16 length = ho_inst->sink_written;
+
+    ho_inst->sink_written = 0;
+
+    if(defer_flush)
+    {
+        ho_inst->p1_pending_len[ho_inst->p1_pending_packets++] = length;
+        ho_inst->p1_pending_bytes += length;
+    }
+    else
+    {
+        if(SinkFlush(ho_inst->link_sink, length) == 0)
+        {
+            return FALSE;
+        }
+        ho_inst->marshal_stats.bytes_sent += length;
+    }
+    return TRUE;
+}
+
+/*! 
+    \brief Marshal P1 clients data into the sink, continuing from the client
+           reached by an earlier call.
 
     Start P1 client data in a new packet followed by end-of-marshal tag.
 
-    If HANDOVER_PROFILE_L2CAP_MTU_SIZE is reached send the packet to peer and block for
-    space in the l2cap sink for a maxium duration of HANDOVER_PROFILE_P1_MARSHAL_TIMEOUT_MSEC.
-    If the required space is claimed, then continue marshaling the P1 client data else return false.
+    If HANDOVER_PROFILE_L2CAP_MTU_SIZE is reached the packet is completed and
+    space claimed for another. When the flush is deferred, marshalling stops
+    without error as soon as no more space can be claimed without blocking.
+    Otherwise each packet is sent to the peer when complete and the claim
+    blocks for a maximum duration of HANDOVER_PROFILE_P1_MARSHAL_TIMEOUT_MSEC.
 
-    \param[in] bd_addr        Bluetooth address of the link to be marshalled.
-    \param[in] stream_offset  Points to the sink buffer to write marshal data.
+    \param[in] bd_addr      Bluetooth address of the link to be marshalled.
+    \param[in] defer_flush  TRUE if the packets are not to be flushed until the
+                            peer has confirmed the start of handover.
 
     \return \ref handover_profile_status_t. Returns,
             1. HANDOVER_PROFILE_STATUS_SUCCESS if marshal of P1 client is successful.
             2. HANDOVER_PROFILE_STATUS_HANDOVER_FAILURE if handover terminated due to SinkFlush() failure.
-            3. HANDOVER_PROFILE_STATUS_HANDOVER_TIMEOUT if any other failure occured.
-
+            3. HANDOVER_PROFILE_STATUS_HANDOVER_TIMEOUT if there was no space in the sink.
 */
-handover_profile_status_t HandoverProfile_MarshalP1Clients(const tp_bdaddr *bd_addr)
+static handover_profile_status_t handoverProfile_MarshalP1(const tp_bdaddr *bd_addr, bool defer_flush)
 {
     handover_profile_task_data_t *ho_inst = Handover_GetTaskData();
-    uint8 *dest_addr=NULL, *write_ptr=NULL, client_id=0;
+    uint8 *write_ptr = NULL;
     uint16 client_len = 0;
+    uint32 start_us = VmGetTimerTime();
 
     /* Marshal P1 clients */
-    while(client_id < ho_inst->num_clients)
+    while(ho_inst->p1_next_client < ho_inst->num_clients)
     {
+        uint8 client_id = ho_inst->p1_next_client;
+        uint32 client_start_us;
+        bool marshalled;
+
         /* Claim MTU size in the sink and add marshal header */
         if(write_ptr == NULL)
         {
-            ho_inst->sink_written = 0;
-            client_len = 0;
-
-            /* Claim MTU size in the sink */
-            dest_addr = handoverProfile_ClaimSink(ho_inst->link_sink, 
-                            HANDOVER_PROFILE_L2CAP_MTU_SIZE,
-                            HANDOVER_PROFILE_P0_MARSHAL_TIMEOUT_MSEC);
-            write_ptr = dest_addr;
-
-            if(dest_addr == NULL)
+            write_ptr = handoverProfile_ClaimP1Packet(HANDOVER_PROFILE_L2CAP_MTU_SIZE, defer_flush);
+            if(write_ptr == NULL)
             {
-                DEBUG_LOG_INFO("HandoverProfile_MarshalP1Clients handoverProfile_ClaimSink failed/timedout!!");
-                return HANDOVER_PROFILE_STATUS_HANDOVER_TIMEOUT;
+                DEBUG_LOG("HandoverProfile_MarshalP1Clients no space for packet, deferred %d", defer_flush);
+                ho_inst->marshal_stats.marshal_us += VmGetTimerTime() - start_us;
+                return defer_flush ? HANDOVER_PROFILE_STATUS_SUCCESS : HANDOVER_PROFILE_STATUS_HANDOVER_TIMEOUT;
             }
 
             /* Append P1 Header (HANDOVER_MARSHAL_DATA) */
@@ -1365,110 +1451,189 @@ handover_profile_status_t HandoverProfile_MarshalP1Clients(const tp_bdaddr *bd_a
             ho_inst->sink_written++;
         }
 
-        if(((ho_inst->sink_written + HANDOVER_PROFILE_P1_CLIENT_HEADER_LEN) < HANDOVER_PROFILE_L2CAP_MTU_SIZE) &&
-             ho_inst->ho_clients[client_id]->pFnMarshal(bd_addr,
-                                                        /* Offset after CLIENT_ID + DATA_LEN fields */
-                                                        write_ptr + HANDOVER_PROFILE_P1_CLIENT_HEADER_LEN,
-                                                        (HANDOVER_PROFILE_L2CAP_MTU_SIZE - (ho_inst->sink_written + HANDOVER_PROFILE_P1_CLIENT_HEADER_LEN)),
-                                                        &client_len))
+        client_start_us = VmGetTimerTime();
+        marshalled = ((ho_inst->sink_written + HANDOVER_PROFILE_P1_CLIENT_HEADER_LEN) < HANDOVER_PROFILE_L2CAP_MTU_SIZE) &&
+                     ho_inst->ho_clients[client_id]->pFnMarshal(bd_addr,
+                                                                /* Offset after CLIENT_ID + DATA_LEN fields */
+                                                                write_ptr + HANDOVER_PROFILE_P1_CLIENT_HEADER_LEN,
+                                                                (HANDOVER_PROFILE_L2CAP_MTU_SIZE - (ho_inst->sink_written + HANDOVER_PROFILE_P1_CLIENT_HEADER_LEN)),
+                                                                &client_len);
+        handoverProfile_UpdateClientStats(client_id, client_start_us, client_len);
+
+        DEBUG_LOG("HandoverProfile_MarshalP1Clients Client Id=%d Marshalled %d bytes, complete %d", client_id, client_len, marshalled);
+
+        /* Append client header(Client ID|DATA_LEN) if client has written marshal data */
+        if(client_len)
         {
-            DEBUG_LOG("HandoverProfile_MarshalP1Clients Client Id=%d Marshalled %d bytes", client_id, client_len);
-            /* Marshal complete for a client.
-               Append client header(Client ID|DATA_LEN) if client has written marshal data */
-            if(client_len)
-            {
-                /* Append P1 CLIENT_ID */
-                write_ptr[HANDOVER_PROFILE_P1_CLIENT_ID_OFFSET] = client_id;
-                /* Append Marshaled data length */
-                CONVERT_FROM_UINT16(write_ptr + HANDOVER_PROFILE_P1_CLIENT_DATA_LEN_OFFSET, client_len);
-                ho_inst->sink_written += client_len + HANDOVER_PROFILE_P1_CLIENT_HEADER_LEN;
-                /* Increment by client header(CLIENT_ID|DATA_LEN) + client data length */
-                write_ptr += HANDOVER_PROFILE_P1_CLIENT_HEADER_LEN + client_len;
-            }
+            /* Append P1 CLIENT_ID */
+            write_ptr[HANDOVER_PROFILE_P1_CLIENT_ID_OFFSET] = client_id;
+            /* Append Marshaled data length */
+            CONVERT_FROM_UINT16(write_ptr + HANDOVER_PROFILE_P1_CLIENT_DATA_LEN_OFFSET, client_len);
+            ho_inst->sink_written += client_len + HANDOVER_PROFILE_P1_CLIENT_HEADER_LEN;
+            /* Increment by client header(CLIENT_ID|DATA_LEN) + client data length */
+            write_ptr += HANDOVER_PROFILE_P1_CLIENT_HEADER_LEN + client_len;
+            client_len = 0;
+        }
 
-            /* Move to next client */
-            client_id++;
-            client_len=0;
+        if(marshalled)
+        {
+            /* Marshal complete for a client, move to next client */
+            ho_inst->p1_next_client++;
         }
-        /* Flush the current packet and check for marshal data again */
+        /* Complete the current packet and continue marshalling the client in a new packet */
         else
         {
-            DEBUG_LOG("HandoverProfile_MarshalP1Clients Client Id=%d marshalled %d bytes returned FALSE, flush the packet to claim more space", client_id, client_len);
-            /* Update the header if the client has written some data */
-            if(client_len)
-            {
-                /* Append P1 CLIENT_ID */
-                write_ptr[HANDOVER_PROFILE_P1_CLIENT_ID_OFFSET] = client_id;
-                /* Append Marshaled data length */
-                CONVERT_FROM_UINT16(write_ptr + HANDOVER_PROFILE_P1_CLIENT_DATA_LEN_OFFSET, client_len);
-                ho_inst->sink_written += client_len + HANDOVER_PROFILE_P1_CLIENT_HEADER_LEN;
-            }
-            /* Send the current packet to peer */
-            if(SinkFlush(ho_inst->link_sink, ho_inst->sink_written) == 0)
+            if(!handoverProfile_CompleteP1Packet(defer_flush))
             {
                 DEBUG_LOG_INFO("HandoverProfile_MarshalP1Clients Unable to flush the packet");
                 return HANDOVER_PROFILE_STATUS_HANDOVER_FAILURE;
             }
-
             write_ptr = NULL;
-            ho_inst->sink_written = 0;
         }
     }
 
-    /* Marshalling P1 data is done. Check if we have enough space (1 byte) in the current packet
-       1. Add end of marshal tag (Client ID=0xFF) else
-       2. Claim more space(2 bytes) for writing end of marshal tag (Marshal(0x80) | MarshalEnd(0xFF)) and
-       3. Flush */
-    if((HANDOVER_PROFILE_L2CAP_MTU_SIZE - ho_inst->sink_written) >= HANDOVER_PROFILE_P0_P1_TAG_LEN)
+    /* Marshalling P1 data is done. Add end of marshal tag (Client ID=0xFF) to
+       the current packet if it has space (1 byte), otherwise complete it and
+       write the tag in a packet of its own (Marshal(0x80) | MarshalEnd(0xFF)) */
+    if(write_ptr != NULL && (HANDOVER_PROFILE_L2CAP_MTU_SIZE - ho_inst->sink_written) < HANDOVER_PROFILE_P0_P1_TAG_LEN)
     {
-        DEBUG_LOG("HandoverProfile_MarshalP0Clients marshal end tag");
-        /* Add Client ID = 0xFF to mark the end of Marshal data */
-        *write_ptr++ = HANDOVER_MARSHAL_END_TAG;
-        ho_inst->sink_written++;
-    }
-    else
-    {
-        if(SinkFlush(ho_inst->link_sink, ho_inst->sink_written) == 0)
+        if(!handoverProfile_CompleteP1Packet(defer_flush))
         {
-            DEBUG_LOG("HandoverProfile_MarshalP1Clients Unable to flush the packet");
+            DEBUG_LOG_INFO("HandoverProfile_MarshalP1Clients Unable to flush the packet");
             return HANDOVER_PROFILE_STATUS_HANDOVER_FAILURE;
         }
+        write_ptr = NULL;
+    }
 
-        ho_inst->sink_written = 0;
-        DEBUG_LOG("HandoverProfile_MarshalP0Clients handoverProfile_ClaimSink again for sending marshal end tag");
-
-        /* Claim at least HANDOVER_PROFILE_MARSHAL_P1_HEADER_LEN in the sink */
-        write_ptr = handoverProfile_ClaimSink(ho_inst->link_sink,
-                        HANDOVER_PROFILE_MARSHAL_P1_HEADER_LEN,
-                        HANDOVER_PROFILE_P0_MARSHAL_TIMEOUT_MSEC);
-
+    if(write_ptr == NULL)
+    {
+        DEBUG_LOG("HandoverProfile_MarshalP1Clients claim space for marshal end tag");
+        write_ptr = handoverProfile_ClaimP1Packet(HANDOVER_PROFILE_MARSHAL_P1_HEADER_LEN, defer_flush);
         if(write_ptr == NULL)
         {
-            DEBUG_LOG("HandoverProfile_MarshalP0Clients handoverProfile_ClaimSink failed/timedout!!");
-            return HANDOVER_PROFILE_STATUS_HANDOVER_TIMEOUT;
+            DEBUG_LOG("HandoverProfile_MarshalP1Clients no space for end tag, deferred %d", defer_flush);
+            ho_inst->marshal_stats.marshal_us += VmGetTimerTime() - start_us;
+            return defer_flush ? HANDOVER_PROFILE_STATUS_SUCCESS : HANDOVER_PROFILE_STATUS_HANDOVER_TIMEOUT;
         }
-        /* Write Marshal(0x80) + End of marshal tag (0xFF) */
         *write_ptr++ = HANDOVER_MARSHAL_DATA;
-        *write_ptr++ = HANDOVER_MARSHAL_END_TAG;
-        ho_inst->sink_written = HANDOVER_PROFILE_MARSHAL_P1_HEADER_LEN;
+        ho_inst->sink_written++;
     }
 
+    /* Add Client ID = 0xFF to mark the end of Marshal data */
+    *write_ptr++ = HANDOVER_MARSHAL_END_TAG;
+    ho_inst->sink_written++;
+
     /* Send the P1 data completely as its cached at secondary */
-    if(ho_inst->sink_written)
+    if(!handoverProfile_CompleteP1Packet(defer_flush))
     {
-        DEBUG_LOG("HandoverProfile_MarshalP1Clients Flush the last P1 packet");
-        if(SinkFlush(ho_inst->link_sink, ho_inst->sink_written) == 0)
+        DEBUG_LOG_INFO("HandoverProfile_MarshalP1Clients Unable to flush the last P1 packet");
+        return HANDOVER_PROFILE_STATUS_HANDOVER_FAILURE;
+    }
+
+    ho_inst->p1_marshal_complete = TRUE;
+    ho_inst->marshal_stats.marshal_us += VmGetTimerTime() - start_us;
+
+    DEBUG_LOG("HandoverProfile_MarshalP1Clients Marshalling P1 data complete, deferred %d", defer_flush);
+    return HANDOVER_PROFILE_STATUS_SUCCESS;
+}
+
+/*! 
+    \brief Marshal as much P1 client data as fits in the sink without sending
+           it to the peer.
+
+    The packets are written to the sink as they are sent to the peer. Each is
+    at most HANDOVER_PROFILE_L2CAP_MTU_SIZE bytes and the last is followed by
+    the end-of-marshal tag. Marshalling stops when the sink has no more space
+    and continues in HandoverProfile_SendP1Data().
+
+    \param[in] bd_addr        Bluetooth address of the link to be marshalled.
+
+    \return \ref handover_profile_status_t. Returns,
+            1. HANDOVER_PROFILE_STATUS_SUCCESS if marshal of P1 client is successful.
+            2. HANDOVER_PROFILE_STATUS_HANDOVER_FAILURE if any other failure occured.
+
+*/
+handover_profile_status_t HandoverProfile_MarshalP1Clients(const tp_bdaddr *bd_addr)
+{
+    handover_profile_task_data_t *ho_inst = Handover_GetTaskData();
+
+    HandoverProfile_DiscardP1Data();
+    memset(&ho_inst->marshal_stats, 0, sizeof(ho_inst->marshal_stats));
+    ho_inst->marshal_stats.num_clients = MIN(ho_inst->num_clients, HANDOVER_PROFILE_MAX_CLIENT_STATS);
+
+    return handoverProfile_MarshalP1(bd_addr, TRUE);
+}
+
+/*! 
+    \brief Send the P1 packets marshalled by HandoverProfile_MarshalP1Clients()
+           to the peer, then marshal and send any P1 data that did not fit.
+
+    \param[in] bd_addr        Bluetooth address of the link to be marshalled.
+
+    \return \ref handover_profile_status_t. Returns,
+            1. HANDOVER_PROFILE_STATUS_SUCCESS if all the packets were sent.
+            2. HANDOVER_PROFILE_STATUS_HANDOVER_FAILURE if handover terminated due to SinkFlush() failure.
+            3. HANDOVER_PROFILE_STATUS_HANDOVER_TIMEOUT if there was no space in the sink.
+
+*/
+handover_profile_status_t HandoverProfile_SendP1Data(const tp_bdaddr *bd_addr)
+{
+    handover_profile_task_data_t *ho_inst = Handover_GetTaskData();
+    handover_profile_status_t ret = HANDOVER_PROFILE_STATUS_SUCCESS;
+    uint32 start_us = VmGetTimerTime();
+    uint8 index;
+
+    /* Flushing a packet leaves the following packets claimed at the start of the sink */
+    for(index = 0; index < ho_inst->p1_pending_packets; index++)
+    {
+        if(SinkFlush(ho_inst->link_sink, ho_inst->p1_pending_len[index]) == 0)
         {
-            DEBUG_LOG_INFO("HandoverProfile_MarshalP1Clients Unable to flush the last P1 packet");
+            DEBUG_LOG_INFO("HandoverProfile_SendP1Data Unable to flush the packet");
+            HandoverProfile_DiscardP1Data();
             return HANDOVER_PROFILE_STATUS_HANDOVER_FAILURE;
         }
+        ho_inst->marshal_stats.bytes_sent += ho_inst->p1_pending_len[index];
+    }
+    ho_inst->p1_pending_packets = 0;
+    ho_inst->p1_pending_bytes = 0;
 
-        ho_inst->sink_written = 0;
-        write_ptr = NULL;
+    if(!ho_inst->p1_marshal_complete)
+    {
+        ret = handoverProfile_MarshalP1(bd_addr, FALSE);
     }
 
-    DEBUG_LOG("HandoverProfile_MarshalP1Clients Marshalling P1 data complete");
-    return HANDOVER_PROFILE_STATUS_SUCCESS;
+    ho_inst->marshal_stats.send_us = VmGetTimerTime() - start_us;
+
+    DEBUG_LOG("HandoverProfile_SendP1Data sent %d bytes in %uus, status %d",
+              ho_inst->marshal_stats.bytes_sent, ho_inst->marshal_stats.send_us, ret);
+    return ret;
+}
+
+/*! 
+    \brief Discard any P1 packets waiting to be sent to the peer.
+
+    The packets are left claimed in the sink. They are never flushed and the
+    space is reused by the next write to the sink, which always starts at the
+    beginning of the claimed space.
+*/
+void HandoverProfile_DiscardP1Data(void)
+{
+    handover_profile_task_data_t *ho_inst = Handover_GetTaskData();
+
+    ho_inst->p1_pending_packets = 0;
+    ho_inst->p1_pending_bytes = 0;
+    ho_inst->p1_next_client = 0;
+    ho_inst->p1_marshal_complete = FALSE;
+    ho_inst->sink_written = 0;
+}
+
+bool HandoverProfile_GetMarshalStats(handover_profile_marshal_stats_t *stats)
+{
+    handover_profile_task_data_t *ho_inst = Handover_GetTaskData();
+
+    PanicNull(stats);
+    *stats = ho_inst->marshal_stats;
+    return (ho_inst->marshal_stats.marshal_us != 0);
 }
 
 /*! 
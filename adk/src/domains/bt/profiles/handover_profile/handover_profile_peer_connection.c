@@ -484,8 +484,20 @@ void HandoverProfile_HandleInternalStartupRequest(HANDOVER_PROFILE_INTERNAL_STAR
                 /* Store address of peer */
                 ho_inst->peer_addr = req->peer_addr;
 
-                /* Begin the search for the handover profile SDP record */
-                HandoverProfile_SetState(HANDOVER_PROFILE_STATE_CONNECTING_SDP_SEARCH);
+                /* Skip the SDP search if the peer PSM is known from an earlier connection */
+                ho_inst->remote_psm_cached = BtDevice_GetCachedRemotePsm(&ho_inst->peer_addr, DEVICE_PROFILE_HANDOVER,
+                                                                         &ho_inst->remote_psm);
+                if (ho_inst->remote_psm_cached)
+                {
+                    DEBUG_LOG("HandoverProfile_HandleInternalStartupRequest, cached peer psm 0x%x", ho_inst->remote_psm);
+                    handoverProfile_ConnectL2cap(&ho_inst->peer_addr);
+                    HandoverProfile_SetState(HANDOVER_PROFILE_STATE_CONNECTING_LOCAL);
+                }
+                else
+                {
+                    /* Begin the search for the handover profile SDP record */
+                    HandoverProfile_SetState(HANDOVER_PROFILE_STATE_CONNECTING_SDP_SEARCH);
+                }
             }
             else
             {
@@ -651,6 +663,7 @@ void HandoverProfile_HandleClSdpServiceSearchAttributeCfm(const CL_SDP_SERVICE_S
                                          &ho_inst->remote_psm, saProtocolDescriptorList))
                 {
                     DEBUG_LOG("HandoverProfile_HandleClSdpServiceSearchAttributeCfm, peer psm 0x%x", ho_inst->remote_psm);
+                    BtDevice_SetCachedRemotePsm(&ho_inst->peer_addr, DEVICE_PROFILE_HANDOVER, ho_inst->remote_psm);
 
                     /* Initiate outgoing peer L2CAP connection */
                     handoverProfile_ConnectL2cap(&ho_inst->peer_addr);
@@ -811,6 +824,17 @@ void HandoverProfile_HandleL2capConnectCfm(const CL_L2CAP_CONNECT_CFM_T *cfm)
                 mmd.source = ho_inst->link_source;
                 HandoverProfile_ProcessHandoverMessage(&mmd);
             }
+            else if (cfm->status >= l2cap_connect_failed && ho_inst->remote_psm_cached &&
+                     HandoverProfile_GetState(ho_inst) == HANDOVER_PROFILE_STATE_CONNECTING_LOCAL &&
+                     ConManagerIsConnected(&ho_inst->peer_addr))
+            {
+                /* The cached PSM may be stale, forget it and fall back to a SDP search */
+                DEBUG_LOG("HandoverProfile_HandleL2capConnectCfm, failed with cached psm, search again");
+
+                BtDevice_SetCachedRemotePsm(&ho_inst->peer_addr, DEVICE_PROFILE_HANDOVER, 0);
+                ho_inst->remote_psm_cached = FALSE;
+                HandoverProfile_SetState(HANDOVER_PROFILE_STATE_CONNECTING_SDP_SEARCH);
+            }
             else if (cfm->status >= l2cap_connect_failed)
             {
                 DEBUG_LOG("HandoverProfile_HandleL2capConnectCfm, failed, go to disconnected state");
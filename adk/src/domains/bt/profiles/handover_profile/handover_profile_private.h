@@ -75,6 +75,8 @@
 #define HANDOVER_PROFILE_P1_CLIENT_DATA_LEN_OFFSET                          (1)
 #define HANDOVER_PROFILE_OPCODE_FIELD_LEN                                   (1)
 #define HANDOVER_PROFILE_L2CAP_MTU_SIZE                                     (0x037F)
+/*! Maximum number of P1 packets marshalled before the peer confirms the start of handover */
+#define HANDOVER_PROFILE_MAX_P1_PENDING_PACKETS                             (4)
 
 /*! Timeout values for various APIs and protocol messages */
 #define HANDOVER_PROFILE_ACL_RECEIVE_ENABLE_TIMEOUT_USEC                    (750000)
@@ -264,6 +266,8 @@ typedef struct
     uint16 local_psm;
     /*!< L2CAP PSM registered by peer device */
     uint16 remote_psm;
+    /*!< remote_psm was taken from the device cache rather than SDP */
+    bool remote_psm_cached;
     /*!< The sink of the L2CAP link */
     Sink link_sink;
     /*!< The source of the L2CAP link */
@@ -301,6 +305,19 @@ typedef struct
          until the secondary earbud's firmware version has been received by the
          primary. */
     handover_profile_secondary_firmware_t secondary_firmware;
+    /*!< Next P1 client to marshal */
+    uint8 p1_next_client;
+    /*!< TRUE once all P1 data including the end tag has been marshalled */
+    bool p1_marshal_complete;
+    /*!< Number of P1 packets marshalled into the sink while waiting for the
+         peer to confirm the start of handover, flushed once it has */
+    uint8 p1_pending_packets;
+    /*!< Total length of the P1 packets in p1_pending_len */
+    uint16 p1_pending_bytes;
+    /*!< Lengths of the P1 packets waiting to be flushed, in sink order */
+    uint16 p1_pending_len[HANDOVER_PROFILE_MAX_P1_PENDING_PACKETS];
+    /*!< P1 marshal statistics for the last handover as primary */
+    handover_profile_marshal_stats_t marshal_stats;
 
 }handover_profile_task_data_t;
 
@@ -552,27 +569,43 @@ void HandoverProfile_DumpData(const uint8 *buf, size_t size);
 handover_profile_status_t HandoverProfile_MarshalP0Clients(const tp_bdaddr *bd_addr);
 
 /*! 
-    \brief Marshal all P1 clients data and send to to peer.
+    \brief Marshal as much P1 client data as fits in the sink without sending
+           it to the peer.
 
-    Marshal the data in two scenarios,
-    1. Append P1 client data in the same packet in which P0 marshal data is complete.
-    2. Start P1 client data in a new packet.
-
-    If HANDOVER_PROFILE_L2CAP_MTU_SIZE is reached send the packet to peer and block for
-    space in the l2cap sink for a maxium duration of HANDOVER_PROFILE_P1_MARSHAL_TIMEOUT_MSEC.
-    If the required space is claimed, then continue marshaling the P1 client data else return false.
+    This is called as soon as the handover start request has been sent, so
+    that marshalling overlaps the peer processing the request. The packets are
+    written to space claimed in the sink and flushed by
+    HandoverProfile_SendP1Data().
 
     \param[in] bd_addr        Bluetooth address of the link to be marshalled.
-    \param[in] stream_offset  Points to the sink buffer to write marshal data.
 
     \return \ref handover_profile_status_t. Returns,
             1. HANDOVER_PROFILE_STATUS_SUCCESS if marshal of P1 client is successful.
-            2. HANDOVER_PROFILE_STATUS_HANDOVER_FAILURE if handover terminated due to SinkFlush() failure.
-            3. HANDOVER_PROFILE_STATUS_HANDOVER_TIMEOUT if any other failure occured.
+            2. HANDOVER_PROFILE_STATUS_HANDOVER_FAILURE if any other failure occured.
 
 */
 handover_profile_status_t HandoverProfile_MarshalP1Clients(const tp_bdaddr *bd_addr);
 
+/*! 
+    \brief Send the P1 packets marshalled by HandoverProfile_MarshalP1Clients()
+           to the peer, then marshal and send any P1 data that did not fit.
+
+    \param[in] bd_addr        Bluetooth address of the link to be marshalled.
+
+    \return \ref handover_profile_status_t. Returns,
+            1. HANDOVER_PROFILE_STATUS_SUCCESS if all the packets were sent.
+            2. HANDOVER_PROFILE_STATUS_HANDOVER_FAILURE if handover terminated due to SinkFlush() failure.
+            3. HANDOVER_PROFILE_STATUS_HANDOVER_TIMEOUT if there was no space in the sink.
+
+*/
+handover_profile_status_t HandoverProfile_SendP1Data(const tp_bdaddr *bd_addr);
+
+/*! 
+    \brief Discard any P1 packets waiting to be sent to the peer.
+
+*/
+void HandoverProfile_DiscardP1Data(void);
+
 /*! 
     \brief Calls commit function of all the P1 clients registered with the
            Handover Profile.
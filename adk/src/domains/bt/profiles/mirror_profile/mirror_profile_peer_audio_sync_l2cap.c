@@ -324,6 +324,8 @@ void MirrorProfile_HandleClSdpServiceSearchAttributeCfm(const CL_SDP_SERVICE_SEA
                                          &mirror_inst->audio_sync.remote_psm, saProtocolDescriptorList))
                 {
                     DEBUG_LOG("MirrorProfile_HandleClSdpServiceSearchAttributeCfm, peer psm 0x%x", mirror_inst->audio_sync.remote_psm);
+                    BtDevice_SetCachedRemotePsm(&mirror_inst->audio_sync.peer_addr, DEVICE_PROFILE_MIRROR,
+                                                mirror_inst->audio_sync.remote_psm);
 
                     /* Create the L2cap connection */
                     mirrorProfile_SetAudioSyncL2capState(MIRROR_PROFILE_STATE_AUDIO_SYNC_L2CAP_LOCAL_CONNECTING);
@@ -425,6 +427,17 @@ void MirrorProfile_HandleL2capConnectCfm(const CL_L2CAP_CONNECT_CFM_T *cfm)
 
                 mirrorProfile_SetAudioSyncL2capState(MIRROR_PROFILE_STATE_AUDIO_SYNC_L2CAP_CONNECTED);
             }
+            else if (cfm->status >= l2cap_connect_failed && mirror_inst->audio_sync.remote_psm_cached &&
+                     mirror_inst->audio_sync.l2cap_state == MIRROR_PROFILE_STATE_AUDIO_SYNC_L2CAP_LOCAL_CONNECTING &&
+                     ConManagerIsConnected(&mirror_inst->audio_sync.peer_addr))
+            {
+                /* The cached PSM may be stale, forget it and fall back to a SDP search */
+                DEBUG_LOG("MirrorProfile_HandleL2capConnectCfm, failed with cached psm, search again");
+
+                BtDevice_SetCachedRemotePsm(&mirror_inst->audio_sync.peer_addr, DEVICE_PROFILE_MIRROR, 0);
+                mirror_inst->audio_sync.remote_psm_cached = FALSE;
+                mirrorProfile_SetAudioSyncL2capState(MIRROR_PROFILE_STATE_AUDIO_SYNC_L2CAP_SDP_SEARCH);
+            }
             else if (cfm->status >= l2cap_connect_failed)
             {
                 DEBUG_LOG("MirrorProfile_HandleL2capConnectCfm, failed, go to disconnected state");
@@ -556,8 +569,19 @@ void MirrorProfile_CreateAudioSyncL2capChannel(Task task, const bdaddr *peer_add
     {
         DEBUG_LOG("MirrorProfile_CreateAudioSyncL2capChannel, ACL connected");
 
-        /* Trigger the SDP Search */
-        mirrorProfile_SetAudioSyncL2capState(MIRROR_PROFILE_STATE_AUDIO_SYNC_L2CAP_SDP_SEARCH);
+        /* Skip the SDP search if the peer PSM is known from an earlier connection */
+        audio_sync->remote_psm_cached = BtDevice_GetCachedRemotePsm(&audio_sync->peer_addr, DEVICE_PROFILE_MIRROR,
+                                                                    &audio_sync->remote_psm);
+        if (audio_sync->remote_psm_cached)
+        {
+            DEBUG_LOG("MirrorProfile_CreateAudioSyncL2capChannel, cached peer psm 0x%x", audio_sync->remote_psm);
+            mirrorProfile_SetAudioSyncL2capState(MIRROR_PROFILE_STATE_AUDIO_SYNC_L2CAP_LOCAL_CONNECTING);
+        }
+        else
+        {
+            /* Trigger the SDP Search */
+            mirrorProfile_SetAudioSyncL2capState(MIRROR_PROFILE_STATE_AUDIO_SYNC_L2CAP_SDP_SEARCH);
+        }
     }
     else
     {
@@ -66,6 +66,9 @@ typedef struct
     /*! L2CAP PSM registered by peer device */
     uint16 remote_psm;
 
+    /*! remote_psm was taken from the device cache rather than SDP */
+    bool remote_psm_cached;
+
     /*! Bluetooth address of the peer */
     bdaddr peer_addr;
 
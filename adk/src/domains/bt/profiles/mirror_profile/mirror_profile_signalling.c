@@ -134,6 +134,23 @@ static void mirrorProfile_HandleA2dpStreamContext(const mirror_profile_stream_co
     a2dp_state->q2q_mode = context->q2q_mode;
     mirrorProfile_UpdateAudioVolumeFromPeer(context->volume);
 
+    /* The secondary learns the codec here, before the mirrored A2DP start, so
+       pre-build its input chain as the primary does when the media channel opens.
+       After a handover both earbuds already have their chains running. */
+    if (MirrorProfile_IsSecondary() && context->audio_state == AUDIO_SYNC_STATE_CONNECTED)
+    {
+        a2dp_codec_settings codec_settings;
+
+        memset(&codec_settings, 0, sizeof(codec_settings));
+        codec_settings.seid = a2dp_state->seid;
+        codec_settings.rate = a2dp_state->sample_rate;
+        codec_settings.codecData.content_protection = a2dp_state->content_protection;
+        codec_settings.codecData.packet_size = a2dp_state->mtu;
+
+        /* The mirrored start is given no maximum bitrate */
+        appKymeraA2dpPrewarm(&codec_settings, 0);
+    }
+
     if (context->flags & MIRROR_PROFILE_STREAM_CONTEXT_FLAG_SEND_RESPONSE)
     {
         mirror_profile_stream_context_response_t *response = PanicUnlessMalloc(sizeof(*response));
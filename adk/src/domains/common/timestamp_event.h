@@ -132,6 +132,25 @@ typedef enum
         following audio sync completion */
     TIMESTAMP_EVENT_KYMERA_INTERNAL_A2DP_AUDIO_SYNCHRONISED,
 
+    /*! Kymera has pre-built the A2DP input chain for the configured codec */
+    TIMESTAMP_EVENT_KYMERA_A2DP_PREWARMED,
+
+    /*! Kymera has started handling the A2DP start on the primary */
+    TIMESTAMP_EVENT_KYMERA_A2DP_START,
+
+    /*! Kymera has created and configured the A2DP output chain */
+    TIMESTAMP_EVENT_KYMERA_A2DP_OUTPUT_CHAIN_READY,
+
+    /*! Kymera has the A2DP input chain configured and connected,
+        either pre-built or built during the start */
+    TIMESTAMP_EVENT_KYMERA_A2DP_INPUT_CHAIN_READY,
+
+    /*! Kymera has started the A2DP chains */
+    TIMESTAMP_EVENT_KYMERA_A2DP_CHAINS_STARTED,
+
+    /*! Kymera has started the hash transform on the first A2DP media packet */
+    TIMESTAMP_EVENT_KYMERA_A2DP_FIRST_PACKET,
+
     /*! AMA profile connected to handset */
     TIMESTAMP_EVENT_PROFILE_CONNECTED_AMA,
 
@@ -162,6 +181,12 @@ typedef enum
     /*! ACCESSORY profile disconnected from handset */
     TIMESTAMP_EVENT_PROFILE_DISCONNECTED_ACCESSORY,
 
+    /*! Earbud has been taken out of the case */
+    TIMESTAMP_EVENT_OUT_OF_CASE,
+
+    /*! A2DP profile has entered the streaming state */
+    TIMESTAMP_EVENT_A2DP_STREAMING,
+
     /*! Always the final event id */
     NUMBER_OF_TIMESTAMP_EVENTS,
 
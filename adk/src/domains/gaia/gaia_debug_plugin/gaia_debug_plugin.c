@@ -277,6 +277,29 @@ static void gaiaDebugPlugin_HandleDataSessionCloseInd(Task response_task, GAIA_D
 static void gaiaDebugPlugin_GetPanicLogData(Task response_task, GAIA_DATA_TRANSFER_INTERNAL_GET_REQ_T *req);
 
 
+/*! \brief Handle DATA_TRANSFER_STREAM_REQ message, with which Gaia Framework
+           requests a source for streaming the Debug Log data.
+
+    \param response_task    Task which #GAIA_DATA_TRANSFER_INTERNAL_STREAM_CFM
+                            is sent to.
+    \param req              Request message that contains the Session ID and
+                            the starting offset.
+
+    This function opens the 'Debug Partition' source and moves it to the offset
+    specified. The source is handed over to Gaia Framework, which streams the
+    data bytes to the mobile app and closes the source when done.
+*/
+static void gaiaDebugPlugin_OpenPanicLogStream(Task response_task, GAIA_DATA_TRANSFER_INTERNAL_STREAM_REQ_T *req);
+
+
+/*! \brief Move the 'Debug Partition' source to the offset specified.
+
+    \param source   The source of the 'Debug Partition'.
+    \param offset   The number of data bytes to skip.
+*/
+static void gaiaDebugPlugin_DropPanicLogData(Source source, uint32 offset);
+
+
 /*! \brief Handles an unknown message of Gaia Data transfer session.
 
     \param task     The task that has sent the data transfer session message.
@@ -382,6 +405,10 @@ static void GaiaDebugPlugin_DataTransferHandler(Task task, MessageId id, Message
             gaiaDebugPlugin_GetPanicLogData(task, (GAIA_DATA_TRANSFER_INTERNAL_GET_REQ_T*)message);
             break;
 
+        case GAIA_DATA_TRANSFER_INTERNAL_STREAM_REQ:
+            gaiaDebugPlugin_OpenPanicLogStream(task, (GAIA_DATA_TRANSFER_INTERNAL_STREAM_REQ_T*)message);
+            break;
+
         default:
             gaiaDebugPlugin_HandleDataSessionUnknown(task, id);
             break;
@@ -779,19 +806,7 @@ static void gaiaDebugPlugin_GetPanicLogData(Task response_task, GAIA_DATA_TRANSF
         }
 
         /* Step 4: Move the starting point to read to the offset specified. */
-        while (offset)
-        {
-            uint16 drop_size;
-
-            source_size = SourceSize(source);
-            drop_size = (offset < source_size) ? (uint16) offset : source_size;
-            if (drop_size == 0)
-            {
-                break;
-            }
-            SourceDrop(source, drop_size);
-            offset -= drop_size;
-        }
+        gaiaDebugPlugin_DropPanicLogData(source, offset);
 
         /* Step 5: Ensure that the data size fits the payload length of 'DataTransfer_Get' Response. */
         if (data_size > DATA_TRANSFER_GET_RESPONSE_PAYLOAD_SIZE)
@@ -867,6 +882,65 @@ static void gaiaDebugPlugin_GetPanicLogData(Task response_task, GAIA_DATA_TRANSF
 }
 
 
+static void gaiaDebugPlugin_DropPanicLogData(Source source, uint32 offset)
+{
+    while (offset)
+    {
+        uint16 source_size = SourceSize(source);
+        uint16 drop_size = (offset < source_size) ? (uint16) offset : source_size;
+
+        if (drop_size == 0)
+        {
+            break;
+        }
+        SourceDrop(source, drop_size);
+        offset -= drop_size;
+    }
+}
+
+
+static void gaiaDebugPlugin_OpenPanicLogStream(Task response_task, GAIA_DATA_TRANSFER_INTERNAL_STREAM_REQ_T *req)
+{
+    data_transfer_status_code_t status;
+    uint32 log_total_size = 0;
+    Source source;
+
+    DEBUG_LOG_DEBUG("gaiaDebugPlugin OpenPanicLogStream Offset:0x%08X", req->starting_offset);
+
+    source = StreamDebugPartitionSource();
+    if (source == NULL)
+    {
+        DEBUG_LOG_ERROR("GaiaDebugPlugin FAILED: StreamDebugPartitionSource");
+        status = data_transfer_status_invalid_source;
+    }
+    else
+    {
+        DebugPartitionInfo(DP_INFO_DATA_SIZE, &log_total_size);
+        if (log_total_size <= req->starting_offset)
+        {
+            DEBUG_LOG_WARN("GaiaDebugPlugin (i) Log size:%d <= Offset:%d", log_total_size, req->starting_offset);
+            SourceClose(source);
+            source = NULL;
+            status = data_transfer_no_more_data;
+        }
+        else
+        {
+            gaiaDebugPlugin_DropPanicLogData(source, req->starting_offset);
+            status = data_transfer_status_success;
+        }
+    }
+
+    {
+        MAKE_GAIA_DATA_TRANSFER_MESSAGE(GAIA_DATA_TRANSFER_INTERNAL_STREAM_CFM);
+        message->status = status;
+        message->session_id = req->session_id;
+        message->sequence = req->sequence;
+        message->source = source;
+        MessageSend(response_task, GAIA_DATA_TRANSFER_INTERNAL_STREAM_CFM, message);
+    }
+}
+
+
 static void gaiaDebugPlugin_HandleDataSessionUnknown(Task task, MessageId id)
 {
     DEBUG_LOG_DEBUG("GaiaDebugPlugin Unknown Msg: 0x%04X", id);
@@ -10,7 +10,9 @@
 #include "gaia_framework_data_channel.h"
 
 #include <panic.h>
+#include <source.h>
 #include <stdlib.h>
+#include <vm.h>
 
 /* Enable debug log outputs with per-module debug log levels.
  * The log output level for this module can be changed with the PyDbg command:
@@ -32,6 +34,12 @@ LOGGING_PRESERVE_MESSAGE_ENUM(gaia_data_ch_internal_messages)
 #define GAIA_FRAMEWORK_DATA_CH_PANIC()
 #endif
 
+/*! \brief The max number of streamed Responses sent before yielding to other tasks. */
+#define GAIA_DATA_TRANSFER_STREAM_RSPS_PER_PASS     (4)
+
+/*! \brief The delay before retrying to stream, if the transport has no space (in milliseconds). */
+#define GAIA_DATA_TRANSFER_STREAM_RETRY_DELAY_MS    (20)
+
 
 /*! \brief Types of transport
 */
@@ -79,6 +87,24 @@ typedef struct __session_instance_t
     /*! Transform of a stream if in use, otherwise this is NULL. */
     Transform                       data_channel_transform;
 
+    /*! Source of the data bytes being streamed, otherwise NULL. */
+    Source                          stream_source;
+    /*! Buffer that a streamed Response is built in, allocated while streaming. */
+    uint8 *                         stream_buffer;
+    /*! The max number of data bytes in a streamed Response. */
+    uint16                          stream_data_size;
+    /*! TRUE while waiting for the Gaia Feature to open the source. */
+    bool                            stream_source_requested;
+    /*! Sequence number of the last source request, so a late confirmation to an earlier one is discarded. */
+    uint16                          stream_sequence;
+    /*! The offset of the next data byte to be streamed. */
+    uint32                          stream_offset;
+    /*! The number of data bytes requested by the mobile app but not sent yet. */
+    uint32                          stream_credit;
+    /*! The number of data bytes streamed and the time the stream started, for throughput logs. */
+    uint32                          stream_bytes_sent;
+    uint32                          stream_start_time;
+
     struct __session_instance_t *next;
 } session_instance_t;
 
@@ -190,6 +216,59 @@ static bool gaiaFrameworkDataChannel_HandleGaiaDataTransferSetRsp(GAIA_DATA_TRAN
 static void gaiaFrameworkDataChannel_SendDataTransferSetupResponse(gaia_data_transfer_session_id_t session_id);
 
 
+/*! \brief Check if the transport can stream 'Data Transfer Get' Responses.
+
+    \param t    GAIA transport associated with the data transfer session.
+
+    \return TRUE if the transport reports its available transmit space, otherwise FALSE.
+*/
+static bool gaiaFrameworkDataChannel_IsStreamingSupported(GAIA_TRANSPORT *t);
+
+
+/*! \brief Stop streaming data bytes and free the resources used for it.
+
+    \param instance     The session instance that streams the data bytes.
+*/
+static void gaiaFrameworkDataChannel_StopStream(session_instance_t *instance);
+
+
+/*! \brief Send the data bytes from the stream source as 'Data Transfer Get' Responses.
+
+    \param instance     The session instance that streams the data bytes.
+
+    This function sends Responses while there is credit and space in the
+    transport. It carries on later with #GAIA_DATA_TRANSFER_INTERNAL_STREAM_CONTINUE
+    if it has to yield or wait for space. The data bytes are copied from the
+    source straight into the Response buffer, without any intermediate messages.
+*/
+static void gaiaFrameworkDataChannel_StreamData(session_instance_t *instance);
+
+
+/*! \brief Handle 'Data Transfer Get' Command for a streaming session.
+
+    \param instance         The session instance of the Session ID in the command.
+
+    \param starting_offset  The starting position of the data bytes requested.
+
+    \param requested_size   The size of the data bytes requested.
+
+    If the starting offset follows the data bytes already requested, the
+    requested size is added to the credit of the stream. Otherwise the stream
+    is restarted and the Gaia Feature is asked for a new source.
+*/
+static void gaiaFrameworkDataChannel_HandleStreamGet(session_instance_t *instance, uint32 starting_offset, uint32 requested_size);
+
+
+/*! \brief Handle #GAIA_DATA_TRANSFER_INTERNAL_STREAM_CFM message from a Gaia
+           Feature's data transfer handler.
+
+    \param cfm  #GAIA_DATA_TRANSFER_INTERNAL_STREAM_CFM message.
+
+    \return TRUE on success, otherwise FALSE.
+*/
+static bool gaiaFrameworkDataChannel_HandleGaiaDataTransferStreamCfm(GAIA_DATA_TRANSFER_INTERNAL_STREAM_CFM_T *cfm);
+
+
 
 /*! \brief Task that receives Gaia Data Transfer internal messages. */
 static TaskData gaia_framework_data_transfer_internal_message_handler = { GaiaFramework_DataTransferInternalMessageHandler };
@@ -281,6 +360,7 @@ static bool gaiaFrameworkDataChannel_AddSessionInstance(GAIA_TRANSPORT *t, gaia_
         session_instance_t *sr;
 
         sr = (session_instance_t*) PanicUnlessMalloc(sizeof(session_instance_t));
+        memset(sr, 0, sizeof(session_instance_t));
         sr->session_id = session_id;
         sr->feature_id = feature_id;
         sr->handler_task = *handler_task;
@@ -317,6 +397,7 @@ static bool gaiaFrameworkDataChannel_DeleteSessionInstance(gaia_data_transfer_se
             {
                 prev->next = instance->next;
             }
+            gaiaFrameworkDataChannel_StopStream(instance);
             free(instance);
             return TRUE;
         }
@@ -478,6 +559,190 @@ static void gaiaFrameworkDataChannel_SendDataTransferSetupResponse(gaia_data_tra
 }
 
 
+static bool gaiaFrameworkDataChannel_IsStreamingSupported(GAIA_TRANSPORT *t)
+{
+    uint32 space;
+
+    return Gaia_TransportGetInfo(t, GAIA_TRANSPORT_TX_AVAILABLE_SPACE, &space);
+}
+
+
+static void gaiaFrameworkDataChannel_StopStream(session_instance_t *instance)
+{
+    if (instance->stream_source != NULL)
+    {
+        uint32 elapsed_ms = VmGetClock() - instance->stream_start_time;
+
+        DEBUG_LOG_INFO("GaiaFW DataTransfer: Stream stopped, Session ID: 0x%04X, %u bytes in %u ms (%u bytes/s)",
+                       instance->session_id, instance->stream_bytes_sent, elapsed_ms,
+                       elapsed_ms ? (instance->stream_bytes_sent * 1000UL) / elapsed_ms : 0);
+        SourceClose(instance->stream_source);
+        instance->stream_source = NULL;
+    }
+
+    free(instance->stream_buffer);
+    instance->stream_buffer = NULL;
+    instance->stream_source_requested = FALSE;
+    instance->stream_credit = 0;
+}
+
+
+static void gaiaFrameworkDataChannel_StreamData(session_instance_t *instance)
+{
+    uint16 rsp_count = 0;
+
+    while (instance->stream_source != NULL && instance->stream_credit != 0)
+    {
+        uint16 data_size = SourceSize(instance->stream_source);
+        uint32 space = 0;
+
+        if (data_size > instance->stream_data_size)
+        {
+            data_size = instance->stream_data_size;
+        }
+        if (data_size > instance->stream_credit)
+        {
+            data_size = (uint16) instance->stream_credit;
+        }
+
+        Gaia_TransportGetInfo(instance->transport, GAIA_TRANSPORT_TX_AVAILABLE_SPACE, &space);
+        if (rsp_count == GAIA_DATA_TRANSFER_STREAM_RSPS_PER_PASS ||
+            space < Gaia_TransportCommonCalcTxPacketLength(GAIA_DATA_TRANSFER_GET_RSP_HEADER_SIZE + data_size, GAIA_STATUS_NONE))
+        {
+            /* Yield to other tasks, or wait for the transport to send the Responses already queued. */
+            MAKE_GAIA_DATA_TRANSFER_MESSAGE(GAIA_DATA_TRANSFER_INTERNAL_STREAM_CONTINUE);
+            message->session_id = instance->session_id;
+            MessageSendLater(&gaia_framework_data_transfer_internal_message_handler, GAIA_DATA_TRANSFER_INTERNAL_STREAM_CONTINUE, message,
+                             (rsp_count == GAIA_DATA_TRANSFER_STREAM_RSPS_PER_PASS) ? 0 : GAIA_DATA_TRANSFER_STREAM_RETRY_DELAY_MS);
+            return;
+        }
+
+        instance->stream_buffer[0] = (uint8) ((instance->session_id & 0xFF00) >> 8);
+        instance->stream_buffer[1] = (uint8)  (instance->session_id & 0x00FF);
+        if (data_size != 0)
+        {
+            memmove(&instance->stream_buffer[GAIA_DATA_TRANSFER_GET_RSP_HEADER_SIZE], SourceMap(instance->stream_source), data_size);
+            SourceDrop(instance->stream_source, data_size);
+        }
+        GaiaFramework_SendResponse(instance->transport, GAIA_CORE_FEATURE_ID, data_transfer_get,
+                                   GAIA_DATA_TRANSFER_GET_RSP_HEADER_SIZE + data_size, instance->stream_buffer);
+        rsp_count++;
+
+        if (data_size == 0)
+        {
+            /* The source has no more data: the Response without data bytes tells the mobile app. */
+            DEBUG_LOG_DEBUG("GaiaFW DataTransfer: Stream end of data, Session ID: 0x%04X", instance->session_id);
+            gaiaFrameworkDataChannel_StopStream(instance);
+            return;
+        }
+
+        instance->stream_offset += data_size;
+        instance->stream_credit -= data_size;
+        instance->stream_bytes_sent += data_size;
+    }
+}
+
+
+static void gaiaFrameworkDataChannel_HandleStreamGet(session_instance_t *instance, uint32 starting_offset, uint32 requested_size)
+{
+    bool is_streaming = (instance->stream_source != NULL || instance->stream_source_requested);
+
+    if (is_streaming && starting_offset == instance->stream_offset + instance->stream_credit)
+    {
+        bool was_idle = (instance->stream_credit == 0);
+
+        DEBUG_LOG_DEBUG("GaiaFW DataTransfer: Stream credit +%u, Session ID: 0x%04X", requested_size, instance->session_id);
+        instance->stream_credit += requested_size;
+
+        /* Otherwise, either the source is still being opened or Responses are already being sent. */
+        if (was_idle && instance->stream_source != NULL)
+        {
+            gaiaFrameworkDataChannel_StreamData(instance);
+        }
+    }
+    else
+    {
+        uint32 max_tx_payload = DATA_TRANSFER_GET_RESPONSE_PAYLOAD_SIZE + GAIA_DATA_TRANSFER_GET_RSP_HEADER_SIZE;
+        Task data_handler;
+
+        DEBUG_LOG_DEBUG("GaiaFW DataTransfer: Stream start, Session ID: 0x%04X, Offset:0x%08X", instance->session_id, starting_offset);
+        gaiaFrameworkDataChannel_StopStream(instance);
+
+        Gaia_TransportGetInfo(instance->transport, GAIA_TRANSPORT_MAX_TX_PAYLOAD, &max_tx_payload);
+        if (max_tx_payload > DATA_TRANSFER_GET_RESPONSE_PAYLOAD_SIZE + GAIA_DATA_TRANSFER_GET_RSP_HEADER_SIZE)
+        {
+            max_tx_payload = DATA_TRANSFER_GET_RESPONSE_PAYLOAD_SIZE + GAIA_DATA_TRANSFER_GET_RSP_HEADER_SIZE;
+        }
+        instance->stream_data_size = (uint16) (max_tx_payload - GAIA_DATA_TRANSFER_GET_RSP_HEADER_SIZE);
+        instance->stream_buffer = (uint8*) PanicUnlessMalloc(GAIA_DATA_TRANSFER_GET_RSP_HEADER_SIZE + instance->stream_data_size);
+        instance->stream_source_requested = TRUE;
+        instance->stream_offset = starting_offset;
+        instance->stream_credit = requested_size;
+        instance->stream_bytes_sent = 0;
+        instance->stream_start_time = VmGetClock();
+
+        /* Ask the registered Feature's data handler for a source of the data bytes. */
+        {
+            MAKE_GAIA_DATA_TRANSFER_MESSAGE(GAIA_DATA_TRANSFER_INTERNAL_STREAM_REQ);
+
+            message->session_id = instance->session_id;
+            message->sequence = ++instance->stream_sequence;
+            message->starting_offset = starting_offset;
+            data_handler = GaiaFramework_GetDataTransferHandler(instance->session_id);
+            (*data_handler).handler(&gaia_framework_data_transfer_internal_message_handler, GAIA_DATA_TRANSFER_INTERNAL_STREAM_REQ, message);
+            free(message);
+        }
+    }
+}
+
+
+static bool gaiaFrameworkDataChannel_HandleGaiaDataTransferStreamCfm(GAIA_DATA_TRANSFER_INTERNAL_STREAM_CFM_T *cfm)
+{
+    session_instance_t  *instance;
+
+    instance = gaiaFrameworkDataChannel_FindSessionInstance(cfm->session_id);
+    if (instance == NULL || !instance->stream_source_requested || cfm->sequence != instance->stream_sequence)
+    {
+        /* The session has been deleted or the stream restarted in the meantime. */
+        DEBUG_LOG_WARN("GaiaFW DataTransfer: STREAM_CFM not expected, Session ID: 0x%04X, Sequence:%u", cfm->session_id, cfm->sequence);
+        if (cfm->source != NULL)
+        {
+            SourceClose(cfm->source);
+        }
+        return FALSE;
+    }
+
+    instance->stream_source_requested = FALSE;
+
+    if (cfm->status == data_transfer_status_success && cfm->source != NULL)
+    {
+        DEBUG_LOG_DEBUG("GaiaFW DataTransfer: STREAM_CFM OK, Session ID: 0x%04X", cfm->session_id);
+        instance->stream_source = cfm->source;
+        gaiaFrameworkDataChannel_StreamData(instance);
+        return TRUE;
+    }
+
+    if (cfm->status == data_transfer_no_more_data)
+    {
+        uint8 rsp_payload[GAIA_DATA_TRANSFER_GET_RSP_HEADER_SIZE];
+
+        /* Nothing to stream from the offset: send the Response without data bytes. */
+        rsp_payload[0] = (uint8) ((cfm->session_id & 0xFF00) >> 8);
+        rsp_payload[1] = (uint8)  (cfm->session_id & 0x00FF);
+        GaiaFramework_SendResponse(instance->transport, GAIA_CORE_FEATURE_ID, data_transfer_get, sizeof(rsp_payload), rsp_payload);
+    }
+    else
+    {
+        DEBUG_LOG_ERROR("GaiaFW DataTransfer: ERROR! STREAM_CFM->status:%d", cfm->status);
+        GaiaFramework_SendError(instance->transport, GAIA_CORE_FEATURE_ID, data_transfer_get,
+                                gaiaFrameworkDataChannel_GetGaiaStatusFromDataTransferStatus(cfm->status));
+    }
+
+    gaiaFrameworkDataChannel_StopStream(instance);
+    return FALSE;
+}
+
+
 Task GaiaFramework_GetDataTransferHandler(gaia_data_transfer_session_id_t session_id)
 {
     session_instance_t *instance = session_instance_linked_list;
@@ -543,6 +808,7 @@ bool GaiaFramework_DataTransferSetup(GAIA_TRANSPORT *t, uint16 payload_length, c
     }
     else
     {
+        gaiaFrameworkDataChannel_StopStream(instance);
         instance->transport_type = transport_type;
 
         switch (transport_type)
@@ -555,6 +821,21 @@ bool GaiaFramework_DataTransferSetup(GAIA_TRANSPORT *t, uint16 payload_length, c
                 result = TRUE;
                 break;
 
+            case transport_gaia_command_response_streaming:
+                /* Uses the existing Gaia link too, but the Responses can only be
+                 * streamed if the transport tells how much it can send. */
+                if (gaiaFrameworkDataChannel_IsStreamingSupported(t))
+                {
+                    gaiaFrameworkDataChannel_SendDataTransferSetupResponse(session_id);
+                    result = TRUE;
+                }
+                else
+                {
+                    DEBUG_LOG_WARN("GaiaFramework_DataTransferSetup: Streaming not supported by the transport");
+                    GaiaFramework_SendError(t, GAIA_CORE_FEATURE_ID, data_transfer_setup, GAIA_STATUS_INVALID_PARAMETER);
+                }
+                break;
+
             default:
                 DEBUG_LOG_WARN("GaiaFramework_DataTransferSetup: Invalid transport type:%d", transport_type);
                 GaiaFramework_SendError(t, GAIA_CORE_FEATURE_ID, data_transfer_setup, GAIA_STATUS_INVALID_PARAMETER);
@@ -581,6 +862,14 @@ bool GaiaFramework_DataTransferGet(GAIA_TRANSPORT *t, uint16 payload_length, con
     {
         GaiaFramework_SendError(t, GAIA_CORE_FEATURE_ID, data_transfer_get, GAIA_STATUS_INVALID_PARAMETER);
     }
+    else if (instance->transport_type == transport_gaia_command_response_streaming)
+    {
+        uint32 starting_offset = (uint32)payload[2] << 24 | (uint32)payload[3] << 16 | (uint32)payload[4] << 8 | (uint32)payload[5];
+        uint32 requested_size = (uint32)payload[6] << 24 | (uint32)payload[7] << 16 | (uint32)payload[8] << 8 | (uint32)payload[9];
+
+        gaiaFrameworkDataChannel_HandleStreamGet(instance, starting_offset, requested_size);
+        result = TRUE;
+    }
     else
     {
         /* Forward the 'Data Transfer Get' request to the registered Feature's data handler. */
@@ -676,6 +965,43 @@ void GaiaFramework_DataTransferInternalMessageHandler(Task task, MessageId id, M
             gaiaFrameworkDataChannel_HandleGaiaDataTransferSetRsp((GAIA_DATA_TRANSFER_INTERNAL_SET_RSP_T*) message);
             break;
 
+        case GAIA_DATA_TRANSFER_INTERNAL_STREAM_CFM:
+            gaiaFrameworkDataChannel_HandleGaiaDataTransferStreamCfm((GAIA_DATA_TRANSFER_INTERNAL_STREAM_CFM_T*) message);
+            break;
+
+        case GAIA_DATA_TRANSFER_INTERNAL_STREAM_CONTINUE:
+            {
+                const GAIA_DATA_TRANSFER_INTERNAL_STREAM_CONTINUE_T *ind = (const GAIA_DATA_TRANSFER_INTERNAL_STREAM_CONTINUE_T*) message;
+                session_instance_t *instance = gaiaFrameworkDataChannel_FindSessionInstance(ind->session_id);
+
+                if (instance != NULL)
+                {
+                    gaiaFrameworkDataChannel_StreamData(instance);
+                }
+            }
+            break;
+
+        case GAIA_DATA_TRANSFER_INTERNAL_UNKNOWN_RESPONSE:
+            {
+                const GAIA_DATA_TRANSFER_INTERNAL_UNKNOWN_RESPONSE_T *rsp = (const GAIA_DATA_TRANSFER_INTERNAL_UNKNOWN_RESPONSE_T*) message;
+                session_instance_t *instance = gaiaFrameworkDataChannel_GetFirstSessionInstance();
+
+                DEBUG_LOG_WARN("GaiaFW DataTransfer: Internal Msg Handler, Feature does not support MESSAGE:gaia_data_ch_internal_messages:0x%04X",
+                               rsp->unknown_message_id);
+
+                /* A Feature that cannot stream fails any stream waiting for its source. */
+                while (rsp->unknown_message_id == GAIA_DATA_TRANSFER_INTERNAL_STREAM_REQ && instance != NULL)
+                {
+                    if (instance->stream_source_requested)
+                    {
+                        GaiaFramework_SendError(instance->transport, GAIA_CORE_FEATURE_ID, data_transfer_get, GAIA_STATUS_INCORRECT_STATE);
+                        gaiaFrameworkDataChannel_StopStream(instance);
+                    }
+                    instance = instance->next;
+                }
+            }
+            break;
+
         default:
             DEBUG_LOG_ERROR("GaiaFW DataTransfer: Internal Msg Handler, UNHANDLED Msg MESSAGE:gaia_data_ch_internal_messages:0x%04X",
                             id);
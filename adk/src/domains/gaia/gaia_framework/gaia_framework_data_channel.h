@@ -72,6 +72,8 @@ typedef enum
     transport_gatt,
     /*! Reriable Write Command Protocol (RWCP) over GATT (BLE) is selected. */
     transport_gatt_rwcp,
+    /*! Existing Gaia link, with 'Data Transfer Get' Responses streamed back to back. */
+    transport_gaia_command_response_streaming,
 
     /*! Total number of transports */
     number_of_core_transport,
@@ -123,6 +125,9 @@ enum gaia_data_ch_internal_messages
     GAIA_DATA_TRANSFER_INTERNAL_GET_RSP,
     GAIA_DATA_TRANSFER_INTERNAL_SET_REQ,
     GAIA_DATA_TRANSFER_INTERNAL_SET_RSP,
+    GAIA_DATA_TRANSFER_INTERNAL_STREAM_REQ,
+    GAIA_DATA_TRANSFER_INTERNAL_STREAM_CFM,
+    GAIA_DATA_TRANSFER_INTERNAL_STREAM_CONTINUE,
     GAIA_DATA_TRANSFER_INTERNAL_TOP
 };
 
@@ -205,6 +210,29 @@ typedef struct
     gaia_data_transfer_session_id_t     session_id;         /*!< A 16-bit ID that represents a data transfer session. */
 } GAIA_DATA_TRANSFER_INTERNAL_SET_RSP_T;
 
+/*! Internal request to open a source that streams the data bytes from the 'offset'. */
+typedef struct
+{
+    gaia_data_transfer_session_id_t     session_id;         /*!< A 16-bit ID that represents a data transfer session. */
+    uint16                              sequence;           /*!< Identifies this request, must be copied into the confirmation. */
+    uint32                              starting_offset;    /*!< The position of the data bytes that the source must start from. */
+} GAIA_DATA_TRANSFER_INTERNAL_STREAM_REQ_T;
+
+/*! Internal confirmation to 'Stream' request. */
+typedef struct
+{
+    data_transfer_status_code_t         status;             /*!< Status that tells whether the source has been opened or not. */
+    gaia_data_transfer_session_id_t     session_id;         /*!< A 16-bit ID that represents a data transfer session. */
+    uint16                              sequence;           /*!< The 'sequence' of the request being confirmed. */
+    Source                              source;             /*!< The source of the data bytes, owned by Gaia Framework until the stream ends. */
+} GAIA_DATA_TRANSFER_INTERNAL_STREAM_CFM_T;
+
+/*! Internal message to carry on streaming data bytes once the transport has space. */
+typedef struct
+{
+    gaia_data_transfer_session_id_t     session_id;         /*!< A 16-bit ID that represents a data transfer session. */
+} GAIA_DATA_TRANSFER_INTERNAL_STREAM_CONTINUE_T;
+
 /*! Macro for creating messages */
 #define MAKE_GAIA_DATA_TRANSFER_MESSAGE(TYPE) TYPE##_T *message = PanicUnlessNew(TYPE##_T);
 #define MAKE_GAIA_DATA_TRANSFER_MESSAGE_WITH_LEN(TYPE, LEN) TYPE##_T *message = (TYPE##_T *) PanicUnlessMalloc(sizeof(TYPE##_T) + LEN - 1);
@@ -326,7 +354,16 @@ bool GaiaFramework_DataTransferSetup(GAIA_TRANSPORT *t, uint16 payload_length, c
     +--------+--------+--------+--------+--------+--------+--------+--------+--------+--------+
 
     Notes:
-        This function is applicable only if the transprot type is 'transport_gaia_command_response'.
+        This function is applicable only if the transprot type is either
+        'transport_gaia_command_response' or 'transport_gaia_command_response_streaming'.
+
+        With 'transport_gaia_command_response_streaming' the Requested Size is a credit
+        rather than the size of a single Response. The Feature is asked once for a source
+        of the data bytes, and the data bytes are sent as back to back Responses as long
+        as there is credit and space in the transport. Another Get command with the
+        Starting Offset following the data already requested adds credit to the stream
+        without restarting it, so the mobile app can pipeline the requests. A Response
+        without data bytes marks the end of the data.
 */
 bool GaiaFramework_DataTransferGet(GAIA_TRANSPORT *t, uint16 payload_length, const uint8 *payload);
 
@@ -9,11 +9,15 @@ Copyright (c) 2011 - 2020 Qualcomm Technologies International, Ltd.
 #include "gaia_framework_internal.h"
 #include "gatt_handler_db_if.h"
 #include "gatt_connect.h"
+#include "gaia_framework_command.h"
 
+#include <connection_manager.h>
+#include <gaia_features.h>
 #include <pmalloc.h>
 #include <source.h>
 #include <sink.h>
 #include <stream.h>
+#include <vm.h>
 #include <panic.h>
 #include <gatt.h>
 #include <gatt_manager.h>
@@ -23,6 +27,16 @@ Copyright (c) 2011 - 2020 Qualcomm Technologies International, Ltd.
 
 #define GAIA_TRANSPORT_GATT_DEFAULT_PROTOCOL_VERSION  (3)
 
+/* Link demand while bulk data, such as RWCP, is arriving on the data endpoint */
+#define GAIA_TRANSPORT_GATT_BULK_THROUGHPUT         (8000)
+#define GAIA_TRANSPORT_GATT_BULK_IDLE_TIMEOUT_MS    (1000)
+
+/* Link demand while DFU commands are arriving on the command endpoint.
+   Each command waits for its response, so latency matters more than throughput */
+#define GAIA_TRANSPORT_GATT_DFU_THROUGHPUT          (2000)
+#define GAIA_TRANSPORT_GATT_DFU_LATENCY_MS          (15)
+#define GAIA_TRANSPORT_GATT_DFU_IDLE_TIMEOUT_MS     (2000)
+
 /* Transport specific data */
 typedef struct
 {
@@ -67,6 +81,24 @@ typedef struct
 
 static void gaiaTransport_GattHandleMessage(Task task, MessageId id, Message message);
 
+/* Clients identifying the link demands placed by the transport */
+static TaskData gaiaTransport_GattBulkDemandTask;
+static TaskData gaiaTransport_GattDfuDemandTask;
+
+static const cm_link_demand_t gaiaTransport_GattBulkDemand =
+{
+    .throughput = GAIA_TRANSPORT_GATT_BULK_THROUGHPUT,
+    .latency_ms = 0,
+    .idle_timeout_ms = GAIA_TRANSPORT_GATT_BULK_IDLE_TIMEOUT_MS
+};
+
+static const cm_link_demand_t gaiaTransport_GattDfuDemand =
+{
+    .throughput = GAIA_TRANSPORT_GATT_DFU_THROUGHPUT,
+    .latency_ms = GAIA_TRANSPORT_GATT_DFU_LATENCY_MS,
+    .idle_timeout_ms = GAIA_TRANSPORT_GATT_DFU_IDLE_TIMEOUT_MS
+};
+
 
 /*************************************************************************
 NAME
@@ -303,6 +335,31 @@ static bool gaiaTransport_GattSendDataPacket(gaia_transport *t, uint16 vendor_id
 }
 
 
+/*! @brief Request or refresh a link demand on the LE link of the transport
+ */
+static void gaiaTransport_GattRequestDemand(gaia_transport_gatt_t *tg, Task client, const cm_link_demand_t *demand)
+{
+    tp_bdaddr tpaddr;
+
+    if (VmGetBdAddrtFromCid(tg->cid, &tpaddr) && tpaddr.transport == TRANSPORT_BLE_ACL)
+        ConManagerRequestDeviceDemand(&tpaddr, client, demand);
+}
+
+
+/*! @brief Release the link demands placed by the transport
+ */
+static void gaiaTransport_GattReleaseDemands(gaia_transport_gatt_t *tg)
+{
+    tp_bdaddr tpaddr;
+
+    if (VmGetBdAddrtFromCid(tg->cid, &tpaddr) && tpaddr.transport == TRANSPORT_BLE_ACL)
+    {
+        ConManagerReleaseDeviceDemand(&tpaddr, &gaiaTransport_GattBulkDemandTask);
+        ConManagerReleaseDeviceDemand(&tpaddr, &gaiaTransport_GattDfuDemandTask);
+    }
+}
+
+
 static void gaiaTransport_GattReceivePacket(gaia_transport_gatt_t *tg, uint16 data_length, const uint8 *data_buf, gaia_data_endpoint_mode_t mode)
 {
     if (data_length >= GAIA_GATT_HEADER_SIZE)
@@ -320,6 +377,10 @@ static void gaiaTransport_GattReceivePacket(gaia_transport_gatt_t *tg, uint16 da
                           vendor_id, command_id, payload_size, payload);
         DEBUG_LOG_DATA_V_VERBOSE(payload, payload_size);
 
+        /* Keep the link responsive while a DFU is transferring the image */
+        if (vendor_id == GAIA_V3_VENDOR_ID && gaiaFrameworkCommand_GetFeatureID(command_id) == GAIA_DFU_FEATURE_ID)
+            gaiaTransport_GattRequestDemand(tg, &gaiaTransport_GattDfuDemandTask, &gaiaTransport_GattDfuDemand);
+
         /* Prepare response, which is copy of header with additional status byte */
         tg->size_response = GAIA_GATT_HEADER_SIZE + GAIA_GATT_RESPONSE_STATUS_SIZE;;
         memcpy(tg->response, data_buf, GAIA_GATT_HEADER_SIZE);
@@ -351,6 +412,7 @@ static void gaiaTransport_GattReceiveDataPacket(gaia_transport_gatt_t *tg, uint1
     switch (tg->data_endpoint_mode)
     {
         case GAIA_DATA_ENDPOINT_MODE_RWCP:
+            gaiaTransport_GattRequestDemand(tg, &gaiaTransport_GattBulkDemandTask, &gaiaTransport_GattBulkDemand);
             RwcpServerHandleMessage(data_buf, data_length);
             break;
 
@@ -695,6 +757,7 @@ static void gaiaTransport_GattDisconnect(uint16 cid)
         {
             DEBUG_LOG("gaiaTransport_GattDisconnect, found transport for CID %u", cid);
 
+            gaiaTransport_GattReleaseDemands(tg);
             gaiaTransport_GattDestroyAttStream(tg);
 
             tg->cid = 0;
@@ -394,6 +394,10 @@ static bool gaiaTransport_RfcommGetInfo(gaia_transport *t, gaia_transport_info_k
             *value = tr->protocol_version;
             break;
 
+        case GAIA_TRANSPORT_TX_AVAILABLE_SPACE:
+            *value = TransportMgrGetAvailableSpace(transport_mgr_type_rfcomm, tr->channel);
+            break;
+
         default:
             return FALSE;
     }
@@ -222,6 +222,10 @@ static bool gaiaTransport_TestGetInfo(gaia_transport *t, gaia_transport_info_key
             *value = tt->protocol_version;
             break;
 
+        case GAIA_TRANSPORT_TX_AVAILABLE_SPACE:
+            *value = SinkSlack(tt->pipe_host);
+            break;
+
         default:
             return FALSE;
     }
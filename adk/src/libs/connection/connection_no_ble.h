@@ -5729,8 +5729,10 @@ void ConnectionSmSendKeypressNotificationRequest(
     VM Connection Library data key Attribute base  + index of the device
     in the trusted device list
 
+    @return TRUE if the data was written, FALSE if the device is not in the
+    trusted device list or the persistent store could not be written.
 */
-void ConnectionSmPutAttributeReq(
+bool ConnectionSmPutAttributeReq(
         uint16 ps_base,
         uint8 addr_type,
         const bdaddr* bd_addr,
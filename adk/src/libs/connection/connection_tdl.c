@@ -1766,8 +1766,9 @@ FUNCTION
     the specified base + the index of the specified device in TDL.
 
 RETURNS
+    TRUE if the data was stored, FALSE otherwise.
 */
-void connectionAuthPutAttribute(
+bool connectionAuthPutAttribute(
         uint16          ps_base,
         uint8           addr_type,
         const bdaddr*   bd_addr,
@@ -1777,14 +1778,17 @@ void connectionAuthPutAttribute(
 {
     uint16 pos; /* TRUSTED_DEVICE_LIST + pos */
     td_data_t *td = tdl_find_device(addr_type, bd_addr, &pos, NULL);
+    bool stored = FALSE;
 
     UNUSED(ps_base);
 
     if (td != NULL)
     {
-        PsStore(PSKEY_TDL_ATTRIBUTE_BASE + pos, psdata, PS_SIZE_ADJ(size_psdata));
+        stored = (PsStore(PSKEY_TDL_ATTRIBUTE_BASE + pos, psdata, PS_SIZE_ADJ(size_psdata)) != 0);
         free(td);
     }
+
+    return stored;
 }
 
 
@@ -188,8 +188,9 @@ FUNCTION
     the specified base + the index of the specified device in TDL.
 
 RETURNS
+    TRUE if the data was stored, FALSE otherwise.
 */
-void connectionAuthPutAttribute(
+bool connectionAuthPutAttribute(
             uint16          ps_base,
             uint8           bd_addr_type,
             const bdaddr*   bd_addr,
@@ -26,7 +26,7 @@ NOTES
 
 
 /*****************************************************************************/
-void ConnectionSmPutAttributeReq(
+bool ConnectionSmPutAttributeReq(
         uint16 ps_base, 
         uint8 addr_type,
         const bdaddr* bd_addr, 
@@ -34,7 +34,7 @@ void ConnectionSmPutAttributeReq(
         const uint8* psdata
         )
 {
-    connectionAuthPutAttribute(
+    return connectionAuthPutAttribute(
             ps_base, 
             addr_type, 
             bd_addr, 
@@ -22,6 +22,16 @@ struct device_tag
     key_value_list_t properties;
 };
 
+static device_property_changed_callback_t device_property_changed_callback;
+
+static void device_NotifyPropertyChanged(device_t device, device_property_t id, const void *value, size_t size)
+{
+    if (device_property_changed_callback)
+    {
+        device_property_changed_callback(device, id, value, size);
+    }
+}
+
 static bool device_UpdatePropertyIfExistingHelper(device_t device, device_property_t id, uint32 value, size_t size)
 {
     bool was_set = TRUE;
@@ -34,6 +44,7 @@ static bool device_UpdatePropertyIfExistingHelper(device_t device, device_proper
             Panic();
         }
     }
+    device_NotifyPropertyChanged(device, id, &value, size);
     return was_set;
 }
 
@@ -69,6 +80,7 @@ void Device_RemoveProperty(device_t device, device_property_t id)
 {
     PanicNull(device);
     KeyValueList_Remove(device->properties, id);
+    device_NotifyPropertyChanged(device, id, NULL, 0);
 }
 
 bool Device_SetProperty(device_t device, device_property_t id, const void *value, size_t size)
@@ -79,6 +91,7 @@ bool Device_SetProperty(device_t device, device_property_t id, const void *value
         Device_RemoveProperty(device, id);
         PanicFalse(KeyValueList_Add(device->properties, id, value, size));
     }
+    device_NotifyPropertyChanged(device, id, value, size);
     return TRUE;
 }
 
@@ -91,7 +104,12 @@ bool Device_GetProperty(device_t device, device_property_t id, void **value, siz
 bool Device_SetPropertyPtr(device_t device, device_property_t id, const void *value)
 {
     PanicNull(device);
-    return KeyValueList_Add(device->properties, id, &value, sizeof(value));
+    if (!KeyValueList_Add(device->properties, id, &value, sizeof(value)))
+    {
+        return FALSE;
+    }
+    device_NotifyPropertyChanged(device, id, &value, sizeof(value));
+    return TRUE;
 }
 
 void *Device_GetPropertyPtr(device_t device, device_property_t id)
@@ -172,3 +190,8 @@ bool Device_GetPropertyU8(device_t device, device_property_t id, uint8 *value)
 
     return found;
 }
+
+void Device_RegisterPropertyChangedCallback(device_property_changed_callback_t callback)
+{
+    device_property_changed_callback = callback;
+}
@@ -191,4 +191,22 @@ bool Device_SetPropertyU8(device_t device, device_property_t id, uint8 value);
 */
 bool Device_GetPropertyU8(device_t device, device_property_t id, uint8 *value);
 
+/*! \brief Callback invoked whenever a device property is set or removed.
+
+    \param device Device whose property changed.
+    \param id Property that changed.
+    \param value Pointer to the new property data, or NULL if it was removed.
+    \param size Size of the new property data in bytes, or 0 if it was removed.
+*/
+typedef void (*device_property_changed_callback_t)(device_t device, device_property_t id, const void *value, size_t size);
+
+/*! \brief Register a callback for property changes on all devices.
+
+    Only one callback is supported; it is used by the device list to keep its
+    property indexes up to date.
+
+    \param callback The callback, or NULL to remove it.
+*/
+void Device_RegisterPropertyChangedCallback(device_property_changed_callback_t callback);
+
 #endif // DEVICE_H_
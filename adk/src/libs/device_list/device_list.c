@@ -12,17 +12,148 @@
 #include <device_list.h>
 #include <panic.h>
 
+/*! A hash of the property value of each device slot, so that lookups by a
+    hot property compare small integers instead of walking the property list
+    of every device. A hash of zero means the property is not set. */
+typedef struct
+{
+    device_property_t id;
+    uint16 *hashes;
+} device_list_index_t;
+
 static device_t *device_list = NULL;
 static uint8 trusted_device_list = 0;
 
+static device_list_index_t device_list_indexes[DEVICE_LIST_MAX_PROPERTY_INDEXES];
+static unsigned device_list_num_indexes = 0;
+
+static uint16 deviceList_HashValue(const void *value, size_t size)
+{
+    const uint8 *data = value;
+    uint32 hash = 2166136261UL;
+    size_t i;
+
+    for (i = 0; i < size; i++)
+    {
+        hash = (hash ^ data[i]) * 16777619UL;
+    }
+    hash = (hash >> 16) ^ (hash & 0xFFFF);
+
+    /* Zero is reserved for an unset property */
+    return hash ? (uint16)hash : 1;
+}
+
+static device_list_index_t *deviceList_GetIndex(device_property_t id)
+{
+    unsigned i;
+
+    for (i = 0; i < device_list_num_indexes; i++)
+    {
+        if (device_list_indexes[i].id == id)
+        {
+            return &device_list_indexes[i];
+        }
+    }
+    return NULL;
+}
+
+static int deviceList_GetSlot(device_t device)
+{
+    int i;
+
+    for (i = 0; i < trusted_device_list; i++)
+    {
+        if (device_list[i] == device)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void deviceList_IndexSlot(device_list_index_t *index, int slot)
+{
+    void *property;
+    size_t property_size;
+
+    index->hashes[slot] = 0;
+    if (device_list[slot] && Device_GetProperty(device_list[slot], index->id, &property, &property_size))
+    {
+        index->hashes[slot] = deviceList_HashValue(property, property_size);
+    }
+}
+
+static void deviceList_IndexAllSlots(int slot)
+{
+    unsigned i;
+
+    for (i = 0; i < device_list_num_indexes; i++)
+    {
+        deviceList_IndexSlot(&device_list_indexes[i], slot);
+    }
+}
+
+static void deviceList_AllocateIndex(device_list_index_t *index)
+{
+    int i;
+
+    index->hashes = (uint16 *)PanicUnlessMalloc(trusted_device_list * sizeof(uint16));
+    for (i = 0; i < trusted_device_list; i++)
+    {
+        deviceList_IndexSlot(index, i);
+    }
+}
+
+static void deviceList_PropertyChanged(device_t device, device_property_t id, const void *value, size_t size)
+{
+    device_list_index_t *index = deviceList_GetIndex(id);
+
+    if (index && index->hashes)
+    {
+        int slot = deviceList_GetSlot(device);
+        if (slot >= 0)
+        {
+            index->hashes[slot] = value ? deviceList_HashValue(value, size) : 0;
+        }
+    }
+}
+
 void DeviceList_Init(uint8 num_devices)
 {
+    unsigned i;
+
     PanicNotZero(device_list);
 
     trusted_device_list = num_devices;
 
     device_list = (device_t *)PanicUnlessMalloc(trusted_device_list * sizeof(device_t));
     memset(device_list, 0, (trusted_device_list * sizeof(device_t)));
+
+    for (i = 0; i < device_list_num_indexes; i++)
+    {
+        deviceList_AllocateIndex(&device_list_indexes[i]);
+    }
+    Device_RegisterPropertyChangedCallback(deviceList_PropertyChanged);
+}
+
+void DeviceList_AddPropertyIndex(device_property_t id)
+{
+    device_list_index_t *index;
+
+    if (deviceList_GetIndex(id))
+    {
+        return;
+    }
+    PanicFalse(device_list_num_indexes < DEVICE_LIST_MAX_PROPERTY_INDEXES);
+
+    index = &device_list_indexes[device_list_num_indexes++];
+    index->id = id;
+    index->hashes = NULL;
+
+    if (device_list)
+    {
+        deviceList_AllocateIndex(index);
+    }
 }
 
 unsigned DeviceList_GetNumOfDevices(void)
@@ -53,6 +184,12 @@ void DeviceList_RemoveAllDevices(void)
     }
     free(device_list);
     device_list = NULL;
+
+    for (i = 0; i < device_list_num_indexes; i++)
+    {
+        free(device_list_indexes[i].hashes);
+        device_list_indexes[i].hashes = NULL;
+    }
 }
 
 bool DeviceList_AddDevice(device_t device)
@@ -65,6 +202,7 @@ bool DeviceList_AddDevice(device_t device)
         if (device_list[i] == 0)
         {
             device_list[i] = device;
+            deviceList_IndexAllSlots(i);
             added = TRUE;
             break;
         }
@@ -87,6 +225,7 @@ void DeviceList_RemoveDevice(device_t device)
         if (device_list[i] == device)
         {
             device_list[i] = 0;
+            deviceList_IndexAllSlots(i);
             /* Should the device be destroyed by this function? */
             break;
         }
@@ -97,9 +236,17 @@ static void deviceList_FindMatchingDevices(device_property_t id, const void *val
 {
     int i;
     unsigned num_found_devices = 0;
+    device_list_index_t *index = deviceList_GetIndex(id);
+    uint16 hash = index ? deviceList_HashValue(value, size) : 0;
 
     for (i = 0; i < trusted_device_list; i++)
     {
+        /* With an index only devices whose value hashes the same need to be compared */
+        if (index && index->hashes[i] != hash)
+        {
+            continue;
+        }
+
         if (device_list[i])
         {
             void *property;
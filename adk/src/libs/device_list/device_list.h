@@ -10,6 +10,11 @@
 
 #include <device.h>
 
+/*! The maximum number of properties that can be indexed. */
+#ifndef DEVICE_LIST_MAX_PROPERTY_INDEXES
+#define DEVICE_LIST_MAX_PROPERTY_INDEXES 4
+#endif
+
 /*! \brief Defines a type for the action function pointer to use with the
            DeviceList_Iterate API.*/
 typedef void (*device_list_iterate_callback_t)(device_t device, void *data);
@@ -20,6 +25,17 @@ typedef void (*device_list_iterate_callback_t)(device_t device, void *data);
 */
 void DeviceList_Init(uint8 num_devices);
 
+/*! \brief Index a property to speed up lookups by its value.
+
+    Lookups by an indexed property, such as the BD address or device type,
+    compare a hash of the value kept for each device instead of reading the
+    property of every device. The index is kept up to date as properties are
+    set and removed.
+
+    \param id The property to index.
+*/
+void DeviceList_AddPropertyIndex(device_property_t id);
+
 /*! \brief Get the number of devices in the list.
 
     \return The number of devices currently in the list.
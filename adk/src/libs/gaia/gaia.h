@@ -328,6 +328,7 @@ typedef enum
     GAIA_TRANSPORT_TX_FLOW_CONTROL,
     GAIA_TRANSPORT_RX_FLOW_CONTROL,
     GAIA_TRANSPORT_PROTOCOL_VERSION,
+    GAIA_TRANSPORT_TX_AVAILABLE_SPACE,   /*!< Octets that can be sent now without overflowing the transmit buffer */
 } gaia_transport_info_key_t;
 
 
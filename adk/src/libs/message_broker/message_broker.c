@@ -12,6 +12,9 @@
 #include "message_broker.h"
 
 #include <panic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vm.h>
 #include <vmtypes.h>
 
 #ifndef MESSAGE_BROKER_DEBUG_LIB
@@ -19,6 +22,18 @@
 #endif
 #include <logging.h>
 
+/*! Statistics for one message group, created when a state message is first
+    sent to the group. */
+typedef struct message_broker_group_stats_entry
+{
+    struct message_broker_group_stats_entry *next;
+    message_group_t group;
+    message_broker_group_stats_t stats;
+
+    /*! The time the last state message was sent to the group. */
+    uint32 last_sent_ms;
+} message_broker_group_stats_entry_t;
+
 /*! Message broker internal state */
 typedef struct
 {
@@ -27,16 +42,85 @@ typedef struct
 
     /*! The number of registrations in the array. */
     unsigned registrations_len;
+
+    /*! Registrations indexed by message group, built in MessageBroker_Init so
+        that registering interest does not scan every registration. */
+    const message_broker_group_registration_t **registration_by_group;
+
+    /*! The number of entries in registration_by_group. */
+    unsigned registration_by_group_len;
+
+    /*! Statistics for the groups that have been sent state messages. */
+    message_broker_group_stats_entry_t *group_stats;
 } message_broker_state_t;
 
 static message_broker_state_t message_broker_state;
 
+static const message_broker_group_registration_t *messageBroker_GetRegistration(message_group_t group)
+{
+    if (group < message_broker_state.registration_by_group_len)
+    {
+        return message_broker_state.registration_by_group[group];
+    }
+    return NULL;
+}
+
+static message_broker_group_stats_entry_t *messageBroker_GetGroupStatsEntry(message_group_t group, bool create)
+{
+    message_broker_group_stats_entry_t *entry;
+
+    for (entry = message_broker_state.group_stats; entry != NULL; entry = entry->next)
+    {
+        if (entry->group == group)
+        {
+            return entry;
+        }
+    }
+
+    if (create)
+    {
+        entry = PanicUnlessMalloc(sizeof(*entry));
+        memset(entry, 0, sizeof(*entry));
+        entry->group = group;
+        entry->next = message_broker_state.group_stats;
+        message_broker_state.group_stats = entry;
+    }
+    return entry;
+}
 
 void MessageBroker_Init(const message_broker_group_registration_t *registrations,
                         unsigned registrations_len)
 {
+    const message_broker_group_registration_t *registration;
+    unsigned len = 0;
+
     message_broker_state.registrations = registrations;
     message_broker_state.registrations_len = registrations_len;
+
+    for (registration = registrations; registration < (registrations + registrations_len); registration++)
+    {
+        len = MAX(len, (unsigned)registration->message_group + 1);
+    }
+
+    free(message_broker_state.registration_by_group);
+    message_broker_state.registration_by_group = NULL;
+    message_broker_state.registration_by_group_len = len;
+
+    if (len)
+    {
+        message_broker_state.registration_by_group = PanicUnlessMalloc(len * sizeof(*message_broker_state.registration_by_group));
+        memset(message_broker_state.registration_by_group, 0, len * sizeof(*message_broker_state.registration_by_group));
+
+        for (registration = registrations; registration < (registrations + registrations_len); registration++)
+        {
+            if (message_broker_state.registration_by_group[registration->message_group])
+            {
+                DEBUG_LOG("MessageBroker_Init, duplicate registration for group=%d", registration->message_group);
+                Panic();
+            }
+            message_broker_state.registration_by_group[registration->message_group] = registration;
+        }
+    }
 }
 
 void MessageBroker_RegisterInterestInMsgGroups(Task task, const message_group_t *msg_groups, unsigned num_groups)
@@ -52,28 +136,92 @@ void MessageBroker_RegisterInterestInMsgGroups(Task task, const message_group_t
     for (msg_group_index = 0; msg_group_index < num_groups; msg_group_index++)
     {
         message_group_t group = msg_groups[msg_group_index];
-        bool registered = FALSE;
 
-        for (registration = message_broker_state.registrations;
-             registration < (message_broker_state.registrations + message_broker_state.registrations_len);
-             registration++)
+        registration = messageBroker_GetRegistration(group);
+        if (registration == NULL)
         {
-            if (group == registration->message_group)
-            {
-                registration->MessageGroupRegister(task, group);
-                registered = TRUE;
-
-            }
+            DEBUG_LOG("MessageBroker_RegisterInterestInMsgGroups, failed to register for group=%d", group);
+            Panic();
         }
+        else
+        {
+            registration->MessageGroupRegister(task, group);
+            DEBUG_LOG("MessageBroker_RegisterInterestInMsgGroups: group = %d", group);
+        }
+    }
+}
+
+void MessageBroker_UnregisterInterestInMsgGroups(Task task, const message_group_t *msg_groups, unsigned num_groups)
+{
+    message_group_t msg_group_index;
+    const message_broker_group_registration_t *registration;
+
+    if (task == NULL || msg_groups == NULL)
+    {
+        Panic();
+    }
+
+    for (msg_group_index = 0; msg_group_index < num_groups; msg_group_index++)
+    {
+        message_group_t group = msg_groups[msg_group_index];
 
-        if (!registered)
+        registration = messageBroker_GetRegistration(group);
+        if (registration == NULL || registration->MessageGroupUnregister == NULL)
         {
-            DEBUG_LOG("MessageBroker_RegisterInterestInMsgGroups, failed to register for group=%d", group);
+            DEBUG_LOG("MessageBroker_UnregisterInterestInMsgGroups, cannot unregister from group=%d", group);
             Panic();
         }
         else
         {
-            DEBUG_LOG("MessageBroker_RegisterInterestInMsgGroups: group = %d", group);
+            registration->MessageGroupUnregister(task, group);
+            DEBUG_LOG("MessageBroker_UnregisterInterestInMsgGroups: group = %d", group);
         }
     }
 }
+
+void MessageBroker_SendStateMessage(message_group_t group, task_list_t *list, MessageId id, void *data, size_t size_data)
+{
+    message_broker_group_stats_entry_t *entry = messageBroker_GetGroupStatsEntry(group, TRUE);
+    uint32 now = VmGetClock();
+    Task next_task = NULL;
+    uint16 coalesced = 0;
+
+    PanicNull(list);
+
+    while (TaskList_Iterate(list, &next_task))
+    {
+        uint16 cancelled = MessageCancelAll(next_task, id);
+        uint16 queue_depth = MessagesPendingForTask(next_task, NULL);
+
+        coalesced += cancelled;
+        entry->stats.max_queue_depth = MAX(entry->stats.max_queue_depth, queue_depth);
+    }
+
+    if (coalesced)
+    {
+        /* The replaced message was at most as old as the previous send. */
+        entry->stats.coalesced += coalesced;
+        entry->stats.max_superseded_ms = MAX(entry->stats.max_superseded_ms, now - entry->last_sent_ms);
+        DEBUG_LOG("MessageBroker_SendStateMessage: group = %d, id = 0x%x, replaced %d", group, id, coalesced);
+    }
+
+    entry->stats.sent++;
+    entry->last_sent_ms = now;
+
+    TaskList_MessageSendWithSize(list, id, data, size_data);
+}
+
+bool MessageBroker_GetGroupStats(message_group_t group, message_broker_group_stats_t *stats)
+{
+    message_broker_group_stats_entry_t *entry = messageBroker_GetGroupStatsEntry(group, FALSE);
+
+    PanicNull(stats);
+
+    if (entry == NULL)
+    {
+        memset(stats, 0, sizeof(*stats));
+        return FALSE;
+    }
+    *stats = entry->stats;
+    return TRUE;
+}
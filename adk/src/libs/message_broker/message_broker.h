@@ -49,6 +49,8 @@
 #define MESSAGE_BROKER_H
 
 #include <csrtypes.h>
+#include <message.h>
+#include <task_list.h>
 
 /*! A type for message groups */
 typedef uint16 message_group_t;
@@ -86,5 +88,60 @@ void MessageBroker_Init(const message_broker_group_registration_t *registrations
 */
 void MessageBroker_RegisterInterestInMsgGroups(Task task, const message_group_t* msg_groups, unsigned num_groups);
 
+/*! \brief MessageBroker_UnregisterInterestInMsgGroups
+    \param task the client's message handler previously registered with MessageBroker_RegisterInterestInMsgGroups
+    \param msg_groups pointer to the array of message groups the client is no longer interested in
+    \param num_groups the number of message groups in the array
+*/
+void MessageBroker_UnregisterInterestInMsgGroups(Task task, const message_group_t* msg_groups, unsigned num_groups);
+
+/*! \brief Delivery statistics for state messages sent to a message group. */
+typedef struct
+{
+    /*! The number of state messages sent to the group's subscribers. */
+    uint32 sent;
+
+    /*! The number of queued messages replaced by a newer one before delivery. */
+    uint32 coalesced;
+
+    /*! The longest time in ms a replaced message had been waiting in a queue. */
+    uint32 max_superseded_ms;
+
+    /*! The most messages found queued ahead of a state message for one subscriber. */
+    uint16 max_queue_depth;
+
+} message_broker_group_stats_t;
+
+/*! \brief MessageBroker_SendStateMessage
+
+    Send a message carrying the latest value of some state to all tasks in a
+    message group owner's task list. Any copy of the same message still queued
+    for a task is cancelled first, so that a burst of updates results in only
+    the latest one being delivered and other messages are not delayed behind
+    the stale ones.
+
+    \param group the message group the message belongs to, used for statistics
+    \param list the group owner's list of subscribers
+    \param id the message ID
+    \param data pointer to the message content, may be NULL if size_data is zero
+    \param size_data the sizeof the message content
+*/
+void MessageBroker_SendStateMessage(message_group_t group, task_list_t *list, MessageId id, void *data, size_t size_data);
+
+/*! \brief Send a state message with data, see MessageBroker_SendStateMessage.
+
+    \note Assumes id is of a form such that appending a _T to the id creates the
+    message structure type string.
+*/
+#define MessageBroker_SendState(group, list, id, message) \
+    MessageBroker_SendStateMessage(group, list, id, message, sizeof(id##_T))
+
+/*! \brief MessageBroker_GetGroupStats
+    \param group the message group
+    \param stats filled in with the statistics for the group
+    \return TRUE if any state messages have been sent to the group
+*/
+bool MessageBroker_GetGroupStats(message_group_t group, message_broker_group_stats_t *stats);
+
 #endif /* MESSAGE_BROKER_H */
 
@@ -15,16 +15,29 @@ DESCRIPTION
 #include <string.h>
 #include "rwcp_server.h"
 #include <gaia.h>
+#include <vmtypes.h>
+
+/* A DATA segment received ahead of the next expected sequence number */
+typedef struct
+{
+    uint8 *payload;          /* copy of the segment payload, NULL if the slot is empty */
+    uint16 size_payload;          /* size of the payload */
+} rwcp_segment_t;
 
 /* Service data type */
 typedef struct
 {
     rwcp_protocol_state protocol_state;          /* RWCP Server states */
     bool out_of_sequence_status;          /* temporarily mute GAP replies during congestion */
-    uint8 last_sequence_number;          /* last acknowledged sequence number */
+    uint16 last_sequence_number;          /* last acknowledged sequence number */
     uint8 rwcp_upgrade_header_size;          /*cumulative header size of GAIA and Upgrade headers */
     bool accept_segments;          /* flow control flag */
     Task client_task;          /*Client task*/
+    bool selective_repeat;          /* selective repeat negotiated with the client */
+    uint16 sequence_number_max;          /* size of the sequence number space */
+    uint16 receive_window;          /* size of the receive window */
+    rwcp_segment_t *segments;          /* out-of-order segments, indexed by sequence % receive_window */
+    rwcp_server_statistics_t statistics;          /* segment counters */
 } SERVER_DATA_T;
 
 /*
@@ -63,6 +76,23 @@ typedef enum
 #define RWCP_RECEIVE_WINDOW_MAX                         32
 #define RWCP_SEQUENCE_NUMBER_INVALID                0xFF
 
+/* Selective repeat is negotiated with an optional payload in the SYN segment,
+   holding the requested options and receive window. The SYN ACK segment echoes
+   the options and window granted by the server. With selective repeat, all
+   other segments have an extended header whose second octet holds the upper
+   bits of a 14-bit sequence number. */
+#define RWCP_SYN_OPTIONS_OFFSET                         1
+#define RWCP_SYN_WINDOW_OFFSET                          2
+#define RWCP_SYN_PAYLOAD_SIZE                           2
+#define RWCP_OPTION_SELECTIVE_REPEAT                    0x01
+#define RWCP_EXTENDED_HEADER_SIZE                       2
+#define RWCP_EXTENDED_SEQUENCE_SHIFT                    6
+#define RWCP_EXTENDED_SEQUENCE_NUMBER_MAX               (1 << 14)
+#ifndef RWCP_SELECTIVE_WINDOW_MAX
+#define RWCP_SELECTIVE_WINDOW_MAX                       128
+#endif
+#define RWCP_SACK_BITMAP_SIZE_MAX                       (RWCP_SELECTIVE_WINDOW_MAX / 8)
+
 #if defined(DEBUG_RWCP_SERVER)
 #define RWCP_SERVER_DEBUG(x)     printf x
 #else
@@ -86,14 +116,35 @@ static SERVER_DATA_T g_server_data;
  *      None.
  *
  *---------------------------------------------------------------------------*/
-static void rwcpSendNotification( uint8 sequence,
-                                  rwcp_server_commands_t command)
+static void rwcpSendNotificationWithPayload( uint16 sequence,
+                                             rwcp_server_commands_t command,
+                                             const uint8 *payload,
+                                             uint16 size_payload)
 {
+    uint8 notification[RWCP_EXTENDED_HEADER_SIZE + RWCP_SACK_BITMAP_SIZE_MAX];
+    uint16 size_header = RWCP_HEADER_SIZE;
+
     /* create the RWCP header */
-    uint8 rwcp_header = 0;
-    rwcp_header |= sequence & RWCP_SEQUENCE_MASK;
-    rwcp_header |= command & RWCP_COMMAND_MASK;
-    GaiaRwcpSendNotification(&rwcp_header, sizeof(rwcp_header));
+    notification[RWCP_HEADER_OFFSET] = (sequence & RWCP_SEQUENCE_MASK) |
+                                       (command & RWCP_COMMAND_MASK);
+    if ( g_server_data.selective_repeat && command != RWCP_SERVER_CMD_SYN_ACK )
+    {
+        notification[RWCP_HEADER_SIZE] = (uint8)(sequence >> RWCP_EXTENDED_SEQUENCE_SHIFT);
+        size_header = RWCP_EXTENDED_HEADER_SIZE;
+    }
+
+    PanicFalse(size_payload <= RWCP_SACK_BITMAP_SIZE_MAX);
+    if ( size_payload )
+    {
+        memcpy(&notification[size_header], payload, size_payload);
+    }
+    GaiaRwcpSendNotification(notification, size_header + size_payload);
+}
+
+static void rwcpSendNotification( uint16 sequence,
+                                  rwcp_server_commands_t command)
+{
+    rwcpSendNotificationWithPayload(sequence, command, NULL, 0);
 }
 
 /*----------------------------------------------------------------------------*
@@ -107,7 +158,7 @@ static void rwcpSendNotification( uint8 sequence,
  *      None.
  *
  *---------------------------------------------------------------------------*/
-static void rwcpDataAck( uint8 sequence )
+static void rwcpDataAck( uint16 sequence )
 {
     RWCP_SERVER_DEBUG(( "A%d\n", sequence ));
     rwcpSendNotification( sequence, RWCP_SERVER_CMD_DATA_ACK);
@@ -125,7 +176,7 @@ static void rwcpDataAck( uint8 sequence )
  *      None.
  *
  *---------------------------------------------------------------------------*/
-static void rwcpRstAck( uint8 sequence )
+static void rwcpRstAck( uint16 sequence )
 {
     RWCP_SERVER_DEBUG(("RA%d\n", sequence ));
     rwcpSendNotification( sequence, RWCP_SERVER_CMD_RST);
@@ -143,7 +194,7 @@ static void rwcpRstAck( uint8 sequence )
  *      None.
  *
  *---------------------------------------------------------------------------*/
-static void rwcpRst( uint8 sequence )
+static void rwcpRst( uint16 sequence )
 {
     RWCP_SERVER_DEBUG(( "R%d\n", sequence ));
     rwcpSendNotification( sequence, RWCP_SERVER_CMD_RST);
@@ -161,10 +212,20 @@ static void rwcpRst( uint8 sequence )
  *      None.
  *
  *---------------------------------------------------------------------------*/
-static void rwcpSynAck( uint8 sequence )
+static void rwcpSynAck( uint8 sequence, bool options_requested )
 {
     RWCP_SERVER_DEBUG(( "SA%d\n", sequence ));
-    rwcpSendNotification( sequence, RWCP_SERVER_CMD_SYN_ACK);
+    if ( options_requested )
+    {
+        uint8 granted[RWCP_SYN_PAYLOAD_SIZE];
+        granted[RWCP_SYN_OPTIONS_OFFSET - 1] = g_server_data.selective_repeat ? RWCP_OPTION_SELECTIVE_REPEAT : 0;
+        granted[RWCP_SYN_WINDOW_OFFSET - 1] = (uint8)MIN(g_server_data.receive_window, 0xFF);
+        rwcpSendNotificationWithPayload( sequence, RWCP_SERVER_CMD_SYN_ACK, granted, sizeof(granted));
+    }
+    else
+    {
+        rwcpSendNotification( sequence, RWCP_SERVER_CMD_SYN_ACK);
+    }
 }
 
 
@@ -179,10 +240,126 @@ static void rwcpSynAck( uint8 sequence )
  *      None.
  *
  *---------------------------------------------------------------------------*/
-static void rwcpGap( uint8 sequence )
+static void rwcpGap( uint16 sequence )
 {
     RWCP_SERVER_DEBUG(( "G%d\n", sequence ));
     rwcpSendNotification( sequence, RWCP_SERVER_CMD_GAP);
+    g_server_data.statistics.gaps_sent++;
+}
+
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      rwcpSelectiveGap
+ *
+ *  DESCRIPTION
+ *      Send a GAP segment carrying the last in-sequence number and a bitmap
+ *      of the segments already buffered beyond it. Bit n of the bitmap is set
+ *      if segment (sequence + 1 + n) has been received, so the client only
+ *      needs to retransmit the missing segments.
+ *
+ *  RETURNS
+ *      None.
+ *
+ *---------------------------------------------------------------------------*/
+static void rwcpSelectiveGap( uint16 sequence )
+{
+    uint8 bitmap[RWCP_SACK_BITMAP_SIZE_MAX];
+    uint16 size_bitmap = 0;
+    uint16 offset;
+
+    memset(bitmap, 0, sizeof(bitmap));
+    for (offset = 0; offset < g_server_data.receive_window; offset++)
+    {
+        uint16 buffered = (sequence + 1 + offset) % g_server_data.sequence_number_max;
+        if (g_server_data.segments[buffered % g_server_data.receive_window].payload)
+        {
+            bitmap[offset / 8] |= (uint8)(1 << (offset % 8));
+            size_bitmap = (uint16)((offset / 8) + 1);
+        }
+    }
+
+    RWCP_SERVER_DEBUG(( "SG%d\n", sequence ));
+    rwcpSendNotificationWithPayload( sequence, RWCP_SERVER_CMD_GAP, bitmap, size_bitmap);
+    g_server_data.statistics.gaps_sent++;
+}
+
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      rwcpReleaseSegments
+ *
+ *  DESCRIPTION
+ *      Free the out-of-order segment buffer and revert to go-back-N.
+ *
+ *  RETURNS
+ *      None.
+ *
+ *---------------------------------------------------------------------------*/
+static void rwcpReleaseSegments(void)
+{
+    if (g_server_data.segments)
+    {
+        uint16 slot;
+        for (slot = 0; slot < g_server_data.receive_window; slot++)
+        {
+            free(g_server_data.segments[slot].payload);
+        }
+        free(g_server_data.segments);
+        g_server_data.segments = NULL;
+    }
+    g_server_data.selective_repeat = FALSE;
+    g_server_data.sequence_number_max = RWCP_SEQUENCE_NUMBER_MAX;
+    g_server_data.receive_window = RWCP_RECEIVE_WINDOW_MAX;
+}
+
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      rwcpNegotiate
+ *
+ *  DESCRIPTION
+ *      Apply the options requested in a SYN segment. Selective repeat is only
+ *      granted if memory for the out-of-order buffer can be allocated,
+ *      otherwise the server falls back to go-back-N.
+ *
+ *  RETURNS
+ *      TRUE if the SYN segment requested options.
+ *
+ *---------------------------------------------------------------------------*/
+static bool rwcpNegotiate(const uint8 *data, uint16 size)
+{
+    rwcpReleaseSegments();
+
+    if (size < RWCP_HEADER_SIZE + RWCP_SYN_PAYLOAD_SIZE)
+    {
+        return FALSE;
+    }
+
+    if (data[RWCP_SYN_OPTIONS_OFFSET] & RWCP_OPTION_SELECTIVE_REPEAT)
+    {
+        uint16 requested = MIN(data[RWCP_SYN_WINDOW_OFFSET], RWCP_SELECTIVE_WINDOW_MAX);
+        uint16 window = 1;
+
+        /* The window is a power of two so segment slots do not alias when
+           the sequence number wraps */
+        while ((window << 1) <= requested)
+        {
+            window <<= 1;
+        }
+        if (requested)
+        {
+            g_server_data.segments = calloc(window, sizeof(rwcp_segment_t));
+        }
+        if (g_server_data.segments)
+        {
+            g_server_data.selective_repeat = TRUE;
+            g_server_data.sequence_number_max = RWCP_EXTENDED_SEQUENCE_NUMBER_MAX;
+            g_server_data.receive_window = window;
+        }
+    }
+    RWCP_SERVER_DEBUG(( "negotiated sr:%d w:%d\n", g_server_data.selective_repeat, g_server_data.receive_window ));
+    return TRUE;
 }
 
 
@@ -197,10 +374,10 @@ static void rwcpGap( uint8 sequence )
  *      The next sequence number.
  *
  *---------------------------------------------------------------------------*/
-static uint8 nextExpectedSequenceNumber(uint8 current_sequence_number)
+static uint16 nextExpectedSequenceNumber(uint16 current_sequence_number)
 {
     UNUSED (current_sequence_number);
-    return (g_server_data.last_sequence_number + 1) % RWCP_SEQUENCE_NUMBER_MAX;
+    return (g_server_data.last_sequence_number + 1) % g_server_data.sequence_number_max;
 }
 
 
@@ -215,7 +392,7 @@ static uint8 nextExpectedSequenceNumber(uint8 current_sequence_number)
  *      TRUE if the sequence number matches the the next expected one
  *
  *---------------------------------------------------------------------------*/
-static bool isNextSequence(uint8 sequence)
+static bool isNextSequence(uint16 sequence)
 {
     return ( sequence == nextExpectedSequenceNumber(g_server_data.last_sequence_number));
 }
@@ -232,17 +409,94 @@ static bool isNextSequence(uint8 sequence)
  *      TRUE if the sequence number is out of sequence
  *
  *---------------------------------------------------------------------------*/
-static bool isOutOfSequence(uint8 sequence)
+static bool isOutOfSequence(uint16 sequence)
 {
     uint16 norm;
 
     /* normalise the number to deal with wrap around */
     norm = ( sequence -
             g_server_data.last_sequence_number +
-            RWCP_SEQUENCE_NUMBER_MAX) %
-            RWCP_SEQUENCE_NUMBER_MAX;
+            g_server_data.sequence_number_max) %
+            g_server_data.sequence_number_max;
+
+    return ( norm > 0 && norm <= g_server_data.receive_window );
+}
+
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      bufferSegment
+ *
+ *  DESCRIPTION
+ *      Keep a copy of an out-of-order DATA segment payload until the
+ *      preceding segments arrive.
+ *
+ *  RETURNS
+ *      TRUE if the segment was already buffered.
+ *
+ *---------------------------------------------------------------------------*/
+static bool bufferSegment(uint16 sequence_number, const uint8 *payload, uint16 size_payload)
+{
+    rwcp_segment_t *segment = &g_server_data.segments[sequence_number % g_server_data.receive_window];
+
+    if (segment->payload)
+    {
+        return TRUE;
+    }
+
+    /* If there is no memory the segment is dropped, it is not marked in the
+       GAP bitmap so the client will retransmit it */
+    segment->payload = malloc(size_payload ? size_payload : 1);
+    if (segment->payload)
+    {
+        memcpy(segment->payload, payload, size_payload);
+        segment->size_payload = size_payload;
+        g_server_data.statistics.segments_buffered++;
+    }
+    return FALSE;
+}
+
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      deliverBufferedSegments
+ *
+ *  DESCRIPTION
+ *      Pass buffered segments that now follow on in sequence to GAIA.
+ *
+ *  RETURNS
+ *      TRUE if out-of-order segments remain buffered.
+ *
+ *---------------------------------------------------------------------------*/
+static bool deliverBufferedSegments(void)
+{
+    uint16 offset;
+
+    for (;;)
+    {
+        uint16 sequence = nextExpectedSequenceNumber(g_server_data.last_sequence_number);
+        rwcp_segment_t *segment = &g_server_data.segments[sequence % g_server_data.receive_window];
+        uint8 *payload = segment->payload;
+
+        if (!payload)
+        {
+            break;
+        }
+        segment->payload = NULL;
+        g_server_data.last_sequence_number = sequence;
+        GaiaRwcpProcessCommand(payload, segment->size_payload);
+        free(payload);
+    }
 
-    return ( norm > 0 && norm <= RWCP_RECEIVE_WINDOW_MAX );
+    for (offset = 1; offset <= g_server_data.receive_window; offset++)
+    {
+        uint16 sequence = (g_server_data.last_sequence_number + offset) % g_server_data.sequence_number_max;
+        if (g_server_data.segments[sequence % g_server_data.receive_window].payload)
+        {
+            return TRUE;
+        }
+    }
+    return FALSE;
 }
 
 
@@ -257,7 +511,7 @@ static bool isOutOfSequence(uint8 sequence)
  *      RWCP DATA packet type handled by the function.
  *
  *---------------------------------------------------------------------------*/
-static rwcp_data_pkts_t handleDataSegment(uint8 sequence_number, const uint8 *data, uint16 size )
+static rwcp_data_pkts_t handleDataSegment(uint16 sequence_number, const uint8 *data, uint16 size )
 {
     /*
      * payload received, check the sequence number
@@ -266,21 +520,48 @@ static rwcp_data_pkts_t handleDataSegment(uint8 sequence_number, const uint8 *da
      * ACK duplicates.
      */
     rwcp_data_pkts_t data_pkt_type = RWCP_DATA_PKT_DISCARDED;
+    uint16 size_header = g_server_data.selective_repeat ? RWCP_EXTENDED_HEADER_SIZE : RWCP_HEADER_SIZE;
+
     if ( g_server_data.accept_segments )
     {
         if ( isNextSequence(sequence_number) )
         {
             data_pkt_type = RWCP_DATA_PKT_IN_SEQUENCE;
             g_server_data.out_of_sequence_status = FALSE;
+            g_server_data.statistics.segments_in_sequence++;
 
-            rwcpDataAck( sequence_number);
             g_server_data.last_sequence_number = sequence_number;
-            GaiaRwcpProcessCommand(&data[RWCP_PAYLOAD_OFFSET],size - RWCP_HEADER_SIZE);
+            GaiaRwcpProcessCommand(&data[size_header],size - size_header);
+
+            /* With selective repeat, the segment may fill a hole in front of
+               buffered segments. Acknowledge everything delivered and report
+               any holes that remain. */
+            if ( g_server_data.selective_repeat && deliverBufferedSegments() )
+            {
+                g_server_data.out_of_sequence_status = TRUE;
+                rwcpSelectiveGap( g_server_data.last_sequence_number);
+            }
+            else
+            {
+                rwcpDataAck( g_server_data.last_sequence_number);
+            }
         }
         else if ( isOutOfSequence(sequence_number) )
         {
             data_pkt_type = RWCP_DATA_PKT_OUT_OF_SEQUENCE;
-            if ( !g_server_data.out_of_sequence_status )
+            g_server_data.statistics.segments_out_of_sequence++;
+            if ( g_server_data.selective_repeat )
+            {
+                /* A repeated out-of-order segment means the client has not
+                   seen the last GAP, so send it again */
+                if ( bufferSegment(sequence_number, &data[size_header], size - size_header) ||
+                     !g_server_data.out_of_sequence_status )
+                {
+                    g_server_data.out_of_sequence_status = TRUE;
+                    rwcpSelectiveGap( g_server_data.last_sequence_number);
+                }
+            }
+            else if ( !g_server_data.out_of_sequence_status )
             {
                 g_server_data.out_of_sequence_status = TRUE;
                 rwcpGap( g_server_data.last_sequence_number);
@@ -296,6 +577,7 @@ static rwcp_data_pkts_t handleDataSegment(uint8 sequence_number, const uint8 *da
         else    /* must be a duplicate, ACK in case the previous ACK was lost */
         {
             data_pkt_type = RWCP_DATA_PKT_DUPLICATE;
+            g_server_data.statistics.segments_duplicate++;
             RWCP_SERVER_DEBUG(( "dup\n" ));
             rwcpDataAck( sequence_number);
         }
@@ -303,6 +585,7 @@ static rwcp_data_pkts_t handleDataSegment(uint8 sequence_number, const uint8 *da
     else
     {
         RWCP_SERVER_DEBUG(( "segment discarded\n" ));   /* silently discard when the server can't accept any more segments */
+        g_server_data.statistics.segments_discarded++;
     }
 
     return data_pkt_type;
@@ -318,6 +601,16 @@ bool RwcpGetOutOfSequenceStatus(void)
     return g_server_data.out_of_sequence_status;
 }
 
+void RwcpServerGetStatistics(rwcp_server_statistics_t *statistics)
+{
+    *statistics = g_server_data.statistics;
+}
+
+uint16 RwcpServerGetReceiveWindow(void)
+{
+    return g_server_data.receive_window;
+}
+
 static bool isRWwcpControlCmd(uint8 command)
 {   
     if ((command==RWCP_CLIENT_CMD_SYN) || (command==RWCP_CLIENT_CMD_RST)/* || (command==RWCP_CLIENT_CMD_RESERVED)*/)
@@ -331,7 +624,7 @@ static bool isRWwcpControlCmd(uint8 command)
 bool RwcpServerHandleMessage(const uint8 *data, uint16 size)
 {
     uint8 rwcp_header;
-    uint8 sequence_number;
+    uint16 sequence_number;
     uint8 command;
     bool status = TRUE;
     rwcp_data_pkts_t data_packet_type = RWCP_DATA_PKT_IN_SEQUENCE;
@@ -348,6 +641,18 @@ bool RwcpServerHandleMessage(const uint8 *data, uint16 size)
     sequence_number = rwcp_header & RWCP_SEQUENCE_MASK;
     command = rwcp_header & RWCP_COMMAND_MASK;
 
+    /* SYN segments always have the short header, all other segments have the
+       extended header once selective repeat is negotiated */
+    if (g_server_data.selective_repeat && command != RWCP_CLIENT_CMD_SYN)
+    {
+        if (size < RWCP_EXTENDED_HEADER_SIZE)
+        {
+            RWCP_SERVER_DEBUG(( "RwcpServerHandleMessage short header\n" ));
+            return FALSE;
+        }
+        sequence_number |= (uint16)data[RWCP_HEADER_SIZE] << RWCP_EXTENDED_SEQUENCE_SHIFT;
+    }
+
     RWCP_SERVER_DEBUG(( "RwcpServerHandleMessage\n" ));
     /* handle messages according to state */
     switch ( g_server_data.protocol_state )
@@ -363,7 +668,7 @@ bool RwcpServerHandleMessage(const uint8 *data, uint16 size)
                 /* SYN received, start the protocol */
                 case RWCP_CLIENT_CMD_SYN:
                     RWCP_SERVER_DEBUG(( "SYN received, LISTEN => SYN_RCVD\n" ));
-                    rwcpSynAck(sequence_number);
+                    rwcpSynAck(sequence_number, rwcpNegotiate(data, size));
                     g_server_data.last_sequence_number = sequence_number;
                     g_server_data.protocol_state = RWCP_SYN_RCVD;
                     break;
@@ -393,7 +698,7 @@ bool RwcpServerHandleMessage(const uint8 *data, uint16 size)
                 /* duplicate SYN received, keep going */
                 case RWCP_CLIENT_CMD_SYN:
                     RWCP_SERVER_DEBUG(( "SYN received, SYN_RCVD => SYN_RCVD\n" ));
-                    rwcpSynAck(sequence_number);
+                    rwcpSynAck(sequence_number, rwcpNegotiate(data, size));
                     g_server_data.last_sequence_number = sequence_number;
                     break;
 
@@ -401,6 +706,7 @@ bool RwcpServerHandleMessage(const uint8 *data, uint16 size)
                 case RWCP_CLIENT_CMD_RST:
                     RWCP_SERVER_DEBUG(( "RST received, SYN_RCVD => LISTEN\n" ));
                     rwcpRstAck( sequence_number);
+                    rwcpReleaseSegments();
                     g_server_data.protocol_state = RWCP_LISTEN;
                     break;
 
@@ -417,6 +723,7 @@ bool RwcpServerHandleMessage(const uint8 *data, uint16 size)
                 default:
                     RWCP_SERVER_DEBUG(( "Unexpected, hdr = %x, SYN_RCVD => LISTEN\n", rwcp_header ));
                     rwcpRst( sequence_number);
+                    rwcpReleaseSegments();
                     g_server_data.protocol_state = RWCP_LISTEN;
                     break;
             }
@@ -432,6 +739,7 @@ bool RwcpServerHandleMessage(const uint8 *data, uint16 size)
                 case RWCP_CLIENT_CMD_RST:
                     RWCP_SERVER_DEBUG(( "RST received, ESTABLISHED => LISTEN\n" ));
                     rwcpRstAck( sequence_number);
+                    rwcpReleaseSegments();
                     g_server_data.protocol_state = RWCP_LISTEN;
                     break;
 
@@ -446,6 +754,7 @@ bool RwcpServerHandleMessage(const uint8 *data, uint16 size)
                 default:
                     RWCP_SERVER_DEBUG(( "Unexpected, hdr = %x, ESTABLISHED => LISTEN\n", rwcp_header ));
                     rwcpRst( sequence_number);
+                    rwcpReleaseSegments();
                     g_server_data.protocol_state = RWCP_LISTEN;
                     break;
             }
@@ -486,4 +795,6 @@ void RwcpServerInit( uint8 header_size)
     g_server_data.client_task = NULL;
     g_server_data.last_sequence_number = 0;
     g_server_data.rwcp_upgrade_header_size = header_size;
+    memset(&g_server_data.statistics, 0, sizeof(g_server_data.statistics));
+    rwcpReleaseSegments();
 }
@@ -40,6 +40,18 @@ typedef enum
     RWCP_MESSAGE_TOP
 } rwcp_transport_message;
 
+/*! @brief RWCP server segment counters
+ */
+typedef struct
+{
+    uint32 segments_in_sequence;        /*!< DATA segments received in sequence */
+    uint32 segments_out_of_sequence;    /*!< DATA segments received ahead of the expected sequence number */
+    uint32 segments_buffered;           /*!< Out of sequence segments kept for selective repeat */
+    uint32 segments_duplicate;          /*!< DATA segments already acknowledged */
+    uint32 segments_discarded;          /*!< DATA segments discarded by flow control */
+    uint32 gaps_sent;                   /*!< GAP segments sent to the client */
+} rwcp_server_statistics_t;
+
 /*! @brief Message containing RWCP data
  */ 
 typedef struct
@@ -103,4 +115,21 @@ void RwcpServerInit( uint8 header_size);
 */
 bool RwcpGetOutOfSequenceStatus(void);
 
+/*! 
+    @brief Get the RWCP server segment counters
+    
+    @param statistics Populated with the counters since RwcpServerInit
+*/
+void RwcpServerGetStatistics(rwcp_server_statistics_t *statistics);
+
+/*! 
+    @brief Get the RWCP receive window
+    
+    The window is 32 segments with go-back-N, or the window granted
+    to the client when selective repeat was negotiated in the SYN segment.
+
+    @return The receive window in segments
+*/
+uint16 RwcpServerGetReceiveWindow(void);
+
 #endif /* __RWCP_SERVER_H__ */
@@ -0,0 +1,243 @@
+/**  Copyright (c) 2018 Qualcomm Technologies International, Ltd. */
+/**     */
+/** *
+ * \file
+ * Sport Health block indexed compressed log
+ * Blocks are laid out one after another in a store made of equally sized chunks; a block never spans
+ * two chunks, so one that would not fit before the end of a chunk is placed at the start of the next
+ * (wrapping to the first), dropping the oldest blocks it overlaps. A small ring
+ * of descriptors, ordered by time, indexes the blocks by sequence number and sample time.
+ */
+#ifdef SPORT_HEALTH_LOG_COMPRESS
+
+#include <stdlib.h>
+#include <string.h>
+#include "sport_health_log_block.h"
+#include "system_clock.h"
+
+typedef struct {
+    uint32 first_time;              // time of the first sample in the block
+    uint32 last_time;               // time of the last sample in the block
+    uint16 offset;                  // offset of the block header in the store, counting across chunks
+    uint16 length;                  // block length including the header
+} sh_log_block_desc;
+
+typedef struct {
+    uint8 * chunks[SH_LOG_BLOCK_STORE_CHUNKS];
+    uint8 * scratch;                // a worst case block is compressed here before space is made for it
+    uint16 write_offset;            // where the next block will be placed
+    uint16 next_seq;                // sequence number of the next block
+    uint8 oldest;                   // index of the oldest descriptor
+    uint8 count;                    // number of blocks in the log
+    sh_log_block_desc desc[SH_LOG_BLOCK_MAX_BLOCKS];
+    sh_log_block_statistics stats;
+} sh_log_block_log;
+
+static sh_log_block_log sh_log_block;
+
+static void sh_log_block_drop_oldest(void);
+static void sh_log_block_make_room(uint16 length);
+static sh_log_block_desc * sh_log_block_desc_at(uint8 age);
+static void sh_log_block_write_uint32(uint8 * p_buf, uint32 val);
+static uint8 * sh_log_block_at(uint16 offset);
+
+/* Drop the oldest block from the index */
+void sh_log_block_drop_oldest(void)
+{
+    sh_log_block.oldest = (sh_log_block.oldest + 1) % SH_LOG_BLOCK_MAX_BLOCKS;
+    sh_log_block.count--;
+    sh_log_block.stats.blocks_evicted++;
+}
+
+/* Make sure a block of length bytes fits at the write offset, dropping the oldest blocks as needed.
+   Blocks after the write offset are always older than those before it, so only the oldest
+   blocks can overlap the space needed */
+void sh_log_block_make_room(uint16 length)
+{
+    uint16 start, end;
+    uint16 chunk_used = sh_log_block.write_offset % SH_LOG_BLOCK_MAX_SIZE;
+    if (chunk_used + length > SH_LOG_BLOCK_MAX_SIZE) {
+        sh_log_block.write_offset += SH_LOG_BLOCK_MAX_SIZE - chunk_used;
+    }
+    if (sh_log_block.write_offset >= SH_LOG_BLOCK_STORE_CHUNKS * SH_LOG_BLOCK_MAX_SIZE) {
+        sh_log_block.write_offset = 0;
+    }
+    start = sh_log_block.write_offset;
+    end = start + length;
+    while (sh_log_block.count > 0) {
+        sh_log_block_desc * p_oldest = &sh_log_block.desc[sh_log_block.oldest];
+        bool overlaps = (p_oldest->offset < end) && (p_oldest->offset + p_oldest->length > start);
+        if (!overlaps && sh_log_block.count < SH_LOG_BLOCK_MAX_BLOCKS) {
+            break;
+        }
+        sh_log_block_drop_oldest();
+    }
+}
+
+/* Descriptor for the block that is age blocks newer than the oldest */
+sh_log_block_desc * sh_log_block_desc_at(uint8 age)
+{
+    return &sh_log_block.desc[(sh_log_block.oldest + age) % SH_LOG_BLOCK_MAX_BLOCKS];
+}
+
+/* Address of the byte at offset in the store */
+uint8 * sh_log_block_at(uint16 offset)
+{
+    return &sh_log_block.chunks[offset / SH_LOG_BLOCK_MAX_SIZE][offset % SH_LOG_BLOCK_MAX_SIZE];
+}
+
+/* Write uint32 to buffer, little-endian */
+void sh_log_block_write_uint32(uint8 * p_buf, uint32 val)
+{
+    p_buf[0] = (uint8)(val & 0xFF);
+    p_buf[1] = (uint8)((val >> 8) & 0xFF);
+    p_buf[2] = (uint8)((val >> 16) & 0xFF);
+    p_buf[3] = (uint8)((val >> 24) & 0xFF);
+}
+
+bool SportHealthLogBlockInit(void)
+{
+    uint8 i;
+    SportHealthLogBlockDeinit();
+    sh_log_block.scratch = malloc(SH_LOG_BLOCK_MAX_SIZE);
+    for (i = 0; i < SH_LOG_BLOCK_STORE_CHUNKS; i++) {
+        sh_log_block.chunks[i] = malloc(SH_LOG_BLOCK_MAX_SIZE);
+        if (sh_log_block.chunks[i] == NULL) {
+            break;
+        }
+    }
+    if (sh_log_block.scratch == NULL || i < SH_LOG_BLOCK_STORE_CHUNKS) {
+        SportHealthLogBlockDeinit();
+        return FALSE;
+    }
+    return TRUE;
+}
+
+void SportHealthLogBlockDeinit(void)
+{
+    uint8 i;
+    for (i = 0; i < SH_LOG_BLOCK_STORE_CHUNKS; i++) {
+        free(sh_log_block.chunks[i]);
+    }
+    free(sh_log_block.scratch);
+    memset(&sh_log_block, 0, sizeof(sh_log_block));
+}
+
+bool SportHealthLogBlockIsEnabled(void)
+{
+    return (sh_log_block.scratch != NULL);
+}
+
+/* Compress the samples into the scratch block: each packet produced by the compressor is sent
+   over GATT (if a callback is given) and appended to the block, so the samples are only encoded once.
+   Only once the block is complete are the oldest blocks dropped to make room for it, so a set of
+   samples that cannot be compressed never costs the log any blocks */
+bool SportHealthLogBlockWriteImu(const imu_sensor_data_t * p_data, NotifyCallback notify)
+{
+    sh_log_compress_imu_info compress_info;
+    sh_log_block_desc * p_desc;
+    uint8 * p_block;
+    uint8 * p_packet;
+    uint16 length = 0;
+    uint8 size;
+    uint32 start_us = SystemClockGetTimerTime();
+
+    if (sh_log_block.scratch == NULL || p_data->accel.frame_count == 0) {
+        return FALSE;
+    }
+    p_block = sh_log_block.scratch;
+    p_packet = &p_block[SH_LOG_BLOCK_HEADER_SIZE];
+
+    size = SportHealthLoggingCompressImuHeader(p_data, &compress_info, p_packet);
+    if (size == 0) {
+        return FALSE;
+    }
+    while (size != 0) {
+        if (notify) {
+            notify(p_packet, size);
+        }
+        length += size;
+        p_packet += size;
+        /* The compression function will return 0 when it is done (or if there is an error) */
+        size = SportHealthLoggingCompressImuData(p_data, &compress_info, p_packet);
+    }
+
+    sh_log_block_make_room(SH_LOG_BLOCK_HEADER_SIZE + length);
+
+    /* Index the block; the descriptor ring has a free slot as make_room dropped one if it was full */
+    p_desc = sh_log_block_desc_at(sh_log_block.count);
+    p_desc->last_time = p_data->accel.last_sample_time;
+    p_desc->first_time = p_data->accel.last_sample_time - (uint32)(p_data->accel.frame_count - 1) * p_data->accel.sampling_interval;
+    p_desc->offset = sh_log_block.write_offset;
+    p_desc->length = SH_LOG_BLOCK_HEADER_SIZE + length;
+    sh_log_block.count++;
+
+    p_block[SH_LOG_BLOCK_SEQ_OFFSET]     = (uint8)(sh_log_block.next_seq & 0xFF);
+    p_block[SH_LOG_BLOCK_SEQ_OFFSET + 1] = (uint8)(sh_log_block.next_seq >> 8);
+    sh_log_block_write_uint32(&p_block[SH_LOG_BLOCK_FIRST_TIME_OFFSET], p_desc->first_time);
+    sh_log_block_write_uint32(&p_block[SH_LOG_BLOCK_LAST_TIME_OFFSET], p_desc->last_time);
+    p_block[SH_LOG_BLOCK_LENGTH_OFFSET]     = (uint8)(length & 0xFF);
+    p_block[SH_LOG_BLOCK_LENGTH_OFFSET + 1] = (uint8)(length >> 8);
+    memcpy(sh_log_block_at(p_desc->offset), p_block, p_desc->length);
+
+    sh_log_block.write_offset += p_desc->length;
+    sh_log_block.next_seq++;
+
+    sh_log_block.stats.samples_encoded += p_data->accel.frame_count;
+    sh_log_block.stats.bytes_uncompressed += (uint32)p_data->accel.frame_count * 6;
+    sh_log_block.stats.bytes_encoded += length;
+    sh_log_block.stats.encode_time_us += SystemClockGetTimerTime() - start_us;
+    return TRUE;
+}
+
+bool SportHealthLogBlockGetNewest(uint16 * seq)
+{
+    if (sh_log_block.count == 0) {
+        return FALSE;
+    }
+    *seq = (uint16)(sh_log_block.next_seq - 1);
+    return TRUE;
+}
+
+/* Blocks are written in time order, so a binary search over the index finds the first block
+   whose last sample is at or after the requested time */
+bool SportHealthLogBlockFindByTime(uint32 time_ms, uint16 * seq)
+{
+    uint8 low = 0;
+    uint8 high = sh_log_block.count;
+    while (low < high) {
+        uint8 mid = (uint8)((low + high) / 2);
+        if (sh_log_block_desc_at(mid)->last_time < time_ms) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+    if (low == sh_log_block.count) {
+        return FALSE;
+    }
+    *seq = (uint16)(sh_log_block.next_seq - sh_log_block.count + low);
+    return TRUE;
+}
+
+bool SportHealthLogBlockGet(uint16 seq, const uint8 ** block, uint16 * length)
+{
+    /* Age relative to the newest block, using unsigned arithmetic so sequence number wrap is handled */
+    uint16 newer = (uint16)(sh_log_block.next_seq - 1 - seq);
+    sh_log_block_desc * p_desc;
+    if (newer >= sh_log_block.count) {
+        return FALSE;
+    }
+    p_desc = sh_log_block_desc_at((uint8)(sh_log_block.count - 1 - newer));
+    *block = sh_log_block_at(p_desc->offset);
+    *length = p_desc->length;
+    return TRUE;
+}
+
+void SportHealthLogBlockGetStatistics(sh_log_block_statistics * stats)
+{
+    *stats = sh_log_block.stats;
+}
+
+#endif
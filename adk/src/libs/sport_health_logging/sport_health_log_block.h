@@ -0,0 +1,75 @@
+/**  Copyright (c) 2018 Qualcomm Technologies International, Ltd. */
+/**     */
+/** *
+ * \file
+ * Sport Health block indexed compressed log
+ * Each block holds the compressed packets for one set of IMU samples, prefixed with a small header
+ * carrying a sequence number and the time span of the samples. Blocks are self-contained (the first
+ * sample of a set is never delta encoded) so a reader can seek by time and fetch only the blocks it
+ * has not yet seen, without decompressing the log from the start.
+ */
+#ifndef SPORT_HEALTH_LOG_BLOCK_H
+#define SPORT_HEALTH_LOG_BLOCK_H
+
+#include "sport_health_log_compress.h"
+
+/* Block header layout, all fields little-endian:
+   [0..1]  block sequence number
+   [2..5]  time of the first sample in ms
+   [6..9]  time of the last sample in ms
+   [10..11] length of the packets that follow the header
+   The packets are stored as sent over GATT: type, length then payload */
+#define SH_LOG_BLOCK_SEQ_OFFSET         0
+#define SH_LOG_BLOCK_FIRST_TIME_OFFSET  2
+#define SH_LOG_BLOCK_LAST_TIME_OFFSET   6
+#define SH_LOG_BLOCK_LENGTH_OFFSET      10
+#define SH_LOG_BLOCK_HEADER_SIZE        12
+
+/* Worst case block: the meta data packet plus every sample uncompressed (6 bytes each) */
+#define SH_LOG_BLOCK_MAX_PACKETS (1 + ((SH_LOG_COMPRESS_MAX_SAMPLES * 6) + GATT_LOGGING_PAYLOAD_SIZE_BYTES - 1) / GATT_LOGGING_PAYLOAD_SIZE_BYTES)
+#define SH_LOG_BLOCK_MAX_SIZE    (SH_LOG_BLOCK_HEADER_SIZE + SH_LOG_BLOCK_MAX_PACKETS * GATT_LOGGING_TOTAL_PACKET_SIZE)
+
+#ifdef SPORT_HEALTH_LOG_COMPRESS
+
+/* Number of blocks that can be indexed; the oldest block is dropped when either the index or the store is full */
+#ifndef SH_LOG_BLOCK_MAX_BLOCKS
+#define SH_LOG_BLOCK_MAX_BLOCKS 16
+#endif
+
+/* Number of chunks in the block store allocated when the app registers its notify callback. Each chunk
+   is a separate allocation of SH_LOG_BLOCK_MAX_SIZE bytes, so it fits a memory pool, and holds one or
+   more whole blocks */
+#ifndef SH_LOG_BLOCK_STORE_CHUNKS
+#define SH_LOG_BLOCK_STORE_CHUNKS 4
+#endif
+
+typedef struct {
+    uint32 samples_encoded;         // samples written into blocks
+    uint32 bytes_uncompressed;      // size those samples would have taken uncompressed
+    uint32 bytes_encoded;           // size of the packets written into blocks, excluding block headers
+    uint32 encode_time_us;          // total time spent compressing samples into blocks
+    uint16 blocks_evicted;          // blocks dropped to make room before being read
+} sh_log_block_statistics;
+
+/* Allocate the block store chunks, plus room to compress one worst case block before it is stored.
+   Returns FALSE if any allocation fails, in which case nothing is left allocated */
+bool SportHealthLogBlockInit(void);
+/* Free the block store and drop all blocks */
+void SportHealthLogBlockDeinit(void);
+/* TRUE if a block store has been allocated */
+bool SportHealthLogBlockIsEnabled(void);
+
+/* Compress a set of IMU samples into a new block. Returns FALSE if the samples cannot be compressed */
+bool SportHealthLogBlockWriteImu(const imu_sensor_data_t * p_data, NotifyCallback notify);
+
+/* Sequence number of the newest block. Returns FALSE if the log is empty */
+bool SportHealthLogBlockGetNewest(uint16 * seq);
+/* Sequence number of the first block containing samples at or after time_ms. Returns FALSE if there is none */
+bool SportHealthLogBlockFindByTime(uint32 time_ms, uint16 * seq);
+/* Get a block, including its header. Returns FALSE if the block has been dropped or not yet written */
+bool SportHealthLogBlockGet(uint16 seq, const uint8 ** block, uint16 * length);
+
+/* Get the compression statistics for the blocks written so far */
+void SportHealthLogBlockGetStatistics(sh_log_block_statistics * stats);
+#endif
+#endif /* SPORT_HEALTH_LOG_BLOCK_H */
@@ -106,7 +106,7 @@ uint8 SportHealthLoggingDecompressImuData  (imu_sensor_data_t * p_data, sh_log_d
 	info->last_packet_received = expected_packet_number;
 
 	/* append data into an array */
-	if (payload[1] > GATT_LOGGING_PAYLOAD_SIZE_BYTES) {
+	if (payload[1] > GATT_LOGGING_TOTAL_PACKET_SIZE) {
         return 0;
     }
 
@@ -162,6 +162,60 @@ uint8 SportHealthLoggingDecompressImuData  (imu_sensor_data_t * p_data, sh_log_d
 	return packet_number;
 }
 
+static uint32 read_uint32(const uint8 * p_buf);
+
+/* Read uint32 from buffer, little-endian */
+uint32 read_uint32(const uint8 * p_buf)
+{
+	return ((uint32)p_buf[3] << 24) + ((uint32)p_buf[2] << 16) + ((uint32)p_buf[1] << 8) + p_buf[0];
+}
+
+/* Read the header of a block from the block indexed log, checking the block holds all of its packets
+   Return length of the packets following the header
+*/
+uint16 SportHealthLoggingDecompressBlockHeader(const uint8 * block, uint16 length, uint16 * seq, uint32 * first_time, uint32 * last_time)
+{
+	uint16 packets_length;
+	if (length < SH_LOG_BLOCK_HEADER_SIZE) {
+		return 0;
+	}
+	packets_length = block[SH_LOG_BLOCK_LENGTH_OFFSET] + (block[SH_LOG_BLOCK_LENGTH_OFFSET + 1] << 8);
+	if (packets_length > length - SH_LOG_BLOCK_HEADER_SIZE) {
+		return 0;
+	}
+	*seq = block[SH_LOG_BLOCK_SEQ_OFFSET] + (block[SH_LOG_BLOCK_SEQ_OFFSET + 1] << 8);
+	*first_time = read_uint32(&block[SH_LOG_BLOCK_FIRST_TIME_OFFSET]);
+	*last_time = read_uint32(&block[SH_LOG_BLOCK_LAST_TIME_OFFSET]);
+	return packets_length;
+}
+
+/* given a block from the block indexed log, walk the packets it holds and decompress them into p_data
+   Blocks do not depend on each other, so any block can be decompressed on its own
+   Return number of decompressed samples
+*/
+uint8 SportHealthLoggingDecompressImuBlock(imu_sensor_data_t * p_data, sh_log_decompress_imu_info * info, const uint8 * block, uint16 length)
+{
+	uint16 seq, packets_length, offset;
+	uint32 first_time, last_time;
+
+	packets_length = SportHealthLoggingDecompressBlockHeader(block, length, &seq, &first_time, &last_time);
+	if (packets_length < GATT_LOGGING_HEADER_SIZE) {
+		return 0;
+	}
+	block += SH_LOG_BLOCK_HEADER_SIZE;
+	if (block[1] > packets_length || SportHealthLoggingDecompressImuHeader(p_data, info, block) == 0) {
+		return 0;
+	}
+	for (offset = block[1]; offset < packets_length; offset += block[offset + 1]) {
+		if ((packets_length - offset) < GATT_LOGGING_HEADER_SIZE || block[offset + 1] < GATT_LOGGING_HEADER_SIZE ||
+			block[offset + 1] > (packets_length - offset) ||
+			SportHealthLoggingDecompressImuData(p_data, info, &block[offset]) == 0) {
+			return 0;
+		}
+	}
+	return info->uzip_complete ? (uint8)p_data->accel.frame_count : 0;
+}
+
 #ifdef SH_LOG_COMPRESS_TEST
 /* This is for use on a desktop machine to validate the code */
 #include "math.h"
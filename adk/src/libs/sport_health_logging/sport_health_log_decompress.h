@@ -9,6 +9,7 @@
 #define SPORT_HEALTH_LOG_DECOMPRESS_H
 #include "sport_health_logging.h"
 #include "sport_health_log_compress.h"
+#include "sport_health_log_block.h"
 
 /* On decompress we expect there to be plenty of memory available so we can use a long buffer */
 typedef struct {
@@ -26,6 +27,11 @@ typedef struct {
 /* de-compression side. Rteurnt he number of bytes decompressed (or 0 if error or complete) */
 uint8 SportHealthLoggingDecompressImuHeader(imu_sensor_data_t * p_data, sh_log_decompress_imu_info * info, const uint8 * payload);
 uint8 SportHealthLoggingDecompressImuData  (imu_sensor_data_t * p_data, sh_log_decompress_imu_info * info, const uint8 * payload);
+/* Decompress a single block from the block indexed log. Returns the number of samples (or 0 if error).
+   The block sequence number and time span can be read without decompressing using SportHealthLoggingDecompressBlockHeader */
+uint8 SportHealthLoggingDecompressImuBlock (imu_sensor_data_t * p_data, sh_log_decompress_imu_info * info, const uint8 * block, uint16 length);
+/* Read a block header. Returns the length of the packets in the block (or 0 if error) */
+uint16 SportHealthLoggingDecompressBlockHeader(const uint8 * block, uint16 length, uint16 * seq, uint32 * first_time, uint32 * last_time);
 
 #ifdef SH_LOG_COMPRESS_TEST
 /* compress, uncompress and check that the results match */
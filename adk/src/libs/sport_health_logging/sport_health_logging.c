@@ -13,6 +13,7 @@
 #include <stdarg.h>
 #ifdef SPORT_HEALTH_LOG_COMPRESS
 #include "sport_health_log_compress.h"
+#include "sport_health_log_block.h"
 #endif
 
 /* We keep track of microsecond clock wraps so that we can keep a stable millisecond time */
@@ -76,6 +77,15 @@ uint32 SportHealthLoggingGetBleLogging(void)
 void SportHealthLoggingRegisterNotifyCallback(NotifyCallback callback)
 {
     sh_log_notifyCallback = callback;
+#ifdef SPORT_HEALTH_LOG_COMPRESS
+    /* The block store lives for as long as the app has logging registered */
+    if (callback == NULL) {
+        SportHealthLogBlockDeinit();
+    }
+    else if (!SportHealthLogBlockIsEnabled() && !SportHealthLogBlockInit()) {
+        DBG_MSG("SportHealthLoggingRegisterNotifyCallback: no memory for the IMU block log");
+    }
+#endif
 }
 
 /* XYZ in each sample */
@@ -240,6 +250,13 @@ void SportHealthLoggingImuSensorData(const imu_sensor_data_t *p_message)
             i = i + NUM_VAL_PER_SAMPLE;
         }
     }
+#ifdef SPORT_HEALTH_LOG_COMPRESS
+    /* With a block store the samples are compressed once, both into the log and over GATT */
+    if (SportHealthLogBlockIsEnabled() &&
+        SportHealthLogBlockWriteImu(p_message, logGatt ? sh_log_notifyCallback : (NotifyCallback)NULL)) {
+        return;
+    }
+#endif
     if (logGatt) {
 #ifdef SPORT_HEALTH_LOG_COMPRESS
         LogData logData;
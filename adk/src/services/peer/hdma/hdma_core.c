@@ -26,7 +26,6 @@
 
 /*! \todo remove unused after development */
 #pragma unitsuppress Unused
-static int16 hdma_Filter(hdma_timestamp timestamp, queue_t *queue, int16 halfLife_ms,int16 maxAge_ms, queue_type_t type);
 #ifdef INCLUDE_HDMA_MIC_QUALITY_EVENT
 static void hdma_ValidateVoiceQuality(hdma_timestamp timestamp,hdma_core_handover_urgency_t *urgency, hdma_core_handover_urgency_t *suppressUrgency );
 #endif
@@ -427,9 +426,11 @@ static uint8 hdma_BudInit(hdma_bud_info_t *bud_info)
     memset(bud_info, 0, sizeof(hdma_bud_info_t));
 #ifdef INCLUDE_HDMA_MIC_QUALITY_EVENT
     Hdma_QueueCreate(&(bud_info->voiceQuality));
+    Hdma_QueueSetFilter(&(bud_info->voiceQuality), &mic);
 #endif
 #ifdef INCLUDE_HDMA_RSSI_EVENT
     Hdma_QueueCreate(&(bud_info->phoneRSSI));
+    Hdma_QueueSetFilter(&(bud_info->phoneRSSI), &rssi);
 #endif
 #ifdef INCLUDE_HDMA_BATTERY_EVENT
     bud_info->batteryStatus = HDMA_CORE_BATTERY_UNKNOWN;
@@ -483,20 +484,19 @@ void Hdma_CoreHandleVoiceQuality(hdma_timestamp timestamp, uint8 isThisBud, uint
 /*! \brief filter voice quality with the filter settings that apply for one urgency and determine if the filtered value meets the handover requirement.
 
     \param[in] timestamp Time at which event is received.
-    \param[in] vqHalfLife Voice quality data older than half life will be down weighted
-    \param[in] vqMaxAge Voice quality data older than Max life will be discarded
+    \param[in] level Urgency level whose filter settings apply
     \param[in] absVQ Absolute voice quality threashold
     \param[in] relVQ Relative voice quality threashold
     \param[in] otherIsBetter Output Voice quality of peer earbud is better
     \param[in] thisIsBetter Output Voice quality of this earbud is better
 */
-static void hdma_CheckVoiceQuality(hdma_timestamp timestamp, int16 vqHalfLife, int16 vqMaxAge, int16 absVQ, int16 relVQ, uint8 *otherIsBetter, uint8 *thisIsBetter)
+static void hdma_CheckVoiceQuality(hdma_timestamp timestamp, hdma_filter_level_t level, int16 absVQ, int16 relVQ, uint8 *otherIsBetter, uint8 *thisIsBetter)
 {
     int16 thisVQ = 0;
     int16 otherVQ = 0;
 
-    thisVQ = hdma_Filter(timestamp, &(hdma_core_data->local_bud.voiceQuality), vqHalfLife, vqMaxAge, HDMA_QUEUE_MIC);
-    otherVQ = hdma_Filter(timestamp, &(hdma_core_data->remote_bud.voiceQuality), vqHalfLife, vqMaxAge, HDMA_QUEUE_MIC);
+    thisVQ = Hdma_QueueFilter(&(hdma_core_data->local_bud.voiceQuality), level, timestamp);
+    otherVQ = Hdma_QueueFilter(&(hdma_core_data->remote_bud.voiceQuality), level, timestamp);
 	
     *otherIsBetter = (thisVQ < absVQ) && ((otherVQ - thisVQ) > relVQ);
     *thisIsBetter = (otherVQ < absVQ) && ((thisVQ - otherVQ) > relVQ);
@@ -515,7 +515,7 @@ static void hdma_CheckVoiceQuality(hdma_timestamp timestamp, int16 vqHalfLife, i
 static void hdma_ValidateVoiceQuality(hdma_timestamp timestamp,hdma_core_handover_urgency_t *urgency, hdma_core_handover_urgency_t *suppressUrgency )
 {
     uint8 otherIsBetter, thisIsBetter;
-    hdma_CheckVoiceQuality(timestamp, mic.halfLife_ms.critical, mic.maxAge_ms.critical,
+    hdma_CheckVoiceQuality(timestamp, HDMA_FILTER_CRITICAL,
                                 mic.absThreshold.critical, mic.relThreshold.critical, &otherIsBetter,&thisIsBetter);
     if (otherIsBetter)
     {
@@ -531,7 +531,7 @@ static void hdma_ValidateVoiceQuality(hdma_timestamp timestamp,hdma_core_handove
         return;
     }
 
-    hdma_CheckVoiceQuality(timestamp, mic.halfLife_ms.high, mic.maxAge_ms.high,
+    hdma_CheckVoiceQuality(timestamp, HDMA_FILTER_HIGH,
                                 mic.absThreshold.high, mic.relThreshold.high, &otherIsBetter,&thisIsBetter);
     if (otherIsBetter)
     {
@@ -546,8 +546,7 @@ static void hdma_ValidateVoiceQuality(hdma_timestamp timestamp,hdma_core_handove
         return;
     }
 
-    hdma_CheckVoiceQuality(timestamp,
-                                mic.halfLife_ms.low, mic.maxAge_ms.low,
+    hdma_CheckVoiceQuality(timestamp, HDMA_FILTER_LOW,
                                 mic.absThreshold.low, mic.relThreshold.low, &otherIsBetter,&thisIsBetter);
 
     if(otherIsBetter)
@@ -590,21 +589,20 @@ void Hdma_CoreHandleLinkQuality(hdma_timestamp timestamp,uint8 isThisBud, uint8
 /*! \brief Filter an RSSI for a single set of urgency settings and determine if a handover is necessary.
 
     \param[in] timestamp Time at which event is received.
-    \param[in] rssiHalfLife_ms RSSI data older than half life will be down weighted
-    \param[in] rssiMaxAge_ms RSSI data older than Max life will be discarded
+    \param[in] level Urgency level whose filter settings apply
     \param[in] absRSSIThreshold Absolute RSSI threshold
     \param[in] relRSSIThreshold Relative RSSI threshold
     \param[out] Whether handover is required
 */
-static uint8 hdma_CheckRSSILevel( hdma_timestamp timestamp, int16 rssiHalfLife_ms,int16 rssiMaxAge_ms, int16 absRSSIThreshold,int16 relRSSIThreshold)
+static uint8 hdma_CheckRSSILevel( hdma_timestamp timestamp, hdma_filter_level_t level, int16 absRSSIThreshold,int16 relRSSIThreshold)
 {
 	int16 thisRSSI = 0;
 	int16 otherRSSI = 0;
 
 	if(hdma_core_data->local_bud.phoneRSSI.size > 0)
-		thisRSSI = hdma_Filter(timestamp, &(hdma_core_data->local_bud.phoneRSSI), rssiHalfLife_ms, rssiMaxAge_ms, HDMA_QUEUE_RSSI);
+		thisRSSI = Hdma_QueueFilter(&(hdma_core_data->local_bud.phoneRSSI), level, timestamp);
 	if(hdma_core_data->remote_bud.phoneRSSI.size > 0)
-		otherRSSI = hdma_Filter(timestamp, &(hdma_core_data->remote_bud.phoneRSSI), rssiHalfLife_ms, rssiMaxAge_ms, HDMA_QUEUE_RSSI);
+		otherRSSI = Hdma_QueueFilter(&(hdma_core_data->remote_bud.phoneRSSI), level, timestamp);
 	
     HDMA_DEBUG_LOG("hdma_CheckRSSILevel: otherRSSI = %d, thisRSSI = %d", otherRSSI, thisRSSI);
 
@@ -623,21 +621,18 @@ static hdma_core_handover_urgency_t hdma_ValidateLink(hdma_timestamp timestamp)
 {
     /*  validate the RF link determinng if a handover is generated at any urgency level */
     hdma_core_handover_urgency_t urgency = HDMA_CORE_HANDOVER_URGENCY_INVALID;
-    if (hdma_CheckRSSILevel(timestamp,
-                                rssi.halfLife_ms.critical, rssi.maxAge_ms.critical,
+    if (hdma_CheckRSSILevel(timestamp, HDMA_FILTER_CRITICAL,
                                 rssi.absThreshold.critical, rssi.relThreshold.critical))
     {
         urgency = HDMA_CORE_HANDOVER_URGENCY_CRITICAL;
     }
-    else if (hdma_CheckRSSILevel(timestamp,
-                                 rssi.halfLife_ms.high, rssi.maxAge_ms.high,
-                                 rssi.absThreshold.high, rssi.relThreshold.high))
+    else if (hdma_CheckRSSILevel(timestamp, HDMA_FILTER_HIGH,
+                                rssi.absThreshold.high, rssi.relThreshold.high))
     {
         urgency = HDMA_CORE_HANDOVER_URGENCY_HIGH;
     }
-    else if (hdma_CheckRSSILevel(timestamp,
-                                    rssi.halfLife_ms.low, rssi.maxAge_ms.low,
-                                    rssi.absThreshold.low, rssi.relThreshold.low))
+    else if (hdma_CheckRSSILevel(timestamp, HDMA_FILTER_LOW,
+                                rssi.absThreshold.low, rssi.relThreshold.low))
     {
         urgency = HDMA_CORE_HANDOVER_URGENCY_LOW;
     }
@@ -645,91 +640,6 @@ static hdma_core_handover_urgency_t hdma_ValidateLink(hdma_timestamp timestamp)
 }
 
 #endif
-/*! \brief Filter data according ot the specified parameters.
-
-    \param[in] timestamp Time at which event is received.
-    \param[in] queue Queue of data from oldest to newest.  Pairs of (timestamp, value)
-    \param[in] halfLife_ms Older data will be down weighted according to this half life
-    \param[in] maxAge_ms Data older that this will be rejected
-    \param[in] type Type of queue to process data accordingly
-    \param[out] Estimated data value now
-*/
-static int16 hdma_Filter(hdma_timestamp timestamp, queue_t *queue, int16 halfLife_ms,int16 maxAge_ms, queue_type_t type)
-{
-    /* filter the RSSI history to obtain a single value */
-    int totVal = 0; /*  32 bit signed   */
-    int totWeight = 0;  /*  32 bit signed   */
-    int32 dt;
-    int index;
-    int16 val;
-    uint8 qual;
-    uint32 t;
-    uint32 NHalf;
-    int residual_x4;
-    uint16 w;
-    int i =0;
-
-    if(!Hdma_IsQueueEmpty(queue))
-    {
-    	HDMA_DEBUG_LOG("hdma_Filter: queue->front = %d, queue->rear= %d, queue->size= %d, halfLife_ms= %d, maxAge_ms= %d", queue->front, queue->rear, queue->size, halfLife_ms, maxAge_ms);
-        HDMA_DEBUG_LOG("hdma_Filter: queue->base_time = %d", queue->base_time);
-		
-        for(index = queue->rear; i < queue->size; i++, index =((index - 1)%(queue->capacity)))
-        {
-            qual = queue->quality[index].data;
-            t = queue->quality[index].timestamp + queue->base_time;
-            val = ((type == HDMA_QUEUE_RSSI) ? (int8)qual : qual);
-			
-            /*  skip any values of 0xFF, these represent unknown voice or unreasonable RSSI */
-            if (type == HDMA_QUEUE_MIC && val == HDMA_UNKNOWN_QUALITY)
-            {
-                continue;
-            }
-
-            dt = MAX(timestamp - t, 0);
-            if (dt > maxAge_ms)
-            {
-                break;
-            }
-
-            NHalf = MIN((dt / halfLife_ms), 10);
-
-            w = (1 << (10 - NHalf));
-
-            /*  apply filter rounding according to the residual */
-            /*  When we filter we down weight older samples.
-             *  We divide by an extra power of two if we are in the last quarter before the next integer (i.e. residual/half life > 3/4)
-             *  and if it is between ¼ and ¾ when we divide by sqrt(2) or
-             *  to do it with integers multiply by 724 and divide by 1024 (again chose to be a bit shift). */
-            residual_x4 = 4 * (dt - NHalf * halfLife_ms);
-            if ((residual_x4 > halfLife_ms) && (residual_x4 <= 3 * halfLife_ms))
-            {
-                w = ((w * 724) >> 10);
-            }
-            else if (residual_x4 > 3 * halfLife_ms)
-            {
-                w = w >> 1;
-            }
-
-            totVal += w * val;
-            totWeight += w;
-            if(index == 0)
-            {
-                index = queue->capacity;
-            }
-        }
-    }
-    if (totWeight > 0)
-    {
-        val = ROUND(totVal,totWeight);
-    }
-    else
-    {
-        val = HDMA_INVALID;
-    }
-    return val;
-}
-
 #ifdef DEBUG_HDMA_UT
 /* Code only for UT */
 hdma_core_result_data_t Hdma_GetCoreHdmaData(void)
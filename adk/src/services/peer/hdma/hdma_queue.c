@@ -10,14 +10,140 @@
 #ifdef INCLUDE_HDMA
 
 #include <stdlib.h>
+#include <string.h>
 #include "hdma_queue.h"
 #ifndef DEBUG_HDMA_UT
 #include <panic.h>
 #endif
 #include "hdma_utils.h"
 
+/*! Weight given to a new sample in the filter sums */
+#define HDMA_FILTER_WEIGHT (1 << 12)
+/*! Number of half lives after which a sample no longer contributes to the filter */
+#define HDMA_FILTER_MAX_HALF_LIVES 16
+
+/*! 2^(-k/32) for k = 0..32, scaled by 256, used to decay by fractions of a half life */
+static const uint16 hdma_filter_decay[33] =
+{
+    256, 251, 245, 240, 235, 230, 225, 220, 215, 211, 206, 202, 197, 193, 189, 185, 181,
+    177, 173, 170, 166, 162, 159, 156, 152, 149, 146, 143, 140, 137, 134, 131, 128
+};
+
 static void hdma_ShiftQueueBaseTimestamp(queue_t* queue);
 
+/*! \brief Decays a weighted value by the time elapsed.
+
+    \param[in] x Weighted value.
+    \param[in] dt Elapsed time in ms.
+    \param[in] halfLife_ms Time over which the value halves.
+    \param[out] x * 2^(-dt/halfLife_ms)
+*/
+static int32 hdma_FilterDecay(int32 x, uint32 dt, int16 halfLife_ms)
+{
+    uint32 NHalf = dt / halfLife_ms;
+    uint32 mag = (x < 0) ? -x : x;
+
+    if (NHalf >= HDMA_FILTER_MAX_HALF_LIVES)
+    {
+        return 0;
+    }
+    mag >>= NHalf;
+    /* Round the remaining fraction of a half life to the nearest 1/32 */
+    mag = (mag * hdma_filter_decay[((((dt - NHalf * halfLife_ms) << 6) / halfLife_ms) + 1) >> 1]) >> 8;
+    return (x < 0) ? -(int32)mag : (int32)mag;
+}
+
+/*! \brief Returns the time of the sample at an index of the queue. */
+static uint32 hdma_QueueTime(queue_t *queue, uint8 index)
+{
+    return queue->quality[index].timestamp + queue->base_time;
+}
+
+/*! \brief Returns the value of the sample at an index of the queue as used by the filter. */
+static int16 hdma_QueueValue(queue_t *queue, uint8 index)
+{
+    uint8 qual = queue->quality[index].data;
+    return (queue->type == HDMA_QUEUE_RSSI) ? (int8)qual : qual;
+}
+
+/*! \brief Removes the oldest sample held by a filter from its sums.
+
+    \param[in] queue Pointer to queue.
+    \param[in] filter Filter holding at least one sample.
+*/
+static void hdma_FilterRemoveOldest(queue_t *queue, hdma_filter_t *filter)
+{
+    uint8 index = (queue->rear + queue->capacity + 1 - filter->count) % queue->capacity;
+    int16 val = hdma_QueueValue(queue, index);
+    int32 w;
+
+    filter->count--;
+    if (filter->count == 0)
+    {
+        /* Start again from exact zero so rounding errors do not build up */
+        filter->totVal = 0;
+        filter->totWeight = 0;
+    }
+    else if (!(queue->type == HDMA_QUEUE_MIC && val == HDMA_UNKNOWN_QUALITY))
+    {
+        w = hdma_FilterDecay(HDMA_FILTER_WEIGHT, hdma_QueueTime(queue, queue->rear) - hdma_QueueTime(queue, index), filter->halfLife_ms);
+        filter->totVal -= w * val;
+        filter->totWeight = MAX(filter->totWeight - w, 0);
+    }
+}
+
+/*! \brief Removes the front sample of the queue from the filters that hold it, before it is overwritten or deleted.
+
+    \param[in] queue Pointer to queue.
+*/
+static void hdma_FilterRemoveFront(queue_t *queue)
+{
+    hdma_filter_t *filter;
+
+    for (filter = queue->filter; filter < &queue->filter[HDMA_FILTER_LEVELS]; filter++)
+    {
+        if (filter->count == queue->size)
+        {
+            hdma_FilterRemoveOldest(queue, filter);
+        }
+    }
+}
+
+/*! \brief Adds a new sample to the filters, decaying the existing sums to the time of the new sample.
+
+    \param[in] queue Pointer to queue, before the sample is inserted.
+    \param[in] val Quality value
+    \param[in] timestamp Timestamp value
+*/
+static void hdma_FilterAdd(queue_t *queue, uint8 val, uint32 timestamp)
+{
+    hdma_filter_t *filter;
+    uint32 dt = 0;
+    int16 value = (queue->type == HDMA_QUEUE_RSSI) ? (int8)val : val;
+    uint8 skip = (queue->type == HDMA_QUEUE_MIC && value == HDMA_UNKNOWN_QUALITY);
+
+    if (!Hdma_IsQueueEmpty(queue))
+    {
+        dt = timestamp - hdma_QueueTime(queue, queue->rear);
+    }
+
+    for (filter = queue->filter; filter < &queue->filter[HDMA_FILTER_LEVELS]; filter++)
+    {
+        if (filter->count && dt)
+        {
+            filter->totVal = hdma_FilterDecay(filter->totVal, dt, filter->halfLife_ms);
+            filter->totWeight = hdma_FilterDecay(filter->totWeight, dt, filter->halfLife_ms);
+        }
+        /*  skip any values of 0xFF, these represent unknown voice */
+        if (!skip)
+        {
+            filter->totVal += HDMA_FILTER_WEIGHT * value;
+            filter->totWeight += HDMA_FILTER_WEIGHT;
+        }
+        filter->count++;
+    }
+}
+
 void Hdma_QueueDestroy(queue_t *q)
 {
     if (q)
@@ -35,7 +161,37 @@ void Hdma_QueueCreate(queue_t *new_queue)
         new_queue->rear = INDEX_NOT_DEFINED;
         new_queue->front = 0;
         new_queue->base_time = 0;
+        new_queue->type = HDMA_QUEUE_RSSI;
+        memset(new_queue->filter, 0, sizeof(new_queue->filter));
+    }
+}
+
+void Hdma_QueueSetFilter(queue_t *queue, const hdma_thresholds_t *thresholds)
+{
+    queue->type = thresholds->type;
+    queue->filter[HDMA_FILTER_CRITICAL].halfLife_ms = thresholds->halfLife_ms.critical;
+    queue->filter[HDMA_FILTER_CRITICAL].maxAge_ms = thresholds->maxAge_ms.critical;
+    queue->filter[HDMA_FILTER_HIGH].halfLife_ms = thresholds->halfLife_ms.high;
+    queue->filter[HDMA_FILTER_HIGH].maxAge_ms = thresholds->maxAge_ms.high;
+    queue->filter[HDMA_FILTER_LOW].halfLife_ms = thresholds->halfLife_ms.low;
+    queue->filter[HDMA_FILTER_LOW].maxAge_ms = thresholds->maxAge_ms.low;
+}
+
+int16 Hdma_QueueFilter(queue_t *queue, hdma_filter_level_t level, uint32 timestamp)
+{
+    hdma_filter_t *filter = &queue->filter[level];
+
+    /* Samples leave the filter oldest first, so only the samples that have aged out since the last call are visited */
+    while (filter->count && (timestamp - hdma_QueueTime(queue, (queue->rear + queue->capacity + 1 - filter->count) % queue->capacity)) > (uint32)filter->maxAge_ms)
+    {
+        hdma_FilterRemoveOldest(queue, filter);
+    }
+
+    if (filter->totWeight <= 0)
+    {
+        return HDMA_INVALID;
     }
+    return ROUND(filter->totVal, filter->totWeight);
 }
 
 uint8 Hdma_IsQueueFull(queue_t* queue)
@@ -66,6 +222,12 @@ void hdma_ShiftQueueBaseTimestamp(queue_t* queue)
 }
 void Hdma_QueueInsert(queue_t* queue,uint8 val, uint32 timestamp)
 {
+    if (Hdma_IsQueueFull(queue))
+    {
+        hdma_FilterRemoveFront(queue);
+    }
+    hdma_FilterAdd(queue, val, timestamp);
+
     if(Hdma_IsQueueEmpty(queue))
     {
         queue->rear = 0;
@@ -103,6 +265,7 @@ uint8 Hdma_QueueDelete(queue_t *queue, uint32 *timestamp)
     }
     else
     {
+        hdma_FilterRemoveFront(queue);
         val = queue->quality[queue->front].data;
         *timestamp = queue->quality[queue->front].timestamp + queue->base_time;
         queue->front = (queue->front + 1)%(queue->capacity);
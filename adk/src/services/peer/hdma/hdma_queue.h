@@ -32,14 +32,35 @@ typedef struct
     uint8 data; /*!<  Quality data    */
 }quality_data_t;
 
+/*! enum describing the urgency level a filter applies to */
+typedef enum {
+    HDMA_FILTER_CRITICAL=0,
+    HDMA_FILTER_HIGH,
+    HDMA_FILTER_LOW,
+    HDMA_FILTER_LEVELS
+}hdma_filter_level_t;
+
+/*! Running state of the exponential filter for one urgency level.
+    The sums hold the newest count samples of the queue, weighted as at the time of the newest sample. */
+typedef struct
+{
+    int32 totVal;   /*!<  Sum of weighted values   */
+    int32 totWeight;    /*!<  Sum of weights    */
+    int16 halfLife_ms;  /*!<  Older data is down weighted according to this half life    */
+    int16 maxAge_ms;    /*!<  Data older than this is rejected    */
+    uint8 count;    /*!<  Number of queue samples held in the sums    */
+}hdma_filter_t;
+
 typedef struct
 {
     quality_data_t quality[BUFFER_LEN];
+    hdma_filter_t filter[HDMA_FILTER_LEVELS];
     uint32 base_time;
     uint8 rear;
     uint8 front;
     uint8 size; /*!<  Current size */
     uint8 capacity; /*!<  Max_SIZE    */
+    uint8 type; /*!<  #queue_type_t of the data    */
 }queue_t;
 
 /*! \brief Creates a new queue having #quality_data_t data with fixed capacity of #BUFFER_LEN
@@ -48,6 +69,25 @@ typedef struct
 */
 void Hdma_QueueCreate(queue_t *q);
 
+/*! \brief Sets the filter settings applied to the queue for each urgency level.
+           Must be called while the queue is empty.
+
+    \param[in] queue Pointer to queue.
+    \param[in] thresholds Filter settings and type of the data held in the queue.
+*/
+void Hdma_QueueSetFilter(queue_t *q, const hdma_thresholds_t *thresholds);
+
+/*! \brief Returns the filtered value of the queue for one urgency level.
+           Samples older than the max age are dropped from the filter, so the cost is
+           independent of the number of samples held.
+
+    \param[in] queue Pointer to queue.
+    \param[in] level Urgency level whose filter settings apply.
+    \param[in] timestamp Time at which the value is wanted.
+    \param[out] Estimated data value now, or #HDMA_INVALID if there is no recent data
+*/
+int16 Hdma_QueueFilter(queue_t *q, hdma_filter_level_t level, uint32 timestamp);
+
 /*! \brief Destroy queue
 
     \param[in] queue Pointer to queue.
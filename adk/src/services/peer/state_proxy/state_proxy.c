@@ -172,6 +172,7 @@ static void stateProxy_HandleInitialState(const state_proxy_initial_state_t* ini
     state_proxy_data_t previous_state = *proxy->remote_state;
 
     *proxy->remote_state = initial_state->state;
+    stateProxy_ResetQualityDeltaReceived();
 
     stateProxy_FlagChangesInState(proxy->remote_state, &previous_state);
     stateProxy_HandleInitialPeerAncData(proxy->remote_state);
@@ -306,6 +307,10 @@ static void stateProxy_HandleMarshalledMsgChannelRxInd(PEER_SIG_MARSHALLED_MSG_C
             stateProxy_HandleRemoteAancLoggingUpdate((const STATE_PROXY_AANC_LOGGING_T *)ind->msg);
             break;
 
+        case MARSHAL_TYPE_state_proxy_quality_delta_t:
+            stateProxy_HandleRemoteQualityDelta((const state_proxy_quality_delta_t *)ind->msg);
+            break;
+
             /* connection events TBD */
         default:
             break;
@@ -452,6 +457,10 @@ static void stateProxy_HandleMessage(Task task, MessageId id, Message message)
             stateProxy_HandleIntervalTimerMicQuality();
             break;
 
+        case STATE_PROXY_INTERNAL_TIMER_QUALITY_DELTA:
+            stateProxy_HandleQualityDeltaTimer();
+            break;
+
             /* ANC update indication */
         case ANC_UPDATE_STATE_DISABLE_IND:
         case ANC_UPDATE_STATE_ENABLE_IND:
@@ -624,6 +633,7 @@ void StateProxy_SendInitialState(void)
         state_proxy_initial_state_t* msg = PanicUnlessMalloc(local_data_size);
         memset(msg, 0, local_data_size);
         memcpy(&msg->state, proxy->local_state, local_data_size);
+        stateProxy_ResetQualityDeltaSent();
 
         /* Bring up peer sig connection */
         if (!appPeerSigIsConnected())
@@ -659,6 +669,10 @@ void StateProxy_SendInitialState(void)
 void StateProxy_SetRole(bool primary)
 {
     state_proxy_task_data_t *proxy = stateProxy_GetTaskData();
+    if (proxy->is_primary != primary)
+    {
+        stateProxy_ResetQualityDeltaSent();
+    }
     proxy->is_primary = primary;
 }
 
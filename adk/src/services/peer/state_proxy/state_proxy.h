@@ -189,6 +189,25 @@ typedef struct
 } STATE_PROXY_EVENT_T;
 
 
+/*! Statistics for the quality measurements forwarded to the peer. */
+typedef struct
+{
+    /*! Number of local mic and link quality measurements queued for the peer. */
+    uint32 updates;
+
+    /*! Number of measurements replaced by a newer one in the same window. */
+    uint32 updates_coalesced;
+
+    /*! Number of quality delta messages sent. */
+    uint32 deltas_sent;
+
+    /*! Bytes of delta data sent. */
+    uint32 bytes_sent;
+
+    /*! Bytes the measurements would have used sent as whole structures. */
+    uint32 bytes_full;
+} state_proxy_peer_sync_stats_t;
+
 /*! \brief Initialise the State Proxy component.
 
     \param[in] init_task Task of the initialisation component.
@@ -236,6 +255,11 @@ void StateProxy_Stop(void);
 */
 bool StateProxy_InitialStateReceived(void);
 
+/*! \brief Get the statistics for quality measurements forwarded to the peer.
+    \param[out] stats The statistics.
+*/
+void StateProxy_GetPeerSyncStats(state_proxy_peer_sync_stats_t *stats);
+
 /* Peer state access functions */
 bool StateProxy_IsPeerInCase(void);
 bool StateProxy_IsPeerOutOfCase(void);
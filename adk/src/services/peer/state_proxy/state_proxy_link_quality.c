@@ -118,7 +118,10 @@ static void stateProxy_NotifyLinkQualityClients(state_proxy_source source, const
                                              state_proxy_event_type_link_quality,
                                              conn);
 
-        stateProxy_MarshalToConnectedPeer(MARSHAL_TYPE(STATE_PROXY_LINK_QUALITY_T), conn, sizeof(*conn));
+        if (source == state_proxy_source_local)
+        {
+            stateProxy_QueueLinkQualityDelta(conn);
+        }
     }
 }
 
@@ -14,11 +14,17 @@
 #include "state_proxy.h"
 #include "state_proxy_marshal_defs.h"
 #include "state_proxy_flags.h"
+#include "state_proxy_connection.h"
+#include "state_proxy_link_quality.h"
+#include "state_proxy_mic_quality.h"
 
 #include <marshal_common.h>
 #include <phy_state.h>
 #include <peer_signalling.h>
 #include <logging.h>
+#include <bdaddr.h>
+#include <message.h>
+#include <string.h>
 
 #include <marshal.h>
 
@@ -151,6 +157,30 @@ const marshal_type_descriptor_t marshal_type_descriptor_STATE_PROXY_AANC_LOGGING
 
 /*----------------------------------------------------------------------------*/
 
+static uint32 state_proxy_quality_delta_data_size(const void *parent,
+                                                  const marshal_member_descriptor_t *member_descriptor,
+                                                  uint32 array_element)
+{
+    const state_proxy_quality_delta_t* delta = parent;
+    UNUSED(member_descriptor);
+    UNUSED(array_element);
+    return delta->size_data;
+}
+
+/*! #state_proxy_quality_delta_t message member descriptor. */
+const marshal_member_descriptor_t state_proxy_quality_delta_member_descriptors[] =
+{
+    MAKE_MARSHAL_MEMBER(state_proxy_quality_delta_t, uint8, size_data),
+    MAKE_MARSHAL_MEMBER_ARRAY(state_proxy_quality_delta_t, uint8, data, 1),
+};
+/*! #state_proxy_quality_delta_t marshal type descriptor. */
+const marshal_type_descriptor_dynamic_t marshal_type_descriptor_state_proxy_quality_delta_t =
+    MAKE_MARSHAL_TYPE_DEFINITION_HAS_DYNAMIC_ARRAY(state_proxy_quality_delta_t,
+                                                   state_proxy_quality_delta_member_descriptors,
+                                                   state_proxy_quality_delta_data_size);
+
+/*----------------------------------------------------------------------------*/
+
 
 /*! X-Macro generate state proxy marshal type descriptor set that can be passed to a (un)marshaller
  *  to initialise it.
@@ -163,9 +193,19 @@ const marshal_type_descriptor_t * const state_proxy_marshal_type_descriptors[NUM
 #undef EXPAND_AS_TYPE_DEFINITION
 
 
+/*! \brief Can messages be marshalled to the peer.
+
+    Only the secondary forwards its state, and only while not paused and while
+    peer signalling is connected.
+*/
+static bool stateProxy_CanMarshalToPeer(void)
+{
+    return !stateProxy_Paused() && appPeerSigIsConnected() && stateProxy_IsSecondary();
+}
+
 void stateProxy_MarshalToConnectedPeer(marshal_type_t marshal_type, Message msg, size_t size)
 {
-    bool send = !stateProxy_Paused() && appPeerSigIsConnected() && stateProxy_IsSecondary();
+    bool send = stateProxy_CanMarshalToPeer();
     DEBUG_LOG("stateProxy_MarshalToConnectedPeer stateProxy_Paused=%u, appPeerSigIsConnected=%u, stateProxy_IsSecondary=%u",
             stateProxy_Paused(), appPeerSigIsConnected(), stateProxy_IsSecondary());
 
@@ -187,3 +227,306 @@ void stateProxy_MarshalToConnectedPeer(marshal_type_t marshal_type, Message msg,
                                          copy, marshal_type);
     }
 }
+
+/*----------------------------------------------------------------------------*/
+
+/*  Quality delta encoding
+    --
+    Mic and link quality are measured every 500ms. Rather than marshalling a
+    whole STATE_PROXY_MIC_QUALITY_T or state_proxy_connection_t for every
+    measurement, the measurements taken within STATE_PROXY_QUALITY_DELTA_WINDOW_MS
+    are sent together in one state_proxy_quality_delta_t.
+
+    data[0]     Bit STATE_PROXY_DELTA_MIC_QUALITY set if a mic quality byte follows.
+    [mic]       The mic quality.
+    Then one entry per measured connection until the end of data:
+    [header]    Connection slot in the upper nibble, field bits in the lower.
+    [device]    If STATE_PROXY_DELTA_DEVICE, the tp_bdaddr of the slot (8 bytes).
+    [rssi]      If STATE_PROXY_DELTA_RSSI, the new RSSI.
+    [quality]   If STATE_PROXY_DELTA_LINK_QUALITY, the new link quality.
+
+    A header with no field bits reports a measurement that did not change, so
+    the peer still sees every measurement while unchanged values cost one byte.
+    The slot identifies the connection on the sender; its device is sent the
+    first time the slot is reported after a reset or after the device changed.
+*/
+
+/*! Window over which measurements are batched into one delta. */
+#ifndef STATE_PROXY_QUALITY_DELTA_WINDOW_MS
+#define STATE_PROXY_QUALITY_DELTA_WINDOW_MS 200
+#endif
+
+#define STATE_PROXY_DELTA_MIC_QUALITY   (1 << 0)
+
+#define STATE_PROXY_DELTA_DEVICE        (1 << 0)
+#define STATE_PROXY_DELTA_RSSI          (1 << 1)
+#define STATE_PROXY_DELTA_LINK_QUALITY  (1 << 2)
+#define STATE_PROXY_DELTA_SLOT_SHIFT    4
+
+/*! Size of a tp_bdaddr in a delta: transport, type, lap (3), uap and nap (2). */
+#define STATE_PROXY_DELTA_DEVICE_SIZE   8
+
+/*! Largest delta: the field byte, the mic quality and an entry per connection. */
+#define STATE_PROXY_DELTA_MAX_SIZE      (2 + STATE_PROXY_MAX_CONNECTIONS * (1 + STATE_PROXY_DELTA_DEVICE_SIZE + 2))
+
+COMPILE_TIME_ASSERT(STATE_PROXY_MAX_CONNECTIONS <= 16, state_proxy_delta_slot_does_not_fit_nibble);
+COMPILE_TIME_ASSERT(STATE_PROXY_DELTA_MAX_SIZE <= 0xFF, state_proxy_delta_size_does_not_fit_uint8);
+
+/*! Connection values last sent or received in a delta. */
+typedef struct
+{
+    tp_bdaddr device;
+    int8 rssi;
+    uint8 link_quality;
+} state_proxy_delta_connection_t;
+
+/*! State of the quality delta encoder and decoder. */
+typedef struct
+{
+    /*! Mask of local connection slots measured since the last delta. */
+    uint16 pending_connections;
+
+    /*! TRUE if mic quality was measured since the last delta. */
+    bool pending_mic_quality;
+
+    /*! Connections as last sent to the peer, indexed by local slot. */
+    state_proxy_delta_connection_t sent[STATE_PROXY_MAX_CONNECTIONS];
+
+    /*! Devices of the peer's slots as last received. */
+    tp_bdaddr received[STATE_PROXY_MAX_CONNECTIONS];
+
+    state_proxy_peer_sync_stats_t stats;
+} state_proxy_quality_delta_state_t;
+
+static state_proxy_quality_delta_state_t state_proxy_quality_delta;
+
+static void stateProxy_StartQualityDeltaTimer(void)
+{
+    if (!state_proxy_quality_delta.pending_connections && !state_proxy_quality_delta.pending_mic_quality)
+    {
+        MessageSendLater(stateProxy_GetTask(), STATE_PROXY_INTERNAL_TIMER_QUALITY_DELTA,
+                         NULL, STATE_PROXY_QUALITY_DELTA_WINDOW_MS);
+    }
+}
+
+void stateProxy_QueueMicQualityDelta(void)
+{
+    state_proxy_quality_delta_state_t *delta = &state_proxy_quality_delta;
+
+    if (stateProxy_CanMarshalToPeer())
+    {
+        stateProxy_StartQualityDeltaTimer();
+        delta->stats.updates++;
+        delta->stats.bytes_full += sizeof(STATE_PROXY_MIC_QUALITY_T);
+        if (delta->pending_mic_quality)
+        {
+            delta->stats.updates_coalesced++;
+        }
+        delta->pending_mic_quality = TRUE;
+    }
+}
+
+void stateProxy_QueueLinkQualityDelta(const state_proxy_connection_t *conn)
+{
+    state_proxy_quality_delta_state_t *delta = &state_proxy_quality_delta;
+    uint16 slot = (uint16)(conn - stateProxy_GetLocalData()->connection);
+
+    PanicFalse(slot < STATE_PROXY_MAX_CONNECTIONS);
+
+    if (stateProxy_CanMarshalToPeer())
+    {
+        stateProxy_StartQualityDeltaTimer();
+        delta->stats.updates++;
+        delta->stats.bytes_full += sizeof(STATE_PROXY_LINK_QUALITY_T);
+        if (delta->pending_connections & (1 << slot))
+        {
+            delta->stats.updates_coalesced++;
+        }
+        delta->pending_connections |= (1 << slot);
+    }
+}
+
+static uint8 *stateProxy_WriteDeltaDevice(uint8 *p, const tp_bdaddr *device)
+{
+    *p++ = (uint8)device->transport;
+    *p++ = (uint8)device->taddr.type;
+    *p++ = (uint8)(device->taddr.addr.lap);
+    *p++ = (uint8)(device->taddr.addr.lap >> 8);
+    *p++ = (uint8)(device->taddr.addr.lap >> 16);
+    *p++ = device->taddr.addr.uap;
+    *p++ = (uint8)(device->taddr.addr.nap);
+    *p++ = (uint8)(device->taddr.addr.nap >> 8);
+    return p;
+}
+
+static const uint8 *stateProxy_ReadDeltaDevice(const uint8 *p, tp_bdaddr *device)
+{
+    device->transport = (TRANSPORT_T)p[0];
+    device->taddr.type = p[1];
+    device->taddr.addr.lap = (uint32)p[2] | ((uint32)p[3] << 8) | ((uint32)p[4] << 16);
+    device->taddr.addr.uap = p[5];
+    device->taddr.addr.nap = (uint16)(p[6] | (p[7] << 8));
+    return p + STATE_PROXY_DELTA_DEVICE_SIZE;
+}
+
+/*! \brief Encode the pending measurements.
+    \param buffer Buffer of at least STATE_PROXY_DELTA_MAX_SIZE bytes.
+    \return The number of bytes encoded.
+*/
+static uint8 stateProxy_EncodeQualityDelta(uint8 *buffer)
+{
+    state_proxy_quality_delta_state_t *delta = &state_proxy_quality_delta;
+    state_proxy_data_t *local = stateProxy_GetLocalData();
+    uint8 *p = buffer + 1;
+    uint16 slot;
+
+    buffer[0] = 0;
+    if (delta->pending_mic_quality)
+    {
+        buffer[0] |= STATE_PROXY_DELTA_MIC_QUALITY;
+        *p++ = local->mic_quality;
+    }
+
+    for (slot = 0; slot < STATE_PROXY_MAX_CONNECTIONS; slot++)
+    {
+        const state_proxy_connection_t *conn = &local->connection[slot];
+        state_proxy_delta_connection_t *sent = &delta->sent[slot];
+        uint8 *header = p;
+
+        if (!(delta->pending_connections & (1 << slot)) || BdaddrTpIsEmpty(&conn->device))
+        {
+            continue;
+        }
+
+        *p++ = (uint8)(slot << STATE_PROXY_DELTA_SLOT_SHIFT);
+        if (!BdaddrTpIsSame(&sent->device, &conn->device))
+        {
+            *header |= STATE_PROXY_DELTA_DEVICE | STATE_PROXY_DELTA_RSSI | STATE_PROXY_DELTA_LINK_QUALITY;
+            p = stateProxy_WriteDeltaDevice(p, &conn->device);
+            sent->device = conn->device;
+        }
+        else
+        {
+            if (sent->rssi != conn->rssi)
+            {
+                *header |= STATE_PROXY_DELTA_RSSI;
+            }
+            if (sent->link_quality != conn->link_quality)
+            {
+                *header |= STATE_PROXY_DELTA_LINK_QUALITY;
+            }
+        }
+        if (*header & STATE_PROXY_DELTA_RSSI)
+        {
+            *p++ = (uint8)conn->rssi;
+            sent->rssi = conn->rssi;
+        }
+        if (*header & STATE_PROXY_DELTA_LINK_QUALITY)
+        {
+            *p++ = conn->link_quality;
+            sent->link_quality = conn->link_quality;
+        }
+    }
+    return (uint8)(p - buffer);
+}
+
+void stateProxy_HandleQualityDeltaTimer(void)
+{
+    state_proxy_quality_delta_state_t *delta = &state_proxy_quality_delta;
+    uint8 buffer[STATE_PROXY_DELTA_MAX_SIZE];
+    uint8 size;
+
+    if (stateProxy_CanMarshalToPeer())
+    {
+        size = stateProxy_EncodeQualityDelta(buffer);
+        if (size > 1 || buffer[0])
+        {
+            state_proxy_quality_delta_t *msg = PanicUnlessMalloc(sizeof(*msg) + size - 1);
+            msg->size_data = size;
+            memcpy(msg->data, buffer, size);
+
+            SP_LOG_VERBOSE("stateProxy_HandleQualityDeltaTimer sending %u bytes", size);
+            appPeerSigMarshalledMsgChannelTx(stateProxy_GetTask(),
+                                             PEER_SIG_MSG_CHANNEL_STATE_PROXY,
+                                             msg, MARSHAL_TYPE(state_proxy_quality_delta_t));
+            delta->stats.deltas_sent++;
+            delta->stats.bytes_sent += size;
+        }
+    }
+    delta->pending_connections = 0;
+    delta->pending_mic_quality = FALSE;
+}
+
+void stateProxy_ResetQualityDeltaSent(void)
+{
+    memset(state_proxy_quality_delta.sent, 0, sizeof(state_proxy_quality_delta.sent));
+}
+
+void stateProxy_ResetQualityDeltaReceived(void)
+{
+    memset(state_proxy_quality_delta.received, 0, sizeof(state_proxy_quality_delta.received));
+}
+
+void stateProxy_HandleRemoteQualityDelta(const state_proxy_quality_delta_t *msg)
+{
+    state_proxy_quality_delta_state_t *delta = &state_proxy_quality_delta;
+    const uint8 *p = msg->data;
+    const uint8 *end = msg->data + msg->size_data;
+
+    if (msg->size_data == 0)
+    {
+        return;
+    }
+
+    if ((*p++ & STATE_PROXY_DELTA_MIC_QUALITY) && p < end)
+    {
+        STATE_PROXY_MIC_QUALITY_T mc = { *p++ };
+        stateProxy_HandleRemoteMicQuality(&mc);
+    }
+
+    while (p < end)
+    {
+        uint8 header = *p++;
+        uint8 slot = header >> STATE_PROXY_DELTA_SLOT_SHIFT;
+        uint8 length = ((header & STATE_PROXY_DELTA_DEVICE) ? STATE_PROXY_DELTA_DEVICE_SIZE : 0) +
+                       ((header & STATE_PROXY_DELTA_RSSI) ? 1 : 0) +
+                       ((header & STATE_PROXY_DELTA_LINK_QUALITY) ? 1 : 0);
+        const state_proxy_connection_t *conn;
+
+        if ((slot >= STATE_PROXY_MAX_CONNECTIONS) || (length > end - p))
+        {
+            DEBUG_LOG("stateProxy_HandleRemoteQualityDelta bad entry 0x%x", header);
+            return;
+        }
+        if (header & STATE_PROXY_DELTA_DEVICE)
+        {
+            p = stateProxy_ReadDeltaDevice(p, &delta->received[slot]);
+        }
+
+        /* Connections not yet known on this side are skipped, as they were when
+           sent as whole structures. */
+        conn = BdaddrTpIsEmpty(&delta->received[slot]) ? NULL :
+                    stateProxy_GetConnection(stateProxy_GetRemoteData(), &delta->received[slot]);
+        if (conn)
+        {
+            STATE_PROXY_LINK_QUALITY_T lq = *conn;
+
+            if (header & STATE_PROXY_DELTA_RSSI)
+            {
+                lq.rssi = (int8)p[0];
+            }
+            if (header & STATE_PROXY_DELTA_LINK_QUALITY)
+            {
+                lq.link_quality = p[(header & STATE_PROXY_DELTA_RSSI) ? 1 : 0];
+            }
+            stateProxy_HandleRemoteLinkQuality(&lq);
+        }
+        p += length - ((header & STATE_PROXY_DELTA_DEVICE) ? STATE_PROXY_DELTA_DEVICE_SIZE : 0);
+    }
+}
+
+void StateProxy_GetPeerSyncStats(state_proxy_peer_sync_stats_t *stats)
+{
+    PanicNull(stats);
+    *stats = state_proxy_quality_delta.stats;
+}
@@ -43,6 +43,16 @@ typedef struct state_proxy_active_handset_addr
     bdaddr active_handset_addr;
 } state_proxy_active_handset_addr_t;
 
+/*! Definition of the state proxy quality delta message.
+    Carries the microphone and link quality measurements taken on the secondary
+    within one batching window, encoding only the fields that changed since the
+    previous delta. See state_proxy_marshal_defs.c for the layout of data. */
+typedef struct state_proxy_quality_delta
+{
+    uint8 size_data;
+    uint8 data[1];
+} state_proxy_quality_delta_t;
+
 /* Create base list of marshal types the state proxy will use. */
 #define MARSHAL_TYPES_TABLE(ENTRY) \
     ENTRY(state_proxy_version_t) \
@@ -73,7 +83,8 @@ typedef struct state_proxy_active_handset_addr
     ENTRY(STATE_PROXY_ANC_DATA_T) \
     ENTRY(STATE_PROXY_AANC_DATA_T) \
     ENTRY(STATE_PROXY_AANC_LOGGING_T)\
-    ENTRY(STATE_PROXY_LEAKTHROUGH_DATA_T)
+    ENTRY(STATE_PROXY_LEAKTHROUGH_DATA_T) \
+    ENTRY(state_proxy_quality_delta_t)
 
 /* X-Macro generate enumeration of all marshal types */
 #define EXPAND_AS_ENUMERATION(type) MARSHAL_TYPE(type),
@@ -113,4 +124,33 @@ extern const marshal_type_descriptor_t * const state_proxy_marshal_type_descript
 */
 void stateProxy_MarshalToConnectedPeer(marshal_type_t marshal_type, Message msg, size_t size);
 
+/*! \brief Queue a local microphone quality measurement for the next quality delta. */
+void stateProxy_QueueMicQualityDelta(void);
+
+/*! \brief Queue a local link quality measurement for the next quality delta.
+
+    \param conn The local connection that was measured.
+*/
+void stateProxy_QueueLinkQualityDelta(const state_proxy_connection_t *conn);
+
+/*! \brief Send the queued quality measurements to the peer as a single delta. */
+void stateProxy_HandleQualityDeltaTimer(void);
+
+/*! \brief Forget the values last sent in quality deltas, so the next delta
+    carries every field in full.
+
+    Called when initial state is sent to the peer and on a role change.
+*/
+void stateProxy_ResetQualityDeltaSent(void);
+
+/*! \brief Forget the peer's connections learnt from quality deltas.
+
+    Called when initial state is received from the peer; the peer resets its
+    sent values before sending initial state, so will send them in full again.
+*/
+void stateProxy_ResetQualityDeltaReceived(void);
+
+/*! \brief Handle a quality delta message from the peer. */
+void stateProxy_HandleRemoteQualityDelta(const state_proxy_quality_delta_t *msg);
+
 #endif /* STATE_PROXY_MARSHAL_DEFS_H */
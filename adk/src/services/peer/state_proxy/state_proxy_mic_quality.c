@@ -32,7 +32,10 @@ static void stateProxy_NotifyMicQualityClients(state_proxy_source source,
                                          state_proxy_event_type_mic_quality,
                                          &mc);
 
-    stateProxy_MarshalToConnectedPeer(MARSHAL_TYPE(STATE_PROXY_MIC_QUALITY_T), &mc, sizeof(mc));
+    if (source == state_proxy_source_local)
+    {
+        stateProxy_QueueMicQualityDelta();
+    }
 }
 
 static void stateProxy_NextMeasurement(void)
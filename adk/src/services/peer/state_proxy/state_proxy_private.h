@@ -166,6 +166,7 @@ enum state_proxy_internal_messages
 {
     STATE_PROXY_INTERNAL_TIMER_MIC_QUALITY = INTERNAL_MESSAGE_BASE,
     STATE_PROXY_INTERNAL_TIMER_LINK_QUALITY,
+    STATE_PROXY_INTERNAL_TIMER_QUALITY_DELTA,
 };
 
 void stateProxy_MsgStateProxyEventClients(state_proxy_source source,
@@ -19,6 +19,7 @@
 
 #ifdef INCLUDE_AMA_LE
     #include "gatt_ama_server.h"
+    #include "gatt_server_ama.h"
 #endif
 
 #define NUMBER_OF_ADVERT_DATA_ITEMS         (1)
@@ -58,6 +59,15 @@ static le_adv_data_callback_t ama_le_advert_callback =
     .GetItem            = amaBle_GetAdvDataItems,
     .ReleaseItems       = amaBle_ReleaseAdvDataItems
 };
+
+/* AMA service data takes turns on air with the other scheduled advertisers,
+   rather than competing with them for space in a single advert */
+static const le_adv_client_schedule_t ama_le_advert_schedule =
+{
+    .priority               = 1,
+    .le_adv_interval_min    = 0,
+    .le_adv_interval_max    = 0
+};
 /********************************************************************
 * Advertising packet prototypes:
 */
@@ -85,7 +95,8 @@ static le_adv_data_item_t ama_adv_data = {0};
 /*********************************************************************/
 void AmaBle_RegisterAdvertising(void)
 {
-    LeAdvertisingManager_Register(NULL, &ama_le_advert_callback);
+    le_adv_mgr_register_handle handle = LeAdvertisingManager_Register(NULL, &ama_le_advert_callback);
+    LeAdvertisingManager_ScheduleClient(handle, &ama_le_advert_schedule);
     DEBUG_LOG("AMA LE ADV: Ama_BleRegisterAdvertising");
 }
 /********************************************************************
@@ -139,6 +150,7 @@ static le_adv_data_item_t amaBle_GetAdvDataItems(const le_adv_data_params_t * pa
 bool AmaBle_SendData(uint8* data, uint16 length)
 {
 #ifdef INCLUDE_AMA_LE
+    GattServerAma_RefreshVoiceDemand();
     return GattAmaServerSendNotification(data , length);  // Can also call GattAmaServerSendNotification()
 #else
     UNUSED(data);
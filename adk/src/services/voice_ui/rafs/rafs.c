@@ -91,6 +91,19 @@ rafs_errors_t Rafs_Read(rafs_file_t file_id, void *buf,
     return result;
 }
 
+rafs_errors_t Rafs_ReadMapped(rafs_file_t file_id, rafs_size_t num_bytes_to_read,
+                              const void **data, rafs_size_t *num_bytes_read)
+{
+    PanicNull(data);
+    PanicNull(num_bytes_read);
+    rafs_errors_t   result = Rafs_ValidateFileIdentifier(file_id);
+    if( result == RAFS_OK )
+    {
+        result = Rafs_DoReadMapped(file_id, num_bytes_to_read, data, num_bytes_read);
+    }
+    return result;
+}
+
 
 rafs_errors_t Rafs_Write(rafs_file_t file_id, const void *buf,
                          rafs_size_t num_bytes_to_write, rafs_size_t *num_bytes_written)
@@ -272,6 +285,10 @@ static void rafs_mount_free(void)
     /* Files opened for reading can simply be dropped without RAFS damage. */
     for(int i = 0 ; i < RAFS_MAX_OPEN_FILES ; i++)
     {
+        if( rafs_self->files->open_files[i] )
+        {
+            free(rafs_self->files->open_files[i]->read_ahead);
+        }
         free(rafs_self->files->open_files[i]);
     }
     free(rafs_self->files);
@@ -428,6 +445,24 @@ rafs_errors_t Rafs_IoControl(rafs_ioc_type_t type, const void *in, const rafs_si
         PanicFalse(out_length == NULL);
         result = Rafs_DoIocSetAppStatusIdleCb(in);
     }
+    else if( type == RAFS_IOC_SET_ALLOCATION_MODE )
+    {
+        PanicFalse(in != NULL);
+        PanicFalse(in_size == sizeof(rafs_allocation_mode_t));
+        PanicFalse(out == NULL);
+        PanicFalse(out_size == 0);
+        PanicFalse(out_length == NULL);
+        result = Rafs_DoIocSetAllocationMode(in);
+    }
+    else if( type == RAFS_IOC_GET_STATISTICS )
+    {
+        PanicFalse(in == NULL);
+        PanicFalse(in_size == 0);
+        PanicFalse(out != NULL);
+        PanicFalse(out_length != NULL);
+        PanicFalse(sizeof(rafs_statistics_t)<=out_size);
+        result = Rafs_DoIocGetStatistics(out, out_length);
+    }
     else
     {
         result = RAFS_UNSUPPORTED_IOC;
@@ -205,6 +205,24 @@ typedef enum {
      * out_size -   0
      * out_length - NULL
     */
+
+    RAFS_IOC_SET_ALLOCATION_MODE,   /*!< Set how extents are chosen for new file data */
+    /*!<
+     * in -         Pointer to a \see rafs_allocation_mode_t.
+     * in_size -    The value sizeof(rafs_allocation_mode_t).
+     * out -        NULL
+     * out_size -   0
+     * out_length - NULL
+    */
+
+    RAFS_IOC_GET_STATISTICS,        /*!< Get the write and stall statistics */
+    /*!<
+     * in -         NULL
+     * in_size -    0
+     * out -        Pointer to a \see rafs_statistics_t.
+     * out_size -   The value sizeof(rafs_statistics_t).
+     * out_length - Pointer to a rafs_size_t for the actual written amount.
+    */
 } rafs_ioc_type_t;
 
 typedef struct {
@@ -212,6 +230,28 @@ typedef struct {
     void    *context;           /*!< An application context pointer to pass to the appIsIdle function */
 } rafs_ioc_set_app_status_idle_cb_t;
 
+/*!
+ * The ways in which RAFS can choose the extent to store file data in.
+ */
+typedef enum {
+    rafs_allocate_longest,  /*!< Use the longest free extent (the default) */
+    rafs_allocate_append,   /*!< Append after the most recently written data, wrapping at the
+                                 end of the partition, so writes are spread over the whole flash */
+} rafs_allocation_mode_t;
+
+/*!
+ * Statistics for judging write amplification and worst case stalls.
+ */
+typedef struct {
+    uint32  file_bytes_written;     /*!< Bytes of file data written by applications */
+    uint32  flash_bytes_written;    /*!< Bytes written to flash, including FAT updates */
+    uint32  blocks_erased;          /*!< Blocks erased by compaction, format and remove */
+    uint32  extent_index_rebuilds;  /*!< Times the free extent index was rebuilt from the sector map */
+    uint32  max_work_ms;            /*!< Longest single step of background work */
+    uint32  file_bytes_read;        /*!< Bytes of file data read by applications */
+    uint32  flash_reads;            /*!< Reads of file data from flash */
+} rafs_statistics_t;
+
 /* === */
 /* API */
 /* === */
@@ -245,6 +285,24 @@ rafs_errors_t Rafs_Read(rafs_file_t file_id, void *buf,
                         rafs_size_t num_bytes_to_read, rafs_size_t *num_bytes_read);
 
 
+/*! \brief  Read from a file without copying the data.
+
+    Small reads are served from a read-ahead buffer; this returns a pointer into
+    that buffer instead of copying out of it. Fewer bytes than requested may be
+    returned before the end of the file, as data is only returned from one
+    read-ahead at a time.
+
+    \param[in]  file_id     The file id to read from.
+    \param[in]  num_bytes_to_read   The maximum number of bytes to read.
+    \param[out] data        A pointer to where to store a pointer to the data.
+    \param[out] num_bytes_read      A pointer to actual number of bytes read.
+    \return RAFS_OK or an error code.
+    \note The data is only valid until the next read, seek or close of the file.
+ */
+rafs_errors_t Rafs_ReadMapped(rafs_file_t file_id, rafs_size_t num_bytes_to_read,
+                              const void **data, rafs_size_t *num_bytes_read);
+
+
 /*! \brief  Write to a file.
     \param[in]  file_id     The file id to write to.
     \param[in]  buf         The data to be written.
@@ -11,6 +11,7 @@
 #include <csrtypes.h>
 #include <vmtypes.h>
 #include <stdlib.h>
+#include <string.h>
 #include <ra_partition_api.h>
 
 #include "rafs.h"
@@ -171,7 +172,7 @@ static bool Rafs_CompactWorkerEraseBackupFatAction(void)
 {
     DEBUG_LOG_FN_ENTRY("Rafs_CompactWorkerEraseBackupFatAction");
     rafs_instance_t *rafs_self = Rafs_GetTaskData();
-    raPartition_result ra_result = RaPartitionErase(&rafs_self->partition->part_handle,
+    raPartition_result ra_result = Rafs_PartErase(&rafs_self->partition->part_handle,
                                                     SEC_FAT*rafs_self->partition->part_info.block_size);
     if( ra_result != RA_PARTITION_RESULT_SUCCESS )
         DEBUG_LOG_ALWAYS("Rafs_CompactWorkerEraseBackupFatAction = %d", ra_result);
@@ -184,54 +185,69 @@ static void Rafs_CompactWorkerEraseBackupFat(compact_work_t *compact_msg)
 }
 
 /* STATE COMPACT_COPY_DIRENTS_TO_BACKUP */
-static bool Rafs_CompactWorkerCopyToBackupAction(void)
+static bool Rafs_CompactWorkerCopyToBackupAction(compact_copy_t *copy, uint32 max_entries, bool *done)
 {
     DEBUG_LOG_FN_ENTRY("Rafs_CompactWorkerCopyToBackupAction");
     bool ok = TRUE;
     rafs_instance_t *rafs_self = Rafs_GetTaskData();
+    uint32 limit = Rafs_GetNumberOfDirEntries();
+    uint32 copied = 0;
 
-    uint16 n_files = Rafs_CountValidFiles();
-    struct resequence *resequence = PanicUnlessMalloc(n_files * sizeof(*resequence));
-    Rafs_GetNormalisedSequenceNumbers(resequence, n_files);
+    if( copy->next_index == 0 )
+    {
+        copy->n_files = Rafs_CountValidFiles();
+        copy->resequence = PanicUnlessMalloc(copy->n_files * sizeof(*copy->resequence));
+        Rafs_GetNormalisedSequenceNumbers(copy->resequence, copy->n_files);
+        copy->next_index = 1;
+        copy->dest_index = 1;
+    }
 
     /* Copy the valid directory entries to the backup FAT */
     /* This does all the hard work of filtering out deleted files */
     /* and rebasing all the sequence counts of the files */
-    uint32 j = 1;
-    uint32 limit = Rafs_GetNumberOfDirEntries();
-    for(uint32 i = 1 ; ok && i < limit ; i++)
+    for( ; ok && copied < max_entries && copy->next_index < limit ; copy->next_index++)
     {
-        if( Rafs_DirEntryRead(PRI_FAT, rafs_self->files->scan_dir_entry, i) )
+        if( Rafs_DirEntryRead(PRI_FAT, rafs_self->files->scan_dir_entry, copy->next_index) )
         {
             if( Rafs_IsErasedData(rafs_self->files->scan_dir_entry, sizeof(*rafs_self->files->scan_dir_entry)) )
             {
+                copy->next_index = limit;
                 break;
             }
             if( !Rafs_IsDeletedEntry(rafs_self->files->scan_dir_entry) )
             {
-                rafs_self->files->scan_dir_entry->stat_counters.sequence_count = resequence[j-1].sequence_number;
-                ok = Rafs_DirEntryWrite(SEC_FAT, rafs_self->files->scan_dir_entry, j);
-                j++;
+                rafs_self->files->scan_dir_entry->stat_counters.sequence_count =
+                        copy->resequence[copy->dest_index-1].sequence_number;
+                ok = Rafs_DirEntryWrite(SEC_FAT, rafs_self->files->scan_dir_entry, copy->dest_index);
+                copy->dest_index++;
+                copied++;
             }
         }
     }
-    if( ok )
+
+    *done = ok && copy->next_index >= limit;
+    if( *done )
     {
-        PanicFalse(j-1 == n_files);
+        PanicFalse(copy->dest_index-1 == copy->n_files);
 
-        if( n_files > 0 )
+        if( copy->n_files > 0 )
         {
-            rafs_self->files->sequence_number = resequence[n_files-1].sequence_number;
+            rafs_self->files->sequence_number = copy->resequence[copy->n_files-1].sequence_number;
         }
-        rafs_self->files->free_dir_slot = j;
+        rafs_self->files->free_dir_slot = copy->dest_index;
+    }
+    if( *done || !ok )
+    {
+        free(copy->resequence);
+        memset(copy, 0, sizeof(*copy));
     }
-    free(resequence);
     return ok;
 }
 static void Rafs_CompactWorkerCopyToBackup(compact_work_t *compact_msg)
 {
-    bool ok = Rafs_CompactWorkerCopyToBackupAction();
-    Rafs_SendNextState(compact_msg, ok, COMPACT_SET_SECONDARY_AS_MASTER);
+    bool done = FALSE;
+    bool ok = Rafs_CompactWorkerCopyToBackupAction(&compact_msg->copy, RAFS_COMPACT_DIRENTS_PER_STEP, &done);
+    Rafs_SendNextState(compact_msg, ok, done ? COMPACT_SET_SECONDARY_AS_MASTER : COMPACT_COPY_DIRENTS_TO_BACKUP);
 }
 
 /* STATE COMPACT_SET_SECONDARY_AS_MASTER */
@@ -252,7 +268,7 @@ static bool Rafs_CompactWorkerErasePrimaryFatAction(void)
 {
     DEBUG_LOG_FN_ENTRY("Rafs_CompactWorkerErasePrimaryFatAction");
     rafs_instance_t *rafs_self = Rafs_GetTaskData();
-    raPartition_result ra_result = RaPartitionErase(&rafs_self->partition->part_handle,
+    raPartition_result ra_result = Rafs_PartErase(&rafs_self->partition->part_handle,
                                                     PRI_FAT*rafs_self->partition->part_info.block_size);
     if( ra_result != RA_PARTITION_RESULT_SUCCESS )
         DEBUG_LOG_ALWAYS("Rafs_CompactWorkerErasePrimaryFatAction = %d", ra_result);
@@ -265,29 +281,44 @@ static void Rafs_CompactWorkerErasePrimaryFat(compact_work_t *compact_msg)
 }
 
 /* STATE COMPACT_COPY_DIRENTS_TO_PRIMARY */
-static bool Rafs_CompactWorkerCopyToPrimaryAction(void)
+static bool Rafs_CompactWorkerCopyToPrimaryAction(compact_copy_t *copy, uint32 max_entries, bool *done)
 {
     DEBUG_LOG_FN_ENTRY("Rafs_CompactWorkerCopyToPrimaryAction");
     bool ok = TRUE;
     rafs_instance_t *rafs_self = Rafs_GetTaskData();
     uint32 limit = Rafs_GetNumberOfDirEntries();
-    for(uint32 i = 1 ; ok && i < limit ; i++)
+    uint32 copied = 0;
+
+    if( copy->next_index == 0 )
+    {
+        copy->next_index = 1;
+    }
+    for( ; ok && copied < max_entries && copy->next_index < limit ; copy->next_index++)
     {
-        if( Rafs_DirEntryRead(SEC_FAT, rafs_self->files->scan_dir_entry, i) )
+        if( Rafs_DirEntryRead(SEC_FAT, rafs_self->files->scan_dir_entry, copy->next_index) )
         {
             if( Rafs_IsErasedData(rafs_self->files->scan_dir_entry, sizeof(*rafs_self->files->scan_dir_entry)) )
             {
+                copy->next_index = limit;
                 break;
             }
-            ok = Rafs_DirEntryWrite(PRI_FAT, rafs_self->files->scan_dir_entry, i);
+            ok = Rafs_DirEntryWrite(PRI_FAT, rafs_self->files->scan_dir_entry, copy->next_index);
+            copied++;
         }
     }
+
+    *done = ok && copy->next_index >= limit;
+    if( *done || !ok )
+    {
+        memset(copy, 0, sizeof(*copy));
+    }
     return ok;
 }
 static void Rafs_CompactWorkerCopyToPrimary(compact_work_t *compact_msg)
 {
-    bool ok = Rafs_CompactWorkerCopyToPrimaryAction();
-    Rafs_SendNextState(compact_msg, ok, COMPACT_WRITE_FAT_HEADER_DATA);
+    bool done = FALSE;
+    bool ok = Rafs_CompactWorkerCopyToPrimaryAction(&compact_msg->copy, RAFS_COMPACT_DIRENTS_PER_STEP, &done);
+    Rafs_SendNextState(compact_msg, ok, done ? COMPACT_WRITE_FAT_HEADER_DATA : COMPACT_COPY_DIRENTS_TO_PRIMARY);
 }
 
 /* STATE COMPACT_WRITE_FAT_HEADER_DATA */
@@ -352,6 +383,7 @@ static void Rafs_CompactSendCompletionMessage(compact_work_t *compact_msg)
         }
         MessageSend(compact_msg->cfm_task, MESSAGE_RAFS_COMPACT_COMPLETE, cfm);
     }
+    free(compact_msg->copy.resequence);
     Rafs_FreeScanDirent();
     rafs_self->busy = FALSE;
 }
@@ -395,16 +427,20 @@ void Rafs_ProgressCompactWorker(compact_work_t *compact_msg)
 
 void Rafs_CompactRepairFromPrimary(void)
 {
+    compact_copy_t copy = { 0 };
+    bool done;
     Rafs_CompactWorkerEraseBackupFatAction();
-    Rafs_CompactWorkerCopyToBackupAction();
+    Rafs_CompactWorkerCopyToBackupAction(&copy, MAX_DIR_ENTRIES, &done);
     Rafs_CompactWorkerSecondaryIsMasterAction();
     Rafs_CompactRepairFromSecondary();
 }
 
 void Rafs_CompactRepairFromSecondary(void)
 {
+    compact_copy_t copy = { 0 };
+    bool done;
     Rafs_CompactWorkerErasePrimaryFatAction();
-    Rafs_CompactWorkerCopyToPrimaryAction();
+    Rafs_CompactWorkerCopyToPrimaryAction(&copy, MAX_DIR_ENTRIES, &done);
     Rafs_CompactWorkerWriteFatHeaderdataAction();
     Rafs_CompactWorkerSetFatsValidAction();
 }
@@ -24,10 +24,12 @@ typedef enum {
  * The steps are
  *  - start the compaction
  *  - erase the secondary FAT
- *  - copy valid directory entries from the primary FAT to the secondary FAT
+ *  - copy valid directory entries from the primary FAT to the secondary FAT,
+ *    \ref RAFS_COMPACT_DIRENTS_PER_STEP entries at a time
  *  - set secondary FAT as master
  *  - erase the primary FAT
- *  - copy valid directory entries from the secondary FAT to the primary FAT
+ *  - copy valid directory entries from the secondary FAT to the primary FAT,
+ *    \ref RAFS_COMPACT_DIRENTS_PER_STEP entries at a time
  *  - write the bulk of the FAT table (excluding first byte)
  *  - set both FATs to be in a valid state.
  */
@@ -44,10 +46,29 @@ typedef enum {
     COMPACT_LAST
 } rafs_compact_states_t;
 
+/**
+ * \brief The number of directory entries copied by each step of the
+ *        copy states, which bounds how long each step can take.
+ */
+#ifndef RAFS_COMPACT_DIRENTS_PER_STEP
+#define RAFS_COMPACT_DIRENTS_PER_STEP   8
+#endif
+
+/**
+ * \brief Progress through one of the copy states, carried between steps.
+ */
+typedef struct {
+    struct resequence      *resequence; /*!< Normalised sequence numbers of the valid files */
+    uint16                  n_files;    /*!< The number of valid files */
+    uint32                  next_index; /*!< The next directory entry to read, 0 before the first step */
+    uint32                  dest_index; /*!< Where the next valid directory entry is written */
+} compact_copy_t;
+
 typedef struct {
     Task                    cfm_task;
     rafs_compact_states_t   state;
     rafs_errors_t           status;
+    compact_copy_t          copy;
 } compact_work_t;
 
 void Rafs_ProgressCompactWorker(compact_work_t *compact_msg);
@@ -60,6 +60,23 @@ STATIC_ASSERT(sizeof(dir_entry_t)==36,dirent_t_should_be_36);
 STATIC_ASSERT(offsetof(dir_entry_t,file_size)==16,bad_filesize_offset);
 STATIC_ASSERT(offsetof(dir_entry_t,inodes)==24,bad_inodes_offset);
 
+/*!
+ * \brief The size of the read-ahead buffer of a file opened for reading.
+ */
+#ifndef RAFS_READ_AHEAD_SIZE
+#define RAFS_READ_AHEAD_SIZE    512
+#endif
+
+/*!
+ * \brief Data read ahead from one extent of a file, so that many small
+ * reads are served by a single flash read.
+ */
+typedef struct {
+    uint32              file_position;  /*!< The file position of data[0] */
+    uint32              length;         /*!< The number of valid bytes in data */
+    uint8               data[RAFS_READ_AHEAD_SIZE]; /*!< The data read ahead */
+} read_ahead_t;
+
 /*!
  * \brief Used to track the state of each opened file.
  */
@@ -71,6 +88,7 @@ typedef struct {
     uint32              extent_position;/*!< The position within the current inode */
     uint16              current_inode;  /*!< The current inode being used */
     rafs_mode_t         flags;          /*!< The flags passed to the open() call */
+    read_ahead_t       *read_ahead;     /*!< Allocated on the first read */
 } open_file_t;
 
 #endif /* RAFS_DIRENT_H */
@@ -36,12 +36,11 @@ typedef struct {
     extentfn    nextUse;    /*! Called for each consecutive sector in the same extent */
 } extentfns_t;
 
-/* Rafs_FindLongestFreeExtent context and callbacks */
-/* ------------------------------------------------ */
+/* Rafs_RebuildFreeExtentIndex context and callbacks */
+/* ------------------------------------------------- */
 typedef struct {
     inode_t     current;
-    inode_t     result;
-} find_longest;
+} index_extents;
 
 /* Rafs_CountFreeExtents context and callbacks */
 /* ------------------------------------------- */
@@ -58,9 +57,11 @@ typedef struct {
     inode_t     current;
 } get_extents;
 
-static void Rafs_FindLongestFirstFree(uint16 sector, void *ctx);
-static void Rafs_FindLongestNextFree(uint16 sector, void *ctx);
-static void Rafs_FindLongestFirstUse(uint16 sector, void *ctx);
+static void Rafs_TraverseExtents(const extentfns_t *fns, void *ctx);
+
+static void Rafs_IndexExtentsFirstFree(uint16 sector, void *ctx);
+static void Rafs_IndexExtentsNextFree(uint16 sector, void *ctx);
+static void Rafs_IndexExtentsFirstUse(uint16 sector, void *ctx);
 
 static void Rafs_CountExtentsFirstFree(uint16 sector, void *ctx);
 
@@ -70,10 +71,10 @@ static void Rafs_GetExtentsFirstUse(uint16 sector, void *ctx);
 /* Sort inodes into largest to smallest size order */
 static int Rafs_SortInodeLengthDescending(const void *pa, const void *pb);
 
-static const extentfns_t find_longest_fns = {
-    Rafs_FindLongestFirstFree,
-    Rafs_FindLongestNextFree,
-    Rafs_FindLongestFirstUse,
+static const extentfns_t index_extents_fns = {
+    Rafs_IndexExtentsFirstFree,
+    Rafs_IndexExtentsNextFree,
+    Rafs_IndexExtentsFirstUse,
     0
 };
 
@@ -92,8 +93,184 @@ static const extentfns_t get_extents_fns = {
 };
 
 
+/*
+ * Free extent index
+ * -----------------
+ */
+/*!
+ * \brief Add a free extent to the index, keeping the index sorted longest first.
+ * If the index is full, the shortest extent is dropped, and is remembered only
+ * by its length so the index can tell when it may no longer hold the longest.
+ * \param extent   The free extent to add.
+ */
+static void Rafs_FreeExtentIndexInsert(const inode_t *extent)
+{
+    free_extent_index_t *index = &Rafs_GetTaskData()->free_extents;
+    uint16 i;
+
+    if( index->count == RAFS_FREE_EXTENT_INDEX_SIZE )
+    {
+        inode_t *shortest = &index->extents[RAFS_FREE_EXTENT_INDEX_SIZE-1];
+        if( Rafs_SortInodeLengthDescending(extent, shortest) >= 0 )
+        {
+            index->unindexed_max = MAX(index->unindexed_max, extent->length);
+            return;
+        }
+        index->unindexed_max = MAX(index->unindexed_max, shortest->length);
+        index->count--;
+    }
+
+    for(i = index->count ; i > 0 && Rafs_SortInodeLengthDescending(extent, &index->extents[i-1]) < 0 ; i-- )
+    {
+        index->extents[i] = index->extents[i-1];
+    }
+    index->extents[i] = *extent;
+    index->count++;
+}
+
+/*!
+ * \brief Remove the sectors of an extent that is now in use from the index.
+ * The indexed free extent containing it is replaced by whatever free space is
+ * left before and after it.
+ * \param used     The extent that is now in use.
+ */
+static void Rafs_FreeExtentIndexAllocate(const inode_t *used)
+{
+    free_extent_index_t *index = &Rafs_GetTaskData()->free_extents;
+    uint32 used_end = (uint32)used->offset + used->length;
+
+    for(uint16 i = 0 ; i < index->count ; i++ )
+    {
+        inode_t free_space = index->extents[i];
+        uint32 free_end = (uint32)free_space.offset + free_space.length;
+
+        if( free_space.offset <= used->offset && used_end <= free_end )
+        {
+            for( ; i < index->count - 1 ; i++ )
+            {
+                index->extents[i] = index->extents[i+1];
+            }
+            index->count--;
+
+            if( used->offset > free_space.offset )
+            {
+                inode_t head = { free_space.offset, (uint16)(used->offset - free_space.offset) };
+                Rafs_FreeExtentIndexInsert(&head);
+            }
+            if( free_end > used_end )
+            {
+                inode_t tail = { (uint16)used_end, (uint16)(free_end - used_end) };
+                Rafs_FreeExtentIndexInsert(&tail);
+            }
+            return;
+        }
+        else if( free_space.offset < used_end && used->offset < free_end )
+        {
+            /* Partially overlaps a free extent, the index can't be trusted */
+            DEBUG_LOG_WARN("Rafs_FreeExtentIndexAllocate %u %u", used->offset, used->length);
+            Rafs_InvalidateFreeExtentIndex();
+            return;
+        }
+    }
+    /* Otherwise it came from an extent that isn't indexed, which can only have
+     * got shorter, so unindexed_max is still an upper bound. */
+}
+
+/*!
+ * \brief Add the sectors of an extent that is now free to the index.
+ * The free extent it joins up with is found by looking at the neighbouring
+ * sectors, and replaces any indexed extents it has swallowed.
+ * \param freed    The extent that is now free.
+ */
+static void Rafs_FreeExtentIndexRelease(const inode_t *freed)
+{
+    rafs_instance_t *rafs_self = Rafs_GetTaskData();
+    free_extent_index_t *index = &rafs_self->free_extents;
+    const uint32 num_sectors = rafs_self->sector_in_use_map_length * sizeof(rafs_self->sector_in_use_map[0]) * CHAR_BIT;
+    uint32 start = freed->offset;
+    uint32 end = (uint32)freed->offset + freed->length;
+    uint16 kept = 0;
+
+    while( start > 0 && !Rafs_SectorMapIsBlockInUse(start - 1) )
+        start--;
+    while( end < num_sectors && !Rafs_SectorMapIsBlockInUse(end) )
+        end++;
+
+    for(uint16 i = 0 ; i < index->count ; i++ )
+    {
+        if( index->extents[i].offset < start || index->extents[i].offset >= end )
+            index->extents[kept++] = index->extents[i];
+    }
+    index->count = kept;
+
+    inode_t merged = { (uint16)start, (uint16)(end - start) };
+    Rafs_FreeExtentIndexInsert(&merged);
+}
+
+static void Rafs_IndexExtentsFirstFree(uint16 sector, void *ctx)
+{
+    index_extents *p = ctx;
+    p->current.offset = sector;
+    p->current.length = 1;
+}
+static void Rafs_IndexExtentsNextFree(uint16 sector, void *ctx)
+{
+    UNUSED(sector);
+    index_extents *p = ctx;
+    p->current.length++;
+}
+static void Rafs_IndexExtentsFirstUse(uint16 sector, void *ctx)
+{
+    UNUSED(sector);
+    index_extents *p = ctx;
+    if( p->current.length > 0 )
+        Rafs_FreeExtentIndexInsert(&p->current);
+    p->current.offset = 0;
+    p->current.length = 0;
+}
+
+/*!
+ * \brief Rebuild the free extent index from the sector map.
+ */
+static void Rafs_RebuildFreeExtentIndex(void)
+{
+    rafs_instance_t *rafs_self = Rafs_GetTaskData();
+    index_extents data = { { 0, 0 } };
+
+    rafs_self->free_extents.count = 0;
+    rafs_self->free_extents.unindexed_max = 0;
+    Rafs_TraverseExtents(&index_extents_fns, &data);
+    if( data.current.length > 0 )
+        Rafs_FreeExtentIndexInsert(&data.current);
+    rafs_self->free_extents.valid = TRUE;
+    rafs_self->stats.extent_index_rebuilds++;
+}
+
+/*!
+ * \brief Get the free extent index, rebuilding it if the longest free
+ * extent might not be in it.
+ * \return the free extent index.
+ */
+static const free_extent_index_t *Rafs_GetFreeExtentIndex(void)
+{
+    free_extent_index_t *index = &Rafs_GetTaskData()->free_extents;
+    if( !index->valid ||
+        ( index->unindexed_max > 0 &&
+          ( index->count == 0 || index->extents[0].length < index->unindexed_max ) ) )
+    {
+        Rafs_RebuildFreeExtentIndex();
+    }
+    return index;
+}
+
+void Rafs_InvalidateFreeExtentIndex(void)
+{
+    Rafs_GetTaskData()->free_extents.valid = FALSE;
+}
+
 bool Rafs_AddExtentsToSectorMap(const inode_t inodes[], uint32 num)
 {
+    rafs_instance_t *rafs_self = Rafs_GetTaskData();
     bool ok = TRUE;
     for(uint32 i = 0 ; ok && i < num ; i++)
     {
@@ -112,13 +289,22 @@ bool Rafs_AddExtentsToSectorMap(const inode_t inodes[], uint32 num)
                     DEBUG_LOG_ALWAYS("Rafs_AddExtentsToSectorMap %u %u %u", i, s, page);
                 }
             }
+            if( ok && rafs_self->free_extents.valid )
+            {
+                Rafs_FreeExtentIndexAllocate(&inodes[i]);
+            }
         }
     }
+    if( !ok )
+    {
+        Rafs_InvalidateFreeExtentIndex();
+    }
     return ok;
 }
 
 bool Rafs_RemoveExtentsFromSectorMap(const inode_t inodes[], uint32 num)
 {
+    rafs_instance_t *rafs_self = Rafs_GetTaskData();
     bool ok = TRUE;
     for(uint32 i = 0 ; ok && i < num ; i++)
     {
@@ -137,8 +323,16 @@ bool Rafs_RemoveExtentsFromSectorMap(const inode_t inodes[], uint32 num)
                     DEBUG_LOG_ALWAYS("Rafs_RemoveExtentsFromSectorMap %u %u %u", i, s, page);
                 }
             }
+            if( ok && rafs_self->free_extents.valid )
+            {
+                Rafs_FreeExtentIndexRelease(&inodes[i]);
+            }
         }
     }
+    if( !ok )
+    {
+        Rafs_InvalidateFreeExtentIndex();
+    }
     return ok;
 }
 
@@ -194,39 +388,52 @@ static void Rafs_TraverseExtents(const extentfns_t *fns, void *ctx)
 }
 
 
-static void Rafs_FindLongestFirstFree(uint16 sector, void *ctx)
-{
-    find_longest *p = ctx;
-    p->current.offset = sector;
-    p->current.length = 1;
-}
-static void Rafs_FindLongestNextFree(uint16 sector, void *ctx)
+inode_t Rafs_FindLongestFreeExtent(void)
 {
-    UNUSED(sector);
-    find_longest *p = ctx;
-    p->current.length++;
+    const free_extent_index_t *index = Rafs_GetFreeExtentIndex();
+    inode_t    result = { 0, 0 };
+    if( index->count > 0 )
+        result = index->extents[0];
+    return result;
 }
-static void Rafs_FindLongestFirstUse(uint16 sector, void *ctx)
+
+inode_t Rafs_FindAppendFreeExtent(void)
 {
-    UNUSED(sector);
-    find_longest *p = ctx;
-    if( p->current.length > p->result.length )
-        p->result = p->current;
-    p->current.offset = 0;
-    p->current.length = 0;
+    rafs_instance_t *rafs_self = Rafs_GetTaskData();
+    const free_extent_index_t *index = Rafs_GetFreeExtentIndex();
+    const inode_t *after_head = NULL;
+    const inode_t *first = NULL;
+
+    if( index->count == 0 )
+    {
+        inode_t none = { 0, 0 };
+        return none;
+    }
+
+    /* A file can only have MAX_INODES extents, so only consider extents at least */
+    /* half as long as the longest; that bounds how much sooner a file can fill up. */
+    for(uint16 i = 0 ; i < index->count ; i++ )
+    {
+        const inode_t *extent = &index->extents[i];
+        if( 2u * extent->length < index->extents[0].length )
+            break;
+        if( extent->offset >= rafs_self->log_head &&
+            ( after_head == NULL || extent->offset < after_head->offset ) )
+            after_head = extent;
+        if( first == NULL || extent->offset < first->offset )
+            first = extent;
+    }
+
+    /* Continue after the last data written, or wrap round to the start */
+    return after_head ? *after_head : *first;
 }
 
-inode_t Rafs_FindLongestFreeExtent(void)
+inode_t Rafs_AllocateFreeExtent(void)
 {
-    find_longest    data = { { 0, 0 }, { 0, 0 } };
-    Rafs_TraverseExtents(&find_longest_fns, &data);
-
-    inode_t    result;
-    if( data.current.length > data.result.length )
-        result = data.current;
-    else
-        result = data.result;
-    return result;
+    rafs_instance_t *rafs_self = Rafs_GetTaskData();
+    if( rafs_self->allocation_mode == rafs_allocate_append )
+        return Rafs_FindAppendFreeExtent();
+    return Rafs_FindLongestFreeExtent();
 }
 
 
@@ -35,6 +35,26 @@ bool Rafs_RemoveExtentsFromSectorMap(const inode_t inodes[], uint32 num);
  */
 inode_t Rafs_FindLongestFreeExtent(void);
 
+/*!
+ * \brief Find the free extent that follows the most recently written file data.
+ * Only extents at least half as long as the longest are considered, and the
+ * search wraps round to the start of the partition.
+ * \return An inode representing the start and length of a writable block.
+ */
+inode_t Rafs_FindAppendFreeExtent(void);
+
+/*!
+ * \brief Find a free extent for file data according to the allocation mode.
+ * \return An inode representing the start and length of a writable block.
+ */
+inode_t Rafs_AllocateFreeExtent(void);
+
+/*!
+ * \brief Mark the free extent index as out of date, so that it is rebuilt
+ * from the sector map when next needed.
+ */
+void Rafs_InvalidateFreeExtentIndex(void);
+
 /*!
  * \brief Rafs_CountFreeExtents
  * This counts the number of free extents that currently exist.
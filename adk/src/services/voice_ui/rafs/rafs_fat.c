@@ -166,15 +166,34 @@ void Rafs_InitialiseSectorMap(void)
 
     for(uint32 i = 0 ; i < num_blocks ; i++)
         Rafs_SectorMapMarkFreeBlock(i);
+
+    Rafs_InvalidateFreeExtentIndex();
 }
 
 
 
+/*!
+ * \brief Get the sector following the last extent of a file.
+ * \param inodes    The inodes of the file.
+ * \return the sector following the file data, or 0 if the file has no data.
+ */
+static uint16 Rafs_GetExtentsEnd(const inode_t inodes[MAX_INODES])
+{
+    uint16 end = 0;
+    for(uint32 i = 0 ; i < MAX_INODES && rafs_isValidInode(&inodes[i]) ; i++)
+    {
+        end = inodes[i].offset + inodes[i].length;
+    }
+    return end;
+}
+
 void Rafs_ScanDirectory(void)
 {
     rafs_instance_t *rafs_self = Rafs_GetTaskData();
     bool ok = TRUE;
 
+    rafs_self->log_head = 0;
+
     /* Mark the two FATs as being in use */
     Rafs_AddExtentsToSectorMap(pri_root_dirent.inodes, MAX_INODES);
     Rafs_AddExtentsToSectorMap(sec_root_dirent.inodes, MAX_INODES);
@@ -199,6 +218,8 @@ void Rafs_ScanDirectory(void)
                 if( rafs_self->files->scan_dir_entry->stat_counters.sequence_count > rafs_self->files->sequence_number )
                 {
                     rafs_self->files->sequence_number = rafs_self->files->scan_dir_entry->stat_counters.sequence_count;
+                    /* The newest file so far, appending resumes after its data */
+                    rafs_self->log_head = Rafs_GetExtentsEnd(rafs_self->files->scan_dir_entry->inodes);
                 }
             }
         }
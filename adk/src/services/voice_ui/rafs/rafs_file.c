@@ -110,7 +110,7 @@ static rafs_errors_t rafs_doOpenWrite(Task task, const char *filename, rafs_mode
         *file_id = Rafs_FindFreeFileSlot();
         if( *file_id != RAFS_INVALID_FD )
         {
-            inode_t free_space = Rafs_FindLongestFreeExtent();
+            inode_t free_space = Rafs_AllocateFreeExtent();
             if( free_space.offset == 0 && free_space.length == 0 )
             {
                 /* There is no usable space to store the file */
@@ -194,6 +194,11 @@ rafs_errors_t Rafs_DoClose(rafs_file_t file_id)
                     (uint16)(of->extent_position / rafs_self->partition->part_info.block_size +
                             (of->extent_position % rafs_self->partition->part_info.block_size != 0) );
             Rafs_AddExtentsToSectorMap(&of->file_dir_entry.inodes[of->current_inode], 1);
+            if( rafs_isValidInode(&of->file_dir_entry.inodes[of->current_inode]) )
+            {
+                rafs_self->log_head = of->file_dir_entry.inodes[of->current_inode].offset +
+                                      of->file_dir_entry.inodes[of->current_inode].length;
+            }
             of->file_dir_entry.file_size = of->file_position;
             bool pri_ok = Rafs_DirEntryWrite(PRI_FAT, &of->file_dir_entry, of->directory_index);
             bool sec_ok = Rafs_DirEntryWrite(SEC_FAT, &of->file_dir_entry, of->directory_index);
@@ -203,6 +208,7 @@ rafs_errors_t Rafs_DoClose(rafs_file_t file_id)
             }
             rafs_self->files->file_is_open_for_writing = FALSE;
         }
+        free(of->read_ahead);
         free(rafs_self->files->open_files[file_id]);
         rafs_self->files->open_files[file_id] = NULL;
         rafs_self->files->num_open_files--;
@@ -210,6 +216,111 @@ rafs_errors_t Rafs_DoClose(rafs_file_t file_id)
     return result;
 }
 
+/*!
+ * \brief Move on to the next extent if the current one has been read.
+ * \param of        The open file
+ * \return the number of bytes that can be read from the current extent,
+ * or 0 at the end of the file.
+ */
+static uint32 rafs_ReadableInExtent(open_file_t *of)
+{
+    rafs_instance_t *rafs_self = Rafs_GetTaskData();
+    uint32 file_remaining = of->file_dir_entry.file_size - of->file_position;
+    uint32 extent_free = 0;
+
+    while( file_remaining > 0 )
+    {
+        inode_t inode = of->file_dir_entry.inodes[of->current_inode];
+        uint32 extent_length = inode.length * rafs_self->partition->part_info.block_size;
+        extent_free = extent_length - of->extent_position;
+        if( extent_free > 0 )
+        {
+            break;
+        }
+
+        /* The current extent has been fully read, try the next one */
+        if( of->current_inode + 1 < MAX_INODES &&
+            rafs_isValidInode(&of->file_dir_entry.inodes[of->current_inode+1]) )
+        {
+            of->current_inode++;
+            of->extent_position = 0;
+        }
+        else
+        {
+            break;
+        }
+    }
+    return MIN(file_remaining, extent_free);
+}
+
+/*!
+ * \brief Read from flash at the current position of a file
+ * \param file_id   The id, for logging
+ * \param of        The open file
+ * \param buf       Where to store the data
+ * \param len       The number of bytes to read, which must all be in the current extent
+ */
+static void rafs_ReadFromExtent(rafs_file_t file_id, open_file_t *of, void *buf, uint32 len)
+{
+    rafs_instance_t *rafs_self = Rafs_GetTaskData();
+    inode_t inode = of->file_dir_entry.inodes[of->current_inode];
+    uint32 extent_start = inode.offset * rafs_self->partition->part_info.block_size + of->extent_position;
+    raPartition_result ra_result = Rafs_PartRead(&rafs_self->partition->part_handle, extent_start, len, buf);
+    if( ra_result != RA_PARTITION_RESULT_SUCCESS )
+        DEBUG_LOG_ALWAYS("Rafs_DoRead(%d,%lu)=%d", file_id, len, ra_result);
+    rafs_self->stats.flash_reads++;
+}
+
+/*!
+ * \brief Test whether the read-ahead buffer holds the data at the current position.
+ * \param of        The open file
+ * \return TRUE if the data is buffered
+ */
+static bool rafs_IsReadAheadHit(const open_file_t *of)
+{
+    const read_ahead_t *ra = of->read_ahead;
+    return ra != NULL &&
+           of->file_position >= ra->file_position &&
+           of->file_position < ra->file_position + ra->length;
+}
+
+/*!
+ * \brief Get the data at the current position of a file from the read-ahead
+ * buffer, reading ahead from the current extent if it isn't already buffered.
+ * \param file_id   The id, for logging
+ * \param of        The open file
+ * \param readable  The number of bytes that can be read from the current extent
+ * \param available a pointer to where to store the number of bytes buffered
+ * \return a pointer to the data at the current position
+ */
+static const uint8 *rafs_GetReadAhead(rafs_file_t file_id, open_file_t *of, uint32 readable, uint32 *available)
+{
+    if( of->read_ahead == NULL )
+    {
+        of->read_ahead = PanicUnlessMalloc(sizeof(*of->read_ahead));
+        of->read_ahead->length = 0;
+    }
+
+    /* The buffer is keyed by file position, so it stays valid across seeks */
+    read_ahead_t *ra = of->read_ahead;
+    if( !rafs_IsReadAheadHit(of) )
+    {
+        ra->file_position = of->file_position;
+        ra->length = MIN(readable, RAFS_SIZEOF(ra->data));
+        rafs_ReadFromExtent(file_id, of, ra->data, ra->length);
+    }
+
+    *available = MIN(readable, ra->file_position + ra->length - of->file_position);
+    return &ra->data[of->file_position - ra->file_position];
+}
+
+static void rafs_AdvanceReadPosition(open_file_t *of, uint32 len)
+{
+    of->file_position += len;
+    of->extent_position += len;
+    Rafs_GetTaskData()->stats.file_bytes_read += len;
+}
+
 rafs_errors_t Rafs_DoRead(rafs_file_t file_id, void *buf,
                           rafs_size_t num_bytes_to_read, rafs_size_t *num_bytes_read)
 {
@@ -217,58 +328,38 @@ rafs_errors_t Rafs_DoRead(rafs_file_t file_id, void *buf,
     rafs_errors_t result = RAFS_OK;
     if( of != NULL )
     {
-        rafs_instance_t *rafs_self = Rafs_GetTaskData();
         char *buff_ptr = buf;
         *num_bytes_read = 0;
         uint32 remaining_to_read = num_bytes_to_read;
-        do {
-            inode_t inode = of->file_dir_entry.inodes[of->current_inode];
-            uint32 extent_offset = inode.offset * rafs_self->partition->part_info.block_size;
-            uint32 extent_length = inode.length * rafs_self->partition->part_info.block_size;
-            uint32 extent_start  = extent_offset + of->extent_position;
-            uint32 extent_free   = extent_length - of->extent_position;
-            uint32 file_remaining= of->file_dir_entry.file_size - of->file_position;
-            uint32 this_read_len = MIN(MIN(file_remaining,remaining_to_read),extent_free);
+        while( remaining_to_read > 0 )
+        {
+            uint32 readable = rafs_ReadableInExtent(of);
+            uint32 this_read_len;
+            if( readable == 0 )
+            {
+                result = RAFS_NO_MORE_DATA;
+                break;
+            }
 
-            if( this_read_len > 0 )
+            if( remaining_to_read >= RAFS_READ_AHEAD_SIZE && !rafs_IsReadAheadHit(of) )
             {
-                raPartition_result ra_result = Rafs_PartRead(&rafs_self->partition->part_handle,
-                                                     extent_start, this_read_len, buff_ptr);
-                if( ra_result != RA_PARTITION_RESULT_SUCCESS )
-                    DEBUG_LOG_ALWAYS("Rafs_DoRead(%d,%lu)=%d", file_id, num_bytes_to_read, ra_result);
+                /* Large reads go straight to the caller's buffer */
+                this_read_len = MIN(remaining_to_read, readable);
+                rafs_ReadFromExtent(file_id, of, buff_ptr, this_read_len);
+            }
+            else
+            {
+                uint32 available;
+                const uint8 *data = rafs_GetReadAhead(file_id, of, readable, &available);
+                this_read_len = MIN(remaining_to_read, available);
+                memcpy(buff_ptr, data, this_read_len);
             }
 
+            rafs_AdvanceReadPosition(of, this_read_len);
             buff_ptr += this_read_len;
-            of->file_position += this_read_len;
-            of->extent_position += this_read_len;
             *num_bytes_read += this_read_len;
             remaining_to_read -= this_read_len;
-
-            if( remaining_to_read > 0 )
-            {
-                /* The current extent has been fully read, try the next one */
-                if( of->current_inode < MAX_INODES)
-                {
-                    /* If it's a valid inode, then start reading from it */
-                    if( rafs_isValidInode(&of->file_dir_entry.inodes[of->current_inode+1]) )
-                    {
-                        of->current_inode++;
-                        of->extent_position = 0;
-                    }
-                    else
-                    {
-                        result = RAFS_NO_MORE_DATA;
-                    }
-                }
-                else
-                {
-                    result = RAFS_NO_MORE_DATA;
-                }
-            }
-        } while ( result == RAFS_OK &&
-                  remaining_to_read != 0 &&
-                  of->file_position < of->file_dir_entry.file_size
-                  );
+        }
 
         /* Reading some bytes at least counts as success */
         if( *num_bytes_read > 0 )
@@ -279,6 +370,31 @@ rafs_errors_t Rafs_DoRead(rafs_file_t file_id, void *buf,
     return result;
 }
 
+rafs_errors_t Rafs_DoReadMapped(rafs_file_t file_id, rafs_size_t num_bytes_to_read,
+                                const void **data, rafs_size_t *num_bytes_read)
+{
+    open_file_t *of = Rafs_FindOpenFileInstanceById(file_id);
+    rafs_errors_t result = RAFS_OK;
+    *data = NULL;
+    *num_bytes_read = 0;
+    if( of != NULL && num_bytes_to_read > 0 )
+    {
+        uint32 readable = rafs_ReadableInExtent(of);
+        if( readable == 0 )
+        {
+            result = RAFS_NO_MORE_DATA;
+        }
+        else
+        {
+            uint32 available;
+            *data = rafs_GetReadAhead(file_id, of, readable, &available);
+            *num_bytes_read = MIN(num_bytes_to_read, available);
+            rafs_AdvanceReadPosition(of, *num_bytes_read);
+        }
+    }
+    return result;
+}
+
 rafs_errors_t Rafs_DoWrite(rafs_file_t file_id, const void *buf,
                            rafs_size_t num_bytes_to_write, rafs_size_t *num_bytes_written)
 {
@@ -311,6 +427,7 @@ rafs_errors_t Rafs_DoWrite(rafs_file_t file_id, const void *buf,
             of->extent_position += this_write_len;
             *num_bytes_written += this_write_len;
             remaining_to_write -= this_write_len;
+            rafs_self->stats.file_bytes_written += this_write_len;
 
             if( remaining_to_write > 0 )
             {
@@ -320,7 +437,8 @@ rafs_errors_t Rafs_DoWrite(rafs_file_t file_id, const void *buf,
                     /* Mark the extent just filled as now in use, so the find will */
                     /* the next largest available extent */
                     Rafs_AddExtentsToSectorMap(&of->file_dir_entry.inodes[of->current_inode], 1);
-                    inode_t free_space = Rafs_FindLongestFreeExtent();
+                    rafs_self->log_head = inode.offset + inode.length;
+                    inode_t free_space = Rafs_AllocateFreeExtent();
 
                     if( free_space.offset == 0 && free_space.length == 0 )
                     {
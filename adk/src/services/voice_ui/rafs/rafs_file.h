@@ -54,6 +54,17 @@ rafs_errors_t Rafs_DoClose(rafs_file_t file_id);
 rafs_errors_t Rafs_DoRead(rafs_file_t file_id, void *buf,
                           rafs_size_t num_bytes_to_read, rafs_size_t *num_bytes_read);
 
+/*!
+ * \brief Read some data from a file, without copying it out of the read-ahead buffer.
+ * \param file_id   The id
+ * \param num_bytes_to_read     The maximum number of bytes to read
+ * \param data                  a pointer to where to store a pointer to the data
+ * \param num_bytes_read        a pointer to actual number of bytes read
+ * \return RAFS_OK or an error status
+ */
+rafs_errors_t Rafs_DoReadMapped(rafs_file_t file_id, rafs_size_t num_bytes_to_read,
+                                const void **data, rafs_size_t *num_bytes_read);
+
 /*!
  * \brief Write some data to a file.
  * \param file_id   The id
@@ -43,8 +43,8 @@ rafs_errors_t Rafs_DoFormat(const char *partition_name, rafs_format_type_t type)
 
     if( result == RAFS_OK )
     {
-        raPartition_result r1 = RaPartitionErase(&rafs_self->partition->part_handle, PRI_FAT*rafs_self->partition->part_info.block_size);
-        raPartition_result r2 = RaPartitionErase(&rafs_self->partition->part_handle, SEC_FAT*rafs_self->partition->part_info.block_size);
+        raPartition_result r1 = Rafs_PartErase(&rafs_self->partition->part_handle, PRI_FAT*rafs_self->partition->part_info.block_size);
+        raPartition_result r2 = Rafs_PartErase(&rafs_self->partition->part_handle, SEC_FAT*rafs_self->partition->part_info.block_size);
         if( r1 == RA_PARTITION_RESULT_SUCCESS &&
             r2 == RA_PARTITION_RESULT_SUCCESS )
         {
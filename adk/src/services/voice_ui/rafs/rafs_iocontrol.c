@@ -64,3 +64,20 @@ rafs_errors_t Rafs_DoIocSetAppStatusIdleCb(const rafs_ioc_set_app_status_idle_cb
     rafs_self->idler = *data;
     return result;
 }
+
+rafs_errors_t Rafs_DoIocSetAllocationMode(const rafs_allocation_mode_t *mode)
+{
+    rafs_errors_t result = RAFS_OK;
+    rafs_instance_t *rafs_self = Rafs_GetTaskData();
+    rafs_self->allocation_mode = *mode;
+    return result;
+}
+
+rafs_errors_t Rafs_DoIocGetStatistics(rafs_statistics_t *stats, rafs_size_t *out_length)
+{
+    rafs_errors_t result = RAFS_OK;
+    rafs_instance_t *rafs_self = Rafs_GetTaskData();
+    *stats = rafs_self->stats;
+    *out_length = sizeof(*stats);
+    return result;
+}
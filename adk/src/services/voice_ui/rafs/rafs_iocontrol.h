@@ -47,4 +47,21 @@ rafs_errors_t Rafs_DoIocGetFileOffset(const char *pathname, uint32 *value, rafs_
  */
 rafs_errors_t Rafs_DoIocSetAppStatusIdleCb(const rafs_ioc_set_app_status_idle_cb_t *data);
 
+/*!
+ * \brief Rafs_DoIocSetAllocationMode
+ * This sets how RAFS chooses the extent to store new file data in.
+ * \param mode      A pointer to a \see rafs_allocation_mode_t
+ * \return RAFS_OK or an error.
+ */
+rafs_errors_t Rafs_DoIocSetAllocationMode(const rafs_allocation_mode_t *mode);
+
+/*!
+ * \brief Rafs_DoIocGetStatistics
+ * This gets the write and stall statistics collected since RAFS was initialised.
+ * \param stats         A pointer to where to store the statistics.
+ * \param out_length    A pointer to where to store sizeof(rafs_statistics_t).
+ * \return RAFS_OK or an error.
+ */
+rafs_errors_t Rafs_DoIocGetStatistics(rafs_statistics_t *stats, rafs_size_t *out_length);
+
 #endif /* RAFS_IOCONTROL_H */
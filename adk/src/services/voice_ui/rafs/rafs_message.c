@@ -14,6 +14,7 @@
 #include <stdlib.h>
 #include <ra_partition_api.h>
 #include <string.h>
+#include <vm.h>
 
 #include "charger_monitor.h"
 #include "battery_monitor.h"
@@ -45,6 +46,7 @@ void Rafs_CreateCompactWorker(Task cfm_task)
     MESSAGE_MAKE(compact_msg,compact_work_t);
     compact_msg->cfm_task = cfm_task;
     compact_msg->status = RAFS_OK;
+    memset(&compact_msg->copy, 0, sizeof(compact_msg->copy));
     if( rafs_self->files->free_dir_slot > 1 )
     {
         compact_msg->state = COMPACT_START;
@@ -133,7 +135,7 @@ static uint32 Rafs_CleanNextBlock(uint32 first, uint32 last)
             {
                 rafs_instance_t *rafs_self = Rafs_GetTaskData();
                 uint32 offset = first * rafs_self->partition->part_info.block_size;
-                RaPartitionBgErase(&rafs_self->partition->part_handle, offset);
+                Rafs_PartBgErase(&rafs_self->partition->part_handle, offset);
                 break;
             }
         }
@@ -204,7 +206,7 @@ void Rafs_ProgressRemoveWorker(remove_work_t *remove_msg)
     {
         uint32  n = remove_msg->num-1;
         uint32 offset = remove_msg->inodes[n].offset * rafs_self->partition->part_info.block_size;
-        RaPartitionBgErase(&rafs_self->partition->part_handle, offset);
+        Rafs_PartBgErase(&rafs_self->partition->part_handle, offset);
         remove_msg->inodes[n].offset++;
         remove_msg->inodes[n].length--;
         if( remove_msg->inodes[n].length == 0 )
@@ -268,6 +270,9 @@ static void Rafs_IdleTimeout(void)
 static void Rafs_MessageHandler(Task task, MessageId id, Message message)
 {
     UNUSED(task);
+    rafs_instance_t *rafs_self = Rafs_GetTaskData();
+    uint32 start_ms = VmGetClock();
+
     switch ( id )
     {
         case MESSAGE_BATTERY_LEVEL_UPDATE_STATE:
@@ -306,6 +311,13 @@ static void Rafs_MessageHandler(Task task, MessageId id, Message message)
             DEBUG_LOG("Rafs_MessageHandler, id=%d unknown",id);
             break;
     }
+
+    /* Each message is one step of background work, so this is the longest */
+    /* the application can have been held up by RAFS. */
+    if( rafs_self )
+    {
+        rafs_self->stats.max_work_ms = MAX(rafs_self->stats.max_work_ms, VmGetClock() - start_ms);
+    }
 }
 
 void Rafs_MessageInit(void)
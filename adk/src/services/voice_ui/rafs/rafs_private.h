@@ -62,6 +62,24 @@ typedef struct {
     uint16              num_files_read;     /*!< Number of files returned via ReadDirectory */
 } dirinfo_t;
 
+/*!
+ * \brief The number of free extents held in the free extent index.
+ */
+#ifndef RAFS_FREE_EXTENT_INDEX_SIZE
+#define RAFS_FREE_EXTENT_INDEX_SIZE     8
+#endif
+
+/*!
+  \brief The largest free extents, kept up to date as sectors are allocated
+  so that finding space for a file does not need to scan the sector map.
+  */
+typedef struct {
+    inode_t             extents[RAFS_FREE_EXTENT_INDEX_SIZE];   /*!< Free extents, longest first */
+    uint16              count;          /*!< The number of valid entries in extents */
+    uint16              unindexed_max;  /*!< No free extent outside the index is longer than this */
+    bool                valid;          /*!< FALSE if the index must be rebuilt from the sector map */
+} free_extent_index_t;
+
 /*!
  * \brief The RAFS global instance data
  * This structure contains the global persistent data of the RAFS.
@@ -77,6 +95,11 @@ typedef struct {
     rafs_power_t        power;      /*!< The charger and battery status */
     rafs_ioc_set_app_status_idle_cb_t
                         idler;      /*!< An application callback to determine if the system is in an idle state */
+    free_extent_index_t free_extents;   /*!< Index of the largest free extents */
+    rafs_allocation_mode_t
+                        allocation_mode;/*!< How extents are chosen for file data */
+    uint16              log_head;   /*!< The sector following the most recently written file data */
+    rafs_statistics_t   stats;      /*!< Write and stall statistics */
 } rafs_instance_t;
 
 /*!
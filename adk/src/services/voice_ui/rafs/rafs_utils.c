@@ -20,6 +20,7 @@
 
 raPartition_result Rafs_PartWrite(raPartition_handle *handle, uint32 offset, uint32 length, const void * buffer)
 {
+    Rafs_GetTaskData()->stats.flash_bytes_written += length;
     return RaPartitionWrite(handle, offset, length, buffer);
 }
 
@@ -28,6 +29,18 @@ raPartition_result Rafs_PartRead(raPartition_handle *handle, uint32 offset, uint
     return RaPartitionRead(handle, offset, length, buffer);
 }
 
+raPartition_result Rafs_PartErase(raPartition_handle *handle, uint32 offset)
+{
+    Rafs_GetTaskData()->stats.blocks_erased++;
+    return RaPartitionErase(handle, offset);
+}
+
+raPartition_result Rafs_PartBgErase(raPartition_handle *handle, uint32 offset)
+{
+    Rafs_GetTaskData()->stats.blocks_erased++;
+    return RaPartitionBgErase(handle, offset);
+}
+
 /* TODO: Think about making these safe functions conform to the C11 strnxxx_s functions */
 bool safe_strncpy(char *dest, const char *src, rafs_size_t num)
 {
@@ -32,6 +32,22 @@ raPartition_result Rafs_PartWrite(raPartition_handle *handle, uint32 offset, uin
  */
 raPartition_result Rafs_PartRead(raPartition_handle *handle, uint32 offset, uint32 length, void * buffer);
 
+/*!
+ * \brief A thin wrapper for RaPartitionErase
+ * \param handle The handle of the partition
+ * \param offset Offset (absolute) within RA partition of the block to erase.
+ * \return Result of erase operation on RA partition.
+ */
+raPartition_result Rafs_PartErase(raPartition_handle *handle, uint32 offset);
+
+/*!
+ * \brief A thin wrapper for RaPartitionBgErase
+ * \param handle The handle of the partition
+ * \param offset Offset (absolute) within RA partition of the block to erase.
+ * \return Result of starting the erase operation on RA partition.
+ */
+raPartition_result Rafs_PartBgErase(raPartition_handle *handle, uint32 offset);
+
 /*!
  * \brief Copy a string in at most num characters
  * \param dest  The destination of the copy
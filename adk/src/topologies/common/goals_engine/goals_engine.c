@@ -11,6 +11,7 @@
 
 #include <logging.h>
 #include <panic.h>
+#include <vm.h>
 
 #include "goals_engine.h"
 
@@ -53,6 +54,9 @@ typedef struct {
     /*! goal_id of the queued goal. */
     goal_id     id;
 
+    /*! Number of decisions for this goal still queued in the queue Task. */
+    uint8       queued_count;
+
     /*! Id of the decision message sent by the rule that activated this goal. */
     MessageId   rule_id;
 
@@ -116,6 +120,15 @@ struct goal_set_tag {
 
     /*! Pending goals that are blocked from running immediately. */
     pending_goals_t         pending_goals;
+
+    /*! Ring of the most recent goal events. */
+    goal_timeline_entry_t   timeline[GOALS_ENGINE_TIMELINE_LEN];
+
+    /*! Index in #timeline the next event will be written to. */
+    uint8                   timeline_next;
+
+    /*! Number of events in #timeline. */
+    uint8                   timeline_count;
 };
 
 
@@ -162,6 +175,54 @@ void GoalsEngine_DebugLogGoalSet(goal_set_t goal_set)
     goalsEngine_DebugLogGoalQueue(goal_set);
 }
 
+/******************************************************************************
+ * Timeline functions
+ *****************************************************************************/
+
+/*! \brief Get a timeline entry by age, 0 being the oldest. */
+static goal_timeline_entry_t *goalsEngine_TimelineEntry(goal_set_t goal_set, unsigned age)
+{
+    unsigned oldest = (goal_set->timeline_next + GOALS_ENGINE_TIMELINE_LEN - goal_set->timeline_count) % GOALS_ENGINE_TIMELINE_LEN;
+    return &goal_set->timeline[(oldest + age) % GOALS_ENGINE_TIMELINE_LEN];
+}
+
+/*! \brief Record a goal event in the timeline, overwriting the oldest if full. */
+static void goalsEngine_RecordTimeline(goal_set_t goal_set, goal_id goal, goal_timeline_event_t event)
+{
+    goal_timeline_entry_t *entry = &goal_set->timeline[goal_set->timeline_next];
+
+    entry->time_ms = VmGetClock();
+    entry->goal = goal;
+    entry->event = event;
+
+    goal_set->timeline_next = (goal_set->timeline_next + 1) % GOALS_ENGINE_TIMELINE_LEN;
+    if (goal_set->timeline_count < GOALS_ENGINE_TIMELINE_LEN)
+    {
+        goal_set->timeline_count++;
+    }
+}
+
+/*! \brief Find how long ago a goal was started, from the timeline.
+
+    \return TRUE if the start of the goal is still in the timeline.
+*/
+static bool goalsEngine_TimeSinceStart(goal_set_t goal_set, goal_id goal, uint32 *elapsed_ms)
+{
+    unsigned age = goal_set->timeline_count;
+
+    while (age--)
+    {
+        const goal_timeline_entry_t *entry = goalsEngine_TimelineEntry(goal_set, age);
+
+        if (entry->goal == goal && entry->event == goal_timeline_started)
+        {
+            *elapsed_ms = VmGetClock() - entry->time_ms;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
 /******************************************************************************
  * Utility functions
  *****************************************************************************/
@@ -256,10 +317,35 @@ static bool goalsEngine_GoalCancelsActive(goal_set_t goal_set, goal_id goal)
     return (goal_set->goals[goal].contention == goal_contention_cancel);
 }
 
-/*! \brief Determine if a goal is a type that will cancel in-progress goals. */
+/*! \brief Determine if a goal is a type that can run alongside in-progress goals. */
 static bool goalsEngine_GoalRunsConcurrently(goal_set_t goal_set, goal_id goal)
 {
-    return (goal_set->goals[goal].contention == goal_contention_concurrent);
+    return (   (goal_set->goals[goal].contention == goal_contention_concurrent)
+            || (goal_set->goals[goal].contention == goal_contention_conflict));
+}
+
+/*! \brief Remove a goal from the lock masks of all queued goals.
+
+    May result in a queued goal being delivered to start.
+*/
+static void goalsEngine_ReleaseGoalFromLocks(goal_set_t goal_set, goal_id goal)
+{
+    FOR_ALL_QUEUED_GOALS(goal_set, i)
+    {
+        pending_goal_entry_t *entry = &goal_set->pending_goals.pending_goals[i];
+
+        if (entry->id != GOAL_ID_NONE)
+        {
+            /* If this queue slot is in-use, update its lock_mask. */
+            REMOVE_GOAL_FROM_MASK(entry->lock_mask, goal);
+            SET_LOCK_FROM_MASK(entry->lock, entry->lock_mask);
+        }
+        else if (entry->lock_mask != GOAL_MASK_NONE)
+        {
+            /* If this queue slot is not in use it should have an empty lock_mask. */
+            DEBUG_LOG("goalsEngine_ReleaseGoalFromLocks WARNING queue index %d lock_mask 0x%08lx%08lx", i, PRINT_ULL(entry->lock_mask));
+        }
+    }
 }
 
 /*! \brief Put goal onto queue to be re-delivered once wait_mask goals are cleared.
@@ -324,6 +410,9 @@ static void goalsEngine_QueueGoal(goal_set_t goal_set, MessageId rule_id, Messag
     SET_LOCK_FROM_MASK(entry->lock, entry->lock_mask);
     entry->rule_id = rule_id;
     entry->id = new_goal;
+    entry->queued_count++;
+
+    goalsEngine_RecordTimeline(goal_set, new_goal, goal_timeline_queued);
 
     if (goal_data)
     {
@@ -371,9 +460,32 @@ static void goalsEngine_DequeGoal(goal_set_t goal_set, goal_id goal)
 
             /* Remove the goal from the queue by resetting the values of this element. */
             entry->id = 0;
+            entry->queued_count = 0;
             entry->rule_id = 0;
             entry->lock_mask = 0;
             entry->lock = 0;
+
+            /* Goals that depend on this goal no longer need to wait for it,
+               unless it is also active. */
+            if (!(goal_set->active_goals_mask & GOAL_MASK(goal)))
+            {
+                goalsEngine_ReleaseGoalFromLocks(goal_set, goal);
+            }
+            break;
+        }
+    }
+}
+
+/*! \brief Account for a queued goal decision having been delivered. */
+static void goalsEngine_GoalDelivered(goal_set_t goal_set, goal_id goal)
+{
+    FOR_ALL_QUEUED_GOALS(goal_set, i)
+    {
+        pending_goal_entry_t *entry = &goal_set->pending_goals.pending_goals[i];
+
+        if (entry->id == goal && entry->queued_count)
+        {
+            entry->queued_count--;
             break;
         }
     }
@@ -581,23 +693,90 @@ static bool goalsEngine_HandleDuplicateCancellationGoal(goal_set_t goal_set, goa
     return do_not_add_duplicate_goal;
 }
 
-/*! \brief Get the concurrent goals for a goal as a bitmask. */
-static goal_mask goalsEngine_GetConcurrentGoalsMask(const goal_entry_t* goal)
+/*! \brief Convert a GOAL_ID_NONE terminated list of goals to a bitmask. */
+static goal_mask goalsEngine_GetGoalListMask(const goal_id *goals)
 {
-    const goal_id *concurrent_goals = goal->concurrent_goals;
     goal_mask goals_mask = 0;
 
-    if (concurrent_goals)
+    if (goals)
     {
-        while (*concurrent_goals != GOAL_ID_NONE)
+        while (*goals != GOAL_ID_NONE)
         {
-            goals_mask |= GOAL_MASK(*concurrent_goals);
-            concurrent_goals++;
+            goals_mask |= GOAL_MASK(*goals);
+            goals++;
         }
     }
     return goals_mask;
 }
 
+/*! \brief Get the concurrent goals for a goal as a bitmask. */
+static goal_mask goalsEngine_GetConcurrentGoalsMask(const goal_entry_t* goal)
+{
+    return goalsEngine_GetGoalListMask(goal->concurrent_goals);
+}
+
+/*! \brief Get the mask of goals that still have decisions in the queue. */
+static goal_mask goalsEngine_GetQueuedGoalsMask(goal_set_t goal_set)
+{
+    goal_mask queued_mask = GOAL_MASK_NONE;
+
+    FOR_ALL_QUEUED_GOALS(goal_set, i)
+    {
+        const pending_goal_entry_t *entry = &goal_set->pending_goals.pending_goals[i];
+
+        if (entry->queued_count)
+        {
+            queued_mask |= GOAL_MASK(entry->id);
+        }
+    }
+    return queued_mask;
+}
+
+/*! \brief Get the goals a goal depends on that have not yet completed.
+
+    A dependency that is either active or queued must complete before the
+    goal can start.
+*/
+static goal_mask goalsEngine_GetDependencyWaitMask(goal_set_t goal_set, goal_id goal)
+{
+    goal_mask depends_mask = goalsEngine_GetGoalListMask(goal_set->goals[goal].depends_on_goals);
+
+    if (depends_mask == GOAL_MASK_NONE)
+    {
+        return GOAL_MASK_NONE;
+    }
+
+    depends_mask &= (goal_set->active_goals_mask | goalsEngine_GetQueuedGoalsMask(goal_set));
+    REMOVE_GOAL_FROM_MASK(depends_mask, goal);
+
+    return depends_mask;
+}
+
+/*! \brief Get the goals a goal must wait for, given the goals currently active.
+
+    \param goal_set The goal set instance.
+    \param goal The goal being considered.
+    \param active_mask The goals to consider as blocking the goal.
+
+    \return active_mask with any goals the goal can run alongside removed.
+*/
+static goal_mask goalsEngine_GetContentionWaitMask(goal_set_t goal_set, goal_id goal, goal_mask active_mask)
+{
+    const goal_entry_t *goal_entry = &goal_set->goals[goal];
+
+    switch (goal_entry->contention)
+    {
+    case goal_contention_concurrent:
+        return active_mask & ~goalsEngine_GetConcurrentGoalsMask(goal_entry);
+
+    case goal_contention_conflict:
+        return active_mask & goalsEngine_GetGoalListMask(goal_entry->conflicting_goals);
+
+    default:
+        return active_mask;
+    }
+}
+
 
 /*! \brief Remove from the wait mask any goals with which the new
            goal *can* run concurrently.
@@ -618,12 +797,10 @@ static bool goalsEngine_HandleConcurrentGoals(goal_set_t goal_set,
 
     if (supports_concurrency)
     {
-        goal_mask mask = goalsEngine_GetConcurrentGoalsMask(goal);
-
-        *wait_mask &= ~mask;
+        *wait_mask = goalsEngine_GetContentionWaitMask(goal_set, new_goal, *wait_mask);
 
-        DEBUG_LOG("goalsEngine_HandleConcurrentGoals Ok goal:%d (0x%08lx%08lx) mask 0x%08lx%08lx",
-                    new_goal, PRINT_ULL(GOAL_MASK(new_goal)), PRINT_ULL(mask));
+        DEBUG_LOG("goalsEngine_HandleConcurrentGoals Ok goal:%d (0x%08lx%08lx) contention:%d wait_mask 0x%08lx%08lx",
+                    new_goal, PRINT_ULL(GOAL_MASK(new_goal)), goal->contention, PRINT_ULL(*wait_mask));
     }
     else
     {
@@ -661,9 +838,8 @@ static void goalsEngine_UpdateQueueMasks(goal_set_t goal_set)
                the queue was last empty by checking the associated message ID */
             if (queue_entry->rule_id)
             {
-                goal_mask wait_mask = goal_set->active_goals_mask;
                 goal_id goal = queue_entry->id;
-                const goal_entry_t *goal_entry = &goal_set->goals[goal];
+                goal_mask wait_mask = goal_set->active_goals_mask;
                 goal_mask old_mask = queue_entry->lock_mask;
 
                 DEBUG_LOG("goalsEngine_UpdateQueueMasks i %d, goal %u", i, goal);
@@ -677,15 +853,14 @@ static void goalsEngine_UpdateQueueMasks(goal_set_t goal_set)
                    goals as cancellation is either already in progress, or they have
                    been added subsequently+.
 
-                   So just remove allowed concurrent goals.
+                   So just remove allowed concurrent goals, or keep only the
+                   conflicting goals, and add any dependencies still to complete.
 
                    + The goal having been added subsequently is possibly an issue
                    but cannot be solved here.
                    */
-                if (goal_entry->contention == goal_contention_concurrent)
-                {
-                    wait_mask &= ~goalsEngine_GetConcurrentGoalsMask(goal_entry);
-                }
+                wait_mask = goalsEngine_GetContentionWaitMask(goal_set, goal, wait_mask);
+                wait_mask |= goalsEngine_GetDependencyWaitMask(goal_set, goal);
 
                 if (wait_mask != old_mask)
                 {
@@ -754,6 +929,8 @@ static void goalsEngine_StartGoal(goal_set_t goal_set, goal_id goal, Message goa
 
     goal_set->active_goals_mask |= GOAL_MASK(goal);
 
+    goalsEngine_RecordTimeline(goal_set, goal, goal_timeline_started);
+
     if (goalsEngine_IsScriptedGoal(goal_set, goal))
     {
         /* start scripted goal */
@@ -820,6 +997,7 @@ void GoalsEngine_ActivateGoal(goal_set_t goal_set, goal_id new_goal, Task task,
                          Message goal_data, size_t goal_data_size)
 {
     bool is_new_goal = (task != goal_set->pending_goals.queue_task);
+    goal_mask depends_mask;
 
     if (GOAL_ID_NONE == new_goal)
     {
@@ -832,6 +1010,7 @@ void GoalsEngine_ActivateGoal(goal_set_t goal_set, goal_id new_goal, Task task,
     if (!is_new_goal)
     {
         goal_set->pending_goals.queue_msg_count--;
+        goalsEngine_GoalDelivered(goal_set, new_goal);
     }
 
     DEBUG_LOG("GoalsEngine_AddGoal goal %d is_new_goal %d existing goals 0x%08lx%08lx", new_goal, is_new_goal, PRINT_ULL(goal_set->active_goals_mask));
@@ -845,7 +1024,9 @@ void GoalsEngine_ActivateGoal(goal_set_t goal_set, goal_id new_goal, Task task,
         return;
     }
 
-    if (goalsEngine_GoalCanRunNow(goal_set, is_new_goal))
+    depends_mask = goalsEngine_GetDependencyWaitMask(goal_set, new_goal);
+
+    if (!depends_mask && goalsEngine_GoalCanRunNow(goal_set, is_new_goal))
     {
         DEBUG_LOG("GoalsEngine_AddGoal start goal %d immediately", new_goal);
         /* no goals active, just start this new one */
@@ -889,6 +1070,12 @@ void GoalsEngine_ActivateGoal(goal_set_t goal_set, goal_id new_goal, Task task,
 
             DEBUG_LOG("GoalsEngine_AddGoal after exclusive handling, wait_mask 0x%08lx%08lx", PRINT_ULL(wait_mask));
 
+            /* a goal never starts before the goals it depends on have
+             * completed, whichever goals it can run alongside. Exclusive
+             * handling may have removed some of them from the queue. */
+            depends_mask = goalsEngine_GetDependencyWaitMask(goal_set, new_goal);
+            wait_mask |= depends_mask;
+
             /* if goal supports concurrency and the wait_mask is clear then the
              * goal can be started now
              * OR
@@ -898,8 +1085,9 @@ void GoalsEngine_ActivateGoal(goal_set_t goal_set, goal_id new_goal, Task task,
              * otherwise queue the goal on
              * completion of the remaining goals in the wait_mask
              */
-            if (   (concurrent && !wait_mask)
-                || goalsEngine_GoalCanRunNow(goal_set, is_new_goal))
+            if (   !depends_mask
+                && (   (concurrent && !wait_mask)
+                    || goalsEngine_GoalCanRunNow(goal_set, is_new_goal)))
             {
                 goalsEngine_StartGoal(goal_set, new_goal, goal_data);
             }
@@ -910,6 +1098,15 @@ void GoalsEngine_ActivateGoal(goal_set_t goal_set, goal_id new_goal, Task task,
         }
     }
 
+    /* if a queued goal was delivered but not started, goals that depend on
+     * it must not be left waiting for it */
+    if (   !is_new_goal
+        && !GoalsEngine_IsGoalActive(goal_set, new_goal)
+        && !(goalsEngine_GetQueuedGoalsMask(goal_set) & GOAL_MASK(new_goal)))
+    {
+        goalsEngine_ReleaseGoalFromLocks(goal_set, new_goal);
+    }
+
     goalsEngine_ResetPendingQueueIfEmpty(goal_set);
 }
 
@@ -922,28 +1119,24 @@ void GoalsEngine_ActivateGoal(goal_set_t goal_set, goal_id new_goal, Task task,
 */
 void GoalsEngine_ClearGoal(goal_set_t goal_set, goal_id goal)
 {
+    uint32 elapsed_ms = 0;
+
     REMOVE_GOAL_FROM_MASK(goal_set->active_goals_mask, goal);
 
-    DEBUG_LOG_INFO("GoalsEngine_ClearGoal goal %d. Mask now 0x%08lx%08lx", goal, PRINT_ULL(goal_set->active_goals_mask));
+    if (goalsEngine_TimeSinceStart(goal_set, goal, &elapsed_ms))
+    {
+        DEBUG_LOG_INFO("GoalsEngine_ClearGoal goal %d after %u ms. Mask now 0x%08lx%08lx", goal, elapsed_ms, PRINT_ULL(goal_set->active_goals_mask));
+    }
+    else
+    {
+        DEBUG_LOG_INFO("GoalsEngine_ClearGoal goal %d. Mask now 0x%08lx%08lx", goal, PRINT_ULL(goal_set->active_goals_mask));
+    }
+
+    goalsEngine_RecordTimeline(goal_set, goal, goal_timeline_cleared);
 
     /*! clear this goal from all pending goal locks,
         may result in a queued goal being delivered to start */
-    FOR_ALL_QUEUED_GOALS(goal_set, i)
-    {
-        pending_goal_entry_t *entry = &goal_set->pending_goals.pending_goals[i];
-
-        if (entry->id != GOAL_ID_NONE)
-        {
-            /* If this queue slot is in-use, update its lock_mask. */
-            REMOVE_GOAL_FROM_MASK(entry->lock_mask, goal);
-            SET_LOCK_FROM_MASK(entry->lock, entry->lock_mask);
-        }
-        else if (entry->lock_mask != GOAL_MASK_NONE)
-        {
-            /* If this queue slot is not in use it should have an empty lock_mask. */
-            DEBUG_LOG("GoalsEngine_ClearGoal WARNING queue index %d lock_mask 0x%08lx%08lx", i, PRINT_ULL(entry->lock_mask));
-        }
-    }
+    goalsEngine_ReleaseGoalFromLocks(goal_set, goal);
 }
 
 /*! \brief Get the rule event generated when a goal procedure completes. */
@@ -973,3 +1166,31 @@ rule_events_t GoalsEngine_GetGoalCompleteEvent(goal_set_t goal_set, goal_id goal
 
     return complete_event;
 }
+
+/*! \brief Get the most recent goal events from the goal set timeline. */
+unsigned GoalsEngine_GetTimeline(goal_set_t goal_set, goal_timeline_entry_t *entries, unsigned max_entries)
+{
+    unsigned count = goal_set->timeline_count;
+    unsigned skip = 0;
+
+    if (count > max_entries)
+    {
+        skip = count - max_entries;
+        count = max_entries;
+    }
+
+    PanicFalse(entries || !max_entries);
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        entries[i] = *goalsEngine_TimelineEntry(goal_set, skip + i);
+    }
+    return count;
+}
+
+/*! \brief Discard all events in the goal set timeline. */
+void GoalsEngine_ResetTimeline(goal_set_t goal_set)
+{
+    goal_set->timeline_next = 0;
+    goal_set->timeline_count = 0;
+}
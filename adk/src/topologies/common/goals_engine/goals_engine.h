@@ -37,6 +37,10 @@ An entry in the goal table can have the following properties:
 * A contention action that defines how the Goal is processed if it is activated
   while other Goal(s) are already active.
 * An optional list of Goal(s) that can run concurrently with this Goal.
+* An optional list of conflicting Goal(s). A goal with conflict contention runs
+  alongside any active Goal that is not in its conflict list.
+* An optional list of Goal(s) this Goal depends on. The Goal is not started
+  while any of them is active or queued, whatever its contention action.
 * An associated Procedure, or Scripted Procedure, that is started when the Goal
   is run.
 * An optional Rule event that is generated when the Procedure started by the
@@ -115,6 +119,10 @@ typedef enum
     /*! Queue the current goal to be run once only goals with which it
         can conncurrently run are active. */
     goal_contention_concurrent,
+
+    /*! Queue the current goal to be run once none of the goals it
+        conflicts with are active. Any other goals may run alongside it. */
+    goal_contention_conflict,
 } goal_contention_t;
 
 /*! Definition of a goal and corresponding procedure to achieve the goal.
@@ -154,8 +162,48 @@ typedef struct
 
     /*! Bitmask of goals which this goal can run concurrently with. */
     const goal_id* concurrent_goals;
+
+    /*! Goals which this goal cannot run alongside, used with
+        #goal_contention_conflict. */
+    const goal_id* conflicting_goals;
+
+    /*! Goals which must complete before this goal is started.
+        Dependencies must not be circular. */
+    const goal_id* depends_on_goals;
 } goal_entry_t;
 
+/*! Goal events recorded in the goal set timeline. */
+typedef enum
+{
+    /*! The goal was queued behind other goals. */
+    goal_timeline_queued,
+
+    /*! The procedure for the goal was started. */
+    goal_timeline_started,
+
+    /*! The goal was cleared, on completion or cancellation. */
+    goal_timeline_cleared,
+} goal_timeline_event_t;
+
+/*! An entry in the goal set timeline. */
+typedef struct
+{
+    /*! Time of the event, from VmGetClock(). */
+    uint32                  time_ms;
+
+    /*! The goal the event applies to. */
+    goal_id                 goal;
+
+    /*! What happened to the goal. */
+    goal_timeline_event_t   event;
+} goal_timeline_entry_t;
+
+/*! Number of events held in the goal set timeline. Once full the oldest
+    events are overwritten. */
+#ifndef GOALS_ENGINE_TIMELINE_LEN
+#define GOALS_ENGINE_TIMELINE_LEN (16)
+#endif
+
 /*! \brief Opaque handle to a goal set instance.
 
     This object contains both the goals table and the current state
@@ -189,6 +237,25 @@ typedef struct goal_set_tag *goal_set_t;
                      .concurrent_goals = concurrent_goals_mask, \
                      .success_event = _success_event }
 
+/*! Macro to add goal to the goals table, which can run alongside any goals
+    other than those it conflicts with. */
+#define GOAL_WITH_CONFLICTS(goal_name, proc_name, fns, exclusive_goal_name, conflicting_goals_list) \
+    [goal_name] =  { .proc = proc_name, .proc_fns = fns, \
+                     .exclusive_goal = exclusive_goal_name, \
+                     .contention = goal_contention_conflict, \
+                     .conflicting_goals = conflicting_goals_list }
+
+/*! Macro to add goal to the goals table, which can run alongside any goals
+    other than those it conflicts with, once the goals it depends on have
+    completed. */
+#define GOAL_WITH_CONFLICTS_AND_DEPENDENCIES(goal_name, proc_name, fns, exclusive_goal_name, \
+                                             conflicting_goals_list, depends_on_goals_list) \
+    [goal_name] =  { .proc = proc_name, .proc_fns = fns, \
+                     .exclusive_goal = exclusive_goal_name, \
+                     .contention = goal_contention_conflict, \
+                     .conflicting_goals = conflicting_goals_list, \
+                     .depends_on_goals = depends_on_goals_list }
+
 /*! Macro to add goal to the goals table and define an event to generate
     on timeout or failure completion. */
 #define GOAL_WITH_TIMEOUT_AND_FAIL(goal_name, proc_name, fns, exclusive_goal_name, _timeout_event, _failure_event) \
@@ -367,6 +434,14 @@ typedef struct goal_set_tag *goal_set_t;
  */
 #define CONCURRENT_GOALS_INIT(...) (const goal_id[]){__VA_ARGS__, GOAL_ID_NONE}
 
+/*! Macro for initialisation of a conflicting goals list.
+    See #CONCURRENT_GOALS_INIT. */
+#define CONFLICTING_GOALS_INIT(...) (const goal_id[]){__VA_ARGS__, GOAL_ID_NONE}
+
+/*! Macro for initialisation of a goal dependency list.
+    See #CONCURRENT_GOALS_INIT. */
+#define DEPENDS_ON_GOALS_INIT(...) (const goal_id[]){__VA_ARGS__, GOAL_ID_NONE}
+
 
 /*! Initialisation parameters for a new goal_set_t instance. */
 typedef struct {
@@ -485,6 +560,26 @@ goal_id GoalsEngine_FindGoalForProcedure(goal_set_t goal_set, procedure_id proc)
 */
 rule_events_t GoalsEngine_GetGoalCompleteEvent(goal_set_t goal_set, goal_id goal, procedure_result_t result);
 
+/*! \brief Get the most recent goal events from the goal set timeline.
+
+    The timeline records when goals are queued, started and cleared, and can
+    be used to measure how long a sequence of goals takes, for example the
+    time from a case open to a handset being connected.
+
+    \param[in] goal_set The goal set instance.
+    \param[out] entries Array to copy the events into, oldest first.
+    \param[in] max_entries Number of entries in the array.
+
+    \return The number of events copied.
+*/
+unsigned GoalsEngine_GetTimeline(goal_set_t goal_set, goal_timeline_entry_t *entries, unsigned max_entries);
+
+/*! \brief Discard all events in the goal set timeline.
+
+    \param[in] goal_set The goal set instance.
+*/
+void GoalsEngine_ResetTimeline(goal_set_t goal_set);
+
 
 /*
     Test functions
@@ -27,6 +27,9 @@ const proceduresDelayCfmTaskData procedures_delay_cfm = {Procedures_DelayCfmHand
 
 #define ProceduresDelayCfmGetTask() (&procedures_delay_cfm.task)
 
+/*! Handler offered delayed complete confirmations before they are sent. */
+static procedure_immediate_complete_func_t procedures_immediate_complete_handler;
+
 /*  \brief Internal message Ids for delayed procedure cfm functions.
 
     When sending a delayed cfm function call, the procedure id is added on to
@@ -73,6 +76,12 @@ void Procedures_DelayedCompleteCfmCallback(procedure_complete_func_t comp_fn,
 {
     PanicFalse(PROCEDURE_ID_MAX >= proc);
 
+    if (procedures_immediate_complete_handler
+        && procedures_immediate_complete_handler(comp_fn, proc, result))
+    {
+        return;
+    }
+
     MAKE_DELAY_CFM_MESSAGE(DELAY_COMPLETE_CFM);
     message->comp_fn = comp_fn;
     message->proc = proc;
@@ -80,6 +89,11 @@ void Procedures_DelayedCompleteCfmCallback(procedure_complete_func_t comp_fn,
     MessageSend(ProceduresDelayCfmGetTask(), PROC_ID_TO_DELAY_CFM_MESSAGE_ID(proc, DELAY_COMPLETE_CFM), message);
 }
 
+void Procedures_SetImmediateCompleteCfmHandler(procedure_immediate_complete_func_t handler)
+{
+    procedures_immediate_complete_handler = handler;
+}
+
 void Procedures_DelayedCancelCfmCallback(procedure_cancel_cfm_func_t cancel_fn,
                                          procedure_id proc, procedure_result_t result)
 {
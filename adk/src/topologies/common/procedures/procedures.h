@@ -113,6 +113,17 @@ typedef struct
 } procedure_fns_t;
 
 
+/*! Handler that may take a delayed complete confirmation immediately.
+
+    \param comp_fn The complete function passed to #Procedures_DelayedCompleteCfmCallback
+    \param proc Id of the Procedure that has completed
+    \param result Completion status
+
+    \return TRUE if the confirmation was handled, FALSE to deliver it by message.
+*/
+typedef bool (*procedure_immediate_complete_func_t)(procedure_complete_func_t comp_fn,
+                                                    procedure_id proc, procedure_result_t result);
+
 /*! \brief Send a delayed start confirmation.
 
     If a Procedure needs to complete within its start function it must
@@ -122,6 +133,10 @@ typedef struct
     callback directly from the #procedure_start_func_t due to the way that Goal
     completion can allow queued goals to run immediately.
 
+    If an immediate complete handler has been set and it accepts the
+    confirmation, the message is not sent. The script engine uses this to
+    chain procedures that complete within their start function.
+
     \param complete_fn The complete function that was passed in to the
                        Procedure #procedure_start_func_t
     \param proc Id of the Procedure that has completed
@@ -130,6 +145,12 @@ typedef struct
 void Procedures_DelayedCompleteCfmCallback(procedure_complete_func_t complete_fn,
                                            procedure_id proc, procedure_result_t result);
 
+/*! \brief Set the handler offered delayed complete confirmations first.
+
+    \param handler The handler, or NULL to always deliver by message.
+*/
+void Procedures_SetImmediateCompleteCfmHandler(procedure_immediate_complete_func_t handler);
+
 /*! \brief Send a delayed cancel confirmation.
 
     If a Procedure needs to call the cancel confirm function within its cancel
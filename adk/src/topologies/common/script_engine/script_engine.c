@@ -13,6 +13,7 @@
 #include <logging.h>
 
 #include <panic.h>
+#include <vm.h>
 
 
 
@@ -26,15 +27,26 @@
 #define NEXT_PROCEDURE(script)          ((SCRIPT_PROCEDURES(script)[NEXT_SCRIPT_STEP]))
 #define NEXT_PROCEDURE_DATA(script)     ((SCRIPT_PROCEDURES_DATA(script)[NEXT_SCRIPT_STEP]))
 
+#define GROUP_PROCEDURE(script, index)      ((SCRIPT_PROCEDURES(script)[NEXT_SCRIPT_STEP + (index)]))
+#define GROUP_PROCEDURE_DATA(script, index) ((SCRIPT_PROCEDURES_DATA(script)[NEXT_SCRIPT_STEP + (index)]))
+
+/*! Does a step start together with the step that follows it. */
+#define STEP_IS_PARALLEL(script, step)  (((script)->script_procs_flags != NULL) \
+                                         && ((script)->script_procs_flags[(step)] & SCRIPT_STEP_PARALLEL))
+
 #define CURRENT_SCRIPT_STEP_VALID(script)   ((NEXT_SCRIPT_STEP < SCRIPT_SIZE((script))))
 #define CURRENT_SCRIPT_STEP_IS_END(script)  ((NEXT_SCRIPT_STEP == SCRIPT_SIZE((script))))
 
+/*! Value of group_step when no step is being started. */
+#define NO_STEP_STARTING    (0xFF)
+
 /*! */
 typedef enum
 {
     script_engine_idle,
     script_engine_active,
     script_engine_cancelling,
+    script_engine_failing,
 } script_engine_state_t;
 
 /*! Context data for script engine module. */
@@ -43,9 +55,27 @@ typedef struct
     /*! Current state of the script engine module */
     script_engine_state_t state;
 
-    /*! Index of the next step to run */
+    /*! Index of the next step to run, the first step of the running group */
     int next_step;
 
+    /*! Number of steps in the running group. */
+    uint8 group_size;
+
+    /*! Index within the group of the step being started, or NO_STEP_STARTING */
+    uint8 group_step;
+
+    /*! Bitmask of the steps in the running group still to complete. */
+    uint16 running_mask;
+
+    /*! Set while #ScriptEngine_StartScript is running the script. */
+    bool starting_script;
+
+    /*! Procedure ids of the steps in the running group, from their start confirmations. */
+    procedure_id group_procs[SCRIPT_ENGINE_MAX_PARALLEL_STEPS];
+
+    /*! Combined result of the steps in the running group. */
+    procedure_result_t group_result;
+
     /*! Pointer to the currently running script. */
     const procedure_script_t* script;
 
@@ -54,12 +84,18 @@ typedef struct
 
     /*! Client that started the current script. */
     Task script_client;
-    
+
     /*! Client procedure callbacks to call when a script starts, completes
         or is cancelled. */
     procedure_start_cfm_func_t start_fn;
     procedure_complete_func_t complete_fn;
     procedure_cancel_cfm_func_t cancel_fn;
+
+    /*! Time the running script was started. */
+    uint32 start_time_ms;
+
+    /*! Number of steps of the running script that completed within their start function. */
+    uint8 chained_steps;
 } ScriptEngineTaskData;
 
 
@@ -87,10 +123,160 @@ static void scriptEngine_EngineReset(void)
     ScriptEngineTaskData* td = TwsTopProcScriptGetTaskData();
     td->state = script_engine_idle;
     td->next_step = 0;
+    td->group_size = 0;
+    td->group_step = NO_STEP_STARTING;
+    td->running_mask = 0;
     td->script = NULL;
 }
 
-/*! \brief Run the next procedure in a script
+/*! \brief End the script and inform the client it has completed.
+
+    If the script completes while it is still being started, the client
+    is informed by message as it cannot handle completion from within the
+    start of the script.
+*/
+static void scriptEngine_Complete(procedure_result_t result)
+{
+    ScriptEngineTaskData* td = TwsTopProcScriptGetTaskData();
+
+    DEBUG_LOG("scriptEngine_Complete script %p result %u in %u ms, %u of %u steps chained",
+              td->script, result, VmGetClock() - td->start_time_ms,
+              td->chained_steps, SCRIPT_SIZE(td->script));
+
+    scriptEngine_EngineReset();
+
+    if (td->starting_script)
+    {
+        Procedures_DelayedCompleteCfmCallback(td->complete_fn, td->proc, result);
+    }
+    else
+    {
+        td->complete_fn(td->proc, result);
+    }
+}
+
+/*! \brief Find the index within the running group of a procedure.
+
+    A procedure is identified by the id from its start confirmation. If that
+    is not known the step being started, or the only running step, is used.
+
+    \return The index, or SCRIPT_ENGINE_MAX_PARALLEL_STEPS if not found.
+*/
+static uint8 scriptEngine_FindGroupStep(procedure_id proc)
+{
+    ScriptEngineTaskData* td = TwsTopProcScriptGetTaskData();
+    uint8 index;
+
+    if (td->group_step != NO_STEP_STARTING)
+    {
+        return td->group_step;
+    }
+
+    for (index = 0; index < td->group_size; index++)
+    {
+        if ((td->running_mask & (1 << index)) && td->group_procs[index] == proc)
+        {
+            return index;
+        }
+    }
+
+    if (td->group_size == 1 && td->running_mask)
+    {
+        return 0;
+    }
+    return SCRIPT_ENGINE_MAX_PARALLEL_STEPS;
+}
+
+/*! \brief Record that a step in the running group has completed.
+
+    \return TRUE if all the steps in the group have now completed.
+*/
+static bool scriptEngine_StepComplete(procedure_id proc, procedure_result_t result)
+{
+    ScriptEngineTaskData* td = TwsTopProcScriptGetTaskData();
+    uint8 index = scriptEngine_FindGroupStep(proc);
+
+    if (index == SCRIPT_ENGINE_MAX_PARALLEL_STEPS)
+    {
+        DEBUG_LOG("scriptEngine_StepComplete proc %d not running, ignored", proc);
+        return FALSE;
+    }
+
+    td->running_mask &= ~(1 << index);
+
+    if (result != procedure_result_success && td->group_result == procedure_result_success)
+    {
+        td->group_result = result;
+    }
+
+    return (td->running_mask == 0);
+}
+
+/*! \brief Cancel all the steps in the running group that have not completed. */
+static void scriptEngine_CancelRunningSteps(void)
+{
+    ScriptEngineTaskData* td = TwsTopProcScriptGetTaskData();
+    uint16 running_mask = td->running_mask;
+    uint8 index;
+
+    for (index = 0; index < td->group_size; index++)
+    {
+        if (running_mask & (1 << index))
+        {
+            DEBUG_LOG("scriptEngine_CancelRunningSteps step %u", NEXT_SCRIPT_STEP + index);
+            GROUP_PROCEDURE(td->script, index)->proc_cancel_fn(scriptEngine_ProcCancelCfm);
+        }
+    }
+}
+
+/*! \brief Start the next group of steps in a script.
+
+    Starts the step at NEXT_SCRIPT_STEP along with any following steps it
+    is marked to run in parallel with. In a script flagged with
+    #SCRIPT_CHAIN_STEPS, steps that complete within their start function are
+    recorded as complete before this function returns.
+*/
+static void scriptEngine_StartGroup(void)
+{
+    ScriptEngineTaskData* td = TwsTopProcScriptGetTaskData();
+    bool parallel;
+
+    td->group_size = 0;
+    td->running_mask = 0;
+    td->group_result = procedure_result_success;
+
+    do
+    {
+        uint8 index = td->group_size++;
+        int step = NEXT_SCRIPT_STEP + index;
+
+        PanicFalse(index < SCRIPT_ENGINE_MAX_PARALLEL_STEPS);
+
+        parallel = STEP_IS_PARALLEL(td->script, step) && ((step + 1) < SCRIPT_SIZE(td->script));
+
+        td->group_procs[index] = 0;
+        td->running_mask |= (1 << index);
+        td->group_step = index;
+
+        DEBUG_LOG("scriptEngine_StartGroup calling start %p", GROUP_PROCEDURE(td->script, index)->proc_start_fn);
+        GROUP_PROCEDURE(td->script, index)->proc_start_fn(td->script_client,
+                                                         scriptEngine_ProcStartCfm,
+                                                         scriptEngine_ProcCompleteCfm,
+                                                         GROUP_PROCEDURE_DATA(td->script, index));
+        td->group_step = NO_STEP_STARTING;
+
+        if (!(td->running_mask & (1 << index)))
+        {
+            td->chained_steps++;
+        }
+
+    } while (parallel && td->group_result == procedure_result_success);
+}
+
+/*! \brief Run the script from the next step
+
+    Groups of steps are started in turn until one does not complete within
+    its start function, in which case the script continues when it completes.
 
     If the end of the script has been reached inform the client that started
     the script by calling the complete callback that it passed in.
@@ -100,21 +286,42 @@ static void scriptEngine_StartCurrentStep(void)
 {
     ScriptEngineTaskData* td = TwsTopProcScriptGetTaskData();
 
-    if (CURRENT_SCRIPT_STEP_VALID(td->script))
+    while (CURRENT_SCRIPT_STEP_VALID(td->script))
     {
-        DEBUG_LOG("scriptEngine_StartCurrentStep calling start %p", NEXT_PROCEDURE(td->script)->proc_start_fn);
-        NEXT_PROCEDURE(td->script)->proc_start_fn(td->script_client,
-                                                 scriptEngine_ProcStartCfm,
-                                                 scriptEngine_ProcCompleteCfm,
-                                                 NEXT_PROCEDURE_DATA(td->script));
+        scriptEngine_StartGroup();
+
+        if (td->group_result != procedure_result_success)
+        {
+            if (td->running_mask)
+            {
+                /* A step failed while others in its group are still running */
+                td->state = script_engine_failing;
+                scriptEngine_CancelRunningSteps();
+            }
+            else
+            {
+                DEBUG_LOG("scriptEngine_StartCurrentStep step %u ended script, result %u",
+                          td->next_step, td->group_result);
+                scriptEngine_Complete(td->group_result);
+            }
+            return;
+        }
+
+        if (td->running_mask)
+        {
+            /* wait for the running steps to complete */
+            return;
+        }
+
+        NEXT_SCRIPT_STEP += td->group_size;
     }
-    else if (CURRENT_SCRIPT_STEP_IS_END(td->script))
+
+    if (CURRENT_SCRIPT_STEP_IS_END(td->script))
     {
         DEBUG_LOG("scriptEngine_StartCurrentStep script %p success", td->script);
 
         /* script finished with no failures, inform client */
-        scriptEngine_EngineReset();
-        td->complete_fn(td->proc, procedure_result_success);
+        scriptEngine_Complete(procedure_result_success);
     }
     else
     {
@@ -132,8 +339,6 @@ static void scriptEngine_StartCurrentStep(void)
     \note We expect all procedures to at least start successfully - so this
     will panic if the procedure fails to start.
 
-    \todo Future use expected to track in-progress procedures for smarter goal resolution
-
     \param[in] proc Id of the procedure that was started.
     \param[in] result Result code the procedure returned after starting.
 */
@@ -142,25 +347,64 @@ static void scriptEngine_ProcStartCfm(procedure_id proc, procedure_result_t resu
     ScriptEngineTaskData* td = TwsTopProcScriptGetTaskData();
 
     DEBUG_LOG("scriptEngine_EngineStartCfm script %p proc %d, result %u", td->script, proc, result);
-    
+
     if (result != procedure_result_success)
     {
         DEBUG_LOG("scriptEngine_EngineStartCfm step %u for script %p failed to start",
                    td->next_step, td->script);
         Panic();
     }
+
+    /* remember which procedure the step is, so its completion can be matched
+       to it when running steps in parallel */
+    if (td->group_step != NO_STEP_STARTING)
+    {
+        td->group_procs[td->group_step] = proc;
+    }
+}
+
+/*! \brief Take the delayed completion of a step immediately.
+
+    Procedures must delay completion from within their start function, but
+    that delay only exists to protect the goals engine. When a step of a
+    script flagged with #SCRIPT_CHAIN_STEPS completes while it is being
+    started, record it here and the script will move on once the start
+    function has returned.
+
+    \return TRUE if the completion was for a step being started.
+*/
+static bool scriptEngine_ImmediateCompleteCfm(procedure_complete_func_t comp_fn,
+                                              procedure_id proc, procedure_result_t result)
+{
+    ScriptEngineTaskData* td = TwsTopProcScriptGetTaskData();
+
+    if (   comp_fn != scriptEngine_ProcCompleteCfm
+        || td->state != script_engine_active
+        || td->group_step == NO_STEP_STARTING
+        || !(td->script->script_flags & SCRIPT_CHAIN_STEPS))
+    {
+        return FALSE;
+    }
+
+    DEBUG_LOG("scriptEngine_ImmediateCompleteCfm proc %d, result %u", proc, result);
+
+    td->group_procs[td->group_step] = proc;
+    scriptEngine_StepComplete(proc, result);
+
+    return TRUE;
 }
 
 /*! \brief Procedure completion callback for a procedure within a script
 
-    Process the completion of the given procedure and then run the next
-    procedure in the script.
+    Process the completion of the given procedure and then, once all the
+    steps in its group are complete, run the next procedure in the script.
 
     If this was the last procedure in the script call the client complete
     callback to inform the client the script is finished.
 
     If the procedure completed with an error pass this back to the client in
-    the client complete callback and end processing of the current script.
+    the client complete callback and end processing of the current script,
+    cancelling any other steps in the group first.
 
     \param[in] proc Id of the procedure that has completed.
     \param[in] result Result code the procedure returned after completion.
@@ -173,33 +417,35 @@ static void scriptEngine_ProcCompleteCfm(procedure_id proc, procedure_result_t r
     /* Only process if we're active */
     if (td->state == script_engine_active)
     {
-        switch (result)
+        bool group_complete = scriptEngine_StepComplete(proc, result);
+
+        switch (td->group_result)
         {
             case procedure_result_success:
-                NEXT_SCRIPT_STEP++;
-                scriptEngine_StartCurrentStep();
-                return;
-
-            case procedure_result_timeout:
+                if (group_complete)
                 {
-                    /* Script step timed out. Finish the script and forward the timeout status. 
-                       If there is an associted timeout event the goals handler will
-                       generate this */
-                    DEBUG_LOG("scriptEngine_EngineCompleteCfm step %u timed out, ending script", td->next_step);
-
-                    scriptEngine_EngineReset();
-                    td->complete_fn(td->proc, procedure_result_timeout);
+                    NEXT_SCRIPT_STEP += td->group_size;
+                    scriptEngine_StartCurrentStep();
                 }
                 return;
 
+            case procedure_result_timeout:
             case procedure_result_failed:
                 {
-                    /* Script step failed. Finish the script and forward the failed status. 
-                       If there is an associted failed event the goals handler will
-                       generate this else panics */
-                    DEBUG_LOG("scriptEngine_EngineCompleteCfm step %u failed", td->next_step);
-                    scriptEngine_EngineReset();
-                    td->complete_fn(td->proc, procedure_result_failed);
+                    /* Script step timed out or failed. Finish the script and forward the status.
+                       If there is an associated event the goals handler will generate this */
+                    DEBUG_LOG("scriptEngine_EngineCompleteCfm step %u ended script, result %u",
+                              td->next_step, td->group_result);
+
+                    if (group_complete)
+                    {
+                        scriptEngine_Complete(td->group_result);
+                    }
+                    else
+                    {
+                        td->state = script_engine_failing;
+                        scriptEngine_CancelRunningSteps();
+                    }
                 }
                 return;
         }
@@ -213,12 +459,16 @@ static void scriptEngine_ProcCompleteCfm(procedure_id proc, procedure_result_t r
 
 /*! \brief Procedure cancel callback for a procedure within a script
 
-    Inform the client the procedure was cancelled by calling the client
-    cancel confirm callback and passing through thre result code.
+    Once every running step has confirmed cancellation, inform the client by
+    calling the client cancel confirm callback and passing through the result
+    code.
 
     Cancelling a procedure within a script is treated as the same as cancelling
     the entire script, so end processing of the current script.
 
+    If the steps were cancelled because another step in their group failed,
+    the client is informed of the failure through the complete callback.
+
     \note A procedure that is part of a script should only ever be cancelled
     by calling #ScriptEngine_CancelScript.
 
@@ -228,10 +478,32 @@ static void scriptEngine_ProcCompleteCfm(procedure_id proc, procedure_result_t r
 static void scriptEngine_ProcCancelCfm(procedure_id proc, procedure_result_t result)
 {
     ScriptEngineTaskData* td = TwsTopProcScriptGetTaskData();
+    uint8 index = scriptEngine_FindGroupStep(proc);
     DEBUG_LOG("scriptEngine_EngineCancelCfm proc %d, result %u", proc, result);
-    
-    PanicFalse(td->state == script_engine_cancelling);
-    
+
+    PanicFalse(td->state == script_engine_cancelling || td->state == script_engine_failing);
+
+    if (index < SCRIPT_ENGINE_MAX_PARALLEL_STEPS)
+    {
+        td->running_mask &= ~(1 << index);
+    }
+    else
+    {
+        /* not matched to a step, count it against the first running step */
+        td->running_mask &= (td->running_mask - 1);
+    }
+    if (td->running_mask)
+    {
+        /* wait for the other running steps to be cancelled */
+        return;
+    }
+
+    if (td->state == script_engine_failing)
+    {
+        scriptEngine_Complete(td->group_result);
+        return;
+    }
+
     /* clean up the script engine */
     scriptEngine_EngineReset();
 
@@ -256,6 +528,8 @@ bool ScriptEngine_StartScript(Task client_task,
 
     PanicFalse(td->state == script_engine_idle);
 
+    Procedures_SetImmediateCompleteCfmHandler(scriptEngine_ImmediateCompleteCfm);
+
     td->start_fn = proc_start_cfm_fn;
     td->complete_fn = proc_complete_fn;
     td->proc = proc;
@@ -263,9 +537,14 @@ bool ScriptEngine_StartScript(Task client_task,
 
     td->state = script_engine_active;
     td->next_step = 0;
+    td->group_step = NO_STEP_STARTING;
     td->script = script;
+    td->start_time_ms = VmGetClock();
+    td->chained_steps = 0;
 
+    td->starting_script = TRUE;
     scriptEngine_StartCurrentStep();
+    td->starting_script = FALSE;
 
     return TRUE;
 }
@@ -293,8 +572,8 @@ bool ScriptEngine_CancelScript(Task script_client,
     /* remember the cancel comfirm callback */
     td->cancel_fn = proc_cancel_cfm_fn;
 
-    /* cancel the current step */
-    NEXT_PROCEDURE(td->script)->proc_cancel_fn(scriptEngine_ProcCancelCfm);
+    /* cancel the current step(s) */
+    scriptEngine_CancelRunningSteps();
 
     return TRUE;
 }
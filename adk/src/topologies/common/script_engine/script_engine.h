@@ -27,6 +27,21 @@ The script engine executes a procedure script is executed in the following way:
 ** No further procedures in the list are run.
 ** Procedures which have already run successfully are not affected.
 
+A script may optionally be defined with #SCRIPT_CHAIN_STEPS. In such a script,
+procedures that complete within their start function are chained: the next
+procedure is started as soon as the start function returns, rather than after
+the delayed complete confirmation has been through the message loop. Only the
+completion of the whole script is delayed, if it happens while the script is
+being started. A chained step runs before any message queued by the previous
+step has been delivered, so only scripts whose steps do not depend on those
+messages should use it.
+
+A script may optionally mark steps with #SCRIPT_STEP_PARALLEL. A step marked
+this way is started together with the step that follows it, and the script
+only moves on once every step in the group has completed. If any step in a
+group fails, the other running steps in the group are cancelled before the
+failure is reported.
+
 */
 
 #ifndef SCRIPT_ENGINE_H
@@ -49,8 +64,26 @@ typedef struct
 
     /*! Number of procedures in the script. */
     size_t script_proc_list_size;
+
+    /*! Optional array of #SCRIPT_STEP_PARALLEL style flags, one per
+        procedure. May be NULL if no step uses them. */
+    const uint8* script_procs_flags;
+
+    /*! #SCRIPT_CHAIN_STEPS style flags for the whole script. */
+    uint8 script_flags;
 } procedure_script_t;
 
+/*! Step flag: start the following step without waiting for this one to
+    complete. */
+#define SCRIPT_STEP_PARALLEL    (1 << 0)
+
+/*! Script flag: start the next step as soon as a step that completes within
+    its start function returns. */
+#define SCRIPT_CHAIN_STEPS      (1 << 0)
+
+/*! Maximum number of steps that can run in parallel in a script. */
+#define SCRIPT_ENGINE_MAX_PARALLEL_STEPS (8)
+
 
 /*! Helper macro to use when defining a topology script.
 
@@ -68,6 +101,21 @@ typedef struct
 #define XDEF_TOPOLOGY_SCRIPT_DATA(fns,data) data
 
 
+/*! Helper macro used in definining a topology script with step flags.
+
+    This macro selects the FN element of an entry */
+#define XDEF_TOPOLOGY_SCRIPT_STEP_FNS(fns,data,flags) &fns
+
+/*! Helper macro used in definining a topology script with step flags.
+
+    This macro selects the data element of an entry */
+#define XDEF_TOPOLOGY_SCRIPT_STEP_DATA(fns,data,flags) data
+
+/*! Helper macro used in definining a topology script with step flags.
+
+    This macro selects the flags element of an entry */
+#define XDEF_TOPOLOGY_SCRIPT_STEP_FLAGS(fns,data,flags) flags
+
 /*! Macro used to define a Topology script.
 
     The macro is used to define a script and creates the three tables necessary.
@@ -106,6 +154,63 @@ typedef struct
         ARRAY_DIM(name##_procs), \
     }
 
+/*! Macro used to define a Topology script whose synchronous steps are chained.
+
+    As #DEFINE_TOPOLOGY_SCRIPT, but the script is flagged with
+    #SCRIPT_CHAIN_STEPS.
+*/
+#define DEFINE_CHAINED_TOPOLOGY_SCRIPT(name, list) \
+    const procedure_fns_t * const name##_procs[] = { \
+        list(XDEF_TOPOLOGY_SCRIPT_FNS) \
+        }; \
+    const Message name##_procs_data[] = { \
+        list(XDEF_TOPOLOGY_SCRIPT_DATA) \
+        }; \
+    const procedure_script_t name##_script = { \
+        name##_procs, \
+        name##_procs_data, \
+        ARRAY_DIM(name##_procs), \
+        NULL, \
+        SCRIPT_CHAIN_STEPS, \
+    }
+
+/*! Macro used to define a Topology script where some steps run in parallel.
+
+    As #DEFINE_TOPOLOGY_SCRIPT, but each entry in the list also has flags.
+    Consecutive steps flagged with #SCRIPT_STEP_PARALLEL are started together
+    with the first step after them that is not. Flags for the whole script,
+    such as #SCRIPT_CHAIN_STEPS, are passed as script_flags.
+
+    \usage
+
+    <PRE>
+        #define MY_SCRIPT(ENTRY) \
+            ENTRY(proc_disconnect_handset_fns, NO_DATA, SCRIPT_STEP_PARALLEL), \
+            ENTRY(proc_cancel_find_role_fns, NO_DATA, 0), \
+            ENTRY(proc_set_role_fns, PROC_SET_ROLE_TYPE_DATA_NONE, 0),
+
+        // Define the script my_script
+        DEFINE_TOPOLOGY_SCRIPT_WITH_FLAGS(my,MY_SCRIPT,0);
+    </PRE>
+*/
+#define DEFINE_TOPOLOGY_SCRIPT_WITH_FLAGS(name, list, script_flags) \
+    const procedure_fns_t * const name##_procs[] = { \
+        list(XDEF_TOPOLOGY_SCRIPT_STEP_FNS) \
+        }; \
+    const Message name##_procs_data[] = { \
+        list(XDEF_TOPOLOGY_SCRIPT_STEP_DATA) \
+        }; \
+    const uint8 name##_procs_flags[] = { \
+        list(XDEF_TOPOLOGY_SCRIPT_STEP_FLAGS) \
+        }; \
+    const procedure_script_t name##_script = { \
+        name##_procs, \
+        name##_procs_data, \
+        ARRAY_DIM(name##_procs), \
+        name##_procs_flags, \
+        script_flags, \
+    }
+
 /*! \brief Start a scripted sequence of procedures.
 
     Along with the script and the procedure id associated with it the client
@@ -138,7 +243,7 @@ bool ScriptEngine_StartScript(Task client_task,
     started the currently running script. If they are different this function
     will panic.
 
-    The script engine will cancel the currently running procedure and then
+    The script engine will cancel the currently running procedure(s) and then
     end processing the script. It does not try to cancel any procedures in the
     script that have already completed.
 
@@ -41,7 +41,9 @@
      - the contention policy of the goal
         - can cancel other goals
         - can execute concurrently with other goals
+        - can execute alongside any goals except those it conflicts with
         - must wait for other goal completion
+     - the goals that must complete before the goal is started
      - function pointers to the procedure or script to achieve the goal
      - events to generate back into the role rules engine following goal completion
         - success, failure or timeout are supported
@@ -51,23 +53,29 @@
 */
 const goal_entry_t hsgoals[] =
 {
-    GOAL_WITH_CONCURRENCY(hs_topology_goal_connect_handset, hs_topology_procedure_connect_handset,
-                          &hs_proc_connect_handset_fns, hs_topology_goal_disconnect_handset,
-                          CONCURRENT_GOALS_INIT(hs_topology_goal_connectable_handset,
-                                                hs_topology_goal_allow_handset_connect)),
+    /* Handset connections must be allowed before connecting, or the handset's
+       profile connections would be rejected */
+    GOAL_WITH_CONFLICTS_AND_DEPENDENCIES(hs_topology_goal_connect_handset, hs_topology_procedure_connect_handset,
+                                         &hs_proc_connect_handset_fns, hs_topology_goal_disconnect_handset,
+                                         CONFLICTING_GOALS_INIT(hs_topology_goal_disconnect_handset,
+                                                                hs_topology_goal_allow_le_connection,
+                                                                hs_topology_goal_system_stop),
+                                         DEPENDS_ON_GOALS_INIT(hs_topology_goal_allow_handset_connect)),
 
     GOAL(hs_topology_goal_disconnect_handset, hs_topology_procedure_disconnect_handset,
          &hs_proc_disconnect_handset_fns, hs_topology_goal_connect_handset), 
 
-    GOAL_WITH_CONCURRENCY(hs_topology_goal_connectable_handset, hs_topology_procedure_enable_connectable_handset,
-                          &hs_proc_enable_connectable_handset_fns, hs_topology_goal_none,
-                          CONCURRENT_GOALS_INIT(hs_topology_goal_connect_handset,
-                                                hs_topology_goal_allow_handset_connect)),
-
-    GOAL_WITH_CONCURRENCY(hs_topology_goal_allow_handset_connect, hs_topology_procedure_allow_handset_connection,
-                          &hs_proc_allow_handset_connect_fns, hs_topology_goal_none,
-                          CONCURRENT_GOALS_INIT(hs_topology_goal_connectable_handset,
-                                                    hs_topology_goal_connect_handset)),
+    GOAL_WITH_CONFLICTS(hs_topology_goal_connectable_handset, hs_topology_procedure_enable_connectable_handset,
+                        &hs_proc_enable_connectable_handset_fns, hs_topology_goal_none,
+                        CONFLICTING_GOALS_INIT(hs_topology_goal_disconnect_handset,
+                                               hs_topology_goal_allow_le_connection,
+                                               hs_topology_goal_system_stop)),
+
+    GOAL_WITH_CONFLICTS(hs_topology_goal_allow_handset_connect, hs_topology_procedure_allow_handset_connection,
+                        &hs_proc_allow_handset_connect_fns, hs_topology_goal_none,
+                        CONFLICTING_GOALS_INIT(hs_topology_goal_disconnect_handset,
+                                               hs_topology_goal_allow_le_connection,
+                                               hs_topology_goal_system_stop)),
 
     GOAL(hs_topology_goal_allow_le_connection, hs_topology_procedure_allow_le_connection,
                            &hs_proc_allow_le_connection_fns, hs_topology_goal_none),
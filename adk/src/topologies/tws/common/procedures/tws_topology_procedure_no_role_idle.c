@@ -46,6 +46,7 @@
     ENTRY(proc_allow_connection_over_bredr_fns, PROC_ALLOW_CONNECTION_OVER_BREDR_ENABLE)
 
 
-/* Define the no_role_idle_script */
-DEFINE_TOPOLOGY_SCRIPT(no_role_idle, NO_ROLE_IDLE_SCRIPT);
+/* Define the no_role_idle_script. No step waits on a message queued by the
+   step before it, so synchronous steps are chained. */
+DEFINE_CHAINED_TOPOLOGY_SCRIPT(no_role_idle, NO_ROLE_IDLE_SCRIPT);
 
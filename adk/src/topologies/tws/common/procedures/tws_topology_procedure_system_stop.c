@@ -38,23 +38,25 @@ const TWSTOP_PROC_SEND_MESSAGE_PARAMS_T system_stop_finished = {PROC_SEND_TOPOLO
 #define PROC_SEND_TOPOLOGY_MESSAGE_SYSTEM_STOP_FINISHED_MESSAGE ((Message)&system_stop_finished)
 
 
+/* Cancelling find role does not depend on the handset, so it runs while
+   the handset is disconnected */
 #define SYSTEM_STOP_SCRIPT(ENTRY) \
-    ENTRY(proc_start_stop_script_fns, NO_DATA), \
-    ENTRY(proc_allow_connection_over_le_fns, PROC_ALLOW_CONNECTION_OVER_LE_DISABLE), \
-    ENTRY(proc_allow_connection_over_bredr_fns, PROC_ALLOW_CONNECTION_OVER_BREDR_DISABLE), \
-    ENTRY(proc_allow_handset_connect_fns, PROC_ALLOW_HANDSET_CONNECT_DATA_DISABLE), \
-    ENTRY(proc_permit_bt_fns, PROC_PERMIT_BT_DISABLE), \
-    ENTRY(proc_enable_connectable_handset_fns, PROC_ENABLE_CONNECTABLE_HANDSET_DATA_DISABLE), \
-    ENTRY(proc_enable_connectable_peer_fns, PROC_ENABLE_CONNECTABLE_PEER_DATA_DISABLE), \
-    ENTRY(proc_enable_le_connectable_handset_fns,PROC_ENABLE_LE_CONNECTABLE_PARAMS_DISABLE), \
-    ENTRY(proc_disconnect_handset_fns, NO_DATA), \
-    ENTRY(proc_release_peer_fns, NO_DATA), \
-    ENTRY(proc_cancel_find_role_fns, NO_DATA), \
-    ENTRY(proc_clean_connections_fns, NO_DATA), \
-    ENTRY(proc_set_address_fns, PROC_SET_ADDRESS_TYPE_DATA_PRIMARY_NO_PANIC), \
-    ENTRY(proc_set_role_fns, PROC_SET_ROLE_TYPE_DATA_NONE), \
-    ENTRY(proc_send_topology_message_fns, PROC_SEND_TOPOLOGY_MESSAGE_SYSTEM_STOP_FINISHED_MESSAGE)
-
-/* Define the no_role_idle_script */
-DEFINE_TOPOLOGY_SCRIPT(system_stop, SYSTEM_STOP_SCRIPT);
+    ENTRY(proc_start_stop_script_fns, NO_DATA, 0), \
+    ENTRY(proc_allow_connection_over_le_fns, PROC_ALLOW_CONNECTION_OVER_LE_DISABLE, 0), \
+    ENTRY(proc_allow_connection_over_bredr_fns, PROC_ALLOW_CONNECTION_OVER_BREDR_DISABLE, 0), \
+    ENTRY(proc_allow_handset_connect_fns, PROC_ALLOW_HANDSET_CONNECT_DATA_DISABLE, 0), \
+    ENTRY(proc_permit_bt_fns, PROC_PERMIT_BT_DISABLE, 0), \
+    ENTRY(proc_enable_connectable_handset_fns, PROC_ENABLE_CONNECTABLE_HANDSET_DATA_DISABLE, 0), \
+    ENTRY(proc_enable_connectable_peer_fns, PROC_ENABLE_CONNECTABLE_PEER_DATA_DISABLE, 0), \
+    ENTRY(proc_enable_le_connectable_handset_fns,PROC_ENABLE_LE_CONNECTABLE_PARAMS_DISABLE, 0), \
+    ENTRY(proc_disconnect_handset_fns, NO_DATA, SCRIPT_STEP_PARALLEL), \
+    ENTRY(proc_cancel_find_role_fns, NO_DATA, 0), \
+    ENTRY(proc_release_peer_fns, NO_DATA, 0), \
+    ENTRY(proc_clean_connections_fns, NO_DATA, 0), \
+    ENTRY(proc_set_address_fns, PROC_SET_ADDRESS_TYPE_DATA_PRIMARY_NO_PANIC, 0), \
+    ENTRY(proc_set_role_fns, PROC_SET_ROLE_TYPE_DATA_NONE, 0), \
+    ENTRY(proc_send_topology_message_fns, PROC_SEND_TOPOLOGY_MESSAGE_SYSTEM_STOP_FINISHED_MESSAGE, 0)
+
+/* Define the system_stop_script */
+DEFINE_TOPOLOGY_SCRIPT_WITH_FLAGS(system_stop, SYSTEM_STOP_SCRIPT, 0);
 
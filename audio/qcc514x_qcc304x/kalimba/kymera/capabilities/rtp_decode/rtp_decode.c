@@ -1592,6 +1592,9 @@ bool rtp_decode_opmsg_set_working_mode(OPERATOR_DATA *op_data, void *message_dat
 
             ttp_get_default_params(&params, TTP_TYPE_A2DP);
             ttp_configure_params(opx_data->ttp_instance, &params);
+
+            /* Latency changes while streaming are walked in rather than stepped */
+            ttp_configure_latency_slew(opx_data->ttp_instance, TRUE);
         }
     }
 
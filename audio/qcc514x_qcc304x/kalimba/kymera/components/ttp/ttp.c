@@ -33,6 +33,7 @@ struct ttp_context
 {
     TIME ttp;
     TIME_INTERVAL target_latency;
+    TIME_INTERVAL configured_latency;
     TIME_INTERVAL countdown;
     TIME_INTERVAL error_offset;
     TIME_INTERVAL old_latency;
@@ -55,6 +56,8 @@ struct ttp_context
     bool startup_ttp_override;
     ttp_mode mode;
     unsigned resync_count;
+    /** Walk the target latency to a new value while running instead of stepping it */
+    bool latency_slew;
 };
 
 
@@ -93,6 +96,13 @@ Private Macro Declarations
 #define LATENCY_STEP_LIMIT -2000
 #define LATENCY_LEAK_FACTOR (FRACTIONAL(0.999))
 
+/* Limit on the rate at which the target latency is walked to a new value.
+ * Each block moves the latency by at most 1/LATENCY_SLEW_RATE_DIVISOR of the
+ * block duration, a 1% rate change that the timed playback SRA and warp can
+ * follow without discarding samples or inserting silence.
+ */
+#define LATENCY_SLEW_RATE_DIVISOR 100
+
 /* Fractional-part scaling for source time based TTP generation
  * Pick a power of 2 to make the calculations more efficient, exact value is not critical
  */
@@ -146,6 +156,38 @@ static void calc_filtered_error(ttp_context *context, TIME_INTERVAL raw_error)
         frac_mul_long((int48)raw_error << DAWTH, FRACTIONAL(1.0)-context->params.filter_gain);
 }
 
+/**
+ * slew_latency
+ *
+ * \brief  Move the target latency one step towards the configured latency
+ *
+ * The step is applied to the TTP as well, so the latency error estimate is
+ * unaffected and the consumer sees timestamps drifting at a bounded rate.
+ *
+ */
+static void slew_latency(ttp_context *context, TIME_INTERVAL period)
+{
+    TIME_INTERVAL step = context->configured_latency - context->target_latency;
+    TIME_INTERVAL max_step = MAX(period / LATENCY_SLEW_RATE_DIVISOR, 1);
+
+    if (step > max_step)
+    {
+        step = max_step;
+    }
+    else if (step < -max_step)
+    {
+        step = -max_step;
+    }
+
+    context->target_latency += step;
+    context->ttp = time_add(context->ttp, step);
+
+    if (context->target_latency == context->configured_latency)
+    {
+        TTP_WARN_MSG1("TTP target latency reached = %d", context->target_latency);
+    }
+}
+
 /**
  * get_msg_fractional
  *
@@ -182,8 +224,9 @@ static void ttp_startup(ttp_context *context, TIME time)
     }
     else
     {
-         context->ttp = time_add(time, context->target_latency);
+         context->ttp = time_add(time, context->configured_latency);
     }
+    context->target_latency = context->configured_latency;
     context->old_latency = context->target_latency;
 
 
@@ -473,12 +516,34 @@ void ttp_configure_latency(ttp_context *context, TIME_INTERVAL target_latency)
     patch_fn_shared(ttp_gen);
 
     /* Just copy the supplied value into the context structure
-     * If this needs to change while running, the estimation should be reset
-     * For now that's not supported
+     * If latency slew is enabled and the generator is running, the target
+     * latency is walked to the new value block by block. Otherwise the change
+     * takes effect as a step and the estimation should be reset.
      */
     TTP_WARN_MSG1("TTP target latency = %d", target_latency);
 
-    context->target_latency = target_latency;
+    context->configured_latency = target_latency;
+    if (!context->latency_slew || (context->state != TTP_STATE_RUNNING))
+    {
+        context->target_latency = target_latency;
+    }
+}
+
+/**
+ * ttp_configure_latency_slew
+ *
+ * \brief  Enable or disable walking the target latency while running
+ *
+ */
+void ttp_configure_latency_slew(ttp_context *context, bool enable)
+{
+    patch_fn_shared(ttp_gen);
+
+    context->latency_slew = enable;
+    if (!enable)
+    {
+        context->target_latency = context->configured_latency;
+    }
 }
 
 /**
@@ -709,6 +774,12 @@ void ttp_update_ttp_from_source_time(ttp_context *context, TIME toa, TIME source
     {
         /* TTP for this block is based on the calculated duration for the previous one */
         context->ttp = time_add(context->ttp, time_delta);
+
+        if ((context->state == TTP_STATE_RUNNING) &&
+            (context->target_latency != context->configured_latency))
+        {
+            slew_latency(context, time_delta);
+        }
     }
 
     /* calculate the raw error only for TTP_STATE_RUNNING or TTP_STATE_STARTUP */  
@@ -839,6 +910,12 @@ void ttp_update_ttp(ttp_context *context, TIME time, unsigned samples, ttp_statu
     {
         /* TTP for this block is based on the calculated duration for the previous one */
         context->ttp = time_add(context->ttp, (TIME_INTERVAL)context->delta);
+
+        if ((context->state == TTP_STATE_RUNNING) &&
+            (context->target_latency != context->configured_latency))
+        {
+            slew_latency(context, (TIME_INTERVAL)context->delta);
+        }
     }
 
     /* calculate the raw error only  for states TTP_STATE_RUNNING and TTP_STATE_STARTUP */
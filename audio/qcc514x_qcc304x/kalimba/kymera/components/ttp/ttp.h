@@ -211,6 +211,20 @@ extern void ttp_get_state_params_status(ttp_context *context,
 extern void ttp_configure_latency(ttp_context *context,
                                   TIME_INTERVAL target_latency);
 
+/**
+ * \brief Enable walking the target latency while running
+ *
+ * When enabled, a latency configured while the generator is running is
+ * reached gradually, with each block moving the TTP by at most 1% of its
+ * duration. A change of N milliseconds therefore takes about 100 * N
+ * milliseconds. The consumer follows the drift with its rate adjustment so
+ * the latency changes without a gap or a skip in the audio.
+ *
+ * \param context Pointer to active TTP context structure.
+ * \param enable  TRUE to walk to a new latency, FALSE to step to it.
+ */
+extern void ttp_configure_latency_slew(ttp_context *context, bool enable);
+
 /**
  * \brief Configure TTP sample period adjustment.
  *
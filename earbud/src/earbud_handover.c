@@ -30,6 +30,7 @@
 #include <marshal.h>
 #include <logging.h>
 #include <stdlib.h>
+#include <vm.h>
 
 #define EB_HANDOVER_DEBUG_VERBOSE_LOG DEBUG_LOG_VERBOSE
 
@@ -85,6 +86,14 @@ typedef struct {
     app_unmarshal_status_t unmarshalling_status;
 } handover_app_unmarshal_data_t;
 
+/*! \brief Time and space taken by a registered interface to marshal its types */
+typedef struct {
+    /* Time spent in the interface's marshal function and marshalling its objects, in microseconds */
+    uint32 marshal_us;
+    /* Number of bytes marshalled */
+    uint16 marshal_bytes;
+} handover_app_interface_stats_t;
+
 /*! \brief Handover context maintains the handover state for the application */
 typedef struct {
     /* Marshaling State */
@@ -117,6 +126,8 @@ typedef struct {
     uint8 unmarshal_data_list_size;
     /* Device being handed-over */
     tp_bdaddr tp_bd_addr;
+    /* Marshal statistics for the last handover, indexed as interfaces */
+    handover_app_interface_stats_t *interface_stats;
 } handover_app_context_t;
 
 /******************************************************************************
@@ -320,6 +331,24 @@ static const registered_handover_interface_t * getNextInterface(void)
     return NULL;
 }
 
+/*! \brief Log the time and space each registered interface took to marshal. */
+static void earbudHandover_LogMarshalStats(void)
+{
+    handover_app_context_t * app_data = earbudHandover_Get();
+    uint8 index;
+
+    for (index = 0; index < app_data->interfaces_len; index++)
+    {
+        const handover_app_interface_stats_t *stats = &app_data->interface_stats[index];
+
+        if (stats->marshal_bytes)
+        {
+            DEBUG_LOG("earbudHandover_Marshal interface %d marshalled %d bytes in %uus",
+                      index, stats->marshal_bytes, stats->marshal_us);
+        }
+    }
+}
+
 /*! \brief Commit the roles on all registered components.
     \param[in] tp_bd_addr Bluetooth address of the connected device / handset.
     \param[in] role TRUE if primary, FALSE otherwise
@@ -424,6 +453,7 @@ static bool earbudHandover_Marshal(const tp_bdaddr *addr, uint8 *buffer, uint16
             app_data->marshal.marshaller = MarshalInit(mtd_handover_app, NUMBER_OF_EARBUD_APP_MARSHAL_OBJECT_TYPES);
             PanicFalse(app_data->marshal.marshaller);
             app_data->curr_type = app_data->curr_interface->type_list->types;
+            memset(app_data->interface_stats, 0, app_data->interfaces_len * sizeof(*app_data->interface_stats));
         }
         else
         {
@@ -436,19 +466,27 @@ static bool earbudHandover_Marshal(const tp_bdaddr *addr, uint8 *buffer, uint16
     /* For all remaining registered interfaces. */
     while(marshalled && (app_data->curr_interface))
     {
+        handover_app_interface_stats_t *stats = &app_data->interface_stats[app_data->curr_interface - app_data->interfaces];
+
         /* For all remaining types in current interface. */
         while(app_data->curr_type < (app_data->curr_interface->type_list->types + app_data->curr_interface->type_list->list_size))
         {
+            uint32 start_us = VmGetTimerTime();
+
             if(app_data->curr_interface->Marshal(&addr->taddr.addr, *app_data->curr_type, &data))
             {
+                size_t produced = MarshalProduced(app_data->marshal.marshaller);
+
                 if(Marshal(app_data->marshal.marshaller, data, *app_data->curr_type))
                 {
+                    stats->marshal_bytes += MarshalProduced(app_data->marshal.marshaller) - produced;
                     EB_HANDOVER_DEBUG_VERBOSE_LOG("earbudHandover_Marshal - Marshalling successfull for type: %d", *app_data->curr_type);
                 }
                 else
                 {
                     /* Insufficient buffer for marshalling. */
                     DEBUG_LOG_WARN("earbudHandover_Marshal - Insufficient buffer for type: %d!", *app_data->curr_type);
+                    stats->marshal_us += VmGetTimerTime() - start_us;
                     marshalled = FALSE;
                     break;
                 }
@@ -457,6 +495,7 @@ static bool earbudHandover_Marshal(const tp_bdaddr *addr, uint8 *buffer, uint16
             {
                 /* Nothing to marshal for this type. Continue ahead. */
             }
+            stats->marshal_us += VmGetTimerTime() - start_us;
 
             /* Move to next Marshal type for current interface */
             app_data->curr_type++;
@@ -472,6 +511,10 @@ static bool earbudHandover_Marshal(const tp_bdaddr *addr, uint8 *buffer, uint16
                  */
                 app_data->curr_type = app_data->curr_interface->type_list->types;
             }
+            else
+            {
+                earbudHandover_LogMarshalStats();
+            }
         }
     }
 
@@ -589,6 +632,7 @@ bool EarbudHandover_Init(Task init_task)
     {
         app_data->interfaces = handover_interface_registrations_begin;
         app_data->interfaces_len = handover_registrations_array_dim;
+        app_data->interface_stats = PanicNull(calloc(handover_registrations_array_dim, sizeof(*app_data->interface_stats)));
     }
 
     /* Register handover interfaces with profile. We Panic if registration fails as handover will
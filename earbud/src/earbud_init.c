@@ -108,6 +108,7 @@
 #include <bredr_scan_manager.h>
 #include <connection_manager.h>
 #include <device_list.h>
+#include <device_properties.h>
 #include <hfp_profile.h>
 #include <scofwd_profile.h>
 #include <handover_profile.h>
@@ -507,6 +508,11 @@ static bool appInitDeviceDbSerialiser(Task init_task)
     /* Allow space in device list to store all paired devices + connected handsets not yet paired */
     DeviceList_Init(appConfigEarbudMaxDevicesSupported() + appConfigMaxNumOfHandsetsCanConnect());
 
+    /* Properties looked up on every connection and profile event */
+    DeviceList_AddPropertyIndex(device_property_bdaddr);
+    DeviceList_AddPropertyIndex(device_property_type);
+    DeviceList_AddPropertyIndex(device_property_flags);
+
     DeviceDbSerialiser_Deserialise();
 
     return TRUE;
@@ -55,6 +55,7 @@
 #include <ui_tones.h>
 #include <device_test_service.h>
 #include <device_test_service_config.h>
+#include <timestamp_event.h>
 #include <hfp_profile_config.h>
 
 #ifdef INCLUDE_FAST_PAIR
@@ -661,6 +662,8 @@ static void appExitParentStateInCase(void)
 {
     DEBUG_LOG_DEBUG("appExitParentStateInCase");
 
+    TimestampEvent(TIMESTAMP_EVENT_OUT_OF_CASE);
+
     /* run rules for being taken out of the case */
     appSmRulesResetEvent(RULE_EVENT_IN_CASE);
     appSmRulesSetEvent(RULE_EVENT_OUT_CASE);